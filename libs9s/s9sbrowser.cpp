@@ -29,8 +29,9 @@ S9sBrowser::S9sBrowser() :
     S9sDisplayList(),
     m_path("/"),
     m_isDebug(false),
-    m_nChars(0)
-
+    m_nChars(0),
+    m_searching(false),
+    m_nameIndexValid(false)
 {
     setHeaderHeight(2);
     setFooterHeight(3);
@@ -55,6 +56,20 @@ S9sBrowser::setCdt(
         m_path    = "/";
     }
 
+    subTreeChanged();
+}
+
+/**
+ * Called when the list of entries shown has been changed, drops everything
+ * that was computed from the previous list.
+ */
+void
+S9sBrowser::subTreeChanged()
+{
+    invalidateLines();
+    m_nameIndex.clear();
+    m_nameIndexValid = false;
+
     setNumberOfItems(m_subTree.nChildren());
 }
 
@@ -107,21 +122,118 @@ void
 S9sBrowser::setSelectionIndexByName(
         const S9sString &name)
 {
-    const S9sVector<S9sTreeNode> &childNodes = m_subTree.childNodes();
     int   index = 0;
 
-    for (uint idx = 0u; idx < childNodes.size(); ++idx)
+    if (m_nameIndexValid)
     {
-        if (childNodes[idx].name() != name)
-            continue;
+        S9sMap<S9sString, int>::const_iterator it = m_nameIndex.find(name);
+
+        if (it != m_nameIndex.end())
+            index = it->second;
+    } else {
+        for (int idx = 0; idx < m_subTree.nChildren(); ++idx)
+        {
+            if (m_subTree.childNode(idx).name() != name)
+                continue;
 
-        index = idx;
-        break;
+            index = idx;
+            break;
+        }
     }
 
     setSelectionIndex(index);
 }
 
+bool
+S9sBrowser::isSearching() const
+{
+    return m_searching;
+}
+
+/**
+ * \param prefix The beginning of the name to find.
+ * \returns The index of the entry with the name that is the first in
+ *   alphabetical order starting with the prefix, -1 if there is no such entry.
+ *
+ * The name index is built when it is first needed after the list changed, the
+ * lookups take logarithmic time, so searching while the user types is fast
+ * even in folders with many entries.
+ */
+int
+S9sBrowser::indexByPrefix(
+        const S9sString &prefix)
+{
+    S9sMap<S9sString, int>::const_iterator it;
+
+    if (!m_nameIndexValid)
+    {
+        for (int idx = 0; idx < m_subTree.nChildren(); ++idx)
+        {
+            // Only the first entry is indexed if more have the same name.
+            m_nameIndex.insert(
+                    std::make_pair(m_subTree.childNode(idx).name(), idx));
+        }
+
+        m_nameIndexValid = true;
+    }
+
+    it = m_nameIndex.lower_bound(prefix);
+    if (it == m_nameIndex.end() || !it->first.startsWith(STR(prefix)))
+        return -1;
+
+    return it->second;
+}
+
+/**
+ * \returns True if the key was used by the search, false if the search ended
+ *   and the key should be processed as usual.
+ *
+ * While searching the printable characters are added to the search string and
+ * the selection jumps to the first entry that starts with the string.
+ */
+bool
+S9sBrowser::processSearchKey(
+        int key)
+{
+    int index;
+
+    if (!m_searching)
+        return false;
+
+    switch (key)
+    {
+        case S9S_KEY_ENTER:
+        case S9S_KEY_ESC:
+            m_searching = false;
+            return true;
+
+        case S9S_KEY_BACKSPACE:
+            if (m_searchString.empty())
+            {
+                m_searching = false;
+                return true;
+            }
+
+            m_searchString.resize(m_searchString.length() - 1);
+            break;
+
+        default:
+            if (key < ' ' || key > '~')
+            {
+                m_searching = false;
+                return false;
+            }
+
+            m_searchString += (char) key;
+    }
+
+    index = indexByPrefix(m_searchString);
+    if (index >= 0)
+        setSelectionIndex(index);
+
+    return true;
+}
+
 void
 S9sBrowser::processKey(
         int key)
@@ -130,6 +242,9 @@ S9sBrowser::processKey(
         return;
 
     resetActivatedStatus();
+
+    if (processSearchKey(key))
+        return;
     
     switch (key)
     {
@@ -147,9 +262,8 @@ S9sBrowser::processKey(
                     m_path = S9sFile::dirname(m_path);
 
                     m_rootNode.subTree(m_path, m_subTree);
+                    subTreeChanged();
                     setSelectionIndexByName(parentBasename);
-
-                    setNumberOfItems(m_subTree.nChildren());
                 } else if (node.nChildren() > 0)
                 {
                     if (!m_path.endsWith("/"))
@@ -158,7 +272,7 @@ S9sBrowser::processKey(
                     m_path += node.name();
                     m_rootNode.subTree(m_path, m_subTree);
                     setSelectionIndex(0);
-                    setNumberOfItems(m_subTree.nChildren());
+                    subTreeChanged();
                 } else {
                     m_acivatedPath  = selectedNodeFullPath();
                     m_activatedNode = selectedNode();
@@ -168,6 +282,12 @@ S9sBrowser::processKey(
 
         case 'd':
             m_isDebug = !m_isDebug;
+            invalidateLines();
+            return;
+
+        case '/':
+            m_searching    = true;
+            m_searchString = "";
             return;
     }
 
@@ -245,7 +365,7 @@ S9sBrowser::printLine(
     column3 = column2 + 10;
 
     m_nChars = 0;
-    ::printf("%s", normal);
+    s9s_printf("%s", normal);
     if (lineIndex == 0)
     {
         printChar("╔");
@@ -256,9 +376,9 @@ S9sBrowser::printLine(
         {
             if (m_nChars == column1 || 
                     m_nChars == column2 || m_nChars == column3)
-                ::printf("╤"); 
+                s9s_printf("╤"); 
             else
-                ::printf("═");
+                s9s_printf("═");
 
             ++m_nChars;
         }
@@ -266,20 +386,20 @@ S9sBrowser::printLine(
         printChar("╗");
     } else if (lineIndex == 1) 
     {
-        ::printf("║");
+        s9s_printf("║");
    
         header1Format.printf("Name");
-        ::printf("│"); 
+        s9s_printf("│"); 
         
         header2Format.printf("User");
-        ::printf("│"); 
+        s9s_printf("│"); 
         
         header3Format.printf("Group");
-        ::printf("│"); 
+        s9s_printf("│"); 
         
         header4Format.printf("Mode");
 
-        ::printf("║");
+        s9s_printf("║");
     } else if (lineIndex == height() - 1)
     {
         // Last line, frame.
@@ -296,9 +416,9 @@ S9sBrowser::printLine(
                     m_nChars == column2 || 
                     m_nChars == column3)
             {
-                ::printf("┴"); 
+                s9s_printf("┴"); 
             } else {
-                ::printf("─");
+                s9s_printf("─");
             }
 
             ++m_nChars;
@@ -312,12 +432,18 @@ S9sBrowser::printLine(
         //
         printChar("║");
         printString(" ");
-        printString(m_name);
+        
+        if (m_searching)
+            printString("/" + m_searchString);
+        else
+            printString(m_name);
+
         printChar(" ", width() - 1);
         printChar("║");
     } else {
         /*
-         * The normal lines, showing data.
+         * The normal lines, showing data. Only the visible lines are
+         * formatted and the lines that are not selected are cached.
          */
         S9sTreeNode node;
         int         listIndex = lineIndex - 2 + firstVisibleIndex();
@@ -325,11 +451,17 @@ S9sBrowser::printLine(
         S9sString   owner;
         S9sString   group;
         S9sString   mode;
+        S9sString   line;
         bool        selected;
 
         ensureSelectionVisible();
         
         selected = isSelected(listIndex) && hasFocus();
+        if (!selected && !m_isDebug && cachedLine(listIndex, line))
+        {
+            s9s_printf("%s", STR(line));
+            return;
+        }
 
         if (listIndex < m_subTree.nChildren())
         {
@@ -356,49 +488,48 @@ S9sBrowser::printLine(
             }
         }
 
-
-        ::printf("║");
+        line = "║";
 
         if (selected)
-            ::printf("%s", selection);
+            line += selection;
         else if (node.isFolder())
-            ::printf("%s", folder);
+            line += folder;
         else if (node.isDevice())
-            ::printf("%s", deviceColor);
+            line += deviceColor;
         else if (node.isFile() && node.isExecutable())
-            ::printf("%s", execColor);
+            line += execColor;
         else if (false && node.isUser())
-            ::printf("%s", user);
+            line += user;
         else if (false && node.isGroup())
-            ::printf("%s", groupColor);
+            line += groupColor;
         else if (false && node.isFile())
-            ::printf("%s", file);
+            line += file;
         else if (false && node.isCluster())
-            ::printf("%s", cluster);
+            line += cluster;
         else if (false && node.isNode())
-            ::printf("%s", hostColor);
-
-        column1Format.printf(name);
-        
-        if (selected)
-            ::printf("%s%s", TERM_NORMAL, selection);
-        else
-            ::printf("%s%s", TERM_NORMAL, normal);
+            line += hostColor;
 
-        ::printf("│"); 
+        line += column1Format.toString(name);
+        line += TERM_NORMAL;
+        line += selected ? selection : normal;
+        line += "│"; 
         
-        column2Format.printf(owner);
-        ::printf("│"); 
+        line += column2Format.toString(owner);
+        line += "│"; 
         
-        column3Format.printf(group);
-        ::printf("│"); 
+        line += column3Format.toString(group);
+        line += "│"; 
         
-        column4Format.printf(mode);
+        line += column4Format.toString(mode);
         
-        //if (selected)
-        ::printf("%s%s", TERM_NORMAL, normal);
+        line += TERM_NORMAL;
+        line += normal;
+        line += "║";
+
+        if (!selected)
+            setCachedLine(listIndex, line);
 
-        ::printf("║");
+        s9s_printf("%s", STR(line));
     }
 }
 
@@ -415,7 +546,7 @@ S9sBrowser::printString(
     if ((int)theString.length() > availableChars)
         myString.resize(availableChars);
 
-    ::printf("%s", STR(myString));
+    s9s_printf("%s", STR(myString));
     m_nChars += myString.length();
 }
 
@@ -423,7 +554,7 @@ void
 S9sBrowser::printChar(
         int c)
 {
-    ::printf("%c", c);
+    s9s_printf("%c", c);
     ++m_nChars;
 }
 
@@ -431,7 +562,7 @@ void
 S9sBrowser::printChar(
         const char *c)
 {
-    ::printf("%s", c);
+    s9s_printf("%s", c);
     ++m_nChars;
 }
 
@@ -442,7 +573,7 @@ S9sBrowser::printChar(
 {
     while (m_nChars < lastColumn)
     {
-        ::printf("%s", c);
+        s9s_printf("%s", c);
         ++m_nChars;
     }
 }
@@ -21,6 +21,7 @@
 
 #include "s9sdisplaylist.h"
 #include "s9streenode.h"
+#include "s9smap.h"
 
 class S9sBrowser :
     public S9sDisplayList
@@ -46,7 +47,13 @@ class S9sBrowser :
 
         void setSelectionIndexByName(const S9sString &name);
 
+        bool isSearching() const;
+        bool processSearchKey(int key);
+
     private:
+        void subTreeChanged();
+        int indexByPrefix(const S9sString &prefix);
+
         void printString(const S9sString &theString);
         void printChar(int c);
         void printChar(const char *c);
@@ -68,4 +75,11 @@ class S9sBrowser :
         bool                         m_isDebug;
         /** Transient value shows the position in the line. */
         int                          m_nChars;
+        /** True while the user is typing a name to search for. */
+        bool                         m_searching;
+        /** The beginning of the name the user typed while searching. */
+        S9sString                    m_searchString;
+        /** The index of the first child by name, built when searching. */
+        S9sMap<S9sString, int>       m_nameIndex;
+        bool                         m_nameIndexValid;
 };
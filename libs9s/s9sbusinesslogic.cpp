@@ -29,9 +29,17 @@
 #include "s9srsakey.h"
 #include "s9sdir.h"
 #include "s9scmongraph.h"
+#include "s9sgraphfollower.h"
 #include "s9smonitor.h"
 #include "s9scalc.h"
 #include "s9scommander.h"
+#include "s9sjobwaiter.h"
+#include "s9slogfollower.h"
+#include "s9seventindex.h"
+#include "s9seventcheckpoints.h"
+#include "s9spollscheduler.h"
+#include "s9srecordwriter.h"
+#include "s9sstatrequest.h"
 
 #include <stdio.h>
 #include <unistd.h>
@@ -345,7 +353,10 @@ S9sBusinessLogic::execute()
         }
     } else if (options->isLogOperation())
     {
-        if (options->isListRequested())
+        if (options->isFollowRequested())
+        {
+            executeLogFollow(client);
+        } else if (options->isListRequested())
         {
             executeLogList(client);
         } else {
@@ -391,7 +402,10 @@ S9sBusinessLogic::execute()
         }
     } else if (options->isEventOperation())
     {
-        if (options->isListRequested())
+        if (options->isBuildIndexRequested())
+        {
+            executeEventBuildIndex();
+        } else if (options->isListRequested())
         {
             // s9s event --list
             S9sMonitor monitor(client);
@@ -914,6 +928,10 @@ S9sBusinessLogic::execute()
         } else if (options->isLogRequested())
         {
             executeJobLog(client);
+        } else if (options->isAllRunningRequested() || 
+                options->jobIds().size() > 1u)
+        {
+            waitForJobs(clusterId, client);
         } else if (options->isWaitRequested())
         {
             waitForJob(clusterId, options->jobId(), client);
@@ -1564,7 +1582,9 @@ S9sBusinessLogic::execute()
  *
  * This method waits for the given job to be finished (or failed, or aborted)
  * and will provide feedback in the form the user requested in the command 
- * line (printing job messages or a progress bar).
+ * line (printing job messages or a progress bar). The events sent by the
+ * controller about the job are used to notice the changes right away, the
+ * controller is polled with an adaptive interval otherwise.
  */
 void 
 S9sBusinessLogic::waitForJob(
@@ -1572,14 +1592,365 @@ S9sBusinessLogic::waitForJob(
         const int       jobId, 
         S9sRpcClient   &client)
 {
-    S9sOptions  *options = S9sOptions::instance();
+    S9sOptions   *options = S9sOptions::instance();
+    S9sJobWaiter  waiter(client, jobId);
     
+    // The events about the job wake us up, so we don't have to poll the
+    // controller every second.
+    waiter.start();
+
     if (options->isLogRequested() || options->isFollowRequested())
     {
-        waitForJobWithLog(clusterId, jobId, client);
+        waitForJobWithLog(clusterId, jobId, client, waiter);
     } else {
-        waitForJobWithProgress(clusterId, jobId, client);
+        waitForJobWithProgress(clusterId, jobId, client, waiter);
+    }
+
+    waiter.stop();
+    PRINT_LOG("Waited for job %d, %llu events, %llu wakeups.", 
+            jobId, waiter.nEvents(), waiter.nWakeups());
+}
+
+/**
+ * \param job The job as it is sent by the controller.
+ * \returns True if the job is ended (finished, failed or aborted).
+ */
+static bool
+isJobEnded(
+        const S9sVariantMap &job)
+{
+    S9sString status = job.valueByPath("status").toString();
+
+    return status == "FINISHED" || status == "FAILED" || status == "ABORTED";
+}
+
+/**
+ * \param clusterId The cluster ID set in the command line, used with the
+ *   --all-running option.
+ * \param client A client for the communication.
+ *
+ * Waits for multiple jobs at once ("s9s job --wait --job-id=1,2,3" or "s9s job
+ * --wait --all-running"). Instead of polling all the jobs one by one the
+ * running jobs are queried with one request and the jobs are checked again
+ * when the controller sends an event about them. A line is printed every time
+ * the state of a job changes (or the job messages are printed with the
+ * --follow option, prefixed by the job ID). A job the controller can not find
+ * is reported and dropped, the other jobs are still waited for. The exit
+ * status shows if any of the jobs failed or could not be waited for.
+ */
+void
+S9sBusinessLogic::waitForJobs(
+        const int     clusterId,
+        S9sRpcClient &client)
+{
+    S9sOptions             *options = S9sOptions::instance();
+    bool                    syntaxHighlight = options->useSyntaxHighlight();
+    bool                    withLog = options->isFollowRequested();
+    S9sString               clusterName = options->clusterName();
+    S9sVariantList          jobIds = options->jobIds();
+    S9sJobWaiter            waiter(client, -1);
+    S9sMap<int, bool>       pending;
+    S9sMap<int, S9sString>  jobStates;
+    S9sMap<int, int>        nLogsPrinted;
+    S9sVector<int>          toCheck;
+    S9sRpcReply             reply;
+    S9sPollScheduler        retry(500, 8000, 20);
+    bool                    success;
+    int                     nFailures = 0;
+    int                     nAuthentications = 0;
+    int                     nSucceeded = 0;
+    int                     nFailed = 0;
+    int                     nUnknown = 0;
+
+    /*
+     * With the --all-running option we wait for the jobs that are running
+     * now.
+     */
+    if (options->isAllRunningRequested())
+    {
+        success = client.getRunningJobInstances(clusterName, clusterId);
+        if (success)
+        {
+            reply   = client.reply();
+            success = reply.isOk();
+        }
+
+        if (!success)
+        {
+            if (!client.errorString().empty())
+                PRINT_ERROR("%s", STR(client.errorString()));
+            else
+                PRINT_ERROR("%s", STR(reply.errorString()));
+
+            client.setExitStatus();
+            return;
+        }
+
+        S9sVariantList jobList = reply.jobs();
+
+        jobIds.clear();
+        for (uint idx = 0u; idx < jobList.size(); ++idx)
+        {
+            S9sVariantMap job = jobList[idx].toVariantMap();
+
+            if (!isJobEnded(job) && job["status"] != "SCHEDULED")
+                jobIds << job["job_id"];
+        }
+    }
+
+    if (jobIds.empty())
+    {
+        if (!options->isBatchRequested())
+            printf("No jobs to wait for.\n");
+
+        return;
+    }
+
+    for (uint idx = 0u; idx < jobIds.size(); ++idx)
+    {
+        int jobId = jobIds[idx].toInt();
+
+        pending[jobId]      = true;
+        nLogsPrinted[jobId] = 0;
+        waiter.addJob(jobId);
+    }
+
+    waiter.start();
+    toCheck = pending.keys();
+
+    while (!pending.empty())
+    {
+        S9sMap<int, S9sVariantMap> jobs;
+        S9sVector<int>             moreLogs;
+        bool                       changed = false;
+
+        success = true;
+
+        /*
+         * If we check more than one job we get the running jobs in one
+         * request. The jobs that are not in the reply are probably ended, we
+         * get them one by one.
+         */
+        if (!withLog && toCheck.size() > 1u)
+        {
+            success = client.getRunningJobInstances(clusterName, clusterId);
+            if (success)
+            {
+                reply   = client.reply();
+                success = reply.isOk();
+            }
+
+            if (success)
+            {
+                S9sVariantList jobList = reply.jobs();
+
+                for (uint idx = 0u; idx < jobList.size(); ++idx)
+                {
+                    S9sVariantMap job = jobList[idx].toVariantMap();
+
+                    jobs[job["job_id"].toInt()] = job;
+                }
+            }
+        }
+
+        for (uint idx = 0u; success && idx < toCheck.size(); ++idx)
+        {
+            int            jobId = toCheck[idx];
+            S9sVariantMap  job;
+            S9sString      state;
+            
+            if (!pending.contains(jobId))
+                continue;
+
+            if (withLog)
+            {
+                int nEntries;
+
+                success = client.getJobLog(
+                        jobId, 300, nLogsPrinted[jobId], false);
+
+                if (success)
+                {
+                    reply   = client.reply();
+                    success = reply.isOk() || !reply.isAuthRequired();
+                }
+
+                if (!success)
+                    break;
+
+                if (!reply.isOk())
+                {
+                    PRINT_ERROR("Job %d: %s", jobId, STR(reply.errorString()));
+                    ++nUnknown;
+                    pending.erase(jobId);
+                    waiter.removeJob(jobId);
+                    continue;
+                }
+
+                nEntries = reply["messages"].toVariantList().size();
+                if (nEntries > 0)
+                {
+                    if (options->hasLogFormat() || options->isJsonRequested())
+                        reply.printJobLog();
+                    else
+                        reply.printJobLogBrief("%4J %M\n");
+
+                    changed = true;
+                }
+
+                if (nEntries >= 300)
+                    moreLogs << jobId;
+
+                nLogsPrinted[jobId] += nEntries;
+                job = reply["job"].toVariantMap();
+            } else if (jobs.contains(jobId))
+            {
+                job = jobs[jobId];
+            } else {
+                success = client.getJobInstanceForWait(jobId);
+                if (success)
+                {
+                    reply   = client.reply();
+                    success = reply.isOk() || !reply.isAuthRequired();
+                }
+
+                if (!success)
+                    break;
+
+                /*
+                 * The controller replied, but it can not give us this job
+                 * (e.g. there is no job with this ID), so we stop waiting for
+                 * it and go on with the others.
+                 */
+                if (!reply.isOk())
+                {
+                    PRINT_ERROR("Job %d: %s", jobId, STR(reply.errorString()));
+                    ++nUnknown;
+                    pending.erase(jobId);
+                    waiter.removeJob(jobId);
+                    continue;
+                }
+
+                job = reply["job"].toVariantMap();
+            }
+
+            /*
+             * Printing a line when the state of the job changes.
+             */
+            state = job["status"].toString() + ":" + 
+                job["progress_percent"].toString() + ":" + 
+                job["status_text"].toString();
+
+            if (state != jobStates[jobId])
+            {
+                jobStates[jobId] = state;
+                changed          = true;
+
+                if (!withLog && !options->isBatchRequested())
+                {
+                    S9sRpcReply jobReply;
+                    S9sString   progressLine;
+
+                    jobReply["job"] = job;
+                    jobReply.progressLine(progressLine, syntaxHighlight);
+                    printf("%s %s\n", 
+                            STR(progressLine), STR(job["title"].toString()));
+                }
+            }
+
+            if (isJobEnded(job) && !moreLogs.contains(jobId))
+            {
+                if (job["status"] == "FINISHED")
+                    ++nSucceeded;
+                else
+                    ++nFailed;
+
+                if (withLog && !options->isBatchRequested())
+                {
+                    printf("%4d Job %s.\n", 
+                            jobId, STR(job["status"].toString()));
+                }
+
+                pending.erase(jobId);
+                waiter.removeJob(jobId);
+            }
+        }
+
+        fflush(stdout);
+
+        /*
+         * Handling the errors the same way we do while waiting for one job.
+         */
+        if (!success)
+        {
+            if (reply.isAuthRequired() && nAuthentications < 3)
+            {
+                ++nAuthentications;
+                client.authenticate();
+                continue;
+            }
+
+            if (!client.errorString().empty())
+                PRINT_ERROR("%s", STR(client.errorString()));
+            else if (!reply.errorString().empty())
+                PRINT_ERROR("%s", STR(reply.errorString()));
+            else 
+                PRINT_ERROR("Error while getting the jobs.");
+
+            ++nFailures;
+            if (nFailures > 3)
+                break;
+
+            usleep(retry.nextDelay(false) * 1000);
+            continue;
+        }
+
+        nFailures        = 0;
+        nAuthentications = 0;
+        retry.reset();
+
+        if (pending.empty())
+            break;
+
+        /*
+         * Waiting for events about the jobs. If the wait timed out or the
+         * event stream was interrupted we check all the jobs.
+         */
+        if (moreLogs.empty())
+        {
+            waiter.setPollHint(client.pollIntervalHint());
+            waiter.waitForUpdate(changed);
+        }
+
+        toCheck = waiter.updatedJobs();
+        if (toCheck.empty() && moreLogs.empty())
+            toCheck = pending.keys();
+
+        for (uint idx = 0u; idx < moreLogs.size(); ++idx)
+        {
+            if (!toCheck.contains(moreLogs[idx]))
+                toCheck << moreLogs[idx];
+        }
     }
+
+    waiter.stop();
+
+    if (!options->isBatchRequested())
+    {
+        printf("%d job(s) finished, %d failed", nSucceeded, nFailed);
+        if (nUnknown > 0)
+            printf(", %d not found", nUnknown);
+
+        if (!pending.empty())
+            printf(", %u not ended", (uint) pending.size());
+
+        printf(".\n");
+    }
+
+    if (nFailed > 0)
+        options->setExitStatus(S9sOptions::JobFailed);
+    else if (nUnknown > 0 || !pending.empty())
+        options->setExitStatus(S9sOptions::Failed);
 }
 
 void
@@ -1711,45 +2082,126 @@ S9sBusinessLogic::executeClusterList(
 }
 
 /**
+ * \param client A client for the communication.
  *
+ * Executing the node --stat --graph=NAME[,NAME...] request. The statistics
+ * needed by the graphs are requested at the same time on separate
+ * connections, graphs using the same statistics share one request.
  */
 void 
 S9sBusinessLogic::executeNodeGraph(
         S9sRpcClient &client)
 {
-    S9sOptions  *options   = S9sOptions::instance();
-    int          clusterId = options->clusterId();
-    S9sString    graphName = options->graph().toLower();
-    S9sCmonGraph::GraphTemplate graphTemplate;
-    S9sRpcReply  reply;
-    bool         success;
+    S9sOptions     *options    = S9sOptions::instance();
+    int             clusterId  = options->clusterId();
+    S9sVector<S9sStatRequest *> requests;
+    S9sVector<S9sRpcReply *>    replies;
+    S9sVector<S9sString>        graphTypes;
+    S9sVector<S9sString>        statNames;
+    S9sVector<int>              requestIndices;
+    S9sString       errorString;
+    bool            success;
 
-    graphTemplate = S9sCmonGraph::stringToGraphTemplate(graphName);
-    if (graphTemplate == S9sCmonGraph::Unknown)
+    /*
+     * Checking the graph names and finding the statistics they need.
+     */
+    success = S9sCmonGraph::parseGraphList(
+            options->graph(), graphTypes, statNames, requestIndices,
+            errorString);
+
+    if (success)
     {
-        PRINT_ERROR("Graph type '%s' is invalid.", STR(graphName));
-        return;
+        for (uint idx = 0u; idx < statNames.size(); ++idx)
+            requests << new S9sStatRequest(client, clusterId, statNames[idx]);
+    } else {
+        PRINT_ERROR("%s", STR(errorString));
+        options->setExitStatus(S9sOptions::BadOptions);
     }
 
-    success = client.getStats(clusterId, S9sCmonGraph::statName(graphTemplate));
-    client.setExitStatus();
+    /*
+     * Sending the requests and waiting for the replies.
+     */
+    if (success)
+    {
+        for (uint idx = 0u; idx < requests.size(); ++idx)
+            requests[idx]->start();
+
+        for (uint idx = 0u; idx < requests.size(); ++idx)
+        {
+            S9sStatRequest *request = requests[idx];
+
+            if (!request->wait() || !request->reply().isOk())
+            {
+                request->setExitStatus();
+
+                if (options->isJsonRequested() && request->wait())
+                    request->reply().printJsonFormat();
+                else
+                    PRINT_ERROR("%s", STR(request->errorString()));
+
+                success = false;
+                break;
+            }
+        }
+    }
 
+    /*
+     * Printing the graphs.
+     */
     if (success)
     {
-        reply = client.reply();
-        success = reply.isOk();
-        if (success)
+        if (options->isJsonRequested())
         {
-            reply.printGraph();
+            for (uint idx = 0u; idx < requests.size(); ++idx)
+                requests[idx]->reply().printJsonFormat();
         } else {
-            if (options->isJsonRequested())
-                reply.printJsonFormat();
+            for (uint idx = 0u; idx < requestIndices.size(); ++idx)
+            {
+                replies << &requests[requestIndices[idx]]->reply();
+            }
+
+            if (options->isFollowRequested())
+                followGraphs(client, replies, graphTypes);
             else
-                PRINT_ERROR("%s", STR(reply.errorString()));
+                S9sRpcReply::printGraphs(replies, graphTypes);
         }
-    } else {
-        PRINT_ERROR("%s", STR(client.errorString()));
     }
+
+    for (uint idx = 0u; idx < requests.size(); ++idx)
+        delete requests[idx];
+}
+
+/**
+ * \param client A client for the communication.
+ * \param replies The replies holding the statistics for the graphs.
+ * \param graphTypes The graph types, one for every reply.
+ *
+ * Executing the node --stat --graph=NAME[,NAME...] --follow request: the
+ * graphs are created from the statistics we received, then they are kept on
+ * the screen and updated from the measurement events until the user quits.
+ */
+void 
+S9sBusinessLogic::followGraphs(
+        S9sRpcClient                   &client,
+        const S9sVector<S9sRpcReply *> &replies,
+        const S9sVector<S9sString>     &graphTypes)
+{
+    S9sOptions                *options = S9sOptions::instance();
+    S9sVector<S9sCmonGraph *>  graphs;
+    S9sGraphFollower           follower(client);
+
+    S9sRpcReply::createGraphs(replies, graphTypes, graphs);
+    for (uint idx = 0u; idx < graphs.size(); ++idx)
+        follower.addGraph(graphs[idx]);
+
+    if (follower.nGraphs() == 0)
+    {
+        PRINT_ERROR("No graphs to follow.");
+        options->setExitStatus(S9sOptions::Failed);
+        return;
+    }
+
+    follower.main();
 }
  
 /**
@@ -2109,8 +2561,9 @@ S9sBusinessLogic::executeNodeSet(
 }
 
 /**
- * This method provides a continuous display of one specific cluster that is
- * similar to the "top" utility.
+ * This method provides a continuous display of one specific cluster (or all
+ * the clusters if no cluster is specified) that is similar to the "top"
+ * utility.
  */
 void 
 S9sBusinessLogic::executeTop(
@@ -2393,6 +2846,154 @@ S9sBusinessLogic::executeLogList(
     } 
 }
 
+/**
+ * Creates the time index and the state checkpoints for an event recording
+ * made without them, so that the play back can seek in it 
+ * ("s9s event --build-index --input-file=FILE").
+ */
+void
+S9sBusinessLogic::executeEventBuildIndex()
+{
+    S9sOptions          *options   = S9sOptions::instance();
+    S9sString            inputFile = options->inputFile();
+    S9sString            indexFile = S9sEventIndex::indexFileName(inputFile);
+    S9sEventIndex        index;
+    S9sEventCheckpoints  checkpoints;
+
+    if (!index.build(inputFile) || !index.save(indexFile))
+    {
+        PRINT_ERROR("%s", STR(index.errorString()));
+        options->setExitStatus(S9sOptions::Failed);
+        return;
+    }
+
+    if (!checkpoints.build(inputFile))
+    {
+        PRINT_ERROR("%s", STR(checkpoints.errorString()));
+        options->setExitStatus(S9sOptions::Failed);
+        return;
+    }
+
+    if (!options->isBatchRequested())
+    {
+        printf("Created '%s' with %u entries.\n", 
+                STR(indexFile), index.size());
+
+        printf("Created '%s' with %u checkpoints.\n", 
+                STR(S9sEventCheckpoints::checkpointFileName(inputFile)),
+                checkpoints.size());
+    }
+}
+
+/**
+ * Prints the log entries (in chronological order) the way "s9s log --list"
+ * would print them.
+ */
+static void
+printLogEntries(
+        const S9sVariantList &entries,
+        S9sRecordWriter      &writer)
+{
+    S9sOptions     *options = S9sOptions::instance();
+    S9sRpcReply     reply;
+    S9sVariantList  reversed;
+
+    if (entries.empty())
+        return;
+
+    if (writer.isValid())
+    {
+        for (uint idx = 0u; idx < entries.size(); ++idx)
+            writer.write(entries[idx].toVariantMap());
+
+        fflush(stdout);
+        return;
+    }
+
+    // The printing methods expect the most recent entry first, the way the
+    // controller sends them.
+    for (uint idx = entries.size(); idx > 0u; --idx)
+        reversed << entries[idx - 1];
+
+    reply["log_entries"] = reversed;
+
+    if (options->isJsonRequested())
+        reply.printJsonFormat();
+    else
+        reply.printLogList();
+
+    fflush(stdout);
+}
+
+/**
+ * \param client A client for the communication.
+ *
+ * Follows the log of the controller ("s9s log --follow"), prints the last few
+ * messages (or the messages created after --from) then the new messages as
+ * they arrive. Only the messages newer than the last one printed are
+ * requested, so the cost does not depend on how many messages are already
+ * in the log.
+ */
+void 
+S9sBusinessLogic::executeLogFollow(
+        S9sRpcClient &client)
+{
+    S9sOptions       *options = S9sOptions::instance();
+    S9sLogFollower    follower(client);
+    S9sPollScheduler  schedule = S9sPollScheduler::fromOptions();
+    S9sRecordWriter   writer;
+    S9sVariantList    entries;
+    int               nFailures = 0;
+    bool              success;
+
+    if (options->hasOutputFormat())
+    {
+        writer = S9sRecordWriter(
+                options->outputFormat(), options->outputFields());
+
+        writer.setHeaderEnabled(!options->isNoHeaderRequested());
+    }
+
+    if (!options->from().empty())
+    {
+        follower.setCreatedAfter(options->from());
+        success = follower.fetchPage(entries);
+    } else {
+        int limit = options->limit() > 0 ? options->limit() : 10;
+
+        success = follower.fetchTail(limit, entries);
+    }
+
+    for (;;)
+    {
+        if (success)
+        {
+            nFailures = 0;
+            printLogEntries(entries, writer);
+        } else {
+            PRINT_ERROR("%s", STR(follower.errorString()));
+
+            ++nFailures;
+            if (nFailures > 3)
+            {
+                options->setExitStatus(S9sOptions::Failed);
+                break;
+            }
+
+            entries.clear();
+        }
+
+        // If the page was full the next one is already on its way.
+        if (!follower.hasMore())
+        {
+            schedule.setHint(client.pollIntervalHint());
+            usleep(schedule.nextDelay(!entries.empty()) * 1000);
+        }
+
+        success = follower.fetchPage(entries);
+    }
+}
+
 /**
  * \param client A client for the communication.
  * 
@@ -2512,7 +3113,8 @@ void
 S9sBusinessLogic::waitForJobWithProgress(
         const int     clusterId,
         const int     jobId, 
-        S9sRpcClient &client)
+        S9sRpcClient &client,
+        S9sJobWaiter &waiter)
 {
     S9sOptions    *options         = S9sOptions::instance();
     bool           syntaxHighlight = options->useSyntaxHighlight();
@@ -2522,7 +3124,10 @@ S9sBusinessLogic::waitForJobWithProgress(
     S9sRpcReply    reply;
     bool           success, finished;
     S9sString      progressLine, previousProgressLine;
+    S9sVariantMap  job;
+    S9sString      jobState, previousJobState;
     bool           titlePrinted = false;
+    bool           changed = false;
     int            nFailures = 0;
     int            nAuthentications = 0;
 
@@ -2577,8 +3182,6 @@ S9sBusinessLogic::waitForJobWithProgress(
 
             if (finished)
                 break;
-
-            sleep(1);
         }
         
         /*
@@ -2603,6 +3206,21 @@ S9sBusinessLogic::waitForJobWithProgress(
             titlePrinted = true;
         }
 
+        /*
+         * Remembering if the job changed, we poll more often while it does.
+         * The progress line itself can not be used, it is animated.
+         */
+        job      = reply["job"].toVariantMap();
+        jobState = job["status"].toString() + ":" + 
+            job["progress_percent"].toString() + ":" + 
+            job["status_text"].toString();
+
+        if (jobState != previousJobState)
+        {
+            changed          = true;
+            previousJobState = jobState;
+        }
+
         /*
          * Printing the progress line.
          */
@@ -2629,7 +3247,6 @@ S9sBusinessLogic::waitForJobWithProgress(
             options->setExitStatus(S9sOptions::JobFailed);
 
         fflush(stdout);
-        sleep(1);
 
         ++rotateCycle;
         rotateCycle %= sizeof(rotate) / sizeof(void *);
@@ -2637,6 +3254,10 @@ S9sBusinessLogic::waitForJobWithProgress(
 end_of_loop:
         if (finished)
             break;
+
+        waiter.setPollHint(client.pollIntervalHint());
+        waiter.waitForUpdate(changed);
+        changed = false;
     }
 
     if (syntaxHighlight)
@@ -2657,7 +3278,8 @@ void
 S9sBusinessLogic::waitForJobWithLog(
         const int     clusterId,
         const int     jobId, 
-        S9sRpcClient &client)
+        S9sRpcClient &client,
+        S9sJobWaiter &waiter)
 {
     S9sOptions    *options         = S9sOptions::instance();
     S9sVariantMap  job;
@@ -2750,7 +3372,13 @@ S9sBusinessLogic::waitForJobWithLog(
         if (finished)
             break;
         
-        sleep(1);
+        // If we got as many messages as we asked for there are probably more
+        // waiting.
+        if (nEntries >= 300)
+            continue;
+
+        waiter.setPollHint(client.pollIntervalHint());
+        waiter.waitForUpdate(nEntries > 0);
     }
 
     printf("\n");
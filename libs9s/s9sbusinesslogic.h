@@ -22,6 +22,8 @@
 #include "s9srpcclient.h"
 #include "s9stopui.h"
 
+class S9sJobWaiter;
+
 /**
  * A class that is able to execute whatever the user requested through the
  * command line options.
@@ -36,6 +38,10 @@ class S9sBusinessLogic
                 const int     jobId, 
                 S9sRpcClient &client);
 
+        void waitForJobs(
+                const int     clusterId,
+                S9sRpcClient &client);
+
     protected:
         virtual void 
             maybeJobRegistered(
@@ -53,12 +59,14 @@ class S9sBusinessLogic
         void waitForJobWithProgress(
                 const int     clusterId,
                 const int     jobId, 
-                S9sRpcClient &client);
+                S9sRpcClient &client,
+                S9sJobWaiter &waiter);
 
         void waitForJobWithLog(
                 const int     clusterId,
                 const int     jobId, 
-                S9sRpcClient &client);
+                S9sRpcClient &client,
+                S9sJobWaiter &waiter);
 
         void executeUserList(S9sRpcClient &client);
         void executeGroupList(S9sRpcClient &client);
@@ -78,6 +86,10 @@ class S9sBusinessLogic
 
         void executeNodeList(S9sRpcClient &client);
         void executeNodeGraph(S9sRpcClient &client);
+        void followGraphs(
+                S9sRpcClient                   &client,
+                const S9sVector<S9sRpcReply *> &replies,
+                const S9sVector<S9sString>     &graphTypes);
         void executeNodeSet(S9sRpcClient &client);
         void executeConfigList(S9sRpcClient &client);
         void executePullConfig(S9sRpcClient &client);
@@ -95,6 +107,8 @@ class S9sBusinessLogic
 
         void executeJobList(S9sRpcClient &client);
         void executeLogList(S9sRpcClient &client);
+        void executeLogFollow(S9sRpcClient &client);
+        void executeEventBuildIndex();
         void executeJobLog(S9sRpcClient &client);
 
         void executeDropCluster(S9sRpcClient &client);
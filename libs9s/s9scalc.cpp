@@ -202,7 +202,7 @@ S9sCalc::processButton(
 bool
 S9sCalc::refreshScreen()
 {
-    printf("%s", TERM_CURSOR_OFF);
+    s9s_printf("%s", TERM_CURSOR_OFF);
 
     startScreen();
     printHeader();
@@ -235,10 +235,10 @@ S9sCalc::printHeader()
     if (!spreadsheetName().empty())
         title = spreadsheetName();
 
-    ::printf("%s%s%s ", bold, STR(title), normal);
-    ::printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
-    ::printf("0x%08x ",      lastKeyCode());
-    ::printf("%02dx%02d ",   width(), height());
+    s9s_printf("%s%s%s ", bold, STR(title), normal);
+    s9s_printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
+    s9s_printf("0x%08x ",      lastKeyCode());
+    s9s_printf("%02dx%02d ",   width(), height());
 
     printNewLine();
     
@@ -254,21 +254,21 @@ S9sCalc::printFooter()
     //const char *bold   = TERM_SCREEN_TITLE_BOLD;
     const char *normal = TERM_SCREEN_TITLE;
 
-    ::printf("%s ", normal);
+    s9s_printf("%s ", normal);
 
     if (!m_errorString.empty())
     {
-        ::printf("%s", STR(m_errorString));
+        s9s_printf("%s", STR(m_errorString));
     } else if (!warning.empty()) 
     {
-        ::printf("%s", STR(warning));
+        s9s_printf("%s", STR(warning));
     } else {
-        ::printf("ok");
+        s9s_printf("ok");
     }
         
     // No new-line at the end, this is the last line.
-    ::printf("%s", TERM_ERASE_EOL);
-    ::printf("%s", TERM_NORMAL);
+    s9s_printf("%s", TERM_ERASE_EOL);
+    s9s_printf("%s", TERM_NORMAL);
     fflush(stdout);    
 }
 
@@ -114,7 +114,6 @@ S9sCmonGraph::realize()
     S9sString   hostName;
     time_t      start = 0;
     time_t      end   = 0;
-    double      dval;
 
     /*
      * Finding out how the user would like to see the node names.
@@ -123,6 +122,15 @@ S9sCmonGraph::realize()
         nodeFormat = options->nodeFormat();
 
     hostName = m_node.toString(false, nodeFormat);
+
+    /*
+     * In live mode the values are already in the graph.
+     */
+    if (isLive())
+    {
+        S9sGraph::realize();
+        return;
+    }
     
     /*
      *
@@ -170,12 +178,13 @@ S9sCmonGraph::realize()
             break;
 
         case CpuTemp:
-            setAggregateType(S9sGraph::Max);
+            // Slowly changing levels, the shape matters more than the peaks.
+            setAggregateType(S9sGraph::LargestTriangle);
             setTitle("Cpu Temperature (℃ ) on %s", STR(hostName));
             break;
 
         case CpuGhz:
-            setAggregateType(S9sGraph::Max);
+            setAggregateType(S9sGraph::LargestTriangle);
             setTitle("CPU clock of %s (GHz)", STR(hostName));
             break;
         
@@ -226,7 +235,7 @@ S9sCmonGraph::realize()
             break;
 
         case MemUtil:
-            setAggregateType(S9sGraph::Max);
+            setAggregateType(S9sGraph::LargestTriangle);
             setTitle("Memory utilization on %s (%%)", STR(hostName));
             break;
         
@@ -318,382 +327,369 @@ S9sCmonGraph::realize()
     for (uint idx = 0u; idx < m_values.size(); ++idx)
     {
         S9sVariant value = m_values[idx];
-   
-        if (!m_filterName.empty())
-        {
-            if (value[m_filterName] != m_filterValue)
-                continue;
-        }
+        S9sVariant graphValue;
 
-        switch (m_graphType)
-        {
-            case Unknown:
-                S9S_WARNING("Unknown graph type.");
-                break;
-
-            case LoadAverage:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+        if (!acceptsSample(value))
+            continue;
 
-                if (value["cpuid"].toInt() != 0)
-                    continue;
-
-                S9sGraph::appendValue(value["loadavg1"]);
-                break;
-            
-            case CpuSys:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-
-                if (value["cpuid"].toInt() != 0)
-                    continue;
-
-                S9sGraph::appendValue(value["sys"].toDouble() * 100.0);
-                break;
-            
-            case CpuIdle:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+        graphValue = sampleValue(value);
+        if (!graphValue.isInvalid())
+            S9sGraph::appendValue(graphValue);
 
-                if (value["cpuid"].toInt() != 0)
-                    continue;
+        /*
+         * Finding the timestamps of the first and last samples.
+         */
+        if (value.contains("created"))
+        {
+            time_t created = value["created"].toTimeT();
+            time_t ended   = created + (value["interval"].toInt() / 1000);
 
-                S9sGraph::appendValue(value["idle"].toDouble() * 100.0);
-                break;
-            
-            case CpuUser:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            if (start == 0)
+                start = created;
 
-                if (value["cpuid"].toInt() != 0)
-                    continue;
+            if (end == 0)
+                end = ended;
 
-                S9sGraph::appendValue(value["user"].toDouble() * 100.0);
-                break;
-            
-            case CpuIoWait:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            if (start > created)
+                start = created;
 
-                if (value["cpuid"].toInt() != 0)
-                    continue;
+            if (end < ended)
+                end = ended;
+        }
+    }
 
-                S9sGraph::appendValue(value["iowait"].toDouble() * 100.0);
-                break;
+    /*
+     * Setting the start time and end time for the graph so that the user can
+     * have an idea what time interval is shown.
+     */
+    if (start == 0 && end == 0)
+    {
+        // If we had no timestamp that's because we had no statistics. No
+        // matter, we set the last 1 minute showing some labels anyway.
+        end = time(NULL);
+        start = end - 60;
+    }
 
-            case CpuTemp:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+    setInterval(start, end);
 
-                if (value["cpuid"].toInt() != 0)
-                    continue;
+    /*
+     * Linking up to the parent class.
+     */
+    S9sGraph::realize();
+}
 
-                S9sGraph::appendValue(value["cputemp"]);
-                break;
+/**
+ * \param sample One statistical sample as the controller sends it.
+ * \returns True if the sample belongs to this graph: it is about the node and
+ *   passes the filter (e.g. the mount point or the network interface).
+ */
+bool
+S9sCmonGraph::acceptsSample(
+        const S9sVariant &sample) const
+{
+    S9sVariant value = sample;
 
-            case CpuGhz:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+    if (!m_filterName.empty() && value[m_filterName] != m_filterValue)
+        return false;
 
-                if (value["cpuid"].toInt() != 0)
-                    continue;
-                
-                S9sGraph::appendValue(value["cpumhz"].toDouble() / 1000.0);
-                break;
+    return value["hostid"].toInt() == m_node.hostId();
+}
 
-            case SqlStatements:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+/**
+ * \param sample One statistical sample as the controller sends it.
+ * \returns The value the graph shows for the sample or an invalid variant if
+ *   the sample does not hold a value for this graph.
+ */
+S9sVariant
+S9sCmonGraph::sampleValue(
+        const S9sVariant &sample) const
+{
+    S9sVariant value = sample;
+    S9sVariant retval;
+    double     dval;
 
-                if (value.contains("COM_SELECT") || 
-                        value.contains("COM_INSERT"))
-                {
-                    double dval;
-
-                    dval = 
-                        value["COM_DELETE"].toDouble() +
-                        value["COM_INSERT"].toDouble() + 
-                        value["COM_REPLACE"].toDouble() + 
-                        value["COM_SELECT"].toDouble() + 
-                        value["COM_UPDATE"].toDouble();
-               
-                    dval /= value["interval"].toDouble() / 1000.0;
-                    
-                    S9sGraph::appendValue(dval);
-                } else if (value.contains("rows-inserted"))
-                {
-                    dval = 
-                        value["rows-deleted"].toDouble() +
-                        value["rows-fetched"].toDouble() + 
-                        value["rows-inserted"].toDouble() + 
-                        value["rows-updated"].toDouble();
-
-                    dval /= value["interval"].toDouble() / 1000.0;
-                    
-                    S9sGraph::appendValue(dval);
-                } else {
-                    S9sGraph::appendValue(0.0);
-                }
-                break;
+    switch (m_graphType)
+    {
+        case Unknown:
+            S9S_WARNING("Unknown graph type.");
+            break;
 
-            case SqlConnections:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-               
-                if (value.contains("CONNECTIONS"))
-                    S9sGraph::appendValue(value["CONNECTIONS"].toDouble());
-                else
-                    S9sGraph::appendValue(value["connections"].toDouble());
+        case LoadAverage:
+            if (value["cpuid"].toInt() != 0)
+                return retval;
 
-                break;
+            retval = value["loadavg1"];
+            break;
+        
+        case CpuSys:
+            if (value["cpuid"].toInt() != 0)
+                return retval;
 
-            case SqlReplicationLag:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-               
-                if (value.contains("REPLICATION_LAG"))
-                    S9sGraph::appendValue(value["REPLICATION_LAG"].toDouble());
-                break;
+            retval = value["sys"].toDouble() * 100.0;
+            break;
+        
+        case CpuIdle:
+            if (value["cpuid"].toInt() != 0)
+                return retval;
 
-            case SqlCommits:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-                
-                if (value.contains("commits"))
-                {
-                    dval  = value["commits"].toDouble();
-                    dval /= value["interval"].toDouble() / 1000.0;
-                
-                    S9sGraph::appendValue(dval);
-                }
+            retval = value["idle"].toDouble() * 100.0;
+            break;
+        
+        case CpuUser:
+            if (value["cpuid"].toInt() != 0)
+                return retval;
 
-                break;
-            
-            case SqlQueries:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            retval = value["user"].toDouble() * 100.0;
+            break;
+        
+        case CpuIoWait:
+            if (value["cpuid"].toInt() != 0)
+                return retval;
 
-                if (value.contains("QUERIES"))
-                {
-                    dval  = value["QUERIES"].toDouble();
-                    dval /= value["interval"].toDouble() / 1000.0;
-                    S9sGraph::appendValue(dval);
-                }
+            retval = value["iowait"].toDouble() * 100.0;
+            break;
 
-                break;
-            
-            case SqlSlowQueries:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+        case CpuTemp:
+            if (value["cpuid"].toInt() != 0)
+                return retval;
 
-                if (value.contains("SLOW_QUERIES"))
-                {
-                    dval  = value["SLOW_QUERIES"].toDouble();
-                    dval /= value["interval"].toDouble() / 1000.0;
-                    S9sGraph::appendValue(dval);
-                }
+            retval = value["cputemp"];
+            break;
 
-                break;
+        case CpuGhz:
+            if (value["cpuid"].toInt() != 0)
+                return retval;
             
-            case SqlOpenTables:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-
-                if (value.contains("OPEN_TABLES"))
-                {
-                    dval  = value["OPEN_TABLES"].toDouble();
-                    S9sGraph::appendValue(dval);
-                }
-
-                break;
+            retval = value["cpumhz"].toDouble() / 1000.0;
+            break;
 
-            case MemUtil:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+        case SqlStatements:
+            if (value.contains("COM_SELECT") || 
+                    value.contains("COM_INSERT"))
+            {
+                double dval;
+
+                dval = 
+                    value["COM_DELETE"].toDouble() +
+                    value["COM_INSERT"].toDouble() + 
+                    value["COM_REPLACE"].toDouble() + 
+                    value["COM_SELECT"].toDouble() + 
+                    value["COM_UPDATE"].toDouble();
+           
+                dval /= value["interval"].toDouble() / 1000.0;
+                
+                retval = dval;
+            } else if (value.contains("rows-inserted"))
+            {
+                dval = 
+                    value["rows-deleted"].toDouble() +
+                    value["rows-fetched"].toDouble() + 
+                    value["rows-inserted"].toDouble() + 
+                    value["rows-updated"].toDouble();
 
-                dval  = value["memoryutilization"].toDouble();
-                dval *= 100.0;
+                dval /= value["interval"].toDouble() / 1000.0;
+                
+                retval = dval;
+            } else {
+                retval = 0.0;
+            }
+            break;
 
-                S9sGraph::appendValue(dval);
-                break;
+        case SqlConnections:
+           
+            if (value.contains("CONNECTIONS"))
+                retval = value["CONNECTIONS"].toDouble();
+            else
+                retval = value["connections"].toDouble();
 
-            case MemFree:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            break;
 
-                dval  = value["ramfree"].toDouble();
-                dval /= 1024.0 * 1024.0 * 1024.0;
+        case SqlReplicationLag:
+           
+            if (value.contains("REPLICATION_LAG"))
+                retval = value["REPLICATION_LAG"].toDouble();
+            break;
 
-                S9sGraph::appendValue(dval);
-                break;
+        case SqlCommits:
             
-            case SwapFree:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-
-                dval  = value["swapfree"].toDouble();
-                dval /= 1024.0 * 1024.0 * 1024.0;
-
-                S9sGraph::appendValue(dval);
-                break;
-
-            case DiskFree:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-
-                dval  = value["free"].toDouble();
-                dval /= 1024.0 * 1024.0 * 1024.0;
-
-                S9sGraph::appendValue(dval);
-                break;
-
-            case DiskReadSpeed:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
-                
-                dval  = value["reads"].toDouble();
+            if (value.contains("commits"))
+            {
+                dval  = value["commits"].toDouble();
                 dval /= value["interval"].toDouble() / 1000.0;
-                dval *= value["blocksize"].toDouble();
-                dval /= 1024.0 * 1024.0;
-
-                S9sGraph::appendValue(dval);
-                break;
             
-            case DiskWriteSpeed:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+                retval = dval;
+            }
 
-                dval  = value["writes"].toDouble();
+            break;
+        
+        case SqlQueries:
+            if (value.contains("QUERIES"))
+            {
+                dval  = value["QUERIES"].toDouble();
                 dval /= value["interval"].toDouble() / 1000.0;
-                dval *= value["blocksize"].toDouble();
-                dval /= 1024.0 * 1024.0;
-
-                S9sGraph::appendValue(dval);
-                break;
-            
-            case DiskReadWriteSpeed:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+                retval = dval;
+            }
 
-                dval  = value["writes"].toDouble();
-                dval += value["reads"].toDouble();
+            break;
+        
+        case SqlSlowQueries:
+            if (value.contains("SLOW_QUERIES"))
+            {
+                dval  = value["SLOW_QUERIES"].toDouble();
                 dval /= value["interval"].toDouble() / 1000.0;
-                dval *= value["blocksize"].toDouble();
-                dval /= 1024.0 * 1024.0;
+                retval = dval;
+            }
 
-                S9sGraph::appendValue(dval);
-                break;
-            
-            case DiskUtilization:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            break;
+        
+        case SqlOpenTables:
+            if (value.contains("OPEN_TABLES"))
+            {
+                dval  = value["OPEN_TABLES"].toDouble();
+                retval = dval;
+            }
 
-                dval  = value["utilization"].toDouble();
-                dval *= 100.0;
+            break;
 
-                S9sGraph::appendValue(dval);
-                break;
+        case MemUtil:
+            dval  = value["memoryutilization"].toDouble();
+            dval *= 100.0;
 
-            case NetSentSpeed:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            retval = dval;
+            break;
 
-                dval  = value["txBytes"].toDouble();
-                dval /= value["interval"].toDouble() / 1000.0;
-                dval /= 1024.0 * 1024.0;
+        case MemFree:
+            dval  = value["ramfree"].toDouble();
+            dval /= 1024.0 * 1024.0 * 1024.0;
 
-                S9sGraph::appendValue(dval);
-                break;
-            
-            case NetReceivedSpeed:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            retval = dval;
+            break;
+        
+        case SwapFree:
+            dval  = value["swapfree"].toDouble();
+            dval /= 1024.0 * 1024.0 * 1024.0;
 
-                dval  = value["rxBytes"].toDouble();
-                dval /= value["interval"].toDouble() / 1000.0;
-                dval /= 1024.0 * 1024.0;
+            retval = dval;
+            break;
 
-                S9sGraph::appendValue(dval);
-                break;
-            
-            case NetReceiveErrors:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+        case DiskFree:
+            dval  = value["free"].toDouble();
+            dval /= 1024.0 * 1024.0 * 1024.0;
 
-                dval  = value["rxErrors"].toDouble();
-                S9sGraph::appendValue(dval);
-                break;
-            
-            case NetTransmitErrors:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            retval = dval;
+            break;
 
-                dval  = value["txErrors"].toDouble();
-                S9sGraph::appendValue(dval);
-                break;
+        case DiskReadSpeed:
             
-            case NetErrors:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            dval  = value["reads"].toDouble();
+            dval /= value["interval"].toDouble() / 1000.0;
+            dval *= value["blocksize"].toDouble();
+            dval /= 1024.0 * 1024.0;
 
-                dval  = value["txErrors"].toDouble();
-                dval += value["rxErrors"].toDouble();
-                S9sGraph::appendValue(dval);
-                break;
-            
-            case NetSpeed:
-                if (value["hostid"].toInt() != m_node.hostId())
-                    continue;
+            retval = dval;
+            break;
+        
+        case DiskWriteSpeed:
+            dval  = value["writes"].toDouble();
+            dval /= value["interval"].toDouble() / 1000.0;
+            dval *= value["blocksize"].toDouble();
+            dval /= 1024.0 * 1024.0;
 
-                dval  = value["rxBytes"].toDouble();
-                dval += value["txBytes"].toDouble();
-                dval /= value["interval"].toDouble() / 1000.0;
-                dval /= 1024.0 * 1024.0;
+            retval = dval;
+            break;
+        
+        case DiskReadWriteSpeed:
+            dval  = value["writes"].toDouble();
+            dval += value["reads"].toDouble();
+            dval /= value["interval"].toDouble() / 1000.0;
+            dval *= value["blocksize"].toDouble();
+            dval /= 1024.0 * 1024.0;
 
-                S9sGraph::appendValue(dval);
-                break;
-        }
+            retval = dval;
+            break;
+        
+        case DiskUtilization:
+            dval  = value["utilization"].toDouble();
+            dval *= 100.0;
 
-        /*
-         * Finding the timestamps of the first and last samples.
-         */
-        if (value.contains("created"))
-        {
-            time_t created = value["created"].toTimeT();
-            time_t ended   = created + (value["interval"].toInt() / 1000);
+            retval = dval;
+            break;
 
-            if (start == 0)
-                start = created;
+        case NetSentSpeed:
+            dval  = value["txBytes"].toDouble();
+            dval /= value["interval"].toDouble() / 1000.0;
+            dval /= 1024.0 * 1024.0;
 
-            if (end == 0)
-                end = ended;
+            retval = dval;
+            break;
+        
+        case NetReceivedSpeed:
+            dval  = value["rxBytes"].toDouble();
+            dval /= value["interval"].toDouble() / 1000.0;
+            dval /= 1024.0 * 1024.0;
 
-            if (start > created)
-                start = created;
+            retval = dval;
+            break;
+        
+        case NetReceiveErrors:
+            dval  = value["rxErrors"].toDouble();
+            retval = dval;
+            break;
+        
+        case NetTransmitErrors:
+            dval  = value["txErrors"].toDouble();
+            retval = dval;
+            break;
+        
+        case NetErrors:
+            dval  = value["txErrors"].toDouble();
+            dval += value["rxErrors"].toDouble();
+            retval = dval;
+            break;
+        
+        case NetSpeed:
+            dval  = value["rxBytes"].toDouble();
+            dval += value["txBytes"].toDouble();
+            dval /= value["interval"].toDouble() / 1000.0;
+            dval /= 1024.0 * 1024.0;
 
-            if (end < ended)
-                end = ended;
-        }
+            retval = dval;
+            break;
     }
 
-    /*
-     * Setting the start time and end time for the graph so that the user can
-     * have an idea what time interval is shown.
-     */
-    if (start == 0 && end == 0)
+    return retval;
+}
+
+/**
+ * \param sample A sample that came in a measurement event.
+ * \returns True if the sample was added to the graph.
+ *
+ * Adds one sample to a graph that is in live mode (see S9sGraph::setLive()).
+ * The samples of other statistics, other nodes or other filter values are
+ * ignored.
+ */
+bool
+S9sCmonGraph::appendLiveSample(
+        const S9sVariantMap &sample)
+{
+    S9sVariant value = sample;
+    S9sVariant graphValue;
+
+    if (sample.contains("class_name") && 
+            sample.at("class_name").toString() != statClassName(m_graphType))
     {
-        // If we had no timestamp that's because we had no statistics. No
-        // matter, we set the last 1 minute showing some labels anyway.
-        end = time(NULL);
-        start = end - 60;
+        return false;
     }
 
-    setInterval(start, end);
+    if (!acceptsSample(value))
+        return false;
 
-    /*
-     * Linking up to the parent class.
-     */
-    S9sGraph::realize();
+    graphValue = sampleValue(value);
+    if (graphValue.isInvalid())
+        return false;
+
+    appendLiveValue(graphValue.toDouble(), value["created"].toTimeT());
+    return true;
 }
 
  
@@ -797,3 +793,96 @@ S9sCmonGraph::statName(
 
     return "";
 }
+
+/**
+ * \returns The class name of the samples the controller sends about the
+ *   statistics the graph shows (e.g. in the measurement events).
+ */
+S9sString
+S9sCmonGraph::statClassName(
+        const S9sCmonGraph::GraphTemplate graphTemplate)
+{
+    S9sString name = statName(graphTemplate);
+
+    if (name == "cpustat")
+        return "CmonCpuStats";
+    else if (name == "sqlstat")
+        return "CmonSqlStats";
+    else if (name == "memorystat")
+        return "CmonMemoryStats";
+    else if (name == "diskstat")
+        return "CmonDiskStats";
+    else if (name == "netstat")
+        return "CmonNetworkStats";
+
+    return "";
+}
+
+/**
+ * \param graphList The comma separated list of graph names as the --graph
+ *   option holds it.
+ * \param graphTypes The graph names, one for every graph.
+ * \param statNames The names of the statistics needed, every name only once
+ *   so that the graphs using the same statistics share one request.
+ * \param statIndices For every graph the index of its statistics in the
+ *   statNames.
+ * \param errorString The place to return the error message.
+ * \returns True if all the graph names were valid.
+ */
+bool
+S9sCmonGraph::parseGraphList(
+        const S9sString       &graphList,
+        S9sVector<S9sString>  &graphTypes,
+        S9sVector<S9sString>  &statNames,
+        S9sVector<int>        &statIndices,
+        S9sString             &errorString)
+{
+    S9sVariantList graphNames = 
+        graphList.toLower().split(std::string(","), true);
+
+    graphTypes.clear();
+    statNames.clear();
+    statIndices.clear();
+
+    if (graphNames.empty())
+    {
+        errorString.sprintf("Graph type '%s' is invalid.", STR(graphList));
+        return false;
+    }
+
+    for (uint idx = 0u; idx < graphNames.size(); ++idx)
+    {
+        S9sString     graphName = graphNames[idx].toString().trim();
+        int           statIndex = -1;
+        S9sString     statName;
+        GraphTemplate graphTemplate;
+
+        graphTemplate = stringToGraphTemplate(graphName);
+        if (graphTemplate == Unknown)
+        {
+            errorString.sprintf("Graph type '%s' is invalid.", STR(graphName));
+            return false;
+        }
+
+        statName = S9sCmonGraph::statName(graphTemplate);
+        for (uint idx1 = 0u; idx1 < statNames.size(); ++idx1)
+        {
+            if (statNames[idx1] == statName)
+            {
+                statIndex = idx1;
+                break;
+            }
+        }
+
+        if (statIndex < 0)
+        {
+            statIndex = statNames.size();
+            statNames << statName;
+        }
+
+        graphTypes  << graphName;
+        statIndices << statIndex;
+    }
+
+    return true;
+}
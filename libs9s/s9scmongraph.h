@@ -5,6 +5,7 @@
 
 #include "s9sgraph.h"
 #include "s9snode.h"
+#include "s9svector.h"
 
 /**
  * A graph that understands Cmon Statistical data.
@@ -59,6 +60,10 @@ class S9sCmonGraph : public S9sGraph
 
         virtual void appendValue(S9sVariant value);
         virtual void realize();
+
+        bool acceptsSample(const S9sVariant &sample) const;
+        S9sVariant sampleValue(const S9sVariant &sample) const;
+        bool appendLiveSample(const S9sVariantMap &sample);
        
         static S9sCmonGraph::GraphTemplate 
             stringToGraphTemplate(
@@ -68,6 +73,18 @@ class S9sCmonGraph : public S9sGraph
             statName(
                     const S9sCmonGraph::GraphTemplate graphTemplate);
 
+        static S9sString
+            statClassName(
+                    const S9sCmonGraph::GraphTemplate graphTemplate);
+
+        static bool
+            parseGraphList(
+                    const S9sString       &graphList,
+                    S9sVector<S9sString>  &graphTypes,
+                    S9sVector<S9sString>  &statNames,
+                    S9sVector<int>        &statIndices,
+                    S9sString             &errorString);
+
     private:
         static S9sVariantMap sm_templateNames;
         
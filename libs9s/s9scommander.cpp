@@ -154,8 +154,17 @@ S9sCommander::main()
 
             updateRequested = m_reloadRequested;
 
+            /*
+             * The parts of the tree the user navigates to are reloaded at
+             * once, the tree we have there might be old.
+             */
+            m_mutex.lock();
+            if (shownPaths() != m_updatedPaths)
+                updateRequested = true;
+            m_mutex.unlock();
+
             if (time(NULL) - m_rootNodeRecevied > updateFreq || 
-                    m_reloadRequested)
+                    updateRequested)
             {
                 updateTree();
             }
@@ -167,32 +176,42 @@ S9sCommander::main()
 
 /**
  * Reloads the tree from the controller and pushes it into the widgets.
+ *
+ * The whole tree is loaded only the first time (or when the tree we have does
+ * not contain a path any more), later only the sub-trees the browsers are
+ * showing are loaded and merged into the tree we have. The browsers are
+ * updated only if something changed.
  */
 void
 S9sCommander::updateTree()
 {
-    S9sRpcReply      getTreeReply;
+    S9sVector<S9sString> paths;
+    bool                 fullUpdate;
 
     // Updating the screen.
     m_mutex.lock();
     m_rightInfo.setInfoRequestName("getTree");
     m_leftInfo.setInfoRequestName("getTree");
+    paths      = shownPaths();
+    fullUpdate = m_rootNodeRecevied == 0;
     m_mutex.unlock();
 
     m_communicating   = true;
     m_reloadRequested = false;
 
-    m_networkMutex.lock();
-    m_client.getTree(true);
-    getTreeReply = m_client.reply();
-    m_networkMutex.unlock();
+    for (uint idx = 0u; idx < paths.size() && !fullUpdate; ++idx)
+    {
+        if (!updateSubTree(paths[idx]))
+            fullUpdate = true;
+    }
+
+    if (fullUpdate)
+        updateSubTree("/");
     
     // Updating the screen.
     m_mutex.lock();
     m_rightInfo.setInfoRequestName("");
     m_leftInfo.setInfoRequestName("");
-    m_rightInfo.setInfoLastReply(getTreeReply);
-    m_leftInfo.setInfoLastReply(getTreeReply);
     
     m_leftInfo.setInfoController(
             m_client.hostName(), m_client.port(), m_client.useTls());
@@ -200,14 +219,7 @@ S9sCommander::updateTree()
     m_rightInfo.setInfoController(
             m_client.hostName(), m_client.port(), m_client.useTls());
 
-    if (getTreeReply.isOk())
-    {
-        m_rootNode = getTreeReply.tree();
-        m_leftBrowser.setCdt(m_rootNode);
-        m_rightBrowser.setCdt(m_rootNode);
-        m_rootNodeRecevied = time(NULL);
-    }
-
+    m_updatedPaths  = paths;
     m_communicating = false;
 
     if (m_dialog != NULL)
@@ -222,6 +234,114 @@ S9sCommander::updateTree()
     m_mutex.unlock(); 
 }
 
+/**
+ * \param path The path of the sub-tree to reload, "/" for the whole tree.
+ * \returns False if the sub-tree could not be merged into the tree we have,
+ *   so the whole tree should be reloaded.
+ */
+bool
+S9sCommander::updateSubTree(
+        const S9sString &path)
+{
+    S9sRpcReply      getTreeReply;
+    S9sTreeNode      received;
+    S9sTreeNode      current;
+    bool             changed = true;
+    bool             success = true;
+
+    m_networkMutex.lock();
+    m_client.getTree(path, true);
+    getTreeReply = m_client.reply();
+    m_networkMutex.unlock();
+
+    if (getTreeReply.isOk())
+        received = getTreeReply.tree();
+
+    m_mutex.lock();
+    m_rightInfo.setInfoLastReply(getTreeReply);
+    m_leftInfo.setInfoLastReply(getTreeReply);
+
+    if (!getTreeReply.isOk())
+    {
+        // Maybe the path is not there any more.
+        success = path == "/";
+        changed = false;
+    } else if (path == "/")
+    {
+        changed    = !m_rootNode.isEqual(received);
+        m_rootNode = received;
+    } else if (m_rootNode.subTree(path, current) && current.isEqual(received))
+    {
+        changed = false;
+    } else if (!m_rootNode.replaceSubTree(path, received))
+    {
+        // The path is new, we need its parents too.
+        success = false;
+        changed = false;
+    }
+
+    if (changed)
+    {
+        S9S_DEBUG("The sub-tree changed at '%s'.", STR(path));
+        m_leftBrowser.setCdt(m_rootNode);
+        m_rightBrowser.setCdt(m_rootNode);
+    }
+
+    if (success && getTreeReply.isOk())
+        m_rootNodeRecevied = time(NULL);
+
+    m_mutex.unlock();
+
+    return success;
+}
+
+/**
+ * \returns The paths the visible browsers are showing, a path is left out if
+ *   it is inside an other path in the list. Should be called with the mutex
+ *   locked.
+ */
+S9sVector<S9sString>
+S9sCommander::shownPaths() const
+{
+    S9sVector<S9sString> paths;
+    S9sVector<S9sString> retval;
+
+    if (m_leftBrowser.isVisible())
+        paths << m_leftBrowser.path();
+
+    if (m_rightBrowser.isVisible())
+        paths << m_rightBrowser.path();
+
+    for (uint idx = 0u; idx < paths.size(); ++idx)
+    {
+        const S9sString &path = paths[idx];
+        bool             contained = false;
+
+        for (uint idx1 = 0u; idx1 < paths.size(); ++idx1)
+        {
+            const S9sString &other = paths[idx1];
+
+            if (idx1 == idx)
+                continue;
+
+            if (other == path && idx1 > idx)
+                continue;
+
+            if (other == "/" || other == path || 
+                    path.startsWith(STR(other + "/")))
+            {
+                contained = true;
+                break;
+            }
+        }
+
+        if (!contained)
+            retval << (path.empty() ? S9sString("/") : path);
+    }
+
+    return retval;
+}
+
 bool
 S9sCommander::renameMove(
         const S9sString sourcePath,
@@ -694,6 +814,20 @@ S9sCommander::processKey(
         return;
     }
 
+    /*
+     * While the user types a name to search for in a browser the keys go to
+     * the browser, the search ends on other keys.
+     */
+    if (m_leftBrowser.hasFocus() && m_leftBrowser.isSearching())
+    {
+        if (m_leftBrowser.processSearchKey(key))
+            return;
+    } else if (m_rightBrowser.hasFocus() && m_rightBrowser.isSearching())
+    {
+        if (m_rightBrowser.processSearchKey(key))
+            return;
+    }
+
     switch (key)
     {
 
@@ -963,25 +1097,25 @@ S9sCommander::printHeader()
     S9sDateTime dt = S9sDateTime::currentDateTime();
     S9sString   title = "S9S";
 
-    ::printf("%s%-12s%s ", 
+    s9s_printf("%s%-12s%s ", 
             TERM_SCREEN_TITLE_BOLD, 
             STR(title), 
             TERM_SCREEN_TITLE);
 
-    ::printf("%c ", rotatingCharacter());
-    ::printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
+    s9s_printf("%c ", rotatingCharacter());
+    s9s_printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
 
     // Printing the network activity character.
     if (m_communicating || m_reloadRequested)
-        ::printf("❌ ");
+        s9s_printf("❌ ");
     else
-        ::printf("⟳ ");
+        s9s_printf("⟳ ");
 
     if (m_viewDebug)
     {
-        ::printf("0x%02x ",      lastKeyCode());
-        ::printf("%02dx%02d ",   width(), height());
-        ::printf("%02d:%03d,%03d ", m_lastButton, m_lastX, m_lastY);
+        s9s_printf("0x%02x ",      lastKeyCode());
+        s9s_printf("%02dx%02d ",   width(), height());
+        s9s_printf("%02d:%03d,%03d ", m_lastButton, m_lastX, m_lastY);
     }
 
     printNewLine();
@@ -998,9 +1132,9 @@ S9sCommander::printFooter()
 
     for (;m_lineCounter < height() - 1; ++m_lineCounter)
     {
-        ::printf("%s", TERM_ERASE_EOL);
-        ::printf("\n\r");
-        ::printf("%s", TERM_ERASE_EOL);
+        s9s_printf("%s", TERM_ERASE_EOL);
+        s9s_printf("\n\r");
+        s9s_printf("%s", TERM_ERASE_EOL);
     } 
 
     fieldSize = (width() / 10) - 2;
@@ -1032,13 +1166,13 @@ S9sCommander::printFooter()
 
     for (uint idx = 0u; idx < labels.size(); ++idx)
     {
-        ::printf(STR(format), 
+        s9s_printf(STR(format), 
                 normal, idx + 1, inverse, 
                 STR(labels[idx].toString()), normal);
     }
 
-    ::printf("%s", TERM_ERASE_EOL);
-    ::printf("%s", TERM_NORMAL);
+    s9s_printf("%s", TERM_ERASE_EOL);
+    s9s_printf("%s", TERM_NORMAL);
     ::fflush(stdout);
 }
 
@@ -1090,7 +1224,7 @@ S9sCommander::entryActivated(
         //sleep(10);
         //setConioTerminalMode(true, true);
         m_waitingForKeyPress = true;
-        ::printf("\n*** Press any key to continue. ***\n");
+        s9s_printf("\n*** Press any key to continue. ***\n");
         fflush(stdout);
     }
 }
@@ -1195,6 +1329,6 @@ S9sCommander::waitForJobWithLog(
         sleep(1);
     }
 
-    printf("\n");
+    s9s_printf("\n");
 }
 
@@ -50,6 +50,8 @@ class S9sCommander :
         virtual void printFooter();
 
         void updateTree();
+        bool updateSubTree(const S9sString &path);
+        S9sVector<S9sString> shownPaths() const;
 
         void entryActivated(
                 const S9sString   &path,
@@ -92,6 +94,8 @@ class S9sCommander :
 
         S9sTreeNode      m_rootNode;
         time_t           m_rootNodeRecevied;
+        /** The paths the browsers were showing at the last update. */
+        S9sVector<S9sString> m_updatedPaths;
         bool             m_communicating;
         bool             m_reloadRequested;
         bool             m_viewDebug;
@@ -1,10 +1,12 @@
 #include "s9sdebug.h"
 
 #include "s9soptions.h"
-#include "s9sdatetime.h"
+#include "s9slogwriter.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <pthread.h>
+#include <errno.h>
 
 /**
  * This function is for printing debug messages that are used only by
@@ -45,6 +47,54 @@ s9s_print_message (
     fflush(stream);
 }
 
+static pthread_once_t logWriterOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Opens the log file the first time something is logged. By this time the
+ * command line options are processed and the configuration files are loaded.
+ */
+static void
+s9s_log_configure()
+{
+    S9sOptions   *options  = S9sOptions::instance();
+    S9sLogWriter *writer   = S9sLogWriter::instance();
+    S9sString     fileName = options->logFile();
+    S9sLogLevel   level;
+
+    if (S9sLogWriter::levelFromString(options->logLevel(), level))
+        writer->setLevel(level);
+
+    if (!fileName.empty())
+    {
+        writer->open(
+                fileName, options->logFileMaxSize(), options->logFileCount());
+    }
+}
+
+static void
+s9s_vlog(
+        S9sLogLevel    level,
+        const char    *file,
+        const int      line,
+        const char    *formatstring,
+        va_list        args)
+{
+    S9sLogWriter *writer;
+    S9sString     logLine;
+    int           savedErrno = errno;
+
+    pthread_once(&logWriterOnce, s9s_log_configure);
+
+    writer = S9sLogWriter::instance();
+    if (!writer->isEnabled(level))
+        return;
+
+    // The format string may contain %m.
+    errno = savedErrno;
+    logLine.vsprintf(formatstring, args);
+    writer->write(level, file, line, logLine);
+}
+
 void
 s9s_log(
         const char    *file,
@@ -52,28 +102,73 @@ s9s_log(
         const char    *formatstring,
         ...)
 {
-    S9sOptions *options = S9sOptions::instance();
-    S9sString   fileName = options->logFile();
-    S9sString   logLine;
-    time_t      now = time(NULL);
+    va_list  args;
 
-    if (!fileName.empty())
+    va_start(args, formatstring);
+    s9s_vlog(LogDebug, file, line, formatstring, args);
+    va_end(args);
+}
+
+void
+s9s_log_level(
+        S9sLogLevel    level,
+        const char    *file,
+        const int      line,
+        const char    *formatstring,
+        ...)
+{
+    va_list  args;
+
+    va_start(args, formatstring);
+    s9s_vlog(level, file, line, formatstring, args);
+    va_end(args);
+}
+
+/**
+ * The frame the calling thread renders into, NULL if it prints to the
+ * standard output.
+ */
+static thread_local std::string *s_frame = NULL;
+
+void
+s9s_set_frame(
+        std::string   *frame)
+{
+    s_frame = frame;
+}
+
+int
+s9s_printf(
+        const char    *formatstring,
+        ...)
+{
+    va_list  args;
+    int      retval;
+
+    va_start(args, formatstring);
+    if (s_frame == NULL)
     {
-        FILE    *stream;
-        va_list  args;
-
-        stream = fopen(STR(fileName), "a");
-        if (stream == NULL)
-            return;
-
-        va_start(args, formatstring);
-        logLine.vsprintf(formatstring, args);
-        fprintf(stream, "%s %20s:%5d DEBUG %s\n", 
-                S9S_TIME_T(now), file, line, STR(logLine));
-        fflush(stream);
-        va_end(args);
-        
-        fclose(stream);
+        retval = vprintf(formatstring, args);
+    } else {
+        char     buffer[1024];
+        va_list  copy;
+
+        va_copy(copy, args);
+        retval = vsnprintf(buffer, sizeof(buffer), formatstring, args);
+        if (retval >= (int) sizeof(buffer))
+        {
+            std::string tmp(retval + 1, '\0');
+
+            vsnprintf(&tmp[0], tmp.size(), formatstring, copy);
+            s_frame->append(tmp, 0, retval);
+        } else if (retval > 0)
+        {
+            s_frame->append(buffer, retval);
+        }
+
+        va_end(copy);
     }
-}
 
+    va_end(args);
+    return retval;
+}
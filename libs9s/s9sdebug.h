@@ -30,16 +30,6 @@
 #  define CRITICAL
 #endif
 
-/**
- * Enum to be used as a severity level for debug messages.
- */
-typedef enum S9sMessageLevel
-{
-    DebugMsg,
-    SystemMsg,
-    WarningMsg
-} S9sMessageLevel;
-
 #undef S9S_DEBUG
 #ifdef DEBUG
 /**
@@ -80,6 +70,30 @@ typedef enum S9sMessageLevel
 /** Protector macro, dosygen complains about it if there is no documentation. */
 #define S9SDEBUG_H
 
+#include <string>
+
+/**
+ * Enum to be used as a severity level for debug messages.
+ */
+typedef enum S9sMessageLevel
+{
+    DebugMsg,
+    SystemMsg,
+    WarningMsg
+} S9sMessageLevel;
+
+/**
+ * The severity of the lines written into the s9s log file. Lines below the
+ * level set by the log_level configuration variable are not written.
+ */
+typedef enum S9sLogLevel
+{
+    LogDebug,
+    LogInfo,
+    LogWarning,
+    LogError
+} S9sLogLevel;
+
 
 /** Clear until the end of line.*/
 #define TERM_ERASE_EOL "\033[K"
@@ -197,6 +211,15 @@ s9s_print_message (
 #define PRINT_LOG(...) \
     s9s_log(__FILE__, __LINE__, __VA_ARGS__)
 
+#define PRINT_LOG_INFO(...) \
+    s9s_log_level(LogInfo, __FILE__, __LINE__, __VA_ARGS__)
+
+#define PRINT_LOG_WARNING(...) \
+    s9s_log_level(LogWarning, __FILE__, __LINE__, __VA_ARGS__)
+
+#define PRINT_LOG_ERROR(...) \
+    s9s_log_level(LogError, __FILE__, __LINE__, __VA_ARGS__)
+
 /**
  * Printf messages to the s9s log file. This file is for debugging the s9s
  * program, it is not about the controller's log.
@@ -208,6 +231,31 @@ s9s_log(
         const char    *formatstring,
         ...);
 
+void
+s9s_log_level(
+        S9sLogLevel    level,
+        const char    *file,
+        const int      line,
+        const char    *formatstring,
+        ...);
+
+/**
+ * Printf to the screen frame the calling thread is rendering (see
+ * s9s_set_frame()) or to the standard output if it is not rendering one.
+ */
+int
+s9s_printf(
+        const char    *formatstring,
+        ...);
+
+/**
+ * Sets the string where the s9s_printf() calls of the calling thread are
+ * collected, NULL sends them to the standard output again. Other threads
+ * keep printing to the standard output.
+ */
+void
+s9s_set_frame(
+        std::string   *frame);
 
 /**
  * A macro to print booleans.
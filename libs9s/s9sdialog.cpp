@@ -147,7 +147,7 @@ S9sDialog::printLine(
     const char *normal     = m_normalColor; 
 
     m_nChars = 0;
-    ::printf("%s", normal);
+    s9s_printf("%s", normal);
 
     if (lineIndex == 0)
     {
@@ -217,14 +217,14 @@ S9sDialog::printLine(
         printChar("║");
     }
     
-    ::printf("%s", TERM_NORMAL);
+    s9s_printf("%s", TERM_NORMAL);
 }
 
 void
 S9sDialog::printChar(
         const char *c)
 {
-    ::printf("%s", c);
+    s9s_printf("%s", c);
     ++m_nChars;
 ;}
 
@@ -235,7 +235,7 @@ S9sDialog::printChar(
 {
     while (m_nChars < lastColumn)
     {
-        ::printf("%s", c);
+        s9s_printf("%s", c);
         ++m_nChars;
     }
 }
@@ -253,7 +253,7 @@ S9sDialog::printString(
     if ((int)theString.length() > availableChars)
         myString.resize(availableChars);
 
-    ::printf("%s", STR(myString));
+    s9s_printf("%s", STR(myString));
     m_nChars += myString.length();
 }
 
@@ -22,6 +22,7 @@
 #include "s9soptions.h"
 #include "s9scontainer.h"
 #include "s9sdatetime.h"
+#include "s9smutexlocker.h"
 
 #define DEBUG
 //#define WARNING
@@ -62,7 +63,11 @@ S9sDisplay::S9sDisplay(
     m_rawTerminal(rawTerminal),
     m_interactive(interactive),
     m_refreshCounter(0),
-    m_isStopped(0)
+    m_isStopped(0),
+    m_inFrame(false),
+    m_maxFps(10),
+    m_dirty(false),
+    m_nFramesDrawn(0ull)
 {
     m_lastKeyCode.lastKeyCode = 0;
     m_lastButton = 0;
@@ -74,6 +79,8 @@ S9sDisplay::S9sDisplay(
 
 S9sDisplay::~S9sDisplay()
 {
+    endFrame();
+
     if (m_rawTerminal || m_interactive)
         reset_terminal_mode();
 }
@@ -147,6 +154,32 @@ S9sDisplay::lastKeyCode() const
     return m_lastKeyCode.lastKeyCode;
 }
 
+/**
+ * \param fps The maximum number of frames drawn in one second when the model
+ *   keeps changing.
+ */
+void
+S9sDisplay::setMaxFps(
+        int fps)
+{
+    m_maxFps = fps < 1 ? 1 : fps;
+}
+
+int
+S9sDisplay::maxFps() const
+{
+    return m_maxFps;
+}
+
+/**
+ * \returns How many times the screen was painted.
+ */
+ulonglong
+S9sDisplay::nFramesDrawn() const
+{
+    return m_nFramesDrawn;
+}
+
 char
 S9sDisplay::rotatingCharacter() const
 {
@@ -163,7 +196,7 @@ S9sDisplay::gotoXy(
     S9sString sequence;
 
     sequence.sprintf("\033[%d;%dH", y, x);
-    ::printf("%s", STR(sequence));
+    s9s_printf("%s", STR(sequence));
 }
 
 int 
@@ -200,7 +233,7 @@ S9sDisplay::exec()
                 ::printf ("\n\rbutton:%u\n\rx:%u\n\ry:%u\n\n\r", btn, x, y);
                 for (int idx = 0; idx < 6; ++idx)
                 {
-                    printf("[%d] 0x%x\n\r", 
+                    s9s_printf("[%d] 0x%x\n\r", 
                             idx,
                             (int)m_lastKeyCode.inputBuffer[idx]);
                 }
@@ -211,7 +244,7 @@ S9sDisplay::exec()
                 processKey(m_lastKeyCode.lastKeyCode);
             }
 
-            refreshOk = refreshScreen();
+            refreshOk = redraw();
             refreshed = true;
             m_mutex.unlock();
         }
@@ -220,13 +253,14 @@ S9sDisplay::exec()
         if (!refreshed)
         {
             m_mutex.lock();
-            refreshOk = refreshScreen();
+            refreshOk = redraw();
             m_mutex.unlock();
         }
-            
+           
+        // Waiting for a key, for the model to change or a second to pass.
         for (int idx = 0; idx < 100; ++idx)
         {
-            if (kbhit())
+            if (kbhit() || isFrameDue())
                 break;
 
             usleep(10000);
@@ -261,8 +295,8 @@ S9sDisplay::printHeader()
 
     title = "S9S                ";
 
-    ::printf("%s%s%s ", bold, STR(title), normal);
-    ::printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
+    s9s_printf("%s%s%s ", bold, STR(title), normal);
+    s9s_printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
     printNewLine();
 }
 
@@ -277,15 +311,15 @@ S9sDisplay::printFooter()
 
     for (;m_lineCounter < height() - 1; ++m_lineCounter)
     {
-        ::printf("%s", TERM_ERASE_EOL);
-        ::printf("\n\r");
-        ::printf("%s", TERM_ERASE_EOL);
+        s9s_printf("%s", TERM_ERASE_EOL);
+        s9s_printf("\n\r");
+        s9s_printf("%s", TERM_ERASE_EOL);
     } 
 
-    ::printf("%sQ%s-Quit ", bold, normal);
+    s9s_printf("%sQ%s-Quit ", bold, normal);
 
-    ::printf("%s", TERM_ERASE_EOL);
-    ::printf("%s", TERM_NORMAL);
+    s9s_printf("%s", TERM_ERASE_EOL);
+    s9s_printf("%s", TERM_NORMAL);
     ::fflush(stdout);
 }
 
@@ -367,9 +401,141 @@ S9sDisplay::startScreen()
     setLocation(0, 0);
     setSize(w.ws_col, w.ws_row);
 
+    if (m_inFrame)
+        m_screenBuffer.setSize(w.ws_col, w.ws_row);
+
     m_lineCounter = 0;
         
-    ::printf("%s", TERM_HOME);
+    s9s_printf("%s", TERM_HOME);
+}
+
+/**
+ * Starts capturing the output of a screen refresh. In interactive mode the
+ * views are not writing the terminal directly, the frame is collected in
+ * memory and endFrame() sends only the changed cells to the terminal, so a
+ * steady screen costs almost nothing on a slow (e.g. ssh) connection.
+ *
+ * The mutex should be locked while a frame is captured. Only the s9s_printf()
+ * calls of this thread go into the frame, the standard output itself is not
+ * touched, so whatever the other threads print still goes to the terminal.
+ */
+void
+S9sDisplay::beginFrame()
+{
+    if (!m_interactive || !m_rawTerminal || m_inFrame)
+        return;
+
+    ::fflush(stdout);
+
+    m_frame.clear();
+    m_inFrame = true;
+    s9s_set_frame(&m_frame);
+}
+
+/**
+ * Finishes the capturing started by beginFrame() and updates the terminal.
+ */
+void
+S9sDisplay::endFrame()
+{
+    S9sString output;
+
+    if (!m_inFrame)
+        return;
+
+    s9s_set_frame(NULL);
+    m_inFrame = false;
+
+    m_screenBuffer.parse(m_frame);
+    m_frame.clear();
+
+    output = m_screenBuffer.render();
+    if (!output.empty())
+    {
+        ::fwrite(output.c_str(), 1, output.length(), stdout);
+        ::fflush(stdout);
+    }
+}
+
+/**
+ * Forces the next frame to repaint the whole screen. Should be called when
+ * something else was printed to the terminal.
+ */
+void
+S9sDisplay::invalidateScreen()
+{
+    m_screenBuffer.invalidate();
+}
+
+/**
+ * \returns The return value of refreshScreen().
+ *
+ * Paints one frame. The mutex should be locked when this method is called.
+ */
+bool
+S9sDisplay::redraw()
+{
+    bool retval;
+
+    beginFrame();
+    retval = refreshScreen();
+    endFrame();
+
+    m_dirty         = false;
+    m_lastFrameTime = S9sDateTime::currentDateTime();
+    ++m_nFramesDrawn;
+
+    return retval;
+}
+
+/**
+ * Called when the model changed and the screen needs to be repainted. The
+ * screen is not painted here, the render tick of the exec() loop will draw the
+ * next frame, so a burst of changes are drawn together in one frame. The mutex
+ * should be locked when this method is called.
+ */
+void
+S9sDisplay::markDirty()
+{
+    m_dirty = true;
+}
+
+/**
+ * \returns True if the model has changed and enough time is passed since the
+ *   last frame to draw a new one without exceeding the maximum frame rate.
+ */
+bool
+S9sDisplay::isFrameDue()
+{
+    S9sMutexLocker locker(m_mutex);
+    double         millis;
+
+    if (!m_dirty)
+        return false;
+
+    millis = S9sDateTime::milliseconds(
+            S9sDateTime::currentDateTime(), m_lastFrameTime);
+
+    return millis >= 1000.0 / m_maxFps;
+}
+
+/**
+ * \returns How many bytes the views painted in interactive mode.
+ */
+ulonglong
+S9sDisplay::bytesGenerated() const
+{
+    return m_screenBuffer.bytesGenerated();
+}
+
+/**
+ * \returns How many bytes were sent to the terminal after the screen
+ *   differences were computed.
+ */
+ulonglong
+S9sDisplay::bytesWritten() const
+{
+    return m_screenBuffer.bytesWritten();
 }
 
 /**
@@ -383,18 +549,18 @@ S9sDisplay::printMiddle(
 
     for (;m_lineCounter < height() / 2;)
     {
-        ::printf("%s", TERM_ERASE_EOL);
-        ::printf("\r\n");
+        s9s_printf("%s", TERM_ERASE_EOL);
+        s9s_printf("\r\n");
         ++m_lineCounter;
     }
 
     nSpaces = (width() - text.length()) / 2;
     for (;nSpaces > 0; --nSpaces)
-        ::printf(" ");
+        s9s_printf(" ");
 
-    ::printf("%s", STR(text));
-    ::printf("%s", TERM_ERASE_EOL);
-    ::printf("\r\n");
+    s9s_printf("%s", STR(text));
+    s9s_printf("%s", TERM_ERASE_EOL);
+    s9s_printf("\r\n");
     ++m_lineCounter;
 }
 
@@ -403,11 +569,11 @@ S9sDisplay::printNewLine()
 {
     if (m_rawTerminal)
     {
-        ::printf("%s", TERM_ERASE_EOL);
-        ::printf("\n\r");
-        ::printf("%s", TERM_NORMAL);
+        s9s_printf("%s", TERM_ERASE_EOL);
+        s9s_printf("\n\r");
+        s9s_printf("%s", TERM_NORMAL);
     } else {
-        ::printf("\n");
+        s9s_printf("\n");
     }
 
     ++m_lineCounter;
@@ -437,14 +603,16 @@ S9sDisplay::setConioTerminalMode(
 
     if (interactive)
     {
-        ::printf("%s", TERM_CURSOR_OFF);
-        ::printf("%s", TERM_AUTOWRAP_OFF);
+        m_screenBuffer.invalidate();
+
+        s9s_printf("%s", TERM_CURSOR_OFF);
+        s9s_printf("%s", TERM_AUTOWRAP_OFF);
     
         // Switch to the alternate buffer screen
-        ::printf("%s", "\e[?47h");
+        s9s_printf("%s", "\e[?47h");
 
         // Enable mouse tracking
-        ::printf("%s", "\e[?9h");
+        s9s_printf("%s", "\e[?9h");
     }
 }
 
@@ -30,6 +30,8 @@
 #include "s9sthread.h"
 #include "s9swidget.h"
 #include "s9sfile.h"
+#include "s9sscreenbuffer.h"
+#include "s9sdatetime.h"
 
 #define S9S_KEY_DOWN      0x425b1b
 #define S9S_KEY_UP        0x415b1b
@@ -77,6 +79,10 @@ class S9sDisplay :
 
         int lastKeyCode() const;
 
+        void setMaxFps(int fps);
+        int maxFps() const;
+        ulonglong nFramesDrawn() const;
+
         static void gotoXy(int x, int y);
 
     protected:
@@ -87,6 +93,16 @@ class S9sDisplay :
         virtual void printFooter();
 
         void startScreen();
+        void beginFrame();
+        void endFrame();
+        void invalidateScreen();
+
+        bool redraw();
+        void markDirty();
+        bool isFrameDue();
+
+        ulonglong bytesGenerated() const;
+        ulonglong bytesWritten() const;
         
         void printMiddle(const S9sString text);
         void printNewLine();
@@ -122,6 +138,19 @@ class S9sDisplay :
         int                          m_lastX;
         int                          m_lastY;
         bool                         m_isStopped;
+
+        /** The differential renderer, only used in interactive mode. */
+        S9sScreenBuffer              m_screenBuffer;
+        /** The frame collected between beginFrame() and endFrame(). */
+        S9sString                    m_frame;
+        bool                         m_inFrame;
+
+        /** The render tick: redraw at most this many times in a second. */
+        int                          m_maxFps;
+        /** The model changed since the last frame was drawn. */
+        bool                         m_dirty;
+        S9sDateTime                  m_lastFrameTime;
+        ulonglong                    m_nFramesDrawn;
 };
 
 void reset_terminal_mode();
@@ -135,12 +135,12 @@ S9sDisplayEntry::print() const
     
     nChars = m_content.size();
 
-    ::printf("%s", selection);
-    ::printf("%s", STR(m_content));
+    s9s_printf("%s", selection);
+    s9s_printf("%s", STR(m_content));
 
     while (nChars < width())
     {
-        ::printf(" ");
+        s9s_printf(" ");
         ++nChars;
     }
 }
@@ -156,8 +156,8 @@ S9sDisplayEntry::showCursor()
         return;
 
     sequence.sprintf("\033[%d;%dH", row, col);
-    ::printf("%s", STR(sequence));
-    ::printf("%s", TERM_CURSOR_ON);
+    s9s_printf("%s", STR(sequence));
+    s9s_printf("%s", TERM_CURSOR_ON);
 
     fflush(stdout);
 }
@@ -19,13 +19,17 @@
  */
 #include "s9sdisplaylist.h"
 #include "s9sdisplay.h"
+#include "s9sdebug.h"
 
 S9sDisplayList::S9sDisplayList() :
     S9sWidget(), 
     m_selectionEnabled(true),
     m_selectionIndex(0),
     m_startIndex(0),
-    m_numberOfItems(0)
+    m_numberOfItems(0),
+    m_headerHeight(0),
+    m_footerHeight(0),
+    m_lineCacheWidth(0)
 {
 }
 
@@ -172,7 +176,7 @@ S9sDisplayList::processKey(
             break;
 
         default:
-            ::printf(" %x ", key);
+            s9s_printf(" %x ", key);
             //sleep(5);
     }
 }
@@ -181,6 +185,18 @@ void
 S9sDisplayList::setNumberOfItems(
         int n)
 {
+    if (n != m_numberOfItems)
+    {
+        /*
+         * The items that are still in the list are the same, but the lines
+         * after the end of the list (empty lines or removed items) are not.
+         */
+        S9sMap<int, S9sString>::iterator it;
+        
+        it = m_lineCache.lower_bound(n < m_numberOfItems ? n : m_numberOfItems);
+        m_lineCache.erase(it, m_lineCache.end());
+    }
+
     m_numberOfItems = n;
 
     if (m_selectionIndex >= m_numberOfItems)
@@ -268,3 +284,96 @@ S9sDisplayList::ensureSelectionVisible()
             m_startIndex = 0;
     }
 }
+
+/**
+ * \param index The index of the item.
+ * \param line The place to return the formatted line.
+ * \returns True if the line for the item was found in the cache.
+ *
+ * The lines are formatted only for the items that are visible, the formatted
+ * lines are kept until the items or the width of the widget change, so
+ * refreshing the screen does not need to format the lines again.
+ */
+bool
+S9sDisplayList::cachedLine(
+        const int  index, 
+        S9sString &line) const
+{
+    S9sMap<int, S9sString>::const_iterator it;
+
+    if (m_lineCacheWidth != width())
+        return false;
+
+    it = m_lineCache.find(index);
+    if (it == m_lineCache.end())
+        return false;
+
+    line = it->second;
+    return true;
+}
+
+/**
+ * Stores the formatted line of one item. Only the lines around the visible
+ * part of the list are kept, so the cache is small even if the list is long.
+ */
+void
+S9sDisplayList::setCachedLine(
+        const int        index, 
+        const S9sString &line)
+{
+    if (m_lineCacheWidth != width())
+    {
+        m_lineCache.clear();
+        m_lineCacheWidth = width();
+    }
+
+    if ((int) m_lineCache.size() > 2 * listHeight())
+    {
+        S9sMap<int, S9sString>::iterator it = m_lineCache.begin();
+
+        while (it != m_lineCache.end())
+        {
+            if (!isIndexVisible(it->first))
+                m_lineCache.erase(it++);
+            else
+                ++it;
+        }
+    }
+
+    m_lineCache[index] = line;
+}
+
+/**
+ * Drops the cached lines, should be called when the items shown in the list
+ * are changed.
+ */
+void
+S9sDisplayList::invalidateLines()
+{
+    m_lineCache.clear();
+}
+
+/**
+ * \param nItems How many items were removed from the top of the list.
+ *
+ * Drops the cached lines of the removed items and moves the others up, so
+ * that the lines stay with their items when the list scrolls by itself.
+ */
+void
+S9sDisplayList::removeCachedLines(
+        const int nItems)
+{
+    S9sMap<int, S9sString> lineCache;
+
+    if (nItems <= 0)
+        return;
+
+    for (S9sMap<int, S9sString>::const_iterator it = 
+                m_lineCache.lower_bound(nItems);
+            it != m_lineCache.end(); ++it)
+    {
+        lineCache[it->first - nItems] = it->second;
+    }
+
+    m_lineCache.swap(lineCache);
+}
@@ -20,7 +20,14 @@
 #pragma once
 
 #include "s9swidget.h"
+#include "s9smap.h"
 
+/**
+ * A list widget that shows a window of a (potentially very long) list of
+ * items. The items are not stored here, the widgets printing the list only
+ * format the visible items and may keep the formatted lines in the line cache
+ * for the next refresh.
+ */
 class S9sDisplayList : public S9sWidget
 {
     public:
@@ -52,6 +59,11 @@ class S9sDisplayList : public S9sWidget
 
         void ensureSelectionVisible();
 
+        bool cachedLine(const int index, S9sString &line) const;
+        void setCachedLine(const int index, const S9sString &line);
+        void invalidateLines();
+        void removeCachedLines(const int nItems);
+
     private:
         int  m_selectionEnabled;
         int  m_selectionIndex;
@@ -59,4 +71,8 @@ class S9sDisplayList : public S9sWidget
         int  m_numberOfItems;
         int  m_headerHeight;
         int  m_footerHeight;
+        /** The formatted lines by item index, see cachedLine(). */
+        S9sMap<int, S9sString> m_lineCache;
+        /** The width of the widget when the cached lines were formatted. */
+        int  m_lineCacheWidth;
 };
@@ -353,7 +353,7 @@ S9sEditor::printLine(
     //const char *selection = "\033[1m\033[48;5;51m" "\033[2m\033[38;5;237m";
 
     m_nChars = 0;
-    ::printf("%s", normal);
+    s9s_printf("%s", normal);
     if (lineIndex == 0)
     {
         // The top frame line.
@@ -405,10 +405,10 @@ S9sEditor::printString(
     if ((int)asciiString.length() > availableChars)
     {
         asciiString.resize(availableChars);
-        ::printf("%s", STR(asciiString));
+        s9s_printf("%s", STR(asciiString));
     } else {
-        ::printf("%s", STR(colorString));
-        ::printf("%s", normal);
+        s9s_printf("%s", STR(colorString));
+        s9s_printf("%s", normal);
     }
 
     m_nChars += asciiString.length();
@@ -418,7 +418,7 @@ void
 S9sEditor::printChar(
         int c)
 {
-    ::printf("%c", c);
+    s9s_printf("%c", c);
     ++m_nChars;
 }
 
@@ -426,7 +426,7 @@ void
 S9sEditor::printChar(
         const char *c)
 {
-    ::printf("%s", c);
+    s9s_printf("%s", c);
     ++m_nChars;
 }
 
@@ -437,7 +437,7 @@ S9sEditor::printChar(
 {
     while (m_nChars < lastColumn)
     {
-        ::printf("%s", c);
+        s9s_printf("%s", c);
         ++m_nChars;
     }
 }
@@ -463,8 +463,8 @@ S9sEditor::showCursor()
         return;
 
     sequence.sprintf("\033[%d;%dH", row, col);
-    ::printf("%s", STR(sequence));
-    ::printf("%s", TERM_CURSOR_ON);
+    s9s_printf("%s", STR(sequence));
+    s9s_printf("%s", TERM_CURSOR_ON);
 
     fflush(stdout);
 }
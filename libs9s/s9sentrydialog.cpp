@@ -99,18 +99,18 @@ S9sEntryDialog::printLine(
     const char *normal     = m_normalColor; 
 
     m_nChars = 0;
-    ::printf("%s", normal);
+    s9s_printf("%s", normal);
 
     if (lineIndex == 2)
     {
         printChar("║");
         m_entry.print();
-        ::printf("%s", normal);
+        s9s_printf("%s", normal);
         printChar("║");
     } else {
         S9sDialog::printLine(lineIndex);
     }
     
-    ::printf("%s", TERM_NORMAL);
+    s9s_printf("%s", TERM_NORMAL);
 }
 
@@ -774,6 +774,16 @@ S9sEvent::clusterId() const
     return getInt("event_specifics/cluster_id");
 }
 
+/**
+ * \returns The name of the host (or server) the event is about, the empty
+ *   string if the event is not about a host.
+ */
+S9sString
+S9sEvent::hostName() const
+{
+    return getString("event_specifics/host/hostname");
+}
+
 bool
 S9sEvent::hasHost() const
 {
@@ -863,3 +873,20 @@ S9sEvent::job() const
 
     return job;
 }
+
+/**
+ * \returns The ID of the job the event is about, either the job itself is in
+ *   the event or a job message that belongs to the job, -1 if the event is not
+ *   about a job.
+ */
+int
+S9sEvent::jobId() const
+{
+    if (hasJob())
+        return job().jobId();
+
+    if (m_properties.valueByPath("/event_specifics/message").isVariantMap())
+        return getInt("/event_specifics/message/job_id");
+
+    return -1;
+}
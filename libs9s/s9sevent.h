@@ -105,6 +105,7 @@ class S9sEvent : public S9sObject
         int senderLine() const;
 
         int clusterId() const;
+        S9sString hostName() const;
 
         S9sString toString() const;
 
@@ -131,6 +132,7 @@ class S9sEvent : public S9sObject
 
         bool hasJob() const;
         S9sJob job() const;
+        int jobId() const;
 
     protected:
         S9sString eventLogToOneLiner() const;
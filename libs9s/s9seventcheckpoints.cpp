@@ -0,0 +1,650 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9seventcheckpoints.h"
+
+#include "s9sevent.h"
+#include "s9sfile.h"
+#include "s9sdatetime.h"
+#include "s9svariantlist.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+#define CHECKPOINT_FILE_HEADER "# s9s event checkpoints 1"
+#define CHECKPOINT_HEADER      "# checkpoint "
+
+/**
+ * How many finished jobs are kept in the checkpoints.
+ */
+const uint S9sEventCheckpoints::maxFinishedJobs = 100u;
+
+S9sEventCheckpoints::S9sEventCheckpoints(
+        const int nEvents,
+        const int interval) :
+    m_nEvents(nEvents > 0 ? nEvents : 1),
+    m_interval(interval > 0 ? interval : 1),
+    m_eventsSince(0),
+    m_lastCreated(0),
+    m_appendStream(NULL)
+{
+}
+
+S9sEventCheckpoints::~S9sEventCheckpoints()
+{
+    close();
+}
+
+/**
+ * \param recordingPath The path of the recording.
+ * \returns The path of the checkpoint file that belongs to the recording.
+ */
+S9sString
+S9sEventCheckpoints::checkpointFileName(
+        const S9sString &recordingPath)
+{
+    return recordingPath + ".ckp";
+}
+
+/**
+ * Removes the oldest finished jobs from the map, so that only the last
+ * maxFinishedJobs finished jobs remain. The jobs that are not finished are
+ * never removed.
+ */
+void
+S9sEventCheckpoints::pruneJobs(
+        S9sMap<int, S9sJob> &jobs)
+{
+    S9sVector<int> finished;
+
+    for (S9sMap<int, S9sJob>::const_iterator it = jobs.begin();
+            it != jobs.end(); ++it)
+    {
+        S9sString status = it->second.status();
+
+        if (status == "FINISHED" || status == "FAILED" || status == "ABORTED")
+            finished << it->first;
+    }
+
+    // The map is ordered by the job ID, the first ones are the oldest.
+    for (uint idx = 0u; idx + maxFinishedJobs < finished.size(); ++idx)
+        jobs.erase(finished[idx]);
+}
+
+/**
+ * Updates the objects with the data found in the event. This is how the
+ * interactive monitor builds its model too, so the restored checkpoints are
+ * the same as what the monitor would have after processing all the events.
+ */
+void
+S9sEventCheckpoints::applyEvent(
+        const S9sEvent                &event,
+        S9sMap<int, S9sCluster>       &clusters,
+        S9sMap<int, S9sNode>          &nodes,
+        S9sMap<int, S9sJob>           &jobs,
+        S9sMap<S9sString, S9sServer>  &servers)
+{
+    // The clusters.
+    if (event.hasCluster())
+    {
+        S9sCluster cluster = event.cluster();
+        // FIXME: what about cluster delete events?
+        if (cluster.clusterId() != 0)
+            clusters[cluster.clusterId()] = cluster;
+    }
+
+    // The jobs.
+    if (event.hasJob())
+    {
+        S9sJob job = event.job();
+            
+        jobs[job.jobId()] = job;
+    }
+    
+    // The hosts.
+    if (event.hasHost())
+    {
+        S9sNode node = event.host();
+
+        nodes[node.hostId()] = node;
+    }
+    
+    // The servers (together with the containers).
+    if (event.hasServer())
+    {
+        S9sServer server = event.server();
+
+        if (event.eventSubClass() == S9sEvent::Destroyed)
+            servers.erase(server.id());
+        else
+            servers[server.id()] = server;
+    }
+}
+
+/**
+ * \returns The objects in one map that can be saved as a JSON string.
+ */
+S9sVariantMap
+S9sEventCheckpoints::snapshot(
+        const S9sMap<int, S9sCluster>      &clusters,
+        const S9sMap<int, S9sNode>         &nodes,
+        const S9sMap<int, S9sJob>          &jobs,
+        const S9sMap<S9sString, S9sServer> &servers)
+{
+    S9sVariantMap  retval;
+    S9sVariantList list;
+
+    for (S9sMap<int, S9sCluster>::const_iterator it = clusters.begin();
+            it != clusters.end(); ++it)
+    {
+        list << it->second.toVariantMap();
+    }
+
+    retval["clusters"] = list;
+    list.clear();
+
+    for (S9sMap<int, S9sNode>::const_iterator it = nodes.begin();
+            it != nodes.end(); ++it)
+    {
+        list << it->second.toVariantMap();
+    }
+
+    retval["nodes"] = list;
+    list.clear();
+
+    for (S9sMap<int, S9sJob>::const_iterator it = jobs.begin();
+            it != jobs.end(); ++it)
+    {
+        list << it->second.toVariantMap();
+    }
+
+    retval["jobs"] = list;
+    list.clear();
+
+    for (S9sMap<S9sString, S9sServer>::const_iterator it = servers.begin();
+            it != servers.end(); ++it)
+    {
+        list << it->second.toVariantMap();
+    }
+
+    retval["servers"] = list;
+    return retval;
+}
+
+/**
+ * Replaces the objects with the ones found in the snapshot.
+ */
+void
+S9sEventCheckpoints::restore(
+        const S9sVariantMap           &snapshot,
+        S9sMap<int, S9sCluster>       &clusters,
+        S9sMap<int, S9sNode>          &nodes,
+        S9sMap<int, S9sJob>           &jobs,
+        S9sMap<S9sString, S9sServer>  &servers)
+{
+    S9sVariantList list;
+
+    clusters.clear();
+    nodes.clear();
+    jobs.clear();
+    servers.clear();
+
+    list = snapshot.valueByPath("/clusters").toVariantList();
+    for (uint idx = 0u; idx < list.size(); ++idx)
+    {
+        S9sCluster cluster(list[idx].toVariantMap());
+
+        clusters[cluster.clusterId()] = cluster;
+    }
+
+    list = snapshot.valueByPath("/nodes").toVariantList();
+    for (uint idx = 0u; idx < list.size(); ++idx)
+    {
+        S9sNode node(list[idx].toVariantMap());
+
+        nodes[node.hostId()] = node;
+    }
+
+    list = snapshot.valueByPath("/jobs").toVariantList();
+    for (uint idx = 0u; idx < list.size(); ++idx)
+    {
+        S9sJob job(list[idx].toVariantMap());
+
+        jobs[job.jobId()] = job;
+    }
+
+    list = snapshot.valueByPath("/servers").toVariantList();
+    for (uint idx = 0u; idx < list.size(); ++idx)
+    {
+        S9sServer server(list[idx].toVariantMap());
+
+        servers[server.id()] = server;
+    }
+}
+
+/**
+ * \param event The next event of the recording.
+ * \param nextOffset The offset of the event after this one in the recording.
+ * \returns True if a checkpoint was taken after this event.
+ */
+bool
+S9sEventCheckpoints::apply(
+        const S9sEvent &event,
+        const off_t     nextOffset)
+{
+    time_t created = event.created().toTimeT();
+
+    applyEvent(event, m_clusters, m_nodes, m_jobs, m_servers);
+
+    if (m_lastCreated == 0)
+        m_lastCreated = created;
+
+    ++m_eventsSince;
+    if (m_eventsSince < m_nEvents && created - m_lastCreated < m_interval)
+        return false;
+
+    m_eventsSince = 0;
+    m_lastCreated = created;
+
+    pruneJobs(m_jobs);
+    return add(created, nextOffset);
+}
+
+/**
+ * \param path The path of the checkpoint file.
+ * \param recordingPath The recording the checkpoints belong to, if provided
+ *   and the checkpoint file exists the objects are restored from the last
+ *   checkpoint and the events after it in the recording.
+ *
+ * Opens the checkpoint file for append, the checkpoints taken later are
+ * written into the file immediately. When an existing recording is appended
+ * the recording has to be provided, otherwise the checkpoints taken later
+ * would hold only the objects of the new events. If the recording has no
+ * checkpoint file (e.g. it was recorded by an older version) the checkpoints
+ * are built from the recording first.
+ */
+bool
+S9sEventCheckpoints::openForAppend(
+        const S9sString &path,
+        const S9sString &recordingPath)
+{
+    struct stat recordingInfo;
+    bool        hasRecording;
+
+    close();
+
+    hasRecording = 
+        !recordingPath.empty() && 
+        stat(STR(recordingPath), &recordingInfo) == 0 &&
+        recordingInfo.st_size > 0;
+
+    if (!S9sFile::fileExists(path) || !load(path))
+    {
+        if (!hasRecording)
+            reset();
+        else if (!build(recordingPath))
+            return false;
+    } else if (!recordingPath.empty() && !restoreState(recordingPath))
+    {
+        // The checkpoints are damaged, creating them again.
+        S9S_WARNING("%s", STR(m_errorString));
+        if (!build(recordingPath))
+            return false;
+    }
+
+    m_appendStream = fopen(STR(path), "a");
+    if (m_appendStream == NULL)
+    {
+        m_errorString.sprintf(
+                "Unable to open '%s' for writing: %s", 
+                STR(path), strerror(errno));
+
+        return false;
+    }
+
+    m_path = path;
+    fseeko(m_appendStream, 0, SEEK_END);
+    if (ftello(m_appendStream) == 0)
+    {
+        fprintf(m_appendStream, "%s\n", CHECKPOINT_FILE_HEADER);
+        fflush(m_appendStream);
+    }
+
+    return true;
+}
+
+bool
+S9sEventCheckpoints::isOpen() const
+{
+    return m_appendStream != NULL;
+}
+
+void
+S9sEventCheckpoints::close()
+{
+    if (m_appendStream != NULL)
+    {
+        fclose(m_appendStream);
+        m_appendStream = NULL;
+    }
+}
+
+/**
+ * Loads the list of the checkpoints from the given file, the snapshots are
+ * skipped and read later by read() when they are needed.
+ */
+bool
+S9sEventCheckpoints::load(
+        const S9sString &path)
+{
+    FILE      *stream;
+    char       line[128];
+    long long  created;
+    long long  offset;
+    long long  length;
+
+    reset();
+
+    stream = fopen(STR(path), "r");
+    if (stream == NULL)
+    {
+        m_errorString.sprintf(
+                "Unable to open '%s' for reading: %s", 
+                STR(path), strerror(errno));
+
+        return false;
+    }
+
+    if (fgets(line, sizeof(line), stream) == NULL || 
+            strncmp(line, CHECKPOINT_FILE_HEADER, 
+                strlen(CHECKPOINT_FILE_HEADER)) != 0)
+    {
+        m_errorString.sprintf(
+                "The '%s' is not a checkpoint file.", STR(path));
+
+        fclose(stream);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), stream) != NULL)
+    {
+        if (sscanf(line, CHECKPOINT_HEADER "%lld %lld %lld", 
+                    &created, &offset, &length) != 3)
+        {
+            continue;
+        }
+
+        m_times     << (time_t) created;
+        m_offsets   << (off_t) offset;
+        m_positions << ftello(stream);
+
+        if (fseeko(stream, length, SEEK_CUR) != 0)
+            break;
+    }
+
+    fclose(stream);
+    m_path = path;
+
+    return true;
+}
+
+/**
+ * Creates the checkpoints for a recording that has none by processing all
+ * the events in it. The checkpoint file is overwritten.
+ */
+bool
+S9sEventCheckpoints::build(
+        const S9sString &recordingPath)
+{
+    S9sString path = checkpointFileName(recordingPath);
+    S9sFile   file(recordingPath);
+    S9sEvent  event;
+
+    close();
+    unlink(STR(path));
+
+    if (!file.openForRead())
+    {
+        m_errorString = file.errorString();
+        return false;
+    }
+
+    if (!openForAppend(path))
+        return false;
+
+    while (file.readEvent(event))
+        apply(event, file.tell());
+
+    close();
+
+    S9S_DEBUG("Created %u checkpoints for '%s'.", size(), STR(recordingPath));
+    return true;
+}
+
+/**
+ * \returns How many checkpoints we have.
+ */
+uint
+S9sEventCheckpoints::size() const
+{
+    return m_times.size();
+}
+
+bool
+S9sEventCheckpoints::empty() const
+{
+    return m_times.empty();
+}
+
+/**
+ * \param target The time we want to see the state at.
+ * \returns The index of the last checkpoint taken before the target time or
+ *   -1 if there is no such checkpoint.
+ */
+int
+S9sEventCheckpoints::find(
+        const time_t target) const
+{
+    int first = 0;
+    int last  = m_times.size();
+
+    while (first < last)
+    {
+        int middle = (first + last) / 2;
+
+        if (m_times[middle] < target)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    return first - 1;
+}
+
+/**
+ * \returns The creation time of the last event processed before the
+ *   checkpoint was taken.
+ */
+time_t
+S9sEventCheckpoints::created(
+        const uint index) const
+{
+    return m_times[index];
+}
+
+/**
+ * \returns The offset of the first event in the recording that was not
+ *   processed when the checkpoint was taken.
+ */
+off_t
+S9sEventCheckpoints::offset(
+        const uint index) const
+{
+    return m_offsets[index];
+}
+
+/**
+ * Reads the snapshot of the given checkpoint from the file.
+ */
+bool
+S9sEventCheckpoints::read(
+        const uint     index,
+        S9sVariantMap &snapshot) const
+{
+    S9sFile   file(m_path);
+    S9sString jsonString;
+    S9sString line;
+
+    snapshot.clear();
+
+    if (index >= m_positions.size() || !file.seek(m_positions[index]))
+    {
+        m_errorString.sprintf(
+                "Unable to read checkpoint %u from '%s'.", 
+                index, STR(m_path));
+
+        return false;
+    }
+
+    while (file.readLine(line) && !line.trim(" \n\r").empty())
+        jsonString += line;
+
+    if (!snapshot.parse(STR(jsonString)))
+    {
+        m_errorString.sprintf(
+                "Error parsing checkpoint %u in '%s'.", index, STR(m_path));
+
+        return false;
+    }
+
+    return true;
+}
+
+S9sString
+S9sEventCheckpoints::errorString() const
+{
+    return m_errorString;
+}
+
+/**
+ * Restores the objects from the last checkpoint and applies the events that
+ * are after it in the recording, so the objects are the same as if the whole
+ * recording had been processed by apply().
+ */
+bool
+S9sEventCheckpoints::restoreState(
+        const S9sString &recordingPath)
+{
+    S9sFile       file(recordingPath);
+    S9sVariantMap theSnapshot;
+    S9sEvent      event;
+    off_t         startOffset = 0;
+
+    m_clusters.clear();
+    m_nodes.clear();
+    m_jobs.clear();
+    m_servers.clear();
+    m_eventsSince = 0;
+    m_lastCreated = 0;
+
+    if (!empty())
+    {
+        if (!read(size() - 1, theSnapshot))
+            return false;
+
+        restore(theSnapshot, m_clusters, m_nodes, m_jobs, m_servers);
+        startOffset   = m_offsets.back();
+        m_lastCreated = m_times.back();
+    }
+
+    if (!S9sFile::fileExists(recordingPath))
+        return true;
+
+    if (!file.seek(startOffset))
+    {
+        m_errorString = file.errorString();
+        return false;
+    }
+
+    while (file.readEvent(event))
+    {
+        applyEvent(event, m_clusters, m_nodes, m_jobs, m_servers);
+
+        if (m_lastCreated == 0)
+            m_lastCreated = event.created().toTimeT();
+
+        ++m_eventsSince;
+    }
+
+    return true;
+}
+
+/**
+ * Takes a checkpoint of the objects built by apply().
+ */
+bool
+S9sEventCheckpoints::add(
+        const time_t created,
+        const off_t  offset)
+{
+    S9sString jsonString;
+
+    if (m_appendStream == NULL)
+        return false;
+
+    jsonString = snapshot(m_clusters, m_nodes, m_jobs, m_servers).toString();
+
+    fprintf(m_appendStream, CHECKPOINT_HEADER "%lld %lld %llu\n", 
+            (long long) created, (long long) offset, 
+            (ulonglong) jsonString.length());
+
+    m_times     << created;
+    m_offsets   << offset;
+    m_positions << ftello(m_appendStream);
+
+    fprintf(m_appendStream, "%s\n\n", STR(jsonString));
+    fflush(m_appendStream);
+
+    return true;
+}
+
+/**
+ * Forgets the checkpoints and the objects.
+ */
+void
+S9sEventCheckpoints::reset()
+{
+    m_times.clear();
+    m_offsets.clear();
+    m_positions.clear();
+
+    m_clusters.clear();
+    m_nodes.clear();
+    m_jobs.clear();
+    m_servers.clear();
+    m_eventsSince = 0;
+    m_lastCreated = 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9smap.h"
+#include "s9svariantmap.h"
+#include "s9scluster.h"
+#include "s9snode.h"
+#include "s9sjob.h"
+#include "s9sserver.h"
+#include "s9sglobal.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <time.h>
+
+class S9sEvent;
+
+/**
+ * Snapshots of the objects (clusters, nodes, jobs and servers) as they are
+ * known after processing the events of a recording up to a given point. The
+ * checkpoints are saved next to the recording (with the ".ckp" extension
+ * added to the name) while recording or while indexing a recording, so the
+ * play back can restore the state at any time from the closest checkpoint
+ * and process only the events after it, forward and backward alike.
+ *
+ * A checkpoint is taken after every nEvents events or after interval seconds
+ * of events, whichever comes first. Every checkpoint in the file has a header
+ * line "# checkpoint CREATED OFFSET LENGTH" where the OFFSET is the offset of
+ * the next event in the recording and LENGTH is the length of the JSON string
+ * that follows, so loading the list of checkpoints does not need to read the
+ * snapshots themselves.
+ *
+ * Only the last maxFinishedJobs finished jobs are kept, the jobs that are not
+ * finished are all kept, so the snapshots do not grow without a limit on long
+ * recordings.
+ */
+class S9sEventCheckpoints
+{
+    public:
+        S9sEventCheckpoints(
+                const int nEvents  = 1000,
+                const int interval = 300);
+
+        virtual ~S9sEventCheckpoints();
+
+        static S9sString checkpointFileName(const S9sString &recordingPath);
+        static void pruneJobs(S9sMap<int, S9sJob> &jobs);
+
+        static void applyEvent(
+                const S9sEvent                &event,
+                S9sMap<int, S9sCluster>       &clusters,
+                S9sMap<int, S9sNode>          &nodes,
+                S9sMap<int, S9sJob>           &jobs,
+                S9sMap<S9sString, S9sServer>  &servers);
+
+        static S9sVariantMap snapshot(
+                const S9sMap<int, S9sCluster>      &clusters,
+                const S9sMap<int, S9sNode>         &nodes,
+                const S9sMap<int, S9sJob>          &jobs,
+                const S9sMap<S9sString, S9sServer> &servers);
+
+        static void restore(
+                const S9sVariantMap           &snapshot,
+                S9sMap<int, S9sCluster>       &clusters,
+                S9sMap<int, S9sNode>          &nodes,
+                S9sMap<int, S9sJob>           &jobs,
+                S9sMap<S9sString, S9sServer>  &servers);
+
+        bool apply(const S9sEvent &event, const off_t nextOffset);
+
+        bool openForAppend(
+                const S9sString &path,
+                const S9sString &recordingPath = S9sString());
+        bool isOpen() const;
+        void close();
+
+        bool load(const S9sString &path);
+        bool build(const S9sString &recordingPath);
+
+        uint size() const;
+        bool empty() const;
+        int find(const time_t target) const;
+        time_t created(const uint index) const;
+        off_t offset(const uint index) const;
+        bool read(const uint index, S9sVariantMap &snapshot) const;
+
+        S9sString errorString() const;
+
+        static const uint maxFinishedJobs;
+
+    private:
+        bool add(const time_t created, const off_t offset);
+        bool restoreState(const S9sString &recordingPath);
+        void reset();
+
+    private:
+        int                           m_nEvents;
+        int                           m_interval;
+
+        /** The objects built from the events processed by apply(). */
+        S9sMap<int, S9sCluster>       m_clusters;
+        S9sMap<int, S9sNode>          m_nodes;
+        S9sMap<int, S9sJob>           m_jobs;
+        S9sMap<S9sString, S9sServer>  m_servers;
+        int                           m_eventsSince;
+        time_t                        m_lastCreated;
+
+        S9sString                     m_path;
+        FILE                         *m_appendStream;
+        S9sVector<time_t>             m_times;
+        S9sVector<off_t>              m_offsets;
+        /** Where the JSON string of the checkpoint is in the file. */
+        S9sVector<off_t>              m_positions;
+        mutable S9sString             m_errorString;
+};
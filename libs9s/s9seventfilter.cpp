@@ -0,0 +1,513 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9seventfilter.h"
+
+#include "s9sevent.h"
+#include "s9scluster.h"
+#include "s9svariantlist.h"
+
+#include <cstring>
+#include <fnmatch.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/**
+ * The depth of the JSon nesting up to which the keys are tracked by
+ * acceptsRaw(), the hostname is in event_specifics/host, on the third level.
+ */
+#define MAX_TRACKED_DEPTH 4
+
+static bool
+keyIs(
+        const char   *key,
+        size_t        keyLength,
+        const char   *name)
+{
+    size_t nameLength = strlen(name);
+
+    return key != NULL && keyLength == nameLength &&
+        memcmp(key, name, nameLength) == 0;
+}
+
+S9sEventFilter::S9sEventFilter() :
+    m_clusterId(S9S_INVALID_CLUSTER_ID)
+{
+}
+
+S9sEventFilter::~S9sEventFilter()
+{
+}
+
+/**
+ * Removes all the conditions, the filter will accept every event.
+ */
+void
+S9sEventFilter::clear()
+{
+    m_classes.clear();
+    m_names.clear();
+    m_disabledNames.clear();
+    m_clusterId = S9S_INVALID_CLUSTER_ID;
+    m_hostPattern.clear();
+}
+
+/**
+ * \returns True if the filter has no conditions and so accepts every event.
+ */
+bool
+S9sEventFilter::empty() const
+{
+    return m_classes.empty() && m_names.empty() && m_disabledNames.empty() &&
+        m_clusterId <= S9S_INVALID_CLUSTER_ID && m_hostPattern.empty();
+}
+
+/**
+ * \param className The event class (e.g. "EventJob") to accept.
+ *
+ * If no classes are enabled the events of all classes are accepted.
+ */
+void
+S9sEventFilter::enableClass(
+        const S9sString &className)
+{
+    if (!m_classes.contains(className))
+        m_classes << className;
+}
+
+/**
+ * \param eventName The event name (subclass, e.g. "Created") to accept.
+ *
+ * If no names are enabled the events of all names are accepted.
+ */
+void
+S9sEventFilter::enableName(
+        const S9sString &eventName)
+{
+    if (!m_names.contains(eventName))
+        m_names << eventName;
+}
+
+/**
+ * \param eventName The event name (subclass) that is never accepted.
+ */
+void
+S9sEventFilter::disableName(
+        const S9sString &eventName)
+{
+    if (!m_disabledNames.contains(eventName))
+        m_disabledNames << eventName;
+}
+
+/**
+ * \param clusterId The ID of the cluster the events should be about or
+ *   S9S_INVALID_CLUSTER_ID to accept the events of all the clusters.
+ */
+void
+S9sEventFilter::setClusterId(
+        const int clusterId)
+{
+    m_clusterId = clusterId;
+}
+
+int
+S9sEventFilter::clusterId() const
+{
+    return m_clusterId;
+}
+
+/**
+ * \param pattern A shell wildcard pattern the name of the host the events are
+ *   about should match, the empty string to accept events about any host or
+ *   no host at all.
+ */
+void
+S9sEventFilter::setHostPattern(
+        const S9sString &pattern)
+{
+    m_hostPattern = pattern;
+}
+
+S9sString
+S9sEventFilter::hostPattern() const
+{
+    return m_hostPattern;
+}
+
+/**
+ * \param record The JSon text of one record from the event stream, not
+ *   necessarily terminated by a null character.
+ * \param length The length of the record in bytes.
+ * \returns False if the record is an event that is surely rejected by the
+ *   filter.
+ *
+ * This method checks the event without parsing it: it walks the text once,
+ * keeps track of the keys on the first few levels and compares the values of
+ * the event_class, event_name, event_specifics/cluster_id and
+ * event_specifics/host/hostname fields with the filter as soon as they are
+ * found. No memory is allocated for the values that are checked (only a host
+ * name longer than any valid DNS name would be copied to the heap).
+ *
+ * The method only rejects the record if it is sure, for anything it can not
+ * decide (e.g. a field is missing, the value has escape sequences or the
+ * record is not an event at all) true is returned, so the records that pass
+ * should be checked again with accepts() after they are parsed.
+ */
+bool
+S9sEventFilter::acceptsRaw(
+        const char *record,
+        size_t      length) const
+{
+    const char *p   = record;
+    const char *end = record + length;
+    const char *keys[MAX_TRACKED_DEPTH];
+    size_t      keyLengths[MAX_TRACKED_DEPTH];
+    bool        isObject[MAX_TRACKED_DEPTH];
+    int         depth     = 0;
+    bool        expectKey = false;
+    int         nNeeded   = 0;
+    int         nPassed   = 0;
+
+    if (empty() || record == NULL)
+        return true;
+
+    for (int idx = 0; idx < MAX_TRACKED_DEPTH; ++idx)
+    {
+        keys[idx]       = NULL;
+        keyLengths[idx] = 0;
+        isObject[idx]   = false;
+    }
+
+    if (!m_classes.empty())
+        ++nNeeded;
+
+    if (!m_names.empty() || !m_disabledNames.empty())
+        ++nNeeded;
+
+    if (m_clusterId > S9S_INVALID_CLUSTER_ID)
+        ++nNeeded;
+
+    if (!m_hostPattern.empty())
+        ++nNeeded;
+
+    while (p < end)
+    {
+        char c = *p;
+
+        if (c == '{' || c == '[')
+        {
+            ++depth;
+            if (depth < MAX_TRACKED_DEPTH)
+            {
+                keys[depth]       = NULL;
+                keyLengths[depth] = 0;
+                isObject[depth]   = c == '{';
+            }
+
+            expectKey = c == '{';
+            ++p;
+        } else if (c == '}' || c == ']')
+        {
+            --depth;
+            expectKey = false;
+            ++p;
+        } else if (c == ',')
+        {
+            expectKey = depth < MAX_TRACKED_DEPTH && isObject[depth];
+            ++p;
+        } else if (c == ':')
+        {
+            expectKey = false;
+            ++p;
+        } else if (c == '"')
+        {
+            const char *start   = ++p;
+            bool        escaped = false;
+            size_t      valueLength;
+
+            while (p < end && *p != '"')
+            {
+                if (*p == '\\')
+                {
+                    escaped = true;
+                    ++p;
+                }
+
+                ++p;
+            }
+
+            // A truncated record, we can not decide.
+            if (p >= end)
+                return true;
+
+            valueLength = p - start;
+            ++p;
+
+            if (depth <= 0 || depth >= MAX_TRACKED_DEPTH)
+                continue;
+
+            if (expectKey)
+            {
+                keys[depth]       = escaped ? NULL : start;
+                keyLengths[depth] = valueLength;
+                continue;
+            }
+
+            if (escaped)
+                continue;
+
+            if (depth == 1 && keyIs(keys[1], keyLengths[1], "event_class") &&
+                    !m_classes.empty())
+            {
+                if (!classAccepted(start, valueLength))
+                    return false;
+
+                ++nPassed;
+            } else if (depth == 1 && 
+                    keyIs(keys[1], keyLengths[1], "event_name") &&
+                    (!m_names.empty() || !m_disabledNames.empty()))
+            {
+                if (!nameAccepted(start, valueLength))
+                    return false;
+
+                ++nPassed;
+            } else if (depth == 3 && 
+                    keyIs(keys[1], keyLengths[1], "event_specifics") &&
+                    keyIs(keys[2], keyLengths[2], "host") &&
+                    keyIs(keys[3], keyLengths[3], "hostname") &&
+                    !m_hostPattern.empty())
+            {
+                if (!hostAccepted(start, valueLength))
+                    return false;
+
+                ++nPassed;
+            }
+        } else if (c == '-' || (c >= '0' && c <= '9'))
+        {
+            bool negative = c == '-';
+            int  value    = 0;
+
+            if (negative)
+                ++p;
+
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                value = value * 10 + (*p - '0');
+                ++p;
+            }
+
+            if (negative)
+                value = -value;
+
+            // Fractions and exponents are skipped as other characters.
+            if (depth == 2 && !expectKey &&
+                    keyIs(keys[1], keyLengths[1], "event_specifics") &&
+                    keyIs(keys[2], keyLengths[2], "cluster_id") &&
+                    m_clusterId > S9S_INVALID_CLUSTER_ID)
+            {
+                if (value != m_clusterId)
+                    return false;
+
+                ++nPassed;
+            }
+        } else {
+            // White space, true, false, null.
+            ++p;
+        }
+
+        if (nPassed >= nNeeded)
+            return true;
+    }
+
+    return true;
+}
+
+bool
+S9sEventFilter::acceptsRaw(
+        const S9sString &record) const
+{
+    return acceptsRaw(record.c_str(), record.length());
+}
+
+/**
+ * \param event The parsed event to check.
+ * \returns True if the event is accepted by the filter.
+ */
+bool
+S9sEventFilter::accepts(
+        const S9sEvent &event) const
+{
+    if (!m_classes.empty())
+    {
+        S9sString className = event.eventTypeString();
+
+        if (!classAccepted(className.c_str(), className.length()))
+            return false;
+    }
+
+    if (!m_names.empty() || !m_disabledNames.empty())
+    {
+        S9sString eventName = event.eventName();
+
+        if (!nameAccepted(eventName.c_str(), eventName.length()))
+            return false;
+    }
+
+    if (m_clusterId > S9S_INVALID_CLUSTER_ID && 
+            m_clusterId != event.clusterId())
+    {
+        return false;
+    }
+
+    if (!m_hostPattern.empty())
+    {
+        S9sString hostName = event.hostName();
+
+        if (!hostAccepted(hostName.c_str(), hostName.length()))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * \returns The filter in the form it is sent to the controller in the
+ *   subscribe request.
+ *
+ * Controllers that do not support filtering the event stream ignore this, so
+ * the events received are always checked on the client side too.
+ */
+S9sVariantMap
+S9sEventFilter::toVariantMap() const
+{
+    S9sVariantMap retval;
+
+    if (!m_classes.empty())
+    {
+        S9sVariantList list;
+
+        for (uint idx = 0u; idx < m_classes.size(); ++idx)
+            list << m_classes[idx];
+
+        retval["event_classes"] = list;
+    }
+
+    if (!m_names.empty())
+    {
+        S9sVariantList list;
+
+        for (uint idx = 0u; idx < m_names.size(); ++idx)
+            list << m_names[idx];
+
+        retval["event_names"] = list;
+    }
+    
+    if (!m_disabledNames.empty())
+    {
+        S9sVariantList list;
+
+        for (uint idx = 0u; idx < m_disabledNames.size(); ++idx)
+            list << m_disabledNames[idx];
+
+        retval["disabled_event_names"] = list;
+    }
+
+    if (m_clusterId > S9S_INVALID_CLUSTER_ID)
+        retval["cluster_id"] = m_clusterId;
+
+    if (!m_hostPattern.empty())
+        retval["host_pattern"] = m_hostPattern;
+
+    return retval;
+}
+
+bool
+S9sEventFilter::classAccepted(
+        const char *value, 
+        size_t      length) const
+{
+    if (m_classes.empty())
+        return true;
+
+    return contains(m_classes, value, length);
+}
+
+bool
+S9sEventFilter::nameAccepted(
+        const char *value, 
+        size_t      length) const
+{
+    if (!m_names.empty() && !contains(m_names, value, length))
+        return false;
+
+    if (contains(m_disabledNames, value, length))
+        return false;
+
+    return true;
+}
+
+/**
+ * The fnmatch() needs a terminated string, the host names fit into a buffer
+ * on the stack (a DNS name is at most 253 characters), so the raw check does
+ * not allocate for them either.
+ */
+bool
+S9sEventFilter::hostAccepted(
+        const char *value, 
+        size_t      length) const
+{
+    char      buffer[256];
+    S9sString hostName;
+
+    if (m_hostPattern.empty())
+        return true;
+
+    if (length < sizeof(buffer))
+    {
+        memcpy(buffer, value, length);
+        buffer[length] = '\0';
+
+        return fnmatch(STR(m_hostPattern), buffer, FNM_EXTMATCH) == 0;
+    }
+
+    hostName.assign(value, length);
+    return fnmatch(STR(m_hostPattern), STR(hostName), FNM_EXTMATCH) == 0;
+}
+
+bool
+S9sEventFilter::contains(
+        const S9sVector<S9sString> &list, 
+        const char                 *value, 
+        size_t                      length)
+{
+    for (uint idx = 0u; idx < list.size(); ++idx)
+    {
+        const S9sString &item = list[idx];
+
+        if (item.length() == length && 
+                memcmp(item.c_str(), value, length) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,79 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9svariantmap.h"
+#include "s9sglobal.h"
+
+class S9sEvent;
+
+/**
+ * A filter for the events the controller sends (event class, event name,
+ * cluster ID and host name pattern). The filter can be checked on the event
+ * record as it arrives from the network, before it is parsed, so the events
+ * that are not needed cost only one pass over the text. The same filter can be
+ * sent to the controller in the subscribe request as a hint.
+ */
+class S9sEventFilter
+{
+    public:
+        S9sEventFilter();
+        virtual ~S9sEventFilter();
+
+        void clear();
+        bool empty() const;
+
+        void enableClass(const S9sString &className);
+        void enableName(const S9sString &eventName);
+        void disableName(const S9sString &eventName);
+
+        void setClusterId(const int clusterId);
+        int clusterId() const;
+
+        void setHostPattern(const S9sString &pattern);
+        S9sString hostPattern() const;
+
+        bool acceptsRaw(const char *record, size_t length) const;
+        bool acceptsRaw(const S9sString &record) const;
+        bool accepts(const S9sEvent &event) const;
+
+        S9sVariantMap toVariantMap() const;
+
+    private:
+        bool classAccepted(const char *value, size_t length) const;
+        bool nameAccepted(const char *value, size_t length) const;
+        bool hostAccepted(const char *value, size_t length) const;
+
+        static bool contains(
+                const S9sVector<S9sString> &list, 
+                const char                 *value, 
+                size_t                      length);
+
+    private:
+        /** The event classes to accept, empty to accept all. */
+        S9sVector<S9sString>  m_classes;
+        /** The event names to accept, empty to accept all. */
+        S9sVector<S9sString>  m_names;
+        S9sVector<S9sString>  m_disabledNames;
+        int                   m_clusterId;
+        S9sString             m_hostPattern;
+};
@@ -0,0 +1,500 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9seventindex.h"
+
+#include "s9sfile.h"
+#include "s9sevent.h"
+#include "s9sdatetime.h"
+#include "s9svariantlist.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+#define INDEX_HEADER "# s9s event index 1"
+
+/**
+ * \param interval The minimum time between two indexed events in seconds.
+ */
+S9sEventIndex::S9sEventIndex(
+        const int interval) :
+    m_interval(interval > 0 ? interval : 1),
+    m_appendStream(NULL)
+{
+}
+
+S9sEventIndex::~S9sEventIndex()
+{
+    close();
+}
+
+/**
+ * \returns The name of the index file that belongs to the given recording.
+ */
+S9sString
+S9sEventIndex::indexFileName(
+        const S9sString &recordingPath)
+{
+    return recordingPath + ".idx";
+}
+
+/**
+ * \param value The value of the --seek command line option.
+ * \param relative Set to true if the value is relative to the start of the
+ *   recording ("+90", "+12:30" or "+1:12:30").
+ * \param seconds The number of seconds from the start of the recording or the
+ *   absolute time if the value is a date and time.
+ * \returns True if the value could be parsed.
+ */
+bool
+S9sEventIndex::parseSeek(
+        const S9sString &value,
+        bool            &relative,
+        time_t          &seconds)
+{
+    relative = value.startsWith("+");
+    seconds  = 0;
+
+    if (relative)
+    {
+        S9sVariantList parts = S9sString(value.substr(1)).split(":");
+
+        if (parts.empty() || parts.size() > 3u)
+            return false;
+
+        for (uint idx = 0u; idx < parts.size(); ++idx)
+        {
+            S9sString part = parts[idx].toString();
+
+            if (!part.looksInteger() || part.toInt() < 0)
+                return false;
+
+            if (idx > 0u && part.toInt() > 59)
+                return false;
+
+            seconds = seconds * 60 + part.toInt();
+        }
+    } else {
+        S9sDateTime dateTime;
+
+        if (!dateTime.parse(value))
+            return false;
+
+        seconds = dateTime.toTimeT();
+    }
+
+    return true;
+}
+
+/**
+ * Loads the index from the given file, the entries already in the index are
+ * dropped.
+ */
+bool
+S9sEventIndex::load(
+        const S9sString &indexPath)
+{
+    FILE      *stream;
+    char       line[128];
+    long long  created;
+    long long  offset;
+
+    m_times.clear();
+    m_offsets.clear();
+
+    stream = fopen(STR(indexPath), "r");
+    if (stream == NULL)
+    {
+        m_errorString.sprintf(
+                "Unable to open '%s' for reading: %s", 
+                STR(indexPath), strerror(errno));
+
+        return false;
+    }
+
+    if (fgets(line, sizeof(line), stream) == NULL || 
+            strncmp(line, INDEX_HEADER, strlen(INDEX_HEADER)) != 0)
+    {
+        m_errorString.sprintf("The '%s' is not an index file.", STR(indexPath));
+        fclose(stream);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), stream) != NULL)
+    {
+        if (sscanf(line, "%lld %lld", &created, &offset) != 2)
+            continue;
+
+        m_times   << (time_t) created;
+        m_offsets << (off_t) offset;
+    }
+
+    fclose(stream);
+    return true;
+}
+
+/**
+ * Saves the whole index into the given file.
+ */
+bool
+S9sEventIndex::save(
+        const S9sString &indexPath)
+{
+    FILE *stream;
+    bool  success = true;
+
+    stream = fopen(STR(indexPath), "w");
+    if (stream == NULL)
+    {
+        m_errorString.sprintf(
+                "Unable to open '%s' for writing: %s", 
+                STR(indexPath), strerror(errno));
+
+        return false;
+    }
+
+    fprintf(stream, "%s interval=%d\n", INDEX_HEADER, m_interval);
+    for (uint idx = 0u; success && idx < m_times.size(); ++idx)
+        success = writeEntry(stream, idx);
+
+    if (fclose(stream) != 0 || !success)
+    {
+        m_errorString.sprintf(
+                "Error writing '%s': %s", STR(indexPath), strerror(errno));
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \param eventString The event as it is in the recording.
+ * \param created The creation time of the event.
+ * \returns True if the creation time was found.
+ *
+ * Finds the creation time of the event without parsing the whole JSON string,
+ * the "tv_sec" in the "event_origins" is enough for the index.
+ */
+static bool
+createdFromString(
+        const S9sString &eventString,
+        time_t          &created)
+{
+    size_t      index = eventString.find("\"event_origins\"");
+    const char *value;
+
+    if (index == std::string::npos)
+        return false;
+
+    index = eventString.find("\"tv_sec\"", index);
+    if (index == std::string::npos)
+        return false;
+
+    value = eventString.c_str() + index + strlen("\"tv_sec\"");
+    while (*value == ' ' || *value == ':')
+        ++value;
+
+    if (*value < '0' || *value > '9')
+        return false;
+
+    created = (time_t) strtoll(value, NULL, 10);
+    return true;
+}
+
+/**
+ * Builds the index by reading the whole recording, this is how the index can
+ * be created for the recordings made without one. The events are not parsed
+ * unless the creation time can not be found in them otherwise.
+ */
+bool
+S9sEventIndex::build(
+        const S9sString &recordingPath)
+{
+    S9sFile   file(recordingPath);
+    S9sString line;
+    S9sString eventString;
+    off_t     offset = 0;
+    off_t     lineOffset;
+    time_t    created;
+
+    m_times.clear();
+    m_offsets.clear();
+
+    if (!file.openForRead())
+    {
+        m_errorString = file.errorString();
+        return false;
+    }
+
+    for (;;)
+    {
+        bool eof;
+
+        lineOffset = file.tell();
+        eof        = !file.readLine(line);
+
+        if (!eof && !line.trim(" \n\r").empty())
+        {
+            if (eventString.empty())
+                offset = lineOffset;
+
+            eventString += line;
+            continue;
+        }
+
+        // An empty line closes the event.
+        if (!eventString.empty())
+        {
+            if (!createdFromString(eventString, created))
+            {
+                S9sVariantMap theMap;
+
+                if (!theMap.parse(STR(eventString)))
+                    break;
+
+                created = S9sEvent(theMap).created().toTimeT();
+            }
+
+            add(created, offset);
+            eventString.clear();
+        }
+
+        if (eof)
+            break;
+    }
+
+    S9S_DEBUG("Indexed '%s' with %u entries.", STR(recordingPath), size());
+    return true;
+}
+
+/**
+ * Loads the index of the recording or builds it if the recording has no
+ * index yet (or the index does not match the recording). The built index is
+ * saved so that the next replay can use it.
+ */
+bool
+S9sEventIndex::loadOrBuild(
+        const S9sString &recordingPath)
+{
+    S9sString   indexPath = indexFileName(recordingPath);
+    struct stat buffer;
+
+    if (stat(STR(recordingPath), &buffer) != 0)
+    {
+        m_errorString.sprintf(
+                "Unable to stat '%s': %s", 
+                STR(recordingPath), strerror(errno));
+
+        return false;
+    }
+
+    /*
+     * The offsets of the compressed recordings are uncompressed offsets, we
+     * can not compare them to the size of the file.
+     */
+    if (load(indexPath) && 
+            (S9sFile::isCompressed(recordingPath) ||
+             lastOffset() < buffer.st_size))
+    {
+        return true;
+    }
+
+    if (!build(recordingPath))
+        return false;
+
+    if (!save(indexPath))
+        S9S_WARNING("%s", STR(m_errorString));
+
+    return true;
+}
+
+/**
+ * Drops all the entries of the index.
+ */
+void
+S9sEventIndex::clear()
+{
+    m_times.clear();
+    m_offsets.clear();
+}
+
+/**
+ * Opens the index file for append, the entries added later are written into
+ * the file immediately. The file is rewritten with the entries the index
+ * already has, so when an existing recording is appended the index of it
+ * should be loaded first.
+ */
+bool
+S9sEventIndex::openForAppend(
+        const S9sString &indexPath)
+{
+    close();
+
+    m_appendStream = fopen(STR(indexPath), "w");
+    if (m_appendStream == NULL)
+    {
+        m_errorString.sprintf(
+                "Unable to open '%s' for writing: %s", 
+                STR(indexPath), strerror(errno));
+
+        return false;
+    }
+
+    fprintf(m_appendStream, "%s interval=%d\n", INDEX_HEADER, m_interval);
+    for (uint idx = 0u; idx < m_times.size(); ++idx)
+        writeEntry(m_appendStream, idx);
+
+    fflush(m_appendStream);
+    return true;
+}
+
+bool
+S9sEventIndex::isOpen() const
+{
+    return m_appendStream != NULL;
+}
+
+void
+S9sEventIndex::close()
+{
+    if (m_appendStream != NULL)
+    {
+        fclose(m_appendStream);
+        m_appendStream = NULL;
+    }
+}
+
+/**
+ * \param created The creation time of the event.
+ * \param offset The offset of the event in the recording.
+ * \returns True if the event was added to the index, false if it was too
+ *   close to the previously indexed event.
+ */
+bool
+S9sEventIndex::add(
+        const time_t created,
+        const off_t  offset)
+{
+    if (!m_times.empty() && created < m_times.back() + m_interval)
+        return false;
+
+    m_times   << created;
+    m_offsets << offset;
+
+    if (m_appendStream != NULL)
+    {
+        writeEntry(m_appendStream, m_times.size() - 1);
+        fflush(m_appendStream);
+    }
+
+    return true;
+}
+
+/**
+ * \param target The time we want to start at.
+ * \returns The offset of the last indexed event created at or before the
+ *   target time, 0 if the target time is before the first indexed event.
+ *
+ * The events between the returned offset and the target time are at most a
+ * few seconds worth of the recording, the caller has to skip them.
+ */
+off_t
+S9sEventIndex::find(
+        const time_t target) const
+{
+    uint first = 0u;
+    uint last  = m_times.size();
+
+    // Finding the first entry that is after the target.
+    while (first < last)
+    {
+        uint middle = first + (last - first) / 2;
+
+        if (m_times[middle] <= target)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    if (first == 0u)
+        return 0;
+
+    return m_offsets[first - 1];
+}
+
+int
+S9sEventIndex::interval() const
+{
+    return m_interval;
+}
+
+uint
+S9sEventIndex::size() const
+{
+    return m_times.size();
+}
+
+bool
+S9sEventIndex::empty() const
+{
+    return m_times.empty();
+}
+
+/**
+ * \returns The creation time of the first event in the recording.
+ */
+time_t
+S9sEventIndex::firstTime() const
+{
+    return m_times.empty() ? 0 : m_times.front();
+}
+
+time_t
+S9sEventIndex::lastTime() const
+{
+    return m_times.empty() ? 0 : m_times.back();
+}
+
+off_t
+S9sEventIndex::lastOffset() const
+{
+    return m_offsets.empty() ? 0 : m_offsets.back();
+}
+
+S9sString
+S9sEventIndex::errorString() const
+{
+    return m_errorString;
+}
+
+bool
+S9sEventIndex::writeEntry(
+        FILE       *stream,
+        const uint  index)
+{
+    return fprintf(stream, "%lld %lld\n", 
+            (long long) m_times[index], (long long) m_offsets[index]) > 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9sglobal.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <time.h>
+
+/**
+ * A sparse time index for the event recordings ("s9s event --output-file").
+ * The recording itself is the usual text file with one JSON string for every
+ * event, the index is stored next to it (with the ".idx" extension added to
+ * the name) and holds the creation time and the file offset of one event
+ * every few seconds. With the index the replay can jump to any point in the
+ * recording with a binary search instead of parsing all the events before
+ * it.
+ *
+ * The index file is a text file, one "TIME OFFSET" line for every indexed
+ * event after a header line, so it can be appended while recording.
+ */
+class S9sEventIndex
+{
+    public:
+        S9sEventIndex(const int interval = 10);
+        virtual ~S9sEventIndex();
+
+        static S9sString indexFileName(const S9sString &recordingPath);
+        static bool parseSeek(
+                const S9sString &value,
+                bool            &relative,
+                time_t          &seconds);
+
+        bool load(const S9sString &indexPath);
+        bool save(const S9sString &indexPath);
+        bool build(const S9sString &recordingPath);
+        bool loadOrBuild(const S9sString &recordingPath);
+        void clear();
+
+        bool openForAppend(const S9sString &indexPath);
+        bool isOpen() const;
+        void close();
+
+        bool add(const time_t created, const off_t offset);
+        off_t find(const time_t target) const;
+
+        int interval() const;
+        uint size() const;
+        bool empty() const;
+        time_t firstTime() const;
+        time_t lastTime() const;
+        off_t lastOffset() const;
+
+        S9sString errorString() const;
+
+    private:
+        bool writeEntry(FILE *stream, const uint index);
+
+    private:
+        int                  m_interval;
+        S9sVector<time_t>    m_times;
+        S9sVector<off_t>     m_offsets;
+        FILE                *m_appendStream;
+        S9sString            m_errorString;
+};
@@ -0,0 +1,679 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9seventrecorder.h"
+#include "config.h"
+
+#include "s9sdatetime.h"
+#include "s9sfile.h"
+#include "s9soptions.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/*
+ * The recorders that are open, closed by an exit handler so that the events
+ * still in the queue are saved when the program exits with exit().
+ */
+static pthread_mutex_t                 sm_activeMutex = 
+    PTHREAD_MUTEX_INITIALIZER;
+static S9sVector<S9sEventRecorder *>   sm_activeRecorders;
+static bool                            sm_exitHandlerRegistered = false;
+
+S9sEventRecorder::S9sEventRecorder(
+        const uint capacity) :
+    m_capacity(capacity > 0u ? capacity : 1u),
+    m_syncPolicy(SyncNever),
+    m_fd(-1),
+    m_gzStream(NULL),
+    m_offset(0),
+    m_lastSync(0),
+    m_unsynced(0),
+    m_running(false),
+    m_stopping(false),
+    m_failed(false),
+    m_nRecorded(0ull),
+    m_nDropped(0ull),
+    m_nBatches(0ull)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_condition, NULL);
+}
+
+S9sEventRecorder::~S9sEventRecorder()
+{
+    close();
+
+    pthread_cond_destroy(&m_condition);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * \param value The value of the --output-fsync option, "never", "batch" or
+ *   the number of seconds between two fsync() calls.
+ * \param seconds The policy as it is used by setSyncPolicy().
+ * \returns True if the value was understood.
+ */
+bool
+S9sEventRecorder::parseSyncPolicy(
+        const S9sString &value,
+        int             &seconds)
+{
+    S9sString trimmed = value.trim();
+
+    if (trimmed == "never")
+    {
+        seconds = SyncNever;
+        return true;
+    } else if (trimmed == "batch")
+    {
+        seconds = SyncBatch;
+        return true;
+    } else if (trimmed.looksInteger() && trimmed.toInt() > 0)
+    {
+        seconds = trimmed.toInt();
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * \param seconds SyncNever, SyncBatch or the number of seconds between two
+ *   fsync() calls.
+ */
+void
+S9sEventRecorder::setSyncPolicy(
+        const int seconds)
+{
+    m_syncPolicy = seconds;
+}
+
+/**
+ * \param path The path of the recording, it is created if it does not exist
+ *   and appended if it does.
+ * \returns True if the recording and its time index are open and the writer
+ *   thread is started.
+ */
+bool
+S9sEventRecorder::open(
+        const S9sString &path)
+{
+    bool compressed = S9sFile::isCompressed(path);
+
+    close();
+
+    m_path     = path;
+    m_failed   = false;
+    m_stopping = false;
+    m_errorString.clear();
+
+    if (compressed && !S9sFile::compressionSupported())
+    {
+        m_errorString.sprintf(
+                "Unable to open '%s': compressed files are not supported "
+                "in this build.", STR(path));
+
+        return false;
+    }
+
+    m_fd = ::open(STR(path), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (m_fd < 0)
+    {
+        m_errorString.sprintf(
+                "Unable to open '%s' for writing: %s", 
+                STR(path), strerror(errno));
+
+        return false;
+    }
+
+    m_offset = compressed ? uncompressedSize() : lseek(m_fd, 0, SEEK_END);
+
+#ifdef HAVE_LIBZ
+    if (compressed)
+    {
+        // The gzFile owns the file descriptor from now on.
+        m_gzStream = gzdopen(m_fd, "ab");
+        if (m_gzStream == NULL)
+        {
+            m_errorString.sprintf(
+                    "Unable to open '%s' for compression.", STR(path));
+
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+    }
+#endif
+
+    /*
+     * When an existing recording is appended we need the index of it, the
+     * index file is rewritten when it is opened.
+     */
+    if (m_offset > 0)
+    {
+        if (!m_index.loadOrBuild(path))
+        {
+            m_errorString = m_index.errorString();
+            close();
+            return false;
+        }
+    } else {
+        m_index.clear();
+        unlink(STR(S9sEventCheckpoints::checkpointFileName(path)));
+    }
+
+    if (!m_index.openForAppend(S9sEventIndex::indexFileName(path)))
+    {
+        m_errorString = m_index.errorString();
+        close();
+        return false;
+    }
+
+    if (!m_checkpoints.openForAppend(
+                S9sEventCheckpoints::checkpointFileName(path), path))
+    {
+        m_errorString = m_checkpoints.errorString();
+        close();
+        return false;
+    }
+
+    bool started;
+
+    m_lastSync = time(NULL);
+    m_unsynced = 0;
+    started    = pthread_create(
+            &m_thread, NULL, S9sEventRecorder::writerEntryPoint, this) == 0;
+
+    pthread_mutex_lock(&m_mutex);
+    m_running = started;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!started)
+    {
+        m_errorString.sprintf(
+                "Unable to start the writer thread: %s", strerror(errno));
+
+        close();
+        return false;
+    }
+
+    pthread_mutex_lock(&sm_activeMutex);
+    sm_activeRecorders << this;
+    if (!sm_exitHandlerRegistered)
+    {
+        atexit(S9sEventRecorder::closeAll);
+        sm_exitHandlerRegistered = true;
+    }
+    pthread_mutex_unlock(&sm_activeMutex);
+
+    S9S_DEBUG("Recording into '%s'.", STR(path));
+    return true;
+}
+
+/**
+ * \returns True if the recording is open and the events are saved.
+ */
+bool
+S9sEventRecorder::isOpen() const
+{
+    bool retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_running;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * Saves the events that are still in the queue, stops the writer thread and
+ * closes the recording. The events dropped are reported here, the recording
+ * is incomplete when they happened.
+ */
+void
+S9sEventRecorder::close()
+{
+    if (isOpen())
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_stopping = true;
+        pthread_cond_signal(&m_condition);
+        pthread_mutex_unlock(&m_mutex);
+
+        pthread_join(m_thread, NULL);
+
+        pthread_mutex_lock(&m_mutex);
+        m_running = false;
+        pthread_mutex_unlock(&m_mutex);
+
+        sync(true);
+
+        if (m_nDropped > 0ull)
+        {
+            PRINT_ERROR(
+                    "%llu event(s) were not saved into '%s', the disk was "
+                    "too slow.", m_nDropped, STR(m_path));
+        }
+    }
+
+#ifdef HAVE_LIBZ
+    if (m_gzStream != NULL)
+    {
+        gzclose((gzFile) m_gzStream);
+        m_gzStream = NULL;
+        m_fd       = -1;
+    }
+#endif
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    m_index.close();
+    m_checkpoints.close();
+
+    pthread_mutex_lock(&sm_activeMutex);
+    for (uint idx = 0u; idx < sm_activeRecorders.size(); ++idx)
+    {
+        if (sm_activeRecorders[idx] == this)
+        {
+            sm_activeRecorders.erase(sm_activeRecorders.begin() + idx);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sm_activeMutex);
+}
+
+/**
+ * \param event The event to save.
+ * \returns True if the event is queued for saving, false if the queue was
+ *   full or the recording is not open.
+ *
+ * This function never waits for the disk, it can be called from the thread
+ * that receives the events.
+ */
+bool
+S9sEventRecorder::record(
+        const S9sEvent &event)
+{
+    bool retval = false;
+
+    pthread_mutex_lock(&m_mutex);
+    if (!m_running || m_failed || m_stopping)
+    {
+        // Not saving anything any more.
+    } else if (m_queue.size() < m_capacity)
+    {
+        m_queue << event;
+        ++m_nRecorded;
+        retval = true;
+        pthread_cond_signal(&m_condition);
+    } else {
+        if (m_nDropped == 0ull)
+        {
+            PRINT_LOG_WARNING(
+                    "The event queue of '%s' is full, dropping events.", 
+                    STR(m_path));
+        }
+
+        ++m_nDropped;
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * \returns True if the writer thread could not write the recording, the
+ *   errorString() tells why.
+ */
+bool
+S9sEventRecorder::failed() const
+{
+    bool retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_failed;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * \returns How many events were accepted for saving.
+ */
+ulonglong
+S9sEventRecorder::nRecorded() const
+{
+    ulonglong retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_nRecorded;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * \returns How many events were dropped because the queue was full.
+ */
+ulonglong
+S9sEventRecorder::nDropped() const
+{
+    ulonglong retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_nDropped;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * \returns How many batches the writer thread wrote.
+ */
+ulonglong
+S9sEventRecorder::nBatches() const
+{
+    ulonglong retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_nBatches;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+S9sString
+S9sEventRecorder::path() const
+{
+    return m_path;
+}
+
+S9sString
+S9sEventRecorder::errorString() const
+{
+    S9sString retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_errorString;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * The main loop of the writer thread: waits for events, takes all of them
+ * from the queue and writes them while the queue is open for new events
+ * again. The loop wakes up every second even when there are no events so
+ * the fsync() is done when the time comes.
+ */
+void
+S9sEventRecorder::writerLoop()
+{
+    S9sVector<S9sEvent> batch;
+    bool                stopping;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&m_mutex);
+        if (m_queue.empty() && !m_stopping)
+        {
+            struct timespec deadline;
+
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += 1;
+
+            pthread_cond_timedwait(&m_condition, &m_mutex, &deadline);
+        }
+
+        batch.swap(m_queue);
+        stopping = m_stopping;
+        pthread_mutex_unlock(&m_mutex);
+
+        if (!batch.empty())
+        {
+            if (!writeBatch(batch))
+                break;
+
+            batch.clear();
+        }
+
+        if (!sync(false) || stopping)
+            break;
+    }
+}
+
+/**
+ * Writes the events into the recording with one write, the time index and
+ * the checkpoints are updated here too.
+ */
+bool
+S9sEventRecorder::writeBatch(
+        const S9sVector<S9sEvent> &batch)
+{
+    S9sString buffer;
+
+    for (uint idx = 0u; idx < batch.size(); ++idx)
+    {
+        const S9sEvent &event = batch[idx];
+
+        m_index.add(event.created().toTimeT(), m_offset + buffer.length());
+
+        buffer += event.toString();
+        buffer += "\n\n";
+
+        m_checkpoints.apply(event, m_offset + buffer.length());
+    }
+
+    if (!writeData(buffer.data(), buffer.length()))
+        return false;
+
+    m_offset += buffer.length();
+
+    pthread_mutex_lock(&m_mutex);
+    ++m_nBatches;
+    pthread_mutex_unlock(&m_mutex);
+
+    return true;
+}
+
+bool
+S9sEventRecorder::writeData(
+        const char *data,
+        size_t      length)
+{
+#ifdef HAVE_LIBZ
+    if (m_gzStream != NULL)
+    {
+        if (gzwrite((gzFile) m_gzStream, data, length) != (int) length)
+        {
+            S9sString errorString;
+
+            errorString.sprintf("Error writing '%s'.", STR(m_path));
+            setError(errorString);
+
+            return false;
+        }
+
+        m_unsynced += length;
+        return true;
+    }
+#endif
+
+    while (length > 0)
+    {
+        ssize_t written = ::write(m_fd, data, length);
+
+        if (written < 0 && errno == EINTR)
+            continue;
+
+        if (written < 0)
+        {
+            S9sString errorString;
+
+            errorString.sprintf(
+                    "Error writing '%s': %s", STR(m_path), strerror(errno));
+
+            setError(errorString);
+
+            return false;
+        }
+
+        data       += written;
+        length     -= written;
+        m_unsynced += written;
+    }
+
+    return true;
+}
+
+/**
+ * \param force Sync now regardless of the policy, used when closing.
+ *
+ * Calls fsync() on the recording when the policy says it is time and
+ * something was written since the last sync. The compressed stream is
+ * flushed first, so that the data is in the file.
+ */
+bool
+S9sEventRecorder::sync(
+        bool force)
+{
+    time_t now = time(NULL);
+
+    if (!force)
+    {
+        if (m_syncPolicy == SyncNever)
+            return true;
+
+        if (m_syncPolicy > 0 && now - m_lastSync < m_syncPolicy)
+            return true;
+
+        if (m_unsynced == 0)
+            return true;
+    }
+
+#ifdef HAVE_LIBZ
+    if (m_gzStream != NULL)
+        gzflush((gzFile) m_gzStream, Z_SYNC_FLUSH);
+#endif
+
+    if (m_syncPolicy != SyncNever && m_fd >= 0 && fsync(m_fd) != 0)
+    {
+        S9sString errorString;
+
+        errorString.sprintf(
+                "Error syncing '%s': %s", STR(m_path), strerror(errno));
+
+        setError(errorString);
+
+        return false;
+    }
+
+    m_lastSync = now;
+    m_unsynced = 0;
+    return true;
+}
+
+/**
+ * \returns The size of the existing compressed recording uncompressed, the
+ *   offset of the first event we are going to add.
+ */
+off_t
+S9sEventRecorder::uncompressedSize() const
+{
+    off_t retval = 0;
+
+#ifdef HAVE_LIBZ
+    gzFile stream = gzopen(STR(m_path), "rb");
+    char   buffer[65536];
+    int    nRead;
+
+    if (stream == NULL)
+        return 0;
+
+    while ((nRead = gzread(stream, buffer, sizeof(buffer))) > 0)
+        retval += nRead;
+
+    gzclose(stream);
+#endif
+
+    return retval;
+}
+
+void
+S9sEventRecorder::setError(
+        const S9sString &errorString)
+{
+    S9S_WARNING("%s", STR(errorString));
+    PRINT_LOG_ERROR("%s", STR(errorString));
+
+    pthread_mutex_lock(&m_mutex);
+    m_errorString = errorString;
+    m_failed      = true;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void *
+S9sEventRecorder::writerEntryPoint(
+        void *pointer)
+{
+    S9sEventRecorder *self = (S9sEventRecorder *) pointer;
+
+    self->writerLoop();
+    return NULL;
+}
+
+/**
+ * The exit handler, the program is usually terminated by calling exit() when
+ * the user presses 'q' and the events in the queue must not be lost then.
+ */
+void
+S9sEventRecorder::closeAll()
+{
+    for (;;)
+    {
+        S9sEventRecorder *recorder = NULL;
+
+        pthread_mutex_lock(&sm_activeMutex);
+        if (!sm_activeRecorders.empty())
+            recorder = sm_activeRecorders.back();
+        pthread_mutex_unlock(&sm_activeMutex);
+
+        if (recorder == NULL)
+            break;
+
+        recorder->close();
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9sevent.h"
+#include "s9seventindex.h"
+#include "s9seventcheckpoints.h"
+#include "s9sglobal.h"
+
+#include <pthread.h>
+#include <sys/types.h>
+#include <time.h>
+
+/**
+ * Saves the events into a recording ("s9s event --output-file") on a
+ * separate writer thread, so a slow disk never blocks the thread that reads
+ * the events from the controller or the thread that draws the screen. The
+ * events are put into a bounded queue, the writer thread takes all the
+ * queued events at once and writes them in one batch together with the time
+ * index and the checkpoints of the recording. If the queue is full the event is dropped and
+ * counted, the caller is never blocked.
+ *
+ * Recordings with the ".gz" extension are compressed (if the program was
+ * built with zlib), the offsets in the time index are then offsets in the
+ * uncompressed stream.
+ */
+class S9sEventRecorder
+{
+    public:
+        enum SyncPolicy
+        {
+            /** Never call fsync(), leave it to the operating system. */
+            SyncNever = -1,
+            /** Call fsync() after every batch written. */
+            SyncBatch = 0,
+        };
+
+        S9sEventRecorder(const uint capacity = 4096);
+        virtual ~S9sEventRecorder();
+
+        static bool parseSyncPolicy(const S9sString &value, int &seconds);
+        void setSyncPolicy(const int seconds);
+
+        bool open(const S9sString &path);
+        bool isOpen() const;
+        void close();
+
+        bool record(const S9sEvent &event);
+        bool failed() const;
+
+        ulonglong nRecorded() const;
+        ulonglong nDropped() const;
+        ulonglong nBatches() const;
+
+        S9sString path() const;
+        S9sString errorString() const;
+
+    private:
+        void writerLoop();
+        bool writeBatch(const S9sVector<S9sEvent> &batch);
+        bool writeData(const char *data, size_t length);
+        bool sync(bool force);
+        off_t uncompressedSize() const;
+        void setError(const S9sString &errorString);
+
+        static void *writerEntryPoint(void *pointer);
+        static void closeAll();
+
+    private:
+        uint                  m_capacity;
+        int                   m_syncPolicy;
+        S9sString             m_path;
+        int                   m_fd;
+        /** The gzFile handle when the recording is compressed. */
+        void                 *m_gzStream;
+        S9sEventIndex         m_index;
+        S9sEventCheckpoints   m_checkpoints;
+        /** The offset of the next event in the (uncompressed) recording. */
+        off_t                 m_offset;
+        time_t                m_lastSync;
+        /** The bytes written since the last fsync(). */
+        size_t                m_unsynced;
+
+        /** Protects the queue, the flags and the counters. */
+        mutable pthread_mutex_t  m_mutex;
+        pthread_cond_t        m_condition;
+        pthread_t             m_thread;
+        bool                  m_running;
+        bool                  m_stopping;
+        bool                  m_failed;
+        S9sVector<S9sEvent>   m_queue;
+        S9sString             m_errorString;
+
+        ulonglong             m_nRecorded;
+        ulonglong             m_nDropped;
+        ulonglong             m_nBatches;
+};
@@ -0,0 +1,223 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9seventresume.h"
+
+#include "s9sevent.h"
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+S9sEventResume::S9sEventResume() :
+    m_seconds(0ull),
+    m_nanoseconds(0ull),
+    m_hasResumePoint(false),
+    m_replaying(false),
+    m_replaySupported(false),
+    m_replayMissed(false),
+    m_nReceived(0ull),
+    m_nDuplicates(0ull),
+    m_nReconnects(0u)
+{
+}
+
+S9sEventResume::~S9sEventResume()
+{
+}
+
+/**
+ * Forgets the resume point, the next subscription starts with the live
+ * events.
+ */
+void
+S9sEventResume::clear()
+{
+    m_seconds         = 0ull;
+    m_nanoseconds     = 0ull;
+    m_hasResumePoint  = false;
+    m_replaying       = false;
+    m_replaySupported = false;
+    m_replayMissed    = false;
+}
+
+/**
+ * \param event The event that just arrived on the event stream.
+ * \returns False if the event was already received before the reconnect and
+ *   so it should be dropped.
+ *
+ * Only the events that arrive right after a reconnect are checked for
+ * duplicates, the live events are always accepted even if they are a bit out
+ * of order.
+ */
+bool
+S9sEventResume::accept(
+        const S9sEvent &event)
+{
+    S9sVariantMap origins = event.property("event_origins").toVariantMap();
+    ulonglong     seconds;
+    ulonglong     nanoseconds;
+
+    seconds     = origins["tv_sec"].toULongLong();
+    nanoseconds = origins["tv_nsec"].toULongLong();
+
+    // Events without the creation time can not be used to resume.
+    if (seconds == 0ull)
+    {
+        ++m_nReceived;
+        return true;
+    }
+
+    if (m_replaying)
+    {
+        if (!isNewer(seconds, nanoseconds))
+        {
+            S9S_DEBUG("Dropping replayed event %llu.%09llu.", 
+                    seconds, nanoseconds);
+
+            m_replaySupported = true;
+            ++m_nDuplicates;
+            return false;
+        }
+
+        m_replayMissed = !m_replaySupported;
+        m_replaying    = false;
+    }
+
+    if (!m_hasResumePoint || isNewer(seconds, nanoseconds))
+    {
+        m_seconds        = seconds;
+        m_nanoseconds    = nanoseconds;
+        m_hasResumePoint = true;
+    }
+
+    ++m_nReceived;
+    return true;
+}
+
+/**
+ * Should be called before subscribing again after the event stream ended. The
+ * new connection might go to a controller that behaves differently, so what
+ * we learned about the replay is forgotten.
+ */
+void
+S9sEventResume::reconnect()
+{
+    ++m_nReconnects;
+    m_replaying       = m_hasResumePoint;
+    m_replaySupported = false;
+    m_replayMissed    = false;
+}
+
+/**
+ * \returns True if at least one event was received, so the subscription can
+ *   be resumed.
+ */
+bool
+S9sEventResume::hasResumePoint() const
+{
+    return m_hasResumePoint;
+}
+
+/**
+ * \returns The creation time of the last event received in the same format
+ *   the events have it (tv_sec and tv_nsec), the empty map if there is no
+ *   resume point.
+ */
+S9sVariantMap
+S9sEventResume::resumePoint() const
+{
+    S9sVariantMap retval;
+
+    if (m_hasResumePoint)
+    {
+        retval["tv_sec"]  = m_seconds;
+        retval["tv_nsec"] = m_nanoseconds;
+    }
+
+    return retval;
+}
+
+/**
+ * \returns True if the controller was seen replaying the events after the
+ *   last reconnect.
+ */
+bool
+S9sEventResume::replaySupported() const
+{
+    return m_replaySupported;
+}
+
+/**
+ * \returns True if a new event arrived after the last reconnect without the
+ *   events we already had, so the events created while we were disconnected
+ *   are lost and the model should be refreshed. Stays true until resynced()
+ *   is called.
+ */
+bool
+S9sEventResume::replayMissed() const
+{
+    return m_replayMissed;
+}
+
+/**
+ * Should be called when the model was refreshed after replayMissed() returned
+ * true.
+ */
+void
+S9sEventResume::resynced()
+{
+    m_replayMissed = false;
+}
+
+/**
+ * \returns How many events were accepted.
+ */
+ulonglong
+S9sEventResume::nReceived() const
+{
+    return m_nReceived;
+}
+
+/**
+ * \returns How many replayed events were dropped because they were received
+ *   before.
+ */
+ulonglong
+S9sEventResume::nDuplicates() const
+{
+    return m_nDuplicates;
+}
+
+uint
+S9sEventResume::nReconnects() const
+{
+    return m_nReconnects;
+}
+
+bool
+S9sEventResume::isNewer(
+        const ulonglong seconds, 
+        const ulonglong nanoseconds) const
+{
+    if (seconds != m_seconds)
+        return seconds > m_seconds;
+
+    return nanoseconds > m_nanoseconds;
+}
@@ -0,0 +1,77 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9svariantmap.h"
+#include "s9sglobal.h"
+
+class S9sEvent;
+
+/**
+ * Keeps track of where the event stream is, so that after the connection to
+ * the controller is lost the subscription can be resumed from the last event
+ * received.
+ *
+ * The resume point is the creation time of the last event. When resuming the
+ * controller is asked to send the events created at or after this time, so
+ * the controllers that can replay the events send the last event we have seen
+ * again. These duplicates are dropped and they also show that the controller
+ * replayed the events, so the events created while we were disconnected are
+ * not lost. If no duplicate arrives the controller did not replay the events
+ * and the model has to be refreshed some other way (see replayMissed()). This
+ * is decided again on every connection.
+ */
+class S9sEventResume
+{
+    public:
+        S9sEventResume();
+        virtual ~S9sEventResume();
+
+        void clear();
+
+        bool accept(const S9sEvent &event);
+        void reconnect();
+
+        bool hasResumePoint() const;
+        S9sVariantMap resumePoint() const;
+        bool replaySupported() const;
+        bool replayMissed() const;
+        void resynced();
+
+        ulonglong nReceived() const;
+        ulonglong nDuplicates() const;
+        uint nReconnects() const;
+
+    private:
+        bool isNewer(const ulonglong seconds, const ulonglong nanoseconds) const;
+
+    private:
+        /** The creation time of the last event received. */
+        ulonglong   m_seconds;
+        ulonglong   m_nanoseconds;
+        bool        m_hasResumePoint;
+        /** True until the first new event after a reconnect. */
+        bool        m_replaying;
+        bool        m_replaySupported;
+        bool        m_replayMissed;
+        ulonglong   m_nReceived;
+        ulonglong   m_nDuplicates;
+        uint        m_nReconnects;
+};
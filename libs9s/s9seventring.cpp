@@ -0,0 +1,175 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9seventring.h"
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+S9sEventRing::S9sEventRing(
+        const uint capacity) :
+    m_capacity(capacity > 0u ? capacity : 1u),
+    m_start(0u),
+    m_nextSequence(0ull)
+{
+}
+
+S9sEventRing::~S9sEventRing()
+{
+}
+
+/**
+ * \param capacity The maximum number of events kept.
+ *
+ * Changes the capacity of the history, the newest events are kept if the
+ * history is longer than the new capacity.
+ */
+void
+S9sEventRing::setCapacity(
+        const uint capacity)
+{
+    S9sVector<S9sEvent> buffer;
+    uint                newCapacity = capacity > 0u ? capacity : 1u;
+    uint                first;
+
+    if (newCapacity == m_capacity)
+        return;
+
+    first = size() > newCapacity ? size() - newCapacity : 0u;
+    for (uint idx = first; idx < size(); ++idx)
+        buffer.push_back(at(idx));
+
+    m_buffer.swap(buffer);
+    m_capacity = newCapacity;
+    m_start    = 0u;
+}
+
+uint
+S9sEventRing::capacity() const
+{
+    return m_capacity;
+}
+
+/**
+ * \returns How many events are in the history.
+ */
+uint
+S9sEventRing::size() const
+{
+    return m_buffer.size();
+}
+
+bool
+S9sEventRing::empty() const
+{
+    return m_buffer.empty();
+}
+
+/**
+ * Removes all the events, the sequence numbers are not reused.
+ */
+void
+S9sEventRing::clear()
+{
+    m_buffer.clear();
+    m_start = 0u;
+}
+
+/**
+ * \param event The event to add as the newest event.
+ * \returns The sequence number of the event.
+ *
+ * The buffer grows until the capacity is reached, then the oldest event is
+ * overwritten.
+ */
+ulonglong
+S9sEventRing::append(
+        const S9sEvent &event)
+{
+    if (m_buffer.size() < m_capacity)
+    {
+        m_buffer.push_back(event);
+    } else {
+        m_buffer[m_start] = event;
+        m_start = (m_start + 1u) % m_capacity;
+    }
+
+    return m_nextSequence++;
+}
+
+/**
+ * \param index The index of the event, 0 is the oldest event in the history.
+ */
+const S9sEvent &
+S9sEventRing::at(
+        const uint index) const
+{
+    return m_buffer[(m_start + index) % m_buffer.size()];
+}
+
+const S9sEvent &
+S9sEventRing::operator[](
+        const uint index) const
+{
+    return at(index);
+}
+
+/**
+ * \returns True if the event with the given sequence number is still in the
+ *   history.
+ */
+bool
+S9sEventRing::contains(
+        const ulonglong sequence) const
+{
+    return sequence >= firstSequence() && sequence < m_nextSequence;
+}
+
+/**
+ * \param sequence The sequence number returned by append().
+ * \returns The event or NULL if it was already overwritten.
+ */
+const S9sEvent *
+S9sEventRing::find(
+        const ulonglong sequence) const
+{
+    if (!contains(sequence))
+        return NULL;
+
+    return &at(sequence - firstSequence());
+}
+
+/**
+ * \returns The sequence number of the oldest event in the history.
+ */
+ulonglong
+S9sEventRing::firstSequence() const
+{
+    return m_nextSequence - m_buffer.size();
+}
+
+/**
+ * \returns The sequence number the next event will get.
+ */
+ulonglong
+S9sEventRing::nextSequence() const
+{
+    return m_nextSequence;
+}
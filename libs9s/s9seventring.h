@@ -0,0 +1,68 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sevent.h"
+#include "s9svector.h"
+#include "s9sglobal.h"
+
+/**
+ * A fixed capacity history of events for the interactive monitor. When the
+ * history is full the new event overwrites the oldest one, so adding an event
+ * costs the same no matter how long the history is and the memory used is
+ * bounded by the capacity.
+ *
+ * Every event gets a sequence number when it is added, the numbers keep
+ * growing when the old events are overwritten. Other data structures can
+ * store these numbers instead of copies of the events and find the event
+ * later if it is still in the history.
+ */
+class S9sEventRing
+{
+    public:
+        S9sEventRing(const uint capacity = 3000u);
+        virtual ~S9sEventRing();
+
+        void setCapacity(const uint capacity);
+        uint capacity() const;
+
+        uint size() const;
+        bool empty() const;
+        void clear();
+
+        ulonglong append(const S9sEvent &event);
+
+        const S9sEvent &at(const uint index) const;
+        const S9sEvent &operator[](const uint index) const;
+
+        bool contains(const ulonglong sequence) const;
+        const S9sEvent *find(const ulonglong sequence) const;
+
+        ulonglong firstSequence() const;
+        ulonglong nextSequence() const;
+
+    private:
+        S9sVector<S9sEvent>  m_buffer;
+        uint                 m_capacity;
+        /** The index of the oldest event in m_buffer. */
+        uint                 m_start;
+        /** The sequence number the next event will get. */
+        ulonglong            m_nextSequence;
+};
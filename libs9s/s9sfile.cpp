@@ -19,6 +19,7 @@
  */
 #include "s9sfile.h"
 #include "s9sfile_p.h"
+#include "config.h"
 
 #include "s9svariantlist.h"
 #include "s9sevent.h"
@@ -33,6 +34,10 @@
 #include <fcntl.h>
 #include <dirent.h>
 
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
 #define READ_BUFFER_SIZE 16384
 #define DIRSEPARATOR '/'
 
@@ -203,7 +208,37 @@ S9sFile::openForRead()
     close();
 
     /*
-     * Opening for append.
+     * The compressed files are read through zlib, the caller sees the
+     * uncompressed content and the uncompressed offsets.
+     */
+    if (isCompressed(m_priv->m_path))
+    {
+#ifdef HAVE_LIBZ
+        m_priv->m_gzInputStream = gzopen(STR(m_priv->m_path), "rb");
+        if (!m_priv->m_gzInputStream)
+        {
+            m_priv->m_errorString.sprintf(
+                    "Unable to open '%s' for reading: %m",
+                    STR(m_priv->m_path));
+
+            S9S_WARNING("%s", STR(m_priv->m_errorString));
+            return false;
+        }
+
+        S9S_DEBUG("Opened '%s' for reading.", STR(m_priv->m_path));
+        return true;
+#else
+        m_priv->m_errorString.sprintf(
+                "Unable to open '%s': compressed files are not supported "
+                "in this build.",
+                STR(m_priv->m_path));
+
+        return false;
+#endif
+    }
+
+    /*
+     * Opening for read.
      */
     m_priv->m_inputStream = fopen(STR(m_priv->m_path), "r");
     if (!m_priv->m_inputStream)
@@ -278,41 +313,187 @@ bool
 S9sFile::readLine(
         S9sString &line)
 {
-    int c;
+    ssize_t nRead;
 
     line.clear();
 
+    if (!isOpenForRead())
+        openForRead();
+
+#ifdef HAVE_LIBZ
+    if (m_priv->m_gzInputStream != NULL)
+        return readGzLine(line);
+#endif
+
+    if (m_priv->m_inputStream == NULL)
+        return false;
+
+    /*
+     * Reading the whole line at once, the buffer is kept between the calls,
+     * reading long files character by character was very slow.
+     */
+    nRead = getline(
+            &m_priv->m_lineBuffer, &m_priv->m_lineBufferSize, 
+            m_priv->m_inputStream);
+
+    if (nRead <= 0)
+        return false;
+
+    line.assign(m_priv->m_lineBuffer, nRead);
+    if (line[nRead - 1] == '\n')
+        ++m_priv->m_lineNumber;
+
+    return true;
+}
+
+/**
+ * \returns The position in the file where the next read will happen or -1
+ *   if the file is not open for reading.
+ */
+off_t
+S9sFile::tell() const
+{
+#ifdef HAVE_LIBZ
+    if (m_priv->m_gzInputStream != NULL)
+        return gztell((gzFile) m_priv->m_gzInputStream);
+#endif
+
     if (m_priv->m_inputStream == NULL)
+        return -1;
+
+    return ftello(m_priv->m_inputStream);
+}
+
+/**
+ * \param offset The position in the file from the start.
+ * \returns True if the position was set.
+ *
+ * Sets the position where the next read will happen, opens the file for read
+ * if it is not open yet. The line number is not known after this.
+ */
+bool
+S9sFile::seek(
+        const off_t offset)
+{
+    if (!isOpenForRead())
         openForRead();
 
+#ifdef HAVE_LIBZ
+    /*
+     * Seeking forward in a compressed file means decompressing everything up
+     * to the offset, it is still better than parsing the events.
+     */
+    if (m_priv->m_gzInputStream != NULL)
+    {
+        if (gzseek((gzFile) m_priv->m_gzInputStream, offset, SEEK_SET) < 0)
+        {
+            m_priv->m_errorString.sprintf(
+                    "Unable to seek in '%s'.", STR(m_priv->m_path));
+
+            return false;
+        }
+
+        m_priv->m_lineNumber = 0ull;
+        return true;
+    }
+#endif
+
     if (m_priv->m_inputStream == NULL)
         return false;
 
-    for (;;)
+    if (fseeko(m_priv->m_inputStream, offset, SEEK_SET) != 0)
     {
-        c = fgetc(m_priv->m_inputStream);
+        m_priv->m_errorString.sprintf(
+                "Unable to seek in '%s': %m", STR(m_priv->m_path));
 
-        S9S_DEBUG("%c/%3d ", c, c);
-        //::printf("%c/%3d\r\n", c, c);
-        //fflush(stdout);
+        return false;
+    }
 
-        switch (c)
-        {
-            case EOF:
-                return !line.empty();
+    m_priv->m_lineNumber = 0ull;
+    return true;
+}
 
-            case '\n':
-                ++m_priv->m_lineNumber;
-                line += c;
-                return true;
+/**
+ * \returns True if the file is open for reading, compressed or not.
+ */
+bool
+S9sFile::isOpenForRead() const
+{
+    return m_priv->m_inputStream != NULL || m_priv->m_gzInputStream != NULL;
+}
 
-            default:
-                line += c;
+/**
+ * \param path The path of a file.
+ * \returns True if the file name says it is a gzip compressed file.
+ */
+bool
+S9sFile::isCompressed(
+        const S9sString &path)
+{
+    return path.endsWith(".gz");
+}
+
+/**
+ * \returns True if the gzip compressed files can be read and written.
+ */
+bool
+S9sFile::compressionSupported()
+{
+#ifdef HAVE_LIBZ
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef HAVE_LIBZ
+/**
+ * Reads one line from the compressed input stream into the line buffer, the
+ * same buffer the uncompressed reading uses.
+ */
+bool
+S9sFile::readGzLine(
+        S9sString &line)
+{
+    gzFile  stream = (gzFile) m_priv->m_gzInputStream;
+    size_t  length = 0;
+
+    if (m_priv->m_lineBuffer == NULL)
+    {
+        m_priv->m_lineBufferSize = READ_BUFFER_SIZE;
+        m_priv->m_lineBuffer     = (char *) malloc(m_priv->m_lineBufferSize);
+    }
+
+    for (;;)
+    {
+        if (length + 1 >= m_priv->m_lineBufferSize)
+        {
+            m_priv->m_lineBufferSize *= 2;
+            m_priv->m_lineBuffer = (char *) realloc(
+                    m_priv->m_lineBuffer, m_priv->m_lineBufferSize);
         }
+
+        if (gzgets(stream, m_priv->m_lineBuffer + length, 
+                    m_priv->m_lineBufferSize - length) == NULL)
+        {
+            break;
+        }
+
+        length += strlen(m_priv->m_lineBuffer + length);
+        if (length > 0 && m_priv->m_lineBuffer[length - 1] == '\n')
+            break;
     }
 
-    return false;
+    if (length == 0)
+        return false;
+
+    line.assign(m_priv->m_lineBuffer, length);
+    if (line[length - 1] == '\n')
+        ++m_priv->m_lineNumber;
+
+    return true;
 }
+#endif
 
 /**
  * \param content The place where we put the content of the file.
@@ -44,12 +44,15 @@ class S9sFile
 
         bool openForAppend();
         bool openForRead();
+        bool isOpenForRead() const;
         void flush();
         void close();
         bool readTxtFile(S9sString &content);
         bool readLine(S9sString &line);
         bool readEvent(S9sEvent &event);
         ulonglong lineNumber() const;
+        off_t tell() const;
+        bool seek(const off_t offset);
         
         bool writeTxtFile(const S9sString &content);
         bool fprintf(const char *formatString, ...);
@@ -60,6 +63,8 @@ class S9sFile
         static S9sFileName basename(const S9sFilePath &filePath);
         static S9sDirName dirname(const S9sFilePath &fileName);
         static bool isAbsolutePath(const S9sFilePath &path);
+        static bool isCompressed(const S9sString &path);
+        static bool compressionSupported();
         static S9sString dirSeparator() { return "/"; };
 
         static S9sFilePath 
@@ -77,6 +82,8 @@ class S9sFile
 
         
     private:
+        bool readGzLine(S9sString &line);
+
         ssize_t safeRead(
                 int     fileDescriptor, 
                 void   *buffer, 
@@ -19,14 +19,23 @@
  */
 
 #include "s9sfile_p.h"
+#include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
 
 S9sFilePrivate::S9sFilePrivate() :
     m_referenceCounter(1),
     m_outputStream(0),
     m_inputStream(0),
-    m_lineNumber(0ull)
+    m_gzInputStream(0),
+    m_lineNumber(0ull),
+    m_lineBuffer(0),
+    m_lineBufferSize(0)
 {
 }
 
@@ -41,13 +50,19 @@ S9sFilePrivate::S9sFilePrivate(
     m_errorString(orig.m_path),
     m_outputStream(0),
     m_inputStream(0),
-    m_lineNumber(0ull)
+    m_gzInputStream(0),
+    m_lineNumber(0ull),
+    m_lineBuffer(0),
+    m_lineBufferSize(0)
 {
 }
 
 S9sFilePrivate::~S9sFilePrivate()
 {
     close();
+
+    if (m_lineBuffer)
+        free(m_lineBuffer);
 }
 
 void 
@@ -76,4 +91,12 @@ S9sFilePrivate::close()
         fclose(m_inputStream);
         m_inputStream = 0;
     }
+
+#ifdef HAVE_LIBZ
+    if (m_gzInputStream)
+    {
+        gzclose((gzFile) m_gzInputStream);
+        m_gzInputStream = 0;
+    }
+#endif
 }
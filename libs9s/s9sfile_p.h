@@ -40,7 +40,11 @@ class S9sFilePrivate
         mutable S9sString       m_errorString;
         FILE                   *m_outputStream;
         FILE                   *m_inputStream;
+        /** The gzFile handle when reading a compressed file. */
+        void                   *m_gzInputStream;
         ulonglong               m_lineNumber;
+        char                   *m_lineBuffer;
+        size_t                  m_lineBufferSize;
         
         friend class S9sFile;
 };
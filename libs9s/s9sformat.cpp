@@ -263,7 +263,7 @@ S9sFormat::printf(
     if (m_withFieldSeparator)
         formatString += " ";
 
-    ::printf(STR(formatString), value);
+    s9s_printf(STR(formatString), value);
 }
 
 
@@ -285,7 +285,7 @@ S9sFormat::printf(
     if (m_withFieldSeparator)
         formatString += " ";
 
-    ::printf(STR(formatString), value);
+    s9s_printf(STR(formatString), value);
 }
 
 void
@@ -305,24 +305,27 @@ S9sFormat::printf(
         formatString += " ";
     
     if (color && m_colorStart != NULL)
-        ::printf("%s", m_colorStart);
+        s9s_printf("%s", m_colorStart);
 
-    ::printf(STR(formatString), STR(myValue));
+    s9s_printf(STR(formatString), STR(myValue));
 
     if (color && m_colorEnd != NULL)
-        ::printf("%s", m_colorEnd);
+        s9s_printf("%s", m_colorEnd);
 }
 
 /**
- * Prints the value to the standard output, then prints the field separator.
+ * \returns The value formatted the way printf() would print it, with the field
+ *   separator and the colors.
  */
-void
-S9sFormat::printf(
+S9sString
+S9sFormat::toString(
         const S9sString &value,
         bool             color) const
 {
     S9sString formatString;
     S9sString myValue = value;
+    S9sString formatted;
+    S9sString retval;
 
     if (m_width > 0)
     {
@@ -370,12 +373,26 @@ S9sFormat::printf(
         formatString += " ";
 
     if (color && m_colorStart != NULL)
-        ::printf("%s", m_colorStart);
+        retval += m_colorStart;
 
-    ::printf(STR(formatString), STR(myValue));
+    formatted.sprintf(STR(formatString), STR(myValue));
+    retval += formatted;
 
     if (color && m_colorEnd != NULL)
-        ::printf("%s", m_colorEnd);
+        retval += m_colorEnd;
+
+    return retval;
+}
+
+/**
+ * Prints the value to the standard output, then prints the field separator.
+ */
+void
+S9sFormat::printf(
+        const S9sString &value,
+        bool             color) const
+{
+    s9s_printf("%s", STR(toString(value, color)));
 }
 
 void
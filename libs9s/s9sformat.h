@@ -62,6 +62,7 @@ class S9sFormat
         void setEllipsize(bool ellipsize = true);
 
         S9sString toString(const double value) const;
+        S9sString toString(const S9sString &value, bool color = true) const;
 
         void widen(const S9sString &value);
         void widen(const int value);
@@ -8,6 +8,7 @@
 
 #include "stdio.h"
 #include "math.h"
+#include <algorithm>
 
 //#define DEBUG
 #define WARNING
@@ -15,6 +16,62 @@
 
 #define IS_DIVISIBLE_BY(a,b) ((int) (a) == ((int) (a) / (b)) * (b))
 
+/*
+ * The reduction kernels working on contiguous arrays of doubles. They are
+ * simple loops over plain pointers so that the compiler can vectorize them.
+ */
+static double
+minimumOf(
+        const double *data,
+        size_t        n)
+{
+    double retval = data[0];
+
+    for (size_t idx = 1u; idx < n; ++idx)
+        retval = data[idx] < retval ? data[idx] : retval;
+
+    return retval;
+}
+
+static double
+maximumOf(
+        const double *data,
+        size_t        n)
+{
+    double retval = data[0];
+
+    for (size_t idx = 1u; idx < n; ++idx)
+        retval = data[idx] > retval ? data[idx] : retval;
+
+    return retval;
+}
+
+static double
+sumOf(
+        const double *data,
+        size_t        n)
+{
+    double retval = 0.0;
+
+    for (size_t idx = 0u; idx < n; ++idx)
+        retval += data[idx];
+
+    return retval;
+}
+
+/**
+ * \returns The index of the first original value in the given bucket when
+ *   the nValues original values are distributed into nBuckets buckets.
+ */
+static size_t
+bucketStart(
+        int    bucket,
+        int    nBuckets,
+        size_t nValues)
+{
+    return (size_t) ((ulonglong) bucket * nValues / nBuckets);
+}
+
 S9sGraph::S9sGraph() :
     m_showDensityFunction(false),
     m_aggregateType(Average),
@@ -24,7 +81,13 @@ S9sGraph::S9sGraph() :
     m_warningLevel(0.0),
     m_errorLevel(0.0),
     m_started(0),
-    m_ended(0)
+    m_ended(0),
+    m_minValue(0.0),
+    m_maxValue(0.0),
+    m_samplesPerColumn(0),
+    m_ringHead(0u),
+    m_lastColumnSum(0.0),
+    m_lastColumnCount(0)
 {
 }
 
@@ -150,7 +213,10 @@ S9sGraph::nValues() const
 S9sVariant
 S9sGraph::max() const
 { 
-    return m_rawData.max(); 
+    if (m_rawData.empty())
+        return S9sVariant();
+
+    return maximumOf(&m_rawData[0], m_rawData.size()); 
 }
 
 /**
@@ -163,7 +229,7 @@ void
 S9sGraph::appendValue(
         S9sVariant value)
 {
-    m_rawData << value;
+    m_rawData.push_back(value.toDouble());
 }
 
 /**
@@ -176,14 +242,165 @@ S9sGraph::realize()
 {
     if (m_showDensityFunction)
     {
-        createDensityFunction(m_rawData, m_normalized, m_width);
+        // The order of the values does not matter here, so the ring of the
+        // live mode can be used as it is.
+        densityFunction(
+                m_rawData, m_normalized, m_width, m_minValue, m_maxValue);
+
+        createLines(m_width, m_height);
+    } else if (isLive())
+    {
+        m_normalized = m_liveColumns;
         createLines(m_width, m_height);
     } else {
-        normalize(m_rawData, m_normalized, m_width);
+        downsample(m_rawData, m_normalized, m_width, m_aggregateType);
         createLines(m_width, m_height);
     }
 }
 
+/**
+ * \param samplesPerColumn How many samples one column of the graph shows, 0 to
+ *   show all the values the graph already has.
+ *
+ * Switches the graph to live mode where the new values are added one by one
+ * with appendLiveValue() while the graph is shown. The graph keeps the last
+ * samplesPerColumn * width values in a ring buffer and the columns are updated
+ * as the values arrive, so realize() does not need to process the whole
+ * series again. The values the graph already has are kept, they are shown as
+ * the history of the series.
+ */
+void
+S9sGraph::setLive(
+        const int samplesPerColumn)
+{
+    S9sVector<double> history = m_rawData;
+    time_t            started = m_started;
+    time_t            ended   = m_ended;
+    size_t            n       = history.size();
+
+    if (isLive() && m_ringHead < n)
+        std::rotate(history.begin(), history.begin() + m_ringHead, history.end());
+
+    m_samplesPerColumn = samplesPerColumn;
+    if (m_samplesPerColumn < 1 && m_width > 0)
+        m_samplesPerColumn = (n + m_width - 1) / m_width;
+
+    if (m_samplesPerColumn < 1)
+        m_samplesPerColumn = 1;
+
+    m_ringHead         = 0u;
+    m_lastColumnSum    = 0.0;
+    m_lastColumnCount  = 0;
+
+    m_rawData.clear();
+    m_rawData.reserve((size_t) m_samplesPerColumn * m_width);
+    m_liveColumns.clear();
+    m_columnTimes.clear();
+
+    // We do not have the time of the old samples, we spread them evenly.
+    for (size_t idx = 0u; idx < n; ++idx)
+    {
+        time_t created = ended;
+
+        if (n > 1u)
+            created = started + (time_t) ((ended - started) * idx / (n - 1u));
+
+        appendLiveValue(history[idx], created);
+    }
+}
+
+/**
+ * \returns True if the graph is in live mode.
+ */
+bool
+S9sGraph::isLive() const
+{
+    return m_samplesPerColumn > 0;
+}
+
+/**
+ * \returns How many samples one column shows in live mode.
+ */
+int
+S9sGraph::samplesPerColumn() const
+{
+    return m_samplesPerColumn;
+}
+
+/**
+ * \param value The new value.
+ * \param created The time the value was measured.
+ *
+ * Adds a new value to a graph in live mode. Only the last column is updated:
+ * the value is aggregated into it, or if the last column is full a new column
+ * is started and the oldest column scrolls out of the graph. Without the live
+ * mode this is the same as appendValue().
+ */
+void
+S9sGraph::appendLiveValue(
+        const double value,
+        const time_t created)
+{
+    size_t capacity = (size_t) m_samplesPerColumn * m_width;
+
+    if (!isLive())
+    {
+        m_rawData.push_back(value);
+        return;
+    }
+
+    if (m_rawData.size() < capacity)
+    {
+        m_rawData.push_back(value);
+    } else if (capacity > 0u)
+    {
+        m_rawData[m_ringHead] = value;
+        m_ringHead = (m_ringHead + 1u) % capacity;
+    }
+
+    if (m_liveColumns.empty() || m_lastColumnCount >= m_samplesPerColumn)
+    {
+        if ((int) m_liveColumns.size() >= m_width && !m_liveColumns.empty())
+        {
+            m_liveColumns.erase(m_liveColumns.begin());
+            m_columnTimes.erase(m_columnTimes.begin());
+        }
+
+        m_liveColumns.push_back(value);
+        m_columnTimes.push_back(created);
+        m_lastColumnSum   = value;
+        m_lastColumnCount = 1;
+    } else {
+        double &last = m_liveColumns.back();
+
+        m_lastColumnSum += value;
+        ++m_lastColumnCount;
+
+        switch (m_aggregateType)
+        {
+            case Max:
+                if (value > last)
+                    last = value;
+                break;
+
+            case Min:
+                if (value < last)
+                    last = value;
+                break;
+
+            case Average:
+            case LargestTriangle:
+                last = m_lastColumnSum / m_lastColumnCount;
+                break;
+        }
+    }
+
+    if (!m_columnTimes.empty())
+        m_started = m_columnTimes.front();
+
+    m_ended = created;
+}
+
 /**
  * Sets the title of the graph.
  */
@@ -225,135 +442,171 @@ S9sGraph::clearValues()
  * \param normalized The vector where the density function data vector will be 
  *   placed.
  * \param newWidth Controls the size of the normalized vector.
+ * \param minimum The place to return the smallest original value.
+ * \param maximum The place to return the biggest original value.
  *
  * This function is called to create a density function data set from a given
  * set of data.
  */
 void
-S9sGraph::createDensityFunction(
-        S9sVariantList &original,
-        S9sVariantList &normalized,
-        int             newWidth)
+S9sGraph::densityFunction(
+        const S9sVector<double> &original,
+        S9sVector<double>       &normalized,
+        int                      newWidth,
+        double                  &minimum,
+        double                  &maximum)
 {
-    S9sVariant minimum = original.min();
-    S9sVariant maximum = original.max();
-    double     sum;
-    double     delta;
+    const double *data = original.empty() ? NULL : &original[0];
+    size_t        n    = original.size();
+    double        delta;
+    double        sum;
+
+    minimum = n > 0u ? minimumOf(data, n) : 0.0;
+    maximum = n > 0u ? maximumOf(data, n) : 0.0;
 
     if (minimum == maximum)
-        maximum = minimum.toDouble() + 1.0;
+        maximum = minimum + 1.0;
 
-    delta = (maximum.toDouble() - minimum.toDouble()) / (newWidth - 1);
-    #if 0
-    S9S_DEBUG("------------------------------------");
-    S9S_DEBUG("*** minimum : %g", minimum.toDouble());
-    S9S_DEBUG("*** maximum : %g", maximum.toDouble());
-    S9S_DEBUG("***   delta : %g", delta);
-    #endif
+    delta = (maximum - minimum) / (newWidth - 1);
 
-    for (int idx = 0; idx < newWidth; ++idx)
-        normalized << 0.0;
+    normalized.assign(newWidth, 0.0);
 
-    for (uint idx = 0; idx < original.size(); ++idx)
+    for (size_t idx = 0u; idx < n; ++idx)
     {
-        double value = original[idx].toDouble();
-        int    targetIdx;
+        int targetIdx = (data[idx] - minimum) / delta;
 
-        targetIdx = (value - minimum.toDouble()) / delta;
-        //S9S_DEBUG("targetIdx : %u", targetIdx);
-        if (targetIdx < 0 || targetIdx >= (int) normalized.size())
+        if (targetIdx < 0 || targetIdx >= newWidth)
         {
-            S9S_WARNING("Target index %u is out of range.", targetIdx);
+            S9S_WARNING("Target index %d is out of range.", targetIdx);
             continue;
         }
 
         normalized[targetIdx] += 1.0;
     }
 
-    m_minValue = minimum;
-    m_maxValue = maximum;
-
     /*
      * Normalizing to percent.
      */
-    sum = normalized.sum().toDouble();
+    sum = sumOf(&normalized[0], newWidth);
     
     if (sum == 0.0)
         sum = 1.0;
 
-    for (uint idx = 0u; idx < normalized.size(); ++idx)
-    {
-        double newValue;
-        
-        newValue  = normalized[idx].toDouble() / sum;
-        newValue *= 100.0;
-        normalized[idx] = newValue;
-    }
+    for (int idx = 0; idx < newWidth; ++idx)
+        normalized[idx] = normalized[idx] / sum * 100.0;
 }
 
 /**
  * \param original The vector with the original data.
  * \param normalized The vector where the normalized vector will be placed.
  * \param newWidth Controls the size of the normalized vector.
+ * \param type How the values are aggregated when there are more values than
+ *   the new width.
  *
  * This function is used to resample the data and produce a version that has
- * the given number of data points.
+ * the given number of data points. The original values are distributed into
+ * newWidth buckets in one pass and every bucket is reduced to one value. If
+ * there are fewer values than buckets the values are repeated.
  */
 void
-S9sGraph::normalize(
-        S9sVariantList &original,
-        S9sVariantList &normalized,
-        int             newWidth)
+S9sGraph::downsample(
+        const S9sVector<double> &original,
+        S9sVector<double>       &normalized,
+        int                      newWidth,
+        AggregateType            type)
 {
-    S9sVariantList tmp;
-    double         origPercent;
-    double         newPercent;
+    const double *data = original.empty() ? NULL : &original[0];
+    size_t        n    = original.size();
 
     S9S_DEBUG("");
     S9S_DEBUG("            width : %d", newWidth);
-    S9S_DEBUG(" original.size() : %u",  original.size());
-    normalized.clear();
+    S9S_DEBUG(" original.size() : %u",  n);
 
-    if (original.empty())
+    if (newWidth <= 0)
     {
-        for (int x = 0; x < newWidth; ++x)
-            normalized << 0.0;
-
+        normalized.clear();
         return;
     }
+
+    normalized.assign(newWidth, 0.0);
+    if (n == 0u)
+        return;
     
-    for (uint origIndex = 0u; origIndex < original.size(); /*++origIndex*/)
-    {    
-        bool added = false;
-
-        tmp << original[origIndex++];
-
-        origPercent = 
-            origIndex == 0 ? 0.0 :
-            ((double) origIndex) / ((double) original.size());
-
-        newPercent  = 
-            normalized.size() == 0u ? 0.0 :
-            (double) (normalized.size()) / (double) newWidth;
-
-        while (newPercent <= origPercent && 
-                (int) normalized.size() < newWidth) 
-        { 
-            normalized << aggregate(tmp);
-            
-            origPercent = 
-                origIndex == 0 ? 0.0 :
-                ((double) origIndex) / ((double) original.size());
-
-            newPercent  = 
-                normalized.size() == 0u ? 0.0 :
-                (double) (normalized.size()) / (double) newWidth;
-
-            added = true;
+    if (type == LargestTriangle && (int) n > newWidth && newWidth > 2)
+    {
+        /*
+         * Largest-Triangle-Three-Buckets: the first and last values are kept,
+         * the rest are distributed into newWidth - 2 buckets and from every
+         * bucket the value that forms the largest triangle with the value
+         * selected from the previous bucket and the average of the next
+         * bucket is selected.
+         */
+        size_t selected = 0u;
+        int    nBuckets = newWidth - 2;
+
+        normalized[0] = data[0];
+
+        for (int bucket = 0; bucket < nBuckets; ++bucket)
+        {
+            size_t first     = 1u + bucketStart(bucket, nBuckets, n - 2u);
+            size_t last      = 1u + bucketStart(bucket + 1, nBuckets, n - 2u);
+            size_t nextFirst = last;
+            size_t nextLast  = bucket + 1 < nBuckets ?
+                1u + bucketStart(bucket + 2, nBuckets, n - 2u) : n;
+            double nextX     = (nextFirst + nextLast - 1) / 2.0;
+            double nextY     = 
+                sumOf(data + nextFirst, nextLast - nextFirst) / 
+                (nextLast - nextFirst);
+            double ax        = selected;
+            double ay        = data[selected];
+            double maxArea   = -1.0;
+            size_t maxIdx    = first;
+
+            for (size_t idx = first; idx < last; ++idx)
+            {
+                double area = fabs(
+                        (ax - nextX) * (data[idx] - ay) - 
+                        (ax - idx) * (nextY - ay));
+
+                if (area > maxArea)
+                {
+                    maxArea = area;
+                    maxIdx  = idx;
+                }
+            }
+
+            selected = maxIdx;
+            normalized[bucket + 1] = data[selected];
+        }
+
+        normalized[newWidth - 1] = data[n - 1];
+        return;
+    }
+
+    for (int bucket = 0; bucket < newWidth; ++bucket)
+    {
+        size_t first = bucketStart(bucket, newWidth, n);
+        size_t last  = bucketStart(bucket + 1, newWidth, n);
+
+        if (last <= first)
+            last = first + 1;
+
+        switch (type)
+        {
+            case Max:
+                normalized[bucket] = maximumOf(data + first, last - first);
+                break;
+
+            case Min:
+                normalized[bucket] = minimumOf(data + first, last - first);
+                break;
+
+            case Average:
+            case LargestTriangle:
+                normalized[bucket] = 
+                    sumOf(data + first, last - first) / (last - first);
+                break;
         }
-        
-        if (added)
-            tmp.clear();
     }
 }
 
@@ -371,7 +624,7 @@ S9sGraph::createLines(
     S9sOptions *options = S9sOptions::instance();
     bool        ascii = options->onlyAscii();
     S9sString   line;
-    S9sVariant  biggest, smallest;
+    double      biggest;
     double      mult;
    
     m_lines.clear();
@@ -414,17 +667,16 @@ S9sGraph::createLines(
     /*
      * The Y labels and the body of the graph.
      */
-    biggest  = m_normalized.max();
-    smallest = m_normalized.min();
+    biggest  = m_normalized.empty() ? 
+        0.0 : maximumOf(&m_normalized[0], m_normalized.size());
 
-    if (biggest.toDouble() < 0.1)
+    if (biggest < 0.1)
         biggest = 0.1;
     
-    mult     = (newHeight / biggest.toDouble());
+    mult     = (newHeight / biggest);
 
     #if 0
-    S9S_DEBUG("   biggest : %g", biggest.toDouble());
-    S9S_DEBUG("  smallest : %g", smallest.toDouble());
+    S9S_DEBUG("   biggest : %g", biggest);
     S9S_DEBUG("      mult : %g", mult);
     S9S_DEBUG("   x range : 0 - %u", m_normalized.size() - 1);
     #endif
@@ -447,7 +699,7 @@ S9sGraph::createLines(
             const char *c;
 
             if (x < (int) m_normalized.size())
-                value = m_normalized[x].toDouble();
+                value = m_normalized[x];
             else 
                 value = 0.0;
 
@@ -632,8 +884,8 @@ S9sGraph::createXLabelsDensity(
     S9sString middleString;
     S9sString line;
     
-    minValue = m_minValue.toDouble();
-    maxValue = m_maxValue.toDouble();
+    minValue = m_minValue;
+    maxValue = m_maxValue;
     middleValue = minValue + (maxValue - minValue) / 2.0;
 
     minString = xLabel(maxValue, minValue);
@@ -703,9 +955,12 @@ S9sString
 S9sGraph::yLabel(
         double baseLine) const
 {
-    double     maxValue = m_normalized.max().toDouble();
+    double     maxValue = 0.0;
     S9sString  retval;
 
+    if (!m_normalized.empty())
+        maxValue = maximumOf(&m_normalized[0], m_normalized.size());
+
     if (maxValue < 10.0)
     {
         baseLine = roundMultiple(baseLine, 0.05);
@@ -755,30 +1010,6 @@ S9sGraph::xLabel(
     return retval;
 }
 
-S9sVariant 
-S9sGraph::aggregate(
-        const S9sVariantList &data) const
-{
-    S9sVariant retval;
-
-    switch (m_aggregateType)
-    {
-        case Max:
-            retval = data.max();
-            break;
-
-        case Min:
-            retval = data.min();
-            break;
-
-        case Average:
-            retval = data.average();
-            break;
-    }
-   
-    return retval;
-}
-
 /**
  * \param graphs The graphs to print.
  * \param columnSeparator The string that will be printed between the graphs.
@@ -5,6 +5,7 @@
 
 #include "s9svariant.h"
 #include "s9svariantlist.h"
+#include "s9svector.h"
 
 #include <math.h>
 #include <vector>
@@ -16,7 +17,9 @@ class S9sGraph
         {
             Max,
             Min,
-            Average
+            Average,
+            /** Largest-Triangle-Three-Buckets, keeps the shape of the data. */
+            LargestTriangle
         };
 
         S9sGraph();
@@ -32,6 +35,14 @@ class S9sGraph
 
         virtual void appendValue(S9sVariant value);
         virtual void realize();
+
+        void setLive(const int samplesPerColumn = 0);
+        bool isLive() const;
+        int samplesPerColumn() const;
+
+        void appendLiveValue(
+                const double value,
+                const time_t created);
         
         void setTitle(
                 const char *formatString,
@@ -50,18 +61,21 @@ class S9sGraph
                 S9sVector<S9sGraph *> graphs,
                 S9sString             columnSeparator);
 
-    protected:
-        void clearValues();
+        static void downsample(
+                const S9sVector<double> &original,
+                S9sVector<double>       &normalized,
+                int                      newWidth,
+                AggregateType            type);
 
-        void normalize(
-                S9sVariantList &original,
-                S9sVariantList &normalized,
-                int             newWidth);
+        static void densityFunction(
+                const S9sVector<double> &original,
+                S9sVector<double>       &normalized,
+                int                      newWidth,
+                double                  &minimum,
+                double                  &maximum);
 
-        void createDensityFunction(
-                S9sVariantList &original,
-                S9sVariantList &normalized,
-                int             newWidth);
+    protected:
+        void clearValues();
 
         void createLines(int newWidth, int newHeight);
         void createXLabelsTime(int newWidth, int newHeight);
@@ -71,9 +85,6 @@ class S9sGraph
         S9sString yLabel(double baseLine) const;
         S9sString xLabel(double maxValue, double value) const;
 
-    private:
-        S9sVariant aggregate(const S9sVariantList &data) const;
-
     private:
         bool            m_showDensityFunction;
         AggregateType   m_aggregateType;
@@ -85,9 +96,20 @@ class S9sGraph
         double          m_errorLevel;
         time_t          m_started;
         time_t          m_ended;
-        S9sVariantList  m_rawData;
-        S9sVariantList  m_normalized;
-        S9sVariant      m_minValue, m_maxValue;
+        /** The original values, kept as doubles in a contiguous array. */
+        S9sVector<double> m_rawData;
+        S9sVector<double> m_normalized;
+        double          m_minValue, m_maxValue;
+        /** How many samples one column shows in live mode, 0 otherwise. */
+        int             m_samplesPerColumn;
+        /** In live mode m_rawData is a ring, this is where the oldest is. */
+        size_t          m_ringHead;
+        /** The aggregated value of every column in live mode. */
+        S9sVector<double> m_liveColumns;
+        /** The creation time of the first sample in every live column. */
+        S9sVector<time_t> m_columnTimes;
+        double          m_lastColumnSum;
+        int             m_lastColumnCount;
 };
 
 template<typename T>
@@ -0,0 +1,429 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9sgraphfollower.h"
+
+#include "s9soptions.h"
+#include "s9spollscheduler.h"
+#include "s9smutexlocker.h"
+
+#include <unistd.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/** The follower gives up after this many failed logins in a row. */
+#define MAX_FAILED_LOGINS 5
+
+S9sGraphFollower::S9sGraphFollower(
+        S9sRpcClient &client) :
+    S9sDisplay(true),
+    m_client(client),
+    m_nEvents(0ull),
+    m_nSamples(0ull)
+{
+    S9sOptions *options = S9sOptions::instance();
+
+    setMaxFps(options->maxFps());
+}
+
+S9sGraphFollower::~S9sGraphFollower()
+{
+    for (uint idx = 0u; idx < m_graphs.size(); ++idx)
+        delete m_graphs[idx];
+
+    m_graphs.clear();
+}
+
+/**
+ * \param graph The graph to show, the follower will destroy it.
+ *
+ * Adds a graph to the view and switches it to live mode. The values the graph
+ * already has are shown as the history, the new samples are added to the end.
+ */
+void
+S9sGraphFollower::addGraph(
+        S9sCmonGraph *graph)
+{
+    if (graph == NULL)
+        return;
+
+    graph->setLive();
+    graph->realize();
+
+    m_graphs << graph;
+}
+
+int
+S9sGraphFollower::nGraphs() const
+{
+    return (int) m_graphs.size();
+}
+
+/**
+ * \returns How many measurement events were received.
+ */
+ulonglong
+S9sGraphFollower::nEvents() const
+{
+    return m_nEvents;
+}
+
+/**
+ * \returns How many samples were added to the graphs.
+ */
+ulonglong
+S9sGraphFollower::nSamples() const
+{
+    return m_nSamples;
+}
+
+/**
+ * Subscribes to the measurement events of the cluster and keeps the graphs on
+ * the screen until the user quits. Reconnects if the event stream drops, but
+ * stops with an error if the login fails several times in a row.
+ */
+void
+S9sGraphFollower::main()
+{
+    S9sOptions       *options = S9sOptions::instance();
+    S9sPollScheduler  reconnect(500, 30000, 20);
+    int               nFailedLogins = 0;
+
+    m_eventFilter.enableClass("EventHost");
+    m_eventFilter.enableName("Measurements");
+    m_eventFilter.setClusterId(options->clusterId());
+    m_client.setEventFilter(m_eventFilter);
+
+    start();
+
+    while (true)
+    {
+        ulonglong nEvents;
+
+        while (!m_client.isAuthenticated())
+        {
+            m_client.maybeAuthenticate();
+
+            if (m_client.isAuthenticated())
+            {
+                nFailedLogins = 0;
+                break;
+            }
+
+            if (++nFailedLogins >= MAX_FAILED_LOGINS)
+            {
+                stop();
+
+                PRINT_ERROR("Login failed %d times: %s", 
+                        nFailedLogins, STR(m_client.errorString()));
+
+                // The lower levels might have set a more specific code.
+                if (options->exitStatus() == S9sOptions::ExitOk)
+                    options->setExitStatus(S9sOptions::AccessDenied);
+
+                return;
+            }
+
+            usleep(reconnect.nextDelay(false) * 1000);
+        }
+
+        m_mutex.lock();
+        nEvents     = m_nEvents;
+        m_lastReply = S9sRpcReply();
+        m_mutex.unlock();
+
+        m_client.subscribeEvents(S9sGraphFollower::eventHandler, (void *) this);
+        replyCallback(m_client.reply());
+
+        usleep(reconnect.nextDelay(m_nEvents > nEvents) * 1000);
+    }
+}
+
+/**
+ * \param event The event that might hold measurements.
+ * \returns True if any of the graphs changed.
+ *
+ * Adds the samples of a measurement event to the graphs they belong to. The
+ * mutex should be locked when this method is called from the event handler.
+ */
+bool
+S9sGraphFollower::processEvent(
+        const S9sEvent &event)
+{
+    S9sVariantList samples;
+    bool           changed = false;
+
+    if (event.eventSubClass() != S9sEvent::Measurements)
+        return false;
+
+    ++m_nEvents;
+    samples = measurementSamples(event);
+
+    for (uint idx = 0u; idx < samples.size(); ++idx)
+    {
+        S9sVariantMap sample = samples[idx].toVariantMap();
+
+        for (uint idx1 = 0u; idx1 < m_graphs.size(); ++idx1)
+        {
+            S9sCmonGraph *graph = m_graphs[idx1];
+
+            if (!graph->appendLiveSample(sample))
+                continue;
+
+            graph->realize();
+
+            ++m_nSamples;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+/**
+ * \returns The samples the measurement event holds in the same form the
+ *   statByName request returns them.
+ *
+ * The measurements might be one sample or a list of samples and the disk
+ * information has the samples of the partitions in it. The samples that do not
+ * have the host ID or the creation time get them from the event.
+ */
+S9sVariantList
+S9sGraphFollower::measurementSamples(
+        const S9sEvent &event)
+{
+    S9sVariantMap  specifics;
+    S9sVariant     measurements;
+    S9sVariantList list;
+    S9sVariantList retval;
+    int            hostId  = -1;
+    time_t         created = event.created().toTimeT();
+
+    specifics    = event.toVariantMap().valueByPath(
+            "/event_specifics").toVariantMap();
+    measurements = specifics["measurements"];
+
+    if (event.hasHost())
+        hostId = event.host().hostId();
+
+    if (measurements.isVariantList())
+        list = measurements.toVariantList();
+    else if (measurements.isVariantMap())
+        list << measurements;
+
+    for (uint idx = 0u; idx < list.size(); ++idx)
+    {
+        S9sVariantMap  sample = list[idx].toVariantMap();
+        S9sVariantList partitions;
+
+        if (sample.contains("partitions"))
+        {
+            partitions = sample["partitions"].toVariantList();
+
+            for (uint idx1 = 0u; idx1 < partitions.size(); ++idx1)
+                list << partitions[idx1];
+
+            continue;
+        }
+
+        if (!sample.contains("hostid"))
+        {
+            if (hostId < 0)
+                continue;
+
+            sample["hostid"] = hostId;
+        }
+
+        if (!sample.contains("created"))
+            sample["created"] = (ulonglong) created;
+
+        retval << sample;
+    }
+
+    return retval;
+}
+
+/**
+ * \returns True if the program should continue refreshing the screen.
+ *
+ * Paints the graphs as many in one row as fits the screen. The mutex is locked
+ * when this method is called.
+ */
+bool
+S9sGraphFollower::refreshScreen()
+{
+    S9sString columnSeparator = "  ";
+    uint      first = 0u;
+
+    startScreen();
+    printHeader();
+
+    if (!m_client.isAuthenticated() || 
+            (!m_lastReply.empty() && !m_lastReply.isOk()))
+    {
+        S9sString message;
+
+        if (!m_lastReply.isOk() && !m_lastReply.errorString().empty())
+            message.sprintf("*** %s ***", STR(m_lastReply.errorString()));
+        else if (!m_client.errorString().empty())
+            message.sprintf("*** %s ***", STR(m_client.errorString()));
+        else 
+            message.sprintf("*** Not connected. ***");
+
+        printMiddle(message);
+        printFooter();
+        return true;
+    }
+
+    while (first < m_graphs.size() && m_lineCounter < height() - 1)
+    {
+        uint last     = first;
+        int  sumWidth = m_graphs[first]->nColumns();
+        int  nRows    = m_graphs[first]->nRows();
+
+        // Finding the graphs that fit into this row.
+        while (last + 1 < m_graphs.size())
+        {
+            int thisWidth = 
+                m_graphs[last + 1]->nColumns() + columnSeparator.length();
+
+            if (sumWidth + thisWidth > width())
+                break;
+
+            sumWidth += thisWidth;
+            ++last;
+
+            if (m_graphs[last]->nRows() > nRows)
+                nRows = m_graphs[last]->nRows();
+        }
+
+        if (first > 0u)
+            printNewLine();
+
+        for (int row = 0; row < nRows && m_lineCounter < height() - 1; ++row)
+        {
+            for (uint idx = first; idx <= last; ++idx)
+            {
+                if (idx > first)
+                    s9s_printf("%s", STR(columnSeparator));
+
+                s9s_printf("%s", STR(m_graphs[idx]->line(row)));
+            }
+
+            printNewLine();
+        }
+
+        first = last + 1;
+    }
+
+    printFooter();
+    return true;
+}
+
+void
+S9sGraphFollower::printHeader()
+{
+    S9sDateTime dt = S9sDateTime::currentDateTime();
+    const char *bold = TERM_SCREEN_TITLE_BOLD;
+    const char *normal = TERM_SCREEN_TITLE;
+
+    s9s_printf("%s%s%s ", bold, "S9S GRAPH VIEW     ", normal);
+    s9s_printf("%c ", rotatingCharacter());
+    s9s_printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
+    s9s_printf("%llu events %llu samples ", m_nEvents, m_nSamples);
+
+    printNewLine();
+}
+
+void
+S9sGraphFollower::printFooter()
+{
+    const char *bold   = TERM_SCREEN_TITLE_BOLD;
+    const char *normal = TERM_SCREEN_TITLE;
+
+    for (;m_lineCounter < height() - 1; ++m_lineCounter)
+    {
+        s9s_printf("%s", TERM_ERASE_EOL);
+        s9s_printf("\n\r");
+        s9s_printf("%s", TERM_ERASE_EOL);
+    } 
+
+    s9s_printf("%s ", normal);
+    s9s_printf("%sQ%s-Quit", bold, normal);
+
+    // No new-line at the end, this is the last line.
+    s9s_printf("%s", TERM_ERASE_EOL);
+    s9s_printf("%s", TERM_NORMAL);
+    fflush(stdout);
+}
+
+/**
+ * Called by the event handler for every event, from the thread that
+ * subscribed to the events.
+ */
+void
+S9sGraphFollower::eventCallback(
+        const S9sEvent &event)
+{
+    S9sMutexLocker locker(m_mutex);
+
+    if (processEvent(event))
+        markDirty();
+}
+
+/**
+ * Called when the event stream ended, the reply shows the error if the
+ * controller refused to send the events.
+ */
+void
+S9sGraphFollower::replyCallback(
+        const S9sRpcReply &reply)
+{
+    S9sMutexLocker locker(m_mutex);
+
+    m_lastReply = reply;
+    markDirty();
+}
+
+void
+S9sGraphFollower::eventHandler(
+        const S9sVariantMap &jsonMessage,
+        void                *userData)
+{
+    S9sGraphFollower *follower = (S9sGraphFollower *) userData;
+
+    if (follower == NULL)
+        return;
+
+    if (!jsonMessage.contains("class_name") ||
+            jsonMessage.at("class_name").toString() != "CmonEvent")
+    {
+        // Not an event.
+        S9sRpcReply reply;
+
+        reply = jsonMessage;
+        follower->replyCallback(reply);
+    } else {
+        S9sEvent event = jsonMessage;
+
+        follower->eventCallback(event);
+    }
+}
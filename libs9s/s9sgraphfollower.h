@@ -0,0 +1,76 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sdisplay.h"
+#include "s9srpcclient.h"
+#include "s9srpcreply.h"
+#include "s9scmongraph.h"
+#include "s9seventfilter.h"
+#include "s9svector.h"
+
+/**
+ * The view of "s9s node --stat --graph=... --follow": the graphs are created
+ * from the statistics of the last hour, then they are switched to live mode
+ * and the samples coming in the measurement events are added to them as they
+ * arrive. Every new sample updates only the last column of the graph it
+ * belongs to and the screen is painted through the differential renderer of
+ * the display, so only the characters that are changed are sent to the
+ * terminal.
+ */
+class S9sGraphFollower :
+    public S9sDisplay
+{
+    public:
+        S9sGraphFollower(S9sRpcClient &client);
+        virtual ~S9sGraphFollower();
+
+        void addGraph(S9sCmonGraph *graph);
+        int nGraphs() const;
+
+        void main();
+        bool processEvent(const S9sEvent &event);
+
+        ulonglong nEvents() const;
+        ulonglong nSamples() const;
+
+        static S9sVariantList measurementSamples(const S9sEvent &event);
+
+    protected:
+        virtual bool refreshScreen();
+        virtual void printHeader();
+        virtual void printFooter();
+
+    private:
+        void eventCallback(const S9sEvent &event);
+        void replyCallback(const S9sRpcReply &reply);
+
+        static void eventHandler(
+                const S9sVariantMap &jsonMessage,
+                void                *userData);
+
+    private:
+        S9sRpcClient                 &m_client;
+        S9sVector<S9sCmonGraph *>     m_graphs;
+        S9sEventFilter                m_eventFilter;
+        S9sRpcReply                   m_lastReply;
+        ulonglong                     m_nEvents;
+        ulonglong                     m_nSamples;
+};
@@ -208,7 +208,7 @@ S9sInfoPanel::printLine(
     const char *selection = "\033[1m\033[48;5;51m" "\033[2m\033[38;5;237m";
 
     m_nChars = 0;
-    ::printf("%s", normal);
+    s9s_printf("%s", normal);
     if (lineIndex == 0)
     {
         // The top frame line.
@@ -307,12 +307,12 @@ S9sInfoPanel::printLine(
             printChar("─", titleStart);
             
             if (hasFocus())
-                ::printf("%s", selection);
+                s9s_printf("%s", selection);
 
             printString(title);
             
             if (hasFocus())
-                ::printf("%s%s", TERM_NORMAL, normal);
+                s9s_printf("%s%s", TERM_NORMAL, normal);
         }
 
         printChar("─", width() - 1);
@@ -620,10 +620,10 @@ S9sInfoPanel::printString(
     if ((int)asciiString.length() > availableChars)
     {
         asciiString.resize(availableChars);
-        ::printf("%s", STR(asciiString));
+        s9s_printf("%s", STR(asciiString));
     } else {
-        ::printf("%s", STR(colorString));
-        ::printf("%s", normal);
+        s9s_printf("%s", STR(colorString));
+        s9s_printf("%s", normal);
     }
 
     m_nChars += asciiString.length();
@@ -639,12 +639,12 @@ S9sInfoPanel::printNameValue(
     S9sString   tmp;
 
     tmp.sprintf("%11s: ", STR(name));
-    ::printf("%s", STR(tmp));
+    s9s_printf("%s", STR(tmp));
     m_nChars += tmp.length();
    
-    ::printf("%s", header);
-    ::printf("%s", STR(value));
-    ::printf("%s", normal);
+    s9s_printf("%s", header);
+    s9s_printf("%s", STR(value));
+    s9s_printf("%s", normal);
     m_nChars += value.length();
 }
 
@@ -652,7 +652,7 @@ void
 S9sInfoPanel::printChar(
         int c)
 {
-    ::printf("%c", c);
+    s9s_printf("%c", c);
     ++m_nChars;
 }
 
@@ -660,7 +660,7 @@ void
 S9sInfoPanel::printChar(
         const char *c)
 {
-    ::printf("%s", c);
+    s9s_printf("%s", c);
     ++m_nChars;
 }
 
@@ -671,7 +671,7 @@ S9sInfoPanel::printChar(
 {
     while (m_nChars < lastColumn)
     {
-        ::printf("%s", c);
+        s9s_printf("%s", c);
         ++m_nChars;
     }
 }
@@ -0,0 +1,441 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9sjobwaiter.h"
+
+#include "s9sevent.h"
+#include "s9sjob.h"
+
+#include <time.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/*
+ * The polling intervals in milliseconds while the event stream works. We poll
+ * rarely, only to be safe, the events wake us up when something happens. 
+ * Without events the intervals are set by the command line options.
+ */
+#define STREAM_MIN_POLL_MS       1000
+#define STREAM_MAX_POLL_MS      10000
+
+/*
+ * How long we wait before re-subscribing when the event stream dropped.
+ */
+#define RESUBSCRIBE_MIN_MS       1000
+#define RESUBSCRIBE_MAX_MS      30000
+
+/**
+ * Adds the given milliseconds to the current time, to be used with
+ * pthread_cond_timedwait().
+ */
+static void
+deadlineAfter(
+        const int        milliseconds,
+        struct timespec &deadline)
+{
+    clock_gettime(CLOCK_REALTIME, &deadline);
+
+    deadline.tv_sec  += milliseconds / 1000;
+    deadline.tv_nsec += (milliseconds % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * \param client The client the waiting thread uses. The event stream is read
+ *   on a separate connection that uses the same session.
+ * \param jobId The ID of the job we are waiting for, -1 if the jobs are added
+ *   later using addJob().
+ */
+S9sJobWaiter::S9sJobWaiter(
+        const S9sRpcClient &client,
+        const int           jobId) :
+    m_streamClient(client.clone()),
+    m_jobId(jobId),
+    m_threadRunning(false),
+    m_stopRequested(false),
+    m_streamActive(false),
+    m_streamRefused(false),
+    m_nUpdates(0ull),
+    m_nUpdatesSeen(0ull),
+    m_nEvents(0ull),
+    m_nWakeups(0ull),
+    m_pollInterval(0),
+    m_streamSchedule(STREAM_MIN_POLL_MS, STREAM_MAX_POLL_MS),
+    m_fallbackSchedule(S9sPollScheduler::fromOptions())
+{
+    // The waiting thread decides about the exit status, the connection
+    // failures of the event stream should not change it.
+    m_streamClient.setUpdatesExitStatus(false);
+
+    if (jobId >= 0)
+        m_jobIds[jobId] = true;
+
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_condition, NULL);
+}
+
+S9sJobWaiter::~S9sJobWaiter()
+{
+    stop();
+
+    pthread_cond_destroy(&m_condition);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * Adds one more job to the jobs we are waiting for.
+ */
+void
+S9sJobWaiter::addJob(
+        const int jobId)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_jobIds[jobId] = true;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * Removes the job from the jobs we are waiting for, e.g. because it already
+ * ended. The events about the job will not wake us up any more.
+ */
+void
+S9sJobWaiter::removeJob(
+        const int jobId)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_jobIds.erase(jobId);
+    m_updatedJobs.erase(jobId);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * \returns True if the background thread that reads the event stream was
+ *   started. If not, the waiter still works, but only by polling.
+ */
+bool
+S9sJobWaiter::start()
+{
+    if (m_threadRunning)
+        return true;
+
+    m_stopRequested = false;
+    m_streamActive  = true;
+    m_threadRunning = pthread_create(
+            &m_thread, NULL, S9sJobWaiter::threadEntryPoint, this) == 0;
+
+    if (!m_threadRunning)
+    {
+        PRINT_LOG("Could not start the event thread, polling the jobs.");
+
+        m_streamActive = false;
+    }
+
+    return m_threadRunning;
+}
+
+/**
+ * Stops reading the event stream and waits for the background thread to end.
+ */
+void
+S9sJobWaiter::stop()
+{
+    if (!m_threadRunning)
+        return;
+
+    pthread_mutex_lock(&m_mutex);
+    m_stopRequested = true;
+    pthread_cond_broadcast(&m_condition);
+    pthread_mutex_unlock(&m_mutex);
+
+    m_streamClient.abortEventStream();
+    pthread_join(m_thread, NULL);
+
+    m_threadRunning = false;
+    m_streamActive  = false;
+}
+
+/**
+ * \param changed True if the job changed since the last time this method was
+ *   called (e.g. new messages or a new progress value), this resets the
+ *   polling interval to the shortest value.
+ * \returns True if an event woke us up, false if the polling interval elapsed.
+ *
+ * The waiting thread calls this method between two queries to the controller,
+ * it returns when an event about the job arrives or when it is time to poll
+ * the job again.
+ */
+bool
+S9sJobWaiter::waitForUpdate(
+        const bool changed)
+{
+    struct timespec deadline;
+    bool            retval = false;
+    int             result = 0;
+
+    pthread_mutex_lock(&m_mutex);
+
+    if (m_streamActive)
+        m_pollInterval = m_streamSchedule.nextDelay(changed);
+    else
+        m_pollInterval = m_fallbackSchedule.nextDelay(changed);
+
+    deadlineAfter(m_pollInterval, deadline);
+    while (m_nUpdates == m_nUpdatesSeen && result == 0)
+    {
+        result = pthread_cond_timedwait(&m_condition, &m_mutex, &deadline);
+    }
+
+    if (m_nUpdates != m_nUpdatesSeen)
+    {
+        m_nUpdatesSeen = m_nUpdates;
+        ++m_nWakeups;
+        retval = true;
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+    return retval;
+}
+
+/**
+ * \param milliseconds The delay the controller asked for before the next
+ *   poll (see S9sRpcClient::pollIntervalHint()), -1 if there is none.
+ *
+ * The next waitForUpdate() will not poll sooner than the controller asked,
+ * but an event about the job still wakes it up.
+ */
+void
+S9sJobWaiter::setPollHint(
+        const int milliseconds)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_streamSchedule.setHint(milliseconds);
+    m_fallbackSchedule.setHint(milliseconds);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * \returns The IDs of the jobs that had events since the last call. The list
+ *   is empty if we were woken up because the event stream ended, in this case
+ *   all the jobs should be checked.
+ */
+S9sVector<int>
+S9sJobWaiter::updatedJobs()
+{
+    S9sVector<int> retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_updatedJobs.keys();
+    m_updatedJobs.clear();
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * \returns True if we are subscribed to the event stream (or at least trying
+ *   to subscribe).
+ */
+bool
+S9sJobWaiter::isStreamActive() const
+{
+    return m_streamActive;
+}
+
+/**
+ * \returns The polling interval in milliseconds used by the last
+ *   waitForUpdate() call.
+ */
+int
+S9sJobWaiter::pollInterval() const
+{
+    return m_pollInterval;
+}
+
+int
+S9sJobWaiter::jobId() const
+{
+    return m_jobId;
+}
+
+/**
+ * \returns How many events about the job were received.
+ */
+ulonglong
+S9sJobWaiter::nEvents() const
+{
+    return m_nEvents;
+}
+
+/**
+ * \returns How many times an event woke up the waiting thread.
+ */
+ulonglong
+S9sJobWaiter::nWakeups() const
+{
+    return m_nWakeups;
+}
+
+/**
+ * The main loop of the background thread. Subscribes to the events and
+ * re-subscribes with a growing delay if the stream drops.
+ */
+void
+S9sJobWaiter::exec()
+{
+    int             delay = RESUBSCRIBE_MIN_MS;
+    struct timespec deadline;
+    ulonglong       nEvents;
+    uint            nJobs;
+    bool            success;
+    S9sRpcReply     reply;
+
+    pthread_mutex_lock(&m_mutex);
+    while (!m_stopRequested && !m_streamRefused)
+    {
+        m_streamActive = true;
+        nEvents        = m_nEvents;
+        nJobs          = m_jobIds.size();
+        pthread_mutex_unlock(&m_mutex);
+
+        PRINT_LOG("Subscribing to events to wait for %u job(s).", nJobs);
+        success = m_streamClient.subscribeEvents(
+                S9sJobWaiter::eventHandler, this);
+
+        // If we got a normal reply instead of a stream the controller refused
+        // to send the events.
+        reply = m_streamClient.reply();
+        if (success && !reply.empty() && !reply.isOk())
+            replyCallback(reply);
+
+        pthread_mutex_lock(&m_mutex);
+        m_streamActive = false;
+        if (m_stopRequested)
+            break;
+
+        // We might have missed some events, the waiting thread should check
+        // the job now.
+        ++m_nUpdates;
+        pthread_cond_broadcast(&m_condition);
+
+        PRINT_LOG("Event stream ended: %s", 
+                STR(m_streamClient.errorString()));
+
+        if (m_streamRefused)
+            break;
+
+        if (m_nEvents != nEvents)
+            delay = RESUBSCRIBE_MIN_MS;
+
+        deadlineAfter(delay, deadline);
+        while (!m_stopRequested)
+        {
+            if (pthread_cond_timedwait(&m_condition, &m_mutex, &deadline) != 0)
+                break;
+        }
+
+        delay *= 2;
+        if (delay > RESUBSCRIBE_MAX_MS)
+            delay = RESUBSCRIBE_MAX_MS;
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * Called by the background thread for every event in the stream.
+ */
+void
+S9sJobWaiter::eventCallback(
+        const S9sEvent &event)
+{
+    int jobId;
+
+    if (event.eventType() != S9sEvent::EventJob)
+        return;
+
+    jobId = event.jobId();
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_jobIds.contains(jobId))
+    {
+        m_updatedJobs[jobId] = true;
+        ++m_nEvents;
+        ++m_nUpdates;
+        pthread_cond_broadcast(&m_condition);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * Called by the background thread when the controller sends a reply instead
+ * of events, e.g. because the authentication is needed or because the
+ * controller does not support the events.
+ */
+void
+S9sJobWaiter::replyCallback(
+        const S9sRpcReply &reply)
+{
+    if (reply.isOk())
+        return;
+
+    PRINT_LOG("Event stream is not available: %s", 
+            STR(reply.errorString()));
+
+    pthread_mutex_lock(&m_mutex);
+    m_streamRefused = true;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void
+S9sJobWaiter::eventHandler(
+        const S9sVariantMap &jsonMessage,
+        void                *userData)
+{
+    S9sJobWaiter *waiter = (S9sJobWaiter *) userData;
+
+    if (!jsonMessage.contains("class_name") ||
+            jsonMessage.at("class_name").toString() != "CmonEvent")
+    {
+        S9sRpcReply reply;
+       
+        reply = jsonMessage;
+        waiter->replyCallback(reply);
+    } else {
+        S9sEvent event = jsonMessage;
+
+        waiter->eventCallback(event);
+    }
+}
+
+void *
+S9sJobWaiter::threadEntryPoint(
+        void *pointer)
+{
+    S9sJobWaiter *self = (S9sJobWaiter *) pointer;
+
+    self->exec();
+    return NULL;
+}
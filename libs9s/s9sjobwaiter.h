@@ -0,0 +1,111 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9srpcclient.h"
+#include "s9spollscheduler.h"
+#include "s9smap.h"
+#include "s9svector.h"
+#include "s9sglobal.h"
+
+#include <pthread.h>
+
+class S9sEvent;
+
+/**
+ * A helper to wait for a job without polling the controller every second. A
+ * background thread subscribes to the event stream of the controller and
+ * wakes up the waiting thread as soon as an event about the job arrives (the
+ * job changed or got a new message), so the job is queried right after
+ * something happened. When there are no events the job is polled with an
+ * interval that grows while nothing changes. If the event stream is not
+ * available or it drops the polling is done by the S9sPollScheduler set up by
+ * the command line options: fast while the job changes, slower while it is
+ * idle.
+ *
+ * One waiter can watch several jobs, the waiting thread can ask which jobs had
+ * events since it last checked.
+ */
+class S9sJobWaiter
+{
+    public:
+        S9sJobWaiter(
+                const S9sRpcClient &client,
+                const int           jobId);
+
+        virtual ~S9sJobWaiter();
+
+        void addJob(const int jobId);
+        void removeJob(const int jobId);
+
+        bool start();
+        void stop();
+
+        bool waitForUpdate(const bool changed);
+        void setPollHint(const int milliseconds);
+        S9sVector<int> updatedJobs();
+
+        bool isStreamActive() const;
+        int pollInterval() const;
+        int jobId() const;
+
+        ulonglong nEvents() const;
+        ulonglong nWakeups() const;
+
+    private:
+        void exec();
+        void eventCallback(const S9sEvent &event);
+        void replyCallback(const S9sRpcReply &reply);
+
+        static void eventHandler(
+                const S9sVariantMap &jsonMessage,
+                void                *userData);
+
+        static void *threadEntryPoint(void *pointer);
+
+    private:
+        S9sRpcClient       m_streamClient;
+        int                m_jobId;
+        /** The IDs of the jobs we wait for. */
+        S9sMap<int, bool>  m_jobIds;
+        /** The jobs that had events since updatedJobs() was last called. */
+        S9sMap<int, bool>  m_updatedJobs;
+
+        pthread_t          m_thread;
+        pthread_mutex_t    m_mutex;
+        pthread_cond_t     m_condition;
+        bool               m_threadRunning;
+        bool               m_stopRequested;
+        bool               m_streamActive;
+        /** The controller does not give us an event stream, we don't retry. */
+        bool               m_streamRefused;
+
+        /** Incremented when an event about the job arrived. */
+        ulonglong          m_nUpdates;
+        /** The value of m_nUpdates the waiting thread already handled. */
+        ulonglong          m_nUpdatesSeen;
+        ulonglong          m_nEvents;
+        ulonglong          m_nWakeups;
+        int                m_pollInterval;
+        /** The polling schedule while the events wake us up. */
+        S9sPollScheduler   m_streamSchedule;
+        /** The polling schedule without the events. */
+        S9sPollScheduler   m_fallbackSchedule;
+};
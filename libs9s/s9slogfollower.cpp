@@ -0,0 +1,438 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9slogfollower.h"
+
+#include "s9smessage.h"
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/**
+ * \param client The client the follower uses to get the log entries. The
+ *   prefetching uses a separate connection with the same session.
+ * \param pageSize How many log entries are requested at once.
+ */
+S9sLogFollower::S9sLogFollower(
+        const S9sRpcClient &client,
+        const int           pageSize) :
+    m_client(client),
+    m_prefetchClient(client.clone()),
+    m_pageSize(pageSize > 0 ? pageSize : 500),
+    m_lastCreatedParsed(false),
+    m_lastMessageId(-1),
+    m_offset(0),
+    m_hasMore(false),
+    m_prefetchRunning(false),
+    m_prefetchOffset(0),
+    m_prefetchSuccess(false),
+    m_nRequests(0ull),
+    m_nReceived(0ull),
+    m_nDuplicates(0ull)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    m_prefetchClient.setUpdatesExitStatus(false);
+}
+
+S9sLogFollower::~S9sLogFollower()
+{
+    S9sRpcReply reply;
+
+    finishPrefetch(reply);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * Sets the high-water mark, only the entries created after this time will be
+ * returned.
+ */
+void
+S9sLogFollower::setCreatedAfter(
+        const S9sString &created)
+{
+    m_lastCreated       = created;
+    m_lastCreatedParsed = m_lastCreatedTime.parse(created);
+    m_boundaryIds.clear();
+    m_offset            = 0;
+}
+
+/**
+ * \param nEntries How many of the most recent entries we need.
+ * \param entries The entries in chronological order.
+ * \returns True if the request was successful.
+ *
+ * Gets the last few log entries, the way "tail -f" starts. The high-water
+ * mark is set to the newest entry returned.
+ */
+bool
+S9sLogFollower::fetchTail(
+        const int       nEntries,
+        S9sVariantList &entries)
+{
+    S9sVariantList page;
+    bool           success;
+
+    entries.clear();
+
+    pthread_mutex_lock(&m_mutex);
+    ++m_nRequests;
+    pthread_mutex_unlock(&m_mutex);
+
+    success = m_client.getLogEntries("", nEntries, 0, false, false);
+    if (success)
+    {
+        S9sRpcReply reply = m_client.reply();
+
+        success = reply.isOk();
+        if (success)
+            page = reply["log_entries"].toVariantList();
+        else
+            m_errorString = reply.errorString();
+    } else {
+        m_errorString = m_client.errorString();
+    }
+
+    if (!success)
+        return false;
+
+    // The controller sends the most recent first.
+    for (uint idx = page.size(); idx > 0u; --idx)
+        entries << page[idx - 1];
+
+    m_nReceived += entries.size();
+    entries      = acceptPage(entries);
+    m_hasMore    = false;
+
+    return true;
+}
+
+/**
+ * \param entries The new entries in chronological order, can be empty.
+ * \returns True if the request was successful.
+ *
+ * Gets the log entries created after the high-water mark and moves the mark.
+ * If the page was full the next page is requested in the background right
+ * away, the next call will not have to wait for it.
+ */
+bool
+S9sLogFollower::fetchPage(
+        S9sVariantList &entries)
+{
+    S9sRpcReply    reply;
+    S9sVariantList page;
+    bool           success;
+
+    entries.clear();
+
+    if (m_prefetchRunning)
+    {
+        success = finishPrefetch(reply);
+    } else {
+        success = authenticate() && requestPage(
+                m_client, m_lastCreated, m_offset, reply, m_errorString);
+    }
+
+    if (!success)
+    {
+        m_hasMore = false;
+        return false;
+    }
+
+    page         = reply["log_entries"].toVariantList();
+    m_nReceived += page.size();
+    m_hasMore    = (int) page.size() >= m_pageSize;
+    entries      = acceptPage(page);
+
+    /*
+     * If a full page had nothing new in it (many entries created at the same
+     * time) we skip it, otherwise we would get the same page again.
+     */
+    if (m_hasMore && entries.empty())
+        m_offset += m_pageSize;
+
+    if (m_hasMore)
+        startPrefetch();
+
+    return true;
+}
+
+/**
+ * \returns True if the last page was full, so there are probably more entries
+ *   to get right away.
+ */
+bool
+S9sLogFollower::hasMore() const
+{
+    return m_hasMore;
+}
+
+/**
+ * \param page The log entries in chronological order as they came from the
+ *   controller.
+ * \returns The entries that were not returned before.
+ *
+ * Drops the entries that are older than the high-water mark or that are at
+ * the mark and were already returned, then moves the mark.
+ */
+S9sVariantList
+S9sLogFollower::acceptPage(
+        const S9sVariantList &page)
+{
+    S9sVariantList retval;
+
+    for (uint idx = 0u; idx < page.size(); ++idx)
+    {
+        S9sVariantMap entry     = page[idx].toVariantMap();
+        S9sMessage    message   = entry;
+        S9sString     created   = entry["created"].toString();
+        int           messageId = message.messageId();
+        int           order     = compareToMark(created);
+
+        if (order < 0)
+        {
+            ++m_nDuplicates;
+            continue;
+        }
+
+        if (order == 0 && m_boundaryIds.contains(messageId))
+        {
+            ++m_nDuplicates;
+            continue;
+        }
+
+        if (order > 0)
+        {
+            m_lastCreated       = created;
+            m_lastCreatedParsed = m_lastCreatedTime.parse(created);
+            m_boundaryIds.clear();
+            m_offset            = 0;
+        }
+
+        m_boundaryIds[messageId] = true;
+        m_lastMessageId          = messageId;
+        retval << entry;
+    }
+
+    return retval;
+}
+
+/**
+ * \returns The creation time of the newest entry returned.
+ */
+S9sString
+S9sLogFollower::lastCreated() const
+{
+    return m_lastCreated;
+}
+
+/**
+ * \returns The ID of the newest entry returned or -1.
+ */
+int
+S9sLogFollower::lastMessageId() const
+{
+    return m_lastMessageId;
+}
+
+S9sString
+S9sLogFollower::errorString() const
+{
+    return m_errorString;
+}
+
+/**
+ * \returns How many requests were sent to the controller.
+ */
+ulonglong
+S9sLogFollower::nRequests() const
+{
+    ulonglong retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_nRequests;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * \returns How many log entries were received, including the duplicates.
+ */
+ulonglong
+S9sLogFollower::nReceived() const
+{
+    return m_nReceived;
+}
+
+/**
+ * \returns How many log entries were dropped because they were already
+ *   returned.
+ */
+ulonglong
+S9sLogFollower::nDuplicates() const
+{
+    return m_nDuplicates;
+}
+
+/**
+ * The session might expire while we follow the log, so we log in again the
+ * way the graph follower does. The prefetching connection gets the new
+ * session too.
+ */
+bool
+S9sLogFollower::authenticate()
+{
+    if (!m_client.isAuthenticated() && !m_client.maybeAuthenticate())
+    {
+        m_errorString = m_client.errorString();
+        if (m_errorString.empty())
+            m_errorString = "Access denied.";
+
+        return false;
+    }
+
+    if (m_client.isAuthenticated() && !m_prefetchClient.isAuthenticated())
+    {
+        m_prefetchClient = m_client.clone();
+        m_prefetchClient.setUpdatesExitStatus(false);
+    }
+
+    return true;
+}
+
+/**
+ * \param created The creation time of a log entry as the controller sent it.
+ * \returns Negative, zero or positive if the entry was created before, at or
+ *   after the high-water mark.
+ *
+ * The times are compared parsed, the mark might come from the --from option
+ * in an other format. If one of them can not be parsed the strings are
+ * compared.
+ */
+int
+S9sLogFollower::compareToMark(
+        const S9sString &created) const
+{
+    S9sDateTime time;
+
+    if (m_lastCreated.empty())
+        return 1;
+
+    if (m_lastCreatedParsed && time.parse(created))
+    {
+        if (time < m_lastCreatedTime)
+            return -1;
+
+        return time == m_lastCreatedTime ? 0 : 1;
+    }
+
+    return created.compare(m_lastCreated);
+}
+
+bool
+S9sLogFollower::requestPage(
+        S9sRpcClient    &client,
+        const S9sString &createdAfter,
+        const int        offset,
+        S9sRpcReply     &reply,
+        S9sString       &errorString)
+{
+    bool success;
+
+    // Called from the prefetch thread too.
+    pthread_mutex_lock(&m_mutex);
+    ++m_nRequests;
+    pthread_mutex_unlock(&m_mutex);
+
+    success = client.getLogEntries(
+            createdAfter, m_pageSize, offset, true, false);
+
+    if (success)
+    {
+        reply   = client.reply();
+        success = reply.isOk();
+
+        if (!success)
+            errorString = reply.errorString();
+    } else {
+        errorString = client.errorString();
+    }
+
+    return success;
+}
+
+/**
+ * Starts getting the next page in the background.
+ */
+void
+S9sLogFollower::startPrefetch()
+{
+    if (m_prefetchRunning)
+        return;
+
+    m_prefetchCreatedAfter = m_lastCreated;
+    m_prefetchOffset       = m_offset;
+    m_prefetchReply        = S9sRpcReply();
+    m_prefetchSuccess      = false;
+    m_prefetchError.clear();
+
+    m_prefetchRunning = pthread_create(
+            &m_prefetchThread, NULL, 
+            S9sLogFollower::prefetchEntryPoint, this) == 0;
+
+    if (!m_prefetchRunning)
+        PRINT_LOG("Could not start the prefetch thread.");
+}
+
+/**
+ * Waits for the background request to end and gets its reply.
+ */
+bool
+S9sLogFollower::finishPrefetch(
+        S9sRpcReply &reply)
+{
+    if (!m_prefetchRunning)
+        return false;
+
+    pthread_join(m_prefetchThread, NULL);
+    m_prefetchRunning = false;
+
+    reply = m_prefetchReply;
+    if (!m_prefetchSuccess)
+        m_errorString = m_prefetchError;
+
+    return m_prefetchSuccess;
+}
+
+void *
+S9sLogFollower::prefetchEntryPoint(
+        void *pointer)
+{
+    S9sLogFollower *follower = (S9sLogFollower *) pointer;
+
+    follower->m_prefetchSuccess = follower->requestPage(
+            follower->m_prefetchClient, 
+            follower->m_prefetchCreatedAfter,
+            follower->m_prefetchOffset,
+            follower->m_prefetchReply,
+            follower->m_prefetchError);
+
+    return NULL;
+}
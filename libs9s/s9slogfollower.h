@@ -0,0 +1,113 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9srpcclient.h"
+#include "s9srpcreply.h"
+#include "s9sdatetime.h"
+#include "s9svariantlist.h"
+#include "s9smap.h"
+#include "s9sglobal.h"
+
+#include <pthread.h>
+
+/**
+ * Follows the log of the controller ("s9s log --follow") without re-reading
+ * the same log entries over and over again. The follower keeps a high-water
+ * mark (the creation time and the IDs of the newest entries it already
+ * returned) and asks the controller only for the entries created after it.
+ * The entries at the boundary might be sent again, these are dropped. When a
+ * page is full there are probably more entries waiting, so the next page is
+ * requested in the background on a separate connection while the caller
+ * prints the current one.
+ */
+class S9sLogFollower
+{
+    public:
+        S9sLogFollower(
+                const S9sRpcClient &client,
+                const int           pageSize = 500);
+
+        virtual ~S9sLogFollower();
+
+        void setCreatedAfter(const S9sString &created);
+
+        bool fetchTail(const int nEntries, S9sVariantList &entries);
+        bool fetchPage(S9sVariantList &entries);
+        bool hasMore() const;
+
+        S9sVariantList acceptPage(const S9sVariantList &page);
+
+        S9sString lastCreated() const;
+        int lastMessageId() const;
+        S9sString errorString() const;
+
+        ulonglong nRequests() const;
+        ulonglong nReceived() const;
+        ulonglong nDuplicates() const;
+
+    private:
+        bool authenticate();
+        int compareToMark(const S9sString &created) const;
+
+        bool requestPage(
+                S9sRpcClient    &client,
+                const S9sString &createdAfter,
+                const int        offset,
+                S9sRpcReply     &reply,
+                S9sString       &errorString);
+
+        void startPrefetch();
+        bool finishPrefetch(S9sRpcReply &reply);
+
+        static void *prefetchEntryPoint(void *pointer);
+
+    private:
+        S9sRpcClient       m_client;
+        S9sRpcClient       m_prefetchClient;
+        int                m_pageSize;
+
+        /** The creation time of the newest entry we returned. */
+        S9sString          m_lastCreated;
+        /** The m_lastCreated parsed, the entries are compared to this. */
+        S9sDateTime        m_lastCreatedTime;
+        bool               m_lastCreatedParsed;
+        /** The IDs of the entries returned with m_lastCreated. */
+        S9sMap<int, bool>  m_boundaryIds;
+        int                m_lastMessageId;
+        /** Skipping this many entries when a full page was already seen. */
+        int                m_offset;
+        bool               m_hasMore;
+        S9sString          m_errorString;
+
+        pthread_t          m_prefetchThread;
+        bool               m_prefetchRunning;
+        S9sString          m_prefetchCreatedAfter;
+        int                m_prefetchOffset;
+        S9sRpcReply        m_prefetchReply;
+        bool               m_prefetchSuccess;
+        S9sString          m_prefetchError;
+
+        /** Protects m_nRequests, the prefetch thread counts too. */
+        mutable pthread_mutex_t  m_mutex;
+        ulonglong          m_nRequests;
+        ulonglong          m_nReceived;
+        ulonglong          m_nDuplicates;
+};
@@ -0,0 +1,571 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9slogwriter.h"
+
+#include "s9sdatetime.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/**
+ * How long the background thread waits for more lines to arrive before it
+ * writes what it has in the buffer, in milliseconds.
+ */
+#define FLUSH_DELAY_MS 50
+
+S9sLogWriter *S9sLogWriter::sm_instance = NULL;
+
+S9sLogWriter::S9sLogWriter(
+        size_t capacity) :
+    m_file(NULL),
+    m_fileSize(0ull),
+    m_maxSize(0ull),
+    m_nFiles(5),
+    m_level(LogDebug),
+    m_buffer(NULL),
+    m_capacity(capacity > 0 ? capacity : 1),
+    m_head(0),
+    m_used(0),
+    m_threadRunning(false),
+    m_stopRequested(false),
+    m_busy(false),
+    m_nLines(0ull),
+    m_nRotations(0ull),
+    m_timeStringTime(0)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_dataCondition, NULL);
+    pthread_cond_init(&m_spaceCondition, NULL);
+}
+
+S9sLogWriter::~S9sLogWriter()
+{
+    close();
+
+    if (sm_instance == this)
+        sm_instance = NULL;
+
+    free(m_buffer);
+    pthread_cond_destroy(&m_spaceCondition);
+    pthread_cond_destroy(&m_dataCondition);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+/**
+ * \returns The log writer used by the PRINT_LOG() macros. The instance is
+ *   never destroyed, an exit handler makes sure everything is written to the
+ *   file when the program exits.
+ */
+S9sLogWriter *
+S9sLogWriter::instance()
+{
+    if (sm_instance == NULL)
+        sm_instance = new S9sLogWriter;
+
+    return sm_instance;
+}
+
+/**
+ * \param path The path of the log file, the lines are appended to it.
+ * \param maxSize The file is rotated when it grows bigger than this many
+ *   bytes, 0 means no rotation.
+ * \param nFiles How many rotated files (path.1, path.2, ...) are kept.
+ * \returns True if the file was opened.
+ *
+ * Opens the log file and starts the background thread that writes into it. If
+ * the thread can not be started the lines are written synchronously.
+ */
+bool
+S9sLogWriter::open(
+        const S9sString &path,
+        ulonglong        maxSize,
+        int              nFiles)
+{
+    static bool atExitRegistered = false;
+
+    close();
+
+    pthread_mutex_lock(&m_mutex);
+    m_file = fopen(STR(path), "a");
+    if (m_file == NULL)
+    {
+        pthread_mutex_unlock(&m_mutex);
+        return false;
+    }
+
+    m_path          = path;
+    m_fileSize      = ftell(m_file);
+    m_maxSize       = maxSize;
+    m_nFiles        = nFiles < 0 ? 0 : nFiles;
+    m_head          = 0;
+    m_used          = 0;
+    m_stopRequested = false;
+
+    if (m_buffer == NULL)
+        m_buffer = (char *) malloc(m_capacity);
+
+    m_threadRunning = m_buffer != NULL && pthread_create(
+            &m_thread, NULL, S9sLogWriter::threadEntryPoint, this) == 0;
+
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!atExitRegistered)
+    {
+        atExitRegistered = true;
+        atexit(S9sLogWriter::atExitHandler);
+    }
+
+    return true;
+}
+
+/**
+ * Writes all the buffered lines into the file, stops the background thread
+ * and closes the file.
+ */
+void
+S9sLogWriter::close()
+{
+    pthread_mutex_lock(&m_mutex);
+    if (m_file == NULL && !m_threadRunning)
+    {
+        pthread_mutex_unlock(&m_mutex);
+        return;
+    }
+
+    if (m_threadRunning)
+    {
+        m_stopRequested = true;
+        pthread_cond_signal(&m_dataCondition);
+        pthread_mutex_unlock(&m_mutex);
+
+        pthread_join(m_thread, NULL);
+
+        pthread_mutex_lock(&m_mutex);
+        m_threadRunning = false;
+        m_stopRequested = false;
+        pthread_cond_broadcast(&m_spaceCondition);
+    }
+
+    if (m_file != NULL)
+    {
+        fclose(m_file);
+        m_file = NULL;
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool
+S9sLogWriter::isOpen() const
+{
+    bool retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_file != NULL;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+S9sString
+S9sLogWriter::path() const
+{
+    return m_path;
+}
+
+void
+S9sLogWriter::setLevel(
+        const S9sLogLevel level)
+{
+    m_level = level;
+}
+
+S9sLogLevel
+S9sLogWriter::level() const
+{
+    return m_level;
+}
+
+/**
+ * \returns True if the file is open and lines with the given severity should
+ *   be written into it. This is cheap, the callers can use it to avoid
+ *   formatting lines that are going to be dropped anyway.
+ */
+bool
+S9sLogWriter::isEnabled(
+        const S9sLogLevel level) const
+{
+    bool retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_file != NULL && level >= m_level;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+/**
+ * Formats one line with the time, the source location and the severity and
+ * puts it into the buffer. This is called by the PRINT_LOG() macros.
+ */
+void
+S9sLogWriter::write(
+        const S9sLogLevel  level,
+        const char        *file,
+        const int          line,
+        const S9sString   &message)
+{
+    S9sString logLine;
+    S9sString timeString;
+    time_t    now;
+
+    if (!isEnabled(level))
+        return;
+
+    // Formatting the date and time is expensive, it changes only once a
+    // second.
+    now = time(NULL);
+    pthread_mutex_lock(&m_mutex);
+    if (now != m_timeStringTime)
+    {
+        m_timeString     = S9S_TIME_T(now);
+        m_timeStringTime = now;
+    }
+
+    timeString = m_timeString;
+    pthread_mutex_unlock(&m_mutex);
+
+    logLine.sprintf("%s %20s:%5d %s %s\n", 
+            STR(timeString), file, line, levelName(level), STR(message));
+
+    append(logLine.c_str(), logLine.length());
+}
+
+/**
+ * Waits until everything that was put into the buffer so far is written into
+ * the file and the file is flushed.
+ */
+void
+S9sLogWriter::flush()
+{
+    pthread_mutex_lock(&m_mutex);
+    if (m_threadRunning)
+    {
+        pthread_cond_signal(&m_dataCondition);
+        while (m_used > 0 || m_busy)
+            pthread_cond_wait(&m_spaceCondition, &m_mutex);
+    } else if (m_file != NULL)
+    {
+        fflush(m_file);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * \returns How many lines were accepted since the writer was created.
+ */
+ulonglong
+S9sLogWriter::nLines() const
+{
+    return m_nLines;
+}
+
+/**
+ * \returns How many times the log file was rotated.
+ */
+ulonglong
+S9sLogWriter::nRotations() const
+{
+    return m_nRotations;
+}
+
+const char *
+S9sLogWriter::levelName(
+        const S9sLogLevel level)
+{
+    switch (level)
+    {
+        case LogDebug:
+            return "DEBUG";
+
+        case LogInfo:
+            return "INFO";
+
+        case LogWarning:
+            return "WARNING";
+
+        case LogError:
+            return "ERROR";
+    }
+
+    return "DEBUG";
+}
+
+/**
+ * \param name The name of the level as in the log_level configuration
+ *   variable (e.g. "debug", "warning").
+ * \param level The place where the level is returned.
+ * \returns True if the name was recognized.
+ */
+bool
+S9sLogWriter::levelFromString(
+        const S9sString &name,
+        S9sLogLevel     &level)
+{
+    S9sString lower = name.trim().toLower();
+
+    if (lower == "debug")
+        level = LogDebug;
+    else if (lower == "info")
+        level = LogInfo;
+    else if (lower == "warning" || lower == "warn")
+        level = LogWarning;
+    else if (lower == "error")
+        level = LogError;
+    else
+        return false;
+
+    return true;
+}
+
+/**
+ * Copies the data into the ring buffer. The lock is held only while the bytes
+ * are copied, the file operations are done by the background thread. If the
+ * buffer is full the caller waits until the background thread makes room. A
+ * line that does not fit into the buffer at all is written into the file
+ * directly when the background thread emptied the buffer, so it is not cut
+ * and the order of the lines is kept.
+ */
+void
+S9sLogWriter::append(
+        const char *data,
+        size_t      length)
+{
+    pthread_mutex_lock(&m_mutex);
+    if (m_file == NULL || m_stopRequested)
+    {
+        pthread_mutex_unlock(&m_mutex);
+        return;
+    }
+
+    if (!m_threadRunning)
+    {
+        fwrite(data, 1, length, m_file);
+        fflush(m_file);
+        m_fileSize += length;
+        ++m_nLines;
+
+        if (m_maxSize > 0ull && m_fileSize >= m_maxSize)
+            rotate();
+
+        pthread_mutex_unlock(&m_mutex);
+        return;
+    }
+
+    if (length > m_capacity)
+    {
+        while ((m_used > 0 || m_busy) && m_threadRunning && !m_stopRequested)
+        {
+            pthread_cond_signal(&m_dataCondition);
+            pthread_cond_wait(&m_spaceCondition, &m_mutex);
+        }
+
+        if (m_used == 0 && !m_busy && !m_stopRequested && m_file != NULL)
+        {
+            fwrite(data, 1, length, m_file);
+            fflush(m_file);
+            m_fileSize += length;
+            ++m_nLines;
+
+            if (m_maxSize > 0ull && m_fileSize >= m_maxSize)
+                rotate();
+        }
+
+        pthread_mutex_unlock(&m_mutex);
+        return;
+    }
+
+    while (m_capacity - m_used < length && m_threadRunning && !m_stopRequested)
+    {
+        pthread_cond_signal(&m_dataCondition);
+        pthread_cond_wait(&m_spaceCondition, &m_mutex);
+    }
+
+    if (m_capacity - m_used >= length && !m_stopRequested)
+    {
+        bool   wasEmpty = m_used == 0;
+        size_t first    = m_capacity - m_head;
+
+        if (first > length)
+            first = length;
+
+        memcpy(m_buffer + m_head, data, first);
+        memcpy(m_buffer, data + first, length - first);
+
+        m_head  = (m_head + length) % m_capacity;
+        m_used += length;
+        ++m_nLines;
+
+        if (wasEmpty || m_used >= m_capacity / 2)
+            pthread_cond_signal(&m_dataCondition);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+/**
+ * Renames path.N-1 to path.N, ..., path to path.1 and opens a new, empty log
+ * file. Called with the mutex locked or from the background thread. If no
+ * file can be opened the logging is disabled, the error is reported only
+ * this once.
+ */
+void
+S9sLogWriter::rotate()
+{
+    fclose(m_file);
+
+    if (m_nFiles > 0)
+    {
+        for (int idx = m_nFiles - 1; idx > 0; --idx)
+        {
+            S9sString from, to;
+
+            from.sprintf("%s.%d", STR(m_path), idx);
+            to.sprintf("%s.%d", STR(m_path), idx + 1);
+            rename(STR(from), STR(to));
+        }
+
+        rename(STR(m_path), STR(m_path + ".1"));
+        m_file = fopen(STR(m_path), "a");
+    } else {
+        m_file = fopen(STR(m_path), "w");
+    }
+
+    m_fileSize = 0ull;
+    ++m_nRotations;
+
+    // If we can not re-create the file we keep writing into the old one.
+    if (m_file == NULL)
+        m_file = fopen(STR(m_path + ".1"), "a");
+
+    if (m_file == NULL)
+    {
+        fprintf(stderr, 
+                "Unable to open log file '%s': %s, logging is disabled.\n",
+                STR(m_path), strerror(errno));
+    }
+}
+
+/**
+ * The main loop of the background thread. It waits for lines, gives the
+ * producers a short time to add more, then writes the content of the ring
+ * buffer with as few fwrite() calls as possible.
+ */
+void
+S9sLogWriter::exec()
+{
+    pthread_mutex_lock(&m_mutex);
+
+    for (;;)
+    {
+        while (m_used == 0 && !m_stopRequested)
+            pthread_cond_wait(&m_dataCondition, &m_mutex);
+
+        if (m_used == 0 && m_stopRequested)
+            break;
+
+        if (!m_stopRequested && m_used < m_capacity / 2)
+        {
+            struct timespec deadline;
+
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += FLUSH_DELAY_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec  += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            pthread_cond_timedwait(&m_dataCondition, &m_mutex, &deadline);
+        }
+
+        m_busy = true;
+        while (m_used > 0)
+        {
+            size_t tail  = (m_head + m_capacity - m_used) % m_capacity;
+            size_t chunk = m_capacity - tail;
+
+            if (chunk > m_used)
+                chunk = m_used;
+
+            // The producers never touch the used part of the buffer, so we
+            // can write it without holding the lock. If the logging is
+            // disabled the data is dropped.
+            pthread_mutex_unlock(&m_mutex);
+            if (m_file != NULL)
+                fwrite(m_buffer + tail, 1, chunk, m_file);
+
+            pthread_mutex_lock(&m_mutex);
+
+            m_used     -= chunk;
+            m_fileSize += chunk;
+            pthread_cond_broadcast(&m_spaceCondition);
+        }
+
+        if (m_file != NULL)
+        {
+            pthread_mutex_unlock(&m_mutex);
+            fflush(m_file);
+            pthread_mutex_lock(&m_mutex);
+
+            if (m_maxSize > 0ull && m_fileSize >= m_maxSize)
+                rotate();
+        }
+
+        m_busy = false;
+        pthread_cond_broadcast(&m_spaceCondition);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void *
+S9sLogWriter::threadEntryPoint(
+        void *pointer)
+{
+    S9sLogWriter *self = (S9sLogWriter *) pointer;
+
+    self->exec();
+    return NULL;
+}
+
+void
+S9sLogWriter::atExitHandler()
+{
+    if (sm_instance != NULL)
+        sm_instance->close();
+}
@@ -0,0 +1,111 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9sglobal.h"
+#include "s9sdebug.h"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+/**
+ * A sink for the log file of the s9s program. The file is opened once and kept
+ * open, the formatted lines are copied into a ring buffer and a background
+ * thread writes them to the file in large chunks. The buffer is drained when
+ * the writer is closed or when the program exits. The file can optionally be
+ * rotated when it grows over a size limit.
+ */
+class S9sLogWriter
+{
+    public:
+        S9sLogWriter(size_t capacity = 256 * 1024);
+        virtual ~S9sLogWriter();
+
+        static S9sLogWriter *instance();
+
+        bool open(
+                const S9sString &path,
+                ulonglong        maxSize = 0ull,
+                int              nFiles  = 5);
+
+        void close();
+        bool isOpen() const;
+        S9sString path() const;
+
+        void setLevel(const S9sLogLevel level);
+        S9sLogLevel level() const;
+        bool isEnabled(const S9sLogLevel level) const;
+
+        void write(
+                const S9sLogLevel  level,
+                const char        *file,
+                const int          line,
+                const S9sString   &message);
+
+        void flush();
+
+        ulonglong nLines() const;
+        ulonglong nRotations() const;
+
+        static const char *levelName(const S9sLogLevel level);
+        static bool levelFromString(const S9sString &name, S9sLogLevel &level);
+
+    private:
+        void append(const char *data, size_t length);
+        void rotate();
+        void exec();
+
+        static void *threadEntryPoint(void *pointer);
+        static void atExitHandler();
+
+    private:
+        S9sString          m_path;
+        FILE              *m_file;
+        ulonglong          m_fileSize;
+        ulonglong          m_maxSize;
+        int                m_nFiles;
+        S9sLogLevel        m_level;
+
+        /** The ring buffer holding the lines not yet written to the file. */
+        char              *m_buffer;
+        size_t             m_capacity;
+        size_t             m_head;
+        size_t             m_used;
+
+        pthread_t          m_thread;
+        mutable pthread_mutex_t m_mutex;
+        /** Signalled when there is something to write or we should stop. */
+        pthread_cond_t     m_dataCondition;
+        /** Signalled when the background thread freed up space in the buffer. */
+        pthread_cond_t     m_spaceCondition;
+        bool               m_threadRunning;
+        bool               m_stopRequested;
+        bool               m_busy;
+
+        ulonglong          m_nLines;
+        ulonglong          m_nRotations;
+
+        S9sString          m_timeString;
+        time_t             m_timeStringTime;
+
+        static S9sLogWriter *sm_instance;
+};
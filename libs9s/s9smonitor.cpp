@@ -25,6 +25,7 @@
 #include "s9srpcreply.h"
 #include "s9smutexlocker.h"
 #include "s9sdatetime.h"
+#include "s9spollscheduler.h"
 #include "s9srpcreply.h"
 
 #include <unistd.h>
@@ -47,8 +48,19 @@ S9sMonitor::S9sMonitor(
     m_selectionIndex(0),
     m_selectionEnabled(true),
     m_leftKeyPresses(0),
-    m_rightKeyPresses(0)
+    m_rightKeyPresses(0),
+    m_eventListSequence(0ull),
+    m_eventListDebug(false),
+    m_nEventsIngested(0ull),
+    m_seekTarget(0),
+    m_inputIndexLoaded(false)
 {
+    S9sOptions *options = S9sOptions::instance();
+
+    setMaxFps(options->maxFps());
+    m_events.setCapacity(options->eventHistory());
+    m_seek = options->seek();
+
     m_nodeListWidget.setSelectionEnabled(false);
     m_nodeViewWidget.setHasFocus(true);
 
@@ -148,10 +160,45 @@ S9sMonitor::setDisplayMode(
 void
 S9sMonitor::main()
 {
+    S9sOptions *options = S9sOptions::instance();
     int    nEvents = 0;
     double millis;
     double speedFactor = 1.0;
 
+    /*
+     * The event class, name and host filters are for printing the events, the
+     * views need all of them to build their model, but all are filtered by
+     * the cluster.
+     */
+    if (m_displayMode == PrintEvents)
+        m_eventFilter = options->eventFilter();
+    else
+        m_eventFilter.setClusterId(options->clusterId());
+
+    /*
+     * The recording should have all the events, so if we record the events
+     * are not dropped before the recorder gets them.
+     */
+    if (m_outputFileName.empty())
+        m_client.setEventFilter(m_eventFilter);
+
+    if (!m_outputFileName.empty())
+    {
+        m_recorder.setSyncPolicy(options->outputFsync());
+        if (!m_recorder.open(m_outputFileName))
+        {
+            PRINT_ERROR("%s", STR(m_recorder.errorString()));
+            return;
+        }
+    }
+
+    /*
+     * Seeking before the display thread is started, so if the time is invalid
+     * we can return without leaving a thread behind that draws the screen.
+     */
+    if (hasInputFile() && !m_seek.empty() && !seekInputFile(m_seek))
+        return;
+
     start();
 
     if (hasInputFile())
@@ -159,14 +206,42 @@ S9sMonitor::main()
         S9sDateTime  prevCreated;
         S9sDateTime  thisCreated;
         S9sEvent     event;
+        time_t       position = m_seekTarget;
         bool         success;
 
         S9S_DEBUG("Has input file...");
         for (;;)
         {
-            while (m_isStopped && m_rightKeyPresses == 0)
+            while (m_isStopped && !isSeekRequested())
                 usleep(100000);
 
+            /*
+             * The left and right arrows move the play back three minutes
+             * backward and forward.
+             */
+            if (isSeekRequested())
+            {
+                int skipSeconds;
+
+                skipSeconds = (m_rightKeyPresses - m_leftKeyPresses) * 60 * 3;
+                m_leftKeyPresses  = 0;
+                m_rightKeyPresses = 0;
+
+                if (!loadInputIndex())
+                    break;
+
+                if (position == 0)
+                    position = m_inputIndex.firstTime();
+
+                position += skipSeconds;
+                if (!replayTo(position, skipSeconds >= 0))
+                    break;
+
+                nEvents = 0;
+                redraw();
+                continue;
+            }
+
             success = m_inputFile.readEvent(event);
             if (!success)
                 break;
@@ -184,59 +259,301 @@ S9sMonitor::main()
                 if (millis > 500)
                     millis = 500;
 
-                if (m_rightKeyPresses == 0)
+                if (!isSeekRequested())
                     usleep(millis * 1000);
             }
-           
-            if (m_rightKeyPresses > 0)
-            {
-                S9sMutexLocker locker(m_mutex);
-                int    skipSeconds = m_rightKeyPresses * 60 * 3;
-                time_t target = thisCreated.toTimeT() + skipSeconds;
-
-                do {
-                    processEvent(event);
-
-                    success = m_inputFile.readEvent(event);
-                    if (!success)
-                        break;
-                
-                    prevCreated = thisCreated;
-                    thisCreated = event.created();
-                    ++nEvents;
-                } while (thisCreated.toTimeT() < target);
-                
-                m_rightKeyPresses = 0;
-                refreshScreen();
-            }
-
-            while (m_isStopped && m_rightKeyPresses == 0)
-                usleep(100000);
 
             m_mutex.lock();
             processEvent(event);
             m_mutex.unlock();
             ++nEvents;
+
+            position = thisCreated.toTimeT();
         }
+
+        // The terminal is restored after the screen is not drawn any more.
+        stop();
     } else {
+        /*
+         * Reconnecting quickly if the stream was working, backing off if the
+         * controller is not available.
+         */
+        S9sPollScheduler reconnect(500, 30000, 20);
+
         while (true)
         {
+            ulonglong nReceived;
+
             while (!m_client.isAuthenticated())
             {
                 m_client.maybeAuthenticate();
 
                 if (!m_client.isAuthenticated())
-                    usleep(3000000);
+                    usleep(reconnect.nextDelay(false) * 1000);
             }
 
+            /*
+             * Events might have been created while we were not connected, we
+             * ask the controller to replay them. Whether it does is decided
+             * on the stream itself, see eventCallback().
+             */
+            if (m_resume.hasResumePoint())
+                m_resume.reconnect();
+
+            m_client.setEventResumePoint(m_resume.resumePoint());
+
+            nReceived   = m_resume.nReceived();
             m_lastReply = S9sRpcReply();
             m_client.subscribeEvents(S9sMonitor::eventHandler, (void *) this);
             m_lastReply = m_client.reply();
-            sleep(1);
+
+            usleep(reconnect.nextDelay(m_resume.nReceived() > nReceived) * 
+                    1000);
         }
     }
 }
 
+/**
+ * \param value The value of the --seek option.
+ * \returns True if the input file is ready to be played back from the given
+ *   time.
+ */
+bool
+S9sMonitor::seekInputFile(
+        const S9sString &value)
+{
+    bool    relative;
+    time_t  target;
+
+    if (!S9sEventIndex::parseSeek(value, relative, target))
+    {
+        PRINT_ERROR("Invalid time to seek to: '%s'.", STR(value));
+        return false;
+    }
+
+    if (!loadInputIndex())
+        return false;
+
+    if (relative)
+        target += m_inputIndex.firstTime();
+
+    m_seekTarget = target;
+    return replayTo(target, false);
+}
+
+/**
+ * Loads the time index (it is built if the recording has none) and the
+ * checkpoints (if the recording has them) of the input file.
+ */
+bool
+S9sMonitor::loadInputIndex()
+{
+    S9sString checkpointPath;
+
+    if (m_inputIndexLoaded)
+        return true;
+
+    if (!m_inputIndex.loadOrBuild(m_inputFileName))
+    {
+        PRINT_ERROR("%s", STR(m_inputIndex.errorString()));
+        return false;
+    }
+
+    checkpointPath = S9sEventCheckpoints::checkpointFileName(m_inputFileName);
+    if (S9sFile::fileExists(checkpointPath) && 
+            !m_inputCheckpoints.load(checkpointPath))
+    {
+        S9S_WARNING("%s", STR(m_inputCheckpoints.errorString()));
+    }
+
+    m_inputIndexLoaded = true;
+    return true;
+}
+
+/**
+ * \returns True if the user pressed the left or the right arrow to move the
+ *   play back.
+ */
+bool
+S9sMonitor::isSeekRequested() const
+{
+    return m_leftKeyPresses > 0 || m_rightKeyPresses > 0;
+}
+
+/**
+ * \param target The time the play back should continue from.
+ * \param forward True if the target is after the events already processed.
+ * \returns True if the input file is ready to be played back from the given
+ *   time.
+ *
+ * Moves the play back of the input file to the given time. If the recording
+ * has checkpoints the state is restored from the last checkpoint before the
+ * target time and only the events after the checkpoint are processed, this
+ * works backward too. Without checkpoints moving forward processes all the
+ * events up to the target time while jumping backward starts from an empty
+ * state at the event the time index points to, so the objects that did not
+ * change after that are not shown until an event about them is played back.
+ */
+bool
+S9sMonitor::replayTo(
+        const time_t target,
+        const bool   forward)
+{
+    S9sMutexLocker locker(m_mutex);
+    S9sVariantMap  snapshot;
+    S9sEvent       event;
+    off_t          offset;
+    int            index;
+    bool           restored = false;
+
+    if (!loadInputIndex())
+        return false;
+
+    /*
+     * The event list is printed from the requested time, the other views
+     * need the state.
+     */
+    index = m_inputCheckpoints.find(target);
+    if (m_displayMode != PrintEvents && index >= 0 &&
+            (!forward || 
+             m_inputCheckpoints.offset(index) > m_inputFile.tell()))
+    {
+        if (m_inputCheckpoints.read(index, snapshot))
+        {
+            restoreState(snapshot);
+            offset   = m_inputCheckpoints.offset(index);
+            restored = true;
+        } else {
+            S9S_WARNING("%s", STR(m_inputCheckpoints.errorString()));
+        }
+    }
+
+    if (!restored && (!forward || m_displayMode == PrintEvents))
+    {
+        offset = m_inputIndex.find(target);
+        if (forward && offset <= m_inputFile.tell())
+            offset = m_inputFile.tell();
+        else if (m_displayMode != PrintEvents)
+            restoreState(S9sVariantMap());
+    } else if (!restored)
+    {
+        offset = m_inputFile.tell();
+    }
+
+    if (!m_inputFile.seek(offset))
+    {
+        PRINT_ERROR("%s", STR(m_inputFile.errorString()));
+        return false;
+    }
+
+    /*
+     * Processing the events between the place we jumped to and the target
+     * time without delay.
+     */
+    for (;;)
+    {
+        offset = m_inputFile.tell();
+        if (!m_inputFile.readEvent(event))
+            break;
+
+        if (event.created().toTimeT() >= target)
+        {
+            m_inputFile.seek(offset);
+            break;
+        }
+
+        if (m_displayMode != PrintEvents)
+            processEvent(event);
+    }
+
+    return true;
+}
+
+/**
+ * Replaces the model with the objects in the snapshot of a checkpoint. The
+ * event history is dropped, it belongs to a different time.
+ */
+void
+S9sMonitor::restoreState(
+        const S9sVariantMap &snapshot)
+{
+    m_events.clear();
+    m_nodeEvents.clear();
+    m_serverEvents.clear();
+    m_jobActivity.clear();
+
+    S9sEventCheckpoints::restore(
+            snapshot, m_clusters, m_nodes, m_jobs, m_servers);
+
+    markDirty();
+}
+
+/**
+ * \param client The client to send the requests with, the event stream is
+ *   read on the connection of the main client.
+ *
+ * Refreshes the clusters, the nodes and the jobs from the controller after
+ * the event stream was interrupted and the controller could not replay the
+ * events we missed. The event list does not have a model, it is not refreshed.
+ */
+void
+S9sMonitor::resync(
+        S9sRpcClient &client)
+{
+    S9sOptions     *options = S9sOptions::instance();
+    S9sRpcReply     reply;
+    S9sVariantList  clusterList;
+    S9sVariantList  jobList;
+
+    if (m_displayMode == PrintEvents)
+        return;
+
+    if (!client.getClusters())
+        return;
+
+    reply       = client.reply();
+    clusterList = reply.clusters();
+
+    if (client.getJobInstances(options->clusterName(), options->clusterId()))
+    {
+        reply   = client.reply();
+        jobList = reply.jobs();
+    }
+
+    S9sMutexLocker locker(m_mutex);
+
+    for (uint idx = 0u; idx < clusterList.size(); ++idx)
+    {
+        S9sCluster         cluster = clusterList[idx].toVariantMap();
+        S9sVector<S9sNode> nodes   = cluster.nodes();
+
+        if (cluster.clusterId() != 0)
+            m_clusters[cluster.clusterId()] = cluster;
+
+        for (uint idx1 = 0u; idx1 < nodes.size(); ++idx1)
+            m_nodes[nodes[idx1].hostId()] = nodes[idx1];
+    }
+
+    /*
+     * We keep the jobs we know about up to date and add the ones that are
+     * not finished yet, the finished jobs we have never seen are not
+     * interesting.
+     */
+    for (uint idx = 0u; idx < jobList.size(); ++idx)
+    {
+        S9sJob    job    = jobList[idx].toVariantMap();
+        S9sString status = job.status();
+
+        if (m_jobs.contains(job.jobId()) || status == "RUNNING" || 
+                status == "DEFINED" || status == "SCHEDULED")
+        {
+            m_jobs[job.jobId()] = job;
+        }
+    }
+
+    markDirty();
+}
+
 /**
  * \returns How many containers found.
  */
@@ -251,6 +568,15 @@ S9sMonitor::nContainers() const
     return retval;
 }
 
+/**
+ * \returns How many events were processed since the monitor was created.
+ */
+ulonglong
+S9sMonitor::nEventsIngested() const
+{
+    return m_nEventsIngested;
+}
+
 S9sVector<S9sServer>
 S9sMonitor::servers() const
 {
@@ -329,7 +655,7 @@ S9sMonitor::refreshScreen()
             break;
 
         default:
-            ::printf("error");
+            s9s_printf("error");
     }
 
     //if (m_viewHelp)
@@ -379,7 +705,7 @@ S9sMonitor::printHelp()
         S9sString line = lines[n].toString();
         
         gotoXy(indent, n + 3);
-        ::printf("%s", STR(line));
+        s9s_printf("%s", STR(line));
     }
 }
 
@@ -431,7 +757,7 @@ S9sMonitor::printContainers()
         serverFormat.widen("SERVER");
         aliasFormat.widen("NAME");
         
-        printf("%s", TERM_SCREEN_HEADER);
+        s9s_printf("%s", TERM_SCREEN_HEADER);
         typeFormat.printf("CLOUD");
         templateFormat.printf("TEMPLATE");
         stateFormat.printf("STATE");
@@ -482,20 +808,20 @@ S9sMonitor::printContainers()
                 templateFormat.printf(container.templateName("-", true));
                 stateFormat.printf(STR(container.state()));
 
-                ::printf("%s", ipColorBegin(ipAddress));
+                s9s_printf("%s", ipColorBegin(ipAddress));
                 ipFormat.printf(STR(ipAddress));
-                ::printf("%s", ipColorEnd(ipAddress));
+                s9s_printf("%s", ipColorEnd(ipAddress));
 
-                ::printf("%s", serverColorBegin());
+                s9s_printf("%s", serverColorBegin());
                 serverFormat.printf(container.parentServerName());
-                ::printf("%s", serverColorEnd());
+                s9s_printf("%s", serverColorEnd());
 
-                ::printf("%s", containerColorBegin(stateAsChar));
+                s9s_printf("%s", containerColorBegin(stateAsChar));
                 aliasFormat.printf(container.alias());
-                ::printf("%s", containerColorEnd());
+                s9s_printf("%s", containerColorEnd());
             } else {
                 // The line is selected, we use a highlight color.
-                ::printf("%s", XTERM_COLOR_SELECTION);
+                s9s_printf("%s", XTERM_COLOR_SELECTION);
                 typeFormat.printf(STR(container.provider()));
                 templateFormat.printf(container.templateName("-"));
                 stateFormat.printf(STR(container.state()));
@@ -543,7 +869,7 @@ S9sMonitor::printServers()
     for (uint idx1 = 0u; idx1 < theServers.size(); ++idx1)
     {
         S9sServer      &server = theServers[idx1];
-        S9sEvent        event = m_serverEvents[server.id()];
+        const S9sEvent &event = serverEvent(server.id());
         
         sourceFileFormat.widen(event.senderFile());
         sourceLineFormat.widen(event.senderLine());
@@ -577,7 +903,7 @@ S9sMonitor::printServers()
         ipFormat.widen("IPADDRESS");
         commentsFormat.widen("COMMENT");
 
-        printf("%s", TERM_SCREEN_HEADER);
+        s9s_printf("%s", TERM_SCREEN_HEADER);
         
         if (m_viewDebug)
         {
@@ -614,7 +940,7 @@ S9sMonitor::printServers()
     for (uint idx1 = 0u; idx1 < theServers.size(); ++idx1)
     {
         S9sServer      &server = theServers[idx1];
-        S9sEvent        event = m_serverEvents[server.id()];
+        const S9sEvent &event = serverEvent(server.id());
         bool            isSelected;
 
         if (!m_serverListWidget.isIndexVisible(idx1))
@@ -630,7 +956,7 @@ S9sMonitor::printServers()
 
         if (isSelected)
         {
-            ::printf("%s", XTERM_COLOR_SELECTION);
+            s9s_printf("%s", XTERM_COLOR_SELECTION);
 
             if (m_viewDebug)
             {
@@ -731,7 +1057,7 @@ S9sMonitor::printClusters()
         groupFormat.widen("GROUP");
         pathFormat.widen("PATH");
 
-        printf("%s", TERM_SCREEN_HEADER);
+        s9s_printf("%s", TERM_SCREEN_HEADER);
         
         if (m_viewObjects)
         {
@@ -768,15 +1094,15 @@ S9sMonitor::printClusters()
             versionFormat.printf(cluster.vendorAndVersion());
             idFormat.printf(cluster.clusterId());
         
-            printf("%s", clusterStateColorBegin(cluster.state()));
+            s9s_printf("%s", clusterStateColorBegin(cluster.state()));
             stateFormat.printf(cluster.state());
-            printf("%s", clusterStateColorEnd());
+            s9s_printf("%s", clusterStateColorEnd());
 
             typeFormat.printf(cluster.clusterType());
     
-            printf("%s", clusterColorBegin());
+            s9s_printf("%s", clusterColorBegin());
             nameFormat.printf(cluster.name());
-            printf("%s", clusterColorEnd());
+            s9s_printf("%s", clusterColorEnd());
         
             messageFormat.printf(cluster.statusText());
         }
@@ -824,7 +1150,7 @@ S9sMonitor::printJobs()
         titleFormat.widen("TITLE");
         titleFormat.widen("STATUS");
 
-        printf("%s", TERM_SCREEN_HEADER /*m_formatter.headerColorBegin()*/);
+        s9s_printf("%s", TERM_SCREEN_HEADER /*m_formatter.headerColorBegin()*/);
         idFormat.printf("ID");
         stateFormat.printf("STATE");
         progressFormat.printf("PROGRESS");
@@ -878,7 +1204,7 @@ S9sMonitor::printJobs()
         idFormat.printf(job.jobId());
         stateFormat.printf(job.status());
 
-        ::printf("%s", STR(progressBar));
+        s9s_printf("%s", STR(progressBar));
 
         titleFormat.printf(job.title());
         statusTextFormat.printf(statusText);
@@ -920,7 +1246,7 @@ S9sMonitor::printNodes()
      */
     foreach (const S9sNode &node, m_nodes)
     {
-        S9sEvent       event = m_eventsForNodes[node.hostId()];
+        const S9sEvent &event = nodeEvent(node.hostId());
         S9sString      clusterName = "-";
 
         if (m_clusters.contains(node.clusterId()))
@@ -959,7 +1285,7 @@ S9sMonitor::printNodes()
         groupFormat.widen("GROUP");
         pathFormat.widen("PATH");
 
-        printf("%s", TERM_SCREEN_HEADER);
+        s9s_printf("%s", TERM_SCREEN_HEADER);
        
         if (m_viewDebug)
         {
@@ -974,13 +1300,13 @@ S9sMonitor::printNodes()
             groupFormat.printf("GROUP", false);
             pathFormat.printf("PATH", false);
         } else {
-            printf("STAT ");
+            s9s_printf("STAT ");
             versionFormat.printf("VERSION");
             clusterIdFormat.printf("CID");
             clusterNameFormat.printf("CLUSTER");
             hostNameFormat.printf("HOST");
             portFormat.printf("PORT");
-            printf("COMMENT");
+            s9s_printf("COMMENT");
         }
 
         printNewLine();
@@ -990,7 +1316,7 @@ S9sMonitor::printNodes()
 
     foreach (const S9sNode &node, m_nodes)
     {
-        S9sEvent       event = m_eventsForNodes[node.hostId()];
+        const S9sEvent &event = nodeEvent(node.hostId());
         S9sString      clusterName = "-";
 
         if (m_clusters.contains(node.clusterId()))
@@ -1013,22 +1339,22 @@ S9sMonitor::printNodes()
             groupFormat.printf(node.groupOwnerName());
             pathFormat.printf(node.fullCdtPath());
         } else {
-            ::printf("%c", node.nodeTypeFlag());
-            ::printf("%c", node.stateAsChar());
-            ::printf("%c", node.roleFlag());
-            ::printf("%c ", node.maintenanceFlag());
+            s9s_printf("%c", node.nodeTypeFlag());
+            s9s_printf("%c", node.stateAsChar());
+            s9s_printf("%c", node.roleFlag());
+            s9s_printf("%c ", node.maintenanceFlag());
 
             versionFormat.printf(node.version());
             clusterIdFormat.printf(node.clusterId());
 
-            printf("%s", clusterColorBegin());
+            s9s_printf("%s", clusterColorBegin());
             clusterNameFormat.printf(clusterName);
-            printf("%s", clusterColorEnd());
+            s9s_printf("%s", clusterColorEnd());
 
             hostNameFormat.printf(node.hostName());
             portFormat.printf(node.port());
 
-            ::printf("%s ", STR(node.message()));
+            s9s_printf("%s ", STR(node.message()));
         }
 
         printNewLine();
@@ -1083,6 +1409,25 @@ S9sMonitor::printEventList()
     m_eventListWidget.setNumberOfItems(m_events.size());
     m_eventListWidget.ensureSelectionVisible();
 
+    /*
+     * The cached lines are indexed by the position in the list, when the
+     * oldest events are dropped the positions change and the lines are moved
+     * with them.
+     */
+    if (m_eventListDebug != m_viewDebug ||
+            m_eventListSequence > m_events.firstSequence() ||
+            m_events.firstSequence() - m_eventListSequence >= m_events.size())
+    {
+        m_eventListWidget.invalidateLines();
+        m_eventListDebug = m_viewDebug;
+    } else if (m_eventListSequence != m_events.firstSequence())
+    {
+        m_eventListWidget.removeCachedLines(
+                (int) (m_events.firstSequence() - m_eventListSequence));
+    }
+
+    m_eventListSequence = m_events.firstSequence();
+
     m_eventViewWidget.setLocation(1, viewHeight + 1);
     m_eventViewWidget.setSize(width(), viewHeight);
     m_eventViewWidget.setSelectionEnabled(false);
@@ -1098,24 +1443,30 @@ S9sMonitor::printEventList()
         if (idx >= m_events.size())
             break;
 
-        S9sEvent  &event = m_events[idx];
+        const S9sEvent &event = m_events[idx];
         S9sString  line;
         bool       isSelected;
         
         isSelected = m_eventListWidget.isSelected(idx);
 
-        line = event.toOneLiner(!isSelected, m_viewDebug);
+        if (isSelected || !m_eventListWidget.cachedLine(idx, line))
+        {
+            line = event.toOneLiner(!isSelected, m_viewDebug);
+
+            line.replace("\n", "\\n");
+            line.replace("\r", "\\r");
 
-        line.replace("\n", "\\n");
-        line.replace("\r", "\\r");
+            if (!isSelected)
+                m_eventListWidget.setCachedLine(idx, line);
+        }
        
         if (isSelected)
         {
-            ::printf("%s", XTERM_COLOR_SELECTION);
-            ::printf("%s ", STR(line));
+            s9s_printf("%s", XTERM_COLOR_SELECTION);
+            s9s_printf("%s ", STR(line));
             printNewLine();
         } else {
-            ::printf("%s ", STR(line));
+            s9s_printf("%s ", STR(line));
             printNewLine();
         }
     }
@@ -1137,16 +1488,16 @@ S9sMonitor::printEventView()
     S9sString title = " Event JSon";
 
     // The title bar.
-    ::printf("%s", TERM_INVERSE);
-    ::printf("%s", STR(title));
+    s9s_printf("%s", TERM_INVERSE);
+    s9s_printf("%s", STR(title));
 
 #if 1
     for (int n = title.length(); n < width() - 2; ++n)
-        ::printf(" ");
+        s9s_printf(" ");
 
-    ::printf("x ");
+    s9s_printf("x ");
 #else
-    ::printf("  %d, %d %dx%d %d - %d", 
+    s9s_printf("  %d, %d %dx%d %d - %d", 
             m_eventViewWidget.x(), m_eventViewWidget.y(),
             m_eventViewWidget.height(), m_eventViewWidget.width(),
             m_eventViewWidget.firstVisibleIndex(),
@@ -1172,117 +1523,99 @@ S9sMonitor::printEventView()
 
         line.replace("\n", "\\n");
         line.replace("\r", "\\r");
-        ::printf("%s", STR(line));
+        s9s_printf("%s", STR(line));
         printNewLine();
 
     }
 }
 
+/**
+ * \returns The last event about the given host or an empty event if it is not
+ *   in the event history any more.
+ */
+const S9sEvent &
+S9sMonitor::nodeEvent(
+        const int hostId) const
+{
+    static const S9sEvent  empty;
+    const S9sEvent        *event = NULL;
+
+    if (m_nodeEvents.contains(hostId))
+        event = m_events.find(m_nodeEvents.at(hostId));
+
+    return event != NULL ? *event : empty;
+}
+
+/**
+ * \returns The last event about the given server or an empty event if it is
+ *   not in the event history any more.
+ */
+const S9sEvent &
+S9sMonitor::serverEvent(
+        const S9sString &serverId) const
+{
+    static const S9sEvent  empty;
+    const S9sEvent        *event = NULL;
+
+    if (m_serverEvents.contains(serverId))
+        event = m_events.find(m_serverEvents.at(serverId));
+
+    return event != NULL ? *event : empty;
+}
+
 /**
  * \param event The event that arrived and shall be processed.
+ *
+ * Updates the model with the data found in the event. The mutex should be
+ * locked when this method is called.
  */
 void 
 S9sMonitor::processEvent(
         S9sEvent &event)
 {
-    ++m_refreshCounter;
+    ulonglong sequence;
 
-    // The events themselves.
-    m_events << event;
+    ++m_refreshCounter;
 
-    while (m_events.size() > 3000)
-        m_events.takeFirst();
+    // The events themselves, the oldest is overwritten when the history is
+    // full.
+    sequence = m_events.append(event);
 
-    // The clusters.
-    if (event.hasCluster())
-    {
-        S9sCluster cluster = event.cluster();
-        // FIXME: what about cluster delete events?
-        if (cluster.clusterId() != 0)
-            m_clusters[cluster.clusterId()] = cluster;
-    }
+    // The objects.
+    S9sEventCheckpoints::applyEvent(
+            event, m_clusters, m_nodes, m_jobs, m_servers);
 
-    // The jobs.
     if (event.hasJob())
-    {
-        S9sJob job = event.job();
-            
-        m_jobs[job.jobId()] = job;
-        m_jobActivity[job.jobId()] = time(NULL);
-    }
+        m_jobActivity[event.job().jobId()] = time(NULL);
     
-    // The hosts.
     if (event.hasHost())
-    {
-        S9sNode  node;
-
-        node = event.host();
-
-        m_nodes[node.hostId()] = node;
-        m_eventsForNodes[node.hostId()] = event;
-    }
+        m_nodeEvents[event.host().hostId()] = sequence;
     
-    // The servers (together with the containers).
     if (event.hasServer())
     {
-        S9sServer  server = event.server();
+        S9sString serverId = event.server().id();
 
         if (event.eventSubClass() == S9sEvent::Destroyed)
-        {
-            m_servers.erase(server.id());
-            m_serverEvents.erase(server.id());
-        } else {
-            m_servers[server.id()]      = server;
-            m_serverEvents[server.id()] = event;
-        }
+            m_serverEvents.erase(serverId);
+        else
+            m_serverEvents[serverId] = sequence;
     }
 
     //removeOldObjects();
+    ++m_nEventsIngested;
+
     if (m_rightKeyPresses > 0)
         return;
 
-    switch (m_displayMode)
-    {
-        case PrintEvents:
-            processEventList(event);
-            break;
-
-        case WatchNodes:
-            if (!m_viewHelp)
-                printNodes();
-            ++m_refreshCounter;
-            break;
-        
-        case WatchContainers:
-            if (!m_viewHelp)
-                printContainers();
-            ++m_refreshCounter;
-            break;
-        
-        case WatchServers:
-            if (!m_viewHelp)
-                printServers();
-            ++m_refreshCounter;
-            break;
-
-        case WatchClusters:
-            if (!m_viewHelp)
-                printClusters();
-            ++m_refreshCounter;
-            break;
-        
-        case WatchJobs:
-            if (!m_viewHelp)
-                printJobs();
-            ++m_refreshCounter;
-            break;
-        
-        case WatchEvents:
-            if (!m_viewHelp)
-                printEvents();
-            ++m_refreshCounter;
-            break;
-    }
+    /*
+     * The event list is a stream, the events are printed as they arrive. The
+     * interactive views are only marked here, the render tick will repaint
+     * them so a burst of events does not cause a burst of redraws.
+     */
+    if (m_displayMode == PrintEvents)
+        processEventList(event);
+    else
+        markDirty();
 }
 
 /**
@@ -1306,7 +1639,7 @@ S9sMonitor::processEventList(
 
     output.replace("\n", "\n\r");
     if (!output.empty())
-        ::printf("\n\r%s", STR(output));
+        s9s_printf("\n\r%s", STR(output));
 }
 
 /**
@@ -1380,39 +1713,42 @@ S9sMonitor::printHeader()
             break;
     }
 
-    ::printf("%s%s%s ", bold, STR(title), normal);
-    ::printf("%c ", rotatingCharacter());
+    s9s_printf("%s%s%s ", bold, STR(title), normal);
+    s9s_printf("%c ", rotatingCharacter());
     
     if (hasInputFile())
     {
         if (m_isStopped)
         {
             if (m_fastMode)
-                ::printf(" ⏩ ");
+                s9s_printf(" ⏩ ");
             else
-                ::printf(" ▶️ ");
+                s9s_printf(" ▶️ ");
         } else {
-            ::printf(" ⏸️ ");
+            s9s_printf(" ⏸️ ");
         }
     } else {
-        ::printf("   ");
+        s9s_printf("   ");
     }
 
     //::printf("⏺ ⏹ ⏸ ⏵ ⏩");
 
-    ::printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
+    s9s_printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
     
-    ::printf("%s%4zu%s event(s) ", bold, m_events.size(), normal);
-    ::printf("%s%zu%s node(s) ",   bold, m_nodes.size(), normal);
-    ::printf("%s%d%s VM(s) ",      bold, nContainers(), normal);
-    ::printf("%s%zu%s cluster(s) ", bold, m_clusters.size(), normal);
-    ::printf("%s%zu%s jobs(s) ",   bold, m_jobs.size(), normal);
+    s9s_printf("%s%4u%s event(s) ", bold, m_events.size(), normal);
+    s9s_printf("%s%zu%s node(s) ",   bold, m_nodes.size(), normal);
+    s9s_printf("%s%d%s VM(s) ",      bold, nContainers(), normal);
+    s9s_printf("%s%zu%s cluster(s) ", bold, m_clusters.size(), normal);
+    s9s_printf("%s%zu%s jobs(s) ",   bold, m_jobs.size(), normal);
 
     if (m_viewDebug)
     {
-        ::printf("0x%08x ",      lastKeyCode());
-        ::printf("%02dx%02d ",   width(), height());
-        ::printf("%02d:%03d,%03d ", m_lastButton, m_lastX, m_lastY);
+        s9s_printf("0x%08x ",      lastKeyCode());
+        s9s_printf("%02dx%02d ",   width(), height());
+        s9s_printf("%02d:%03d,%03d ", m_lastButton, m_lastX, m_lastY);
+        s9s_printf("%lluk/%lluk ", 
+                bytesWritten() / 1024ull, bytesGenerated() / 1024ull);
+        s9s_printf("%llu/%llu ", m_nEventsIngested, nFramesDrawn());
     }
 
     printNewLine();
@@ -1430,21 +1766,24 @@ S9sMonitor::printFooter()
     //::printf("%s", TERM_ERASE_EOL);
     for (;m_lineCounter < height() - 1; ++m_lineCounter)
     {
-        ::printf("%s", TERM_ERASE_EOL);
-        ::printf("\n\r");
-        ::printf("%s", TERM_ERASE_EOL);
+        s9s_printf("%s", TERM_ERASE_EOL);
+        s9s_printf("\n\r");
+        s9s_printf("%s", TERM_ERASE_EOL);
     } 
 
-    ::printf("%s ", normal);
-    ::printf("%sN%s-Nodes ", bold, normal);
-    ::printf("%sC%s-Clusters ", bold, normal);
-    ::printf("%sJ%s-Jobs ", bold, normal);
-    ::printf("%sV%s-Containers ", bold, normal);
-    ::printf("%sE%s-Events ", bold, normal);
-    ::printf("%sD%s-Debug mode ", bold, normal);
-    ::printf("%sH%s-Help ", bold, normal);
-    ::printf("%sQ%s-Quit", bold, normal);
+    s9s_printf("%s ", normal);
+    s9s_printf("%sN%s-Nodes ", bold, normal);
+    s9s_printf("%sC%s-Clusters ", bold, normal);
+    s9s_printf("%sJ%s-Jobs ", bold, normal);
+    s9s_printf("%sV%s-Containers ", bold, normal);
+    s9s_printf("%sE%s-Events ", bold, normal);
+    s9s_printf("%sD%s-Debug mode ", bold, normal);
+    s9s_printf("%sH%s-Help ", bold, normal);
+    s9s_printf("%sQ%s-Quit", bold, normal);
    
+    if (m_recorder.isOpen() && m_recorder.nDropped() > 0ull)
+        s9s_printf("    [%llu dropped]", m_recorder.nDropped());
+
     //if (!m_outputFileName.empty())
     //    ::printf("    [%s]", STR(m_outputFileName));
     //    ::printf("    {%s}", STR(m_inputFileName));
@@ -1452,8 +1791,8 @@ S9sMonitor::printFooter()
     // Just for debugging now.
     //::printf("'%s'", STR(m_client.reply().requestStatusAsString()));
     // No new-line at the end, this is the last line.
-    ::printf("%s", TERM_ERASE_EOL);
-    ::printf("%s", TERM_NORMAL);
+    s9s_printf("%s", TERM_ERASE_EOL);
+    s9s_printf("%s", TERM_NORMAL);
 
     if (m_viewHelp)
         printHelp();
@@ -1660,52 +1999,42 @@ void
 S9sMonitor::eventCallback(
         S9sEvent &event)
 {
-    S9sMutexLocker    locker(m_mutex);
-    S9sOptions       *options = S9sOptions::instance();
-    
-    if (!m_outputFileName.empty())
-    {
-        bool success;
-
-        success = m_outputFile.fprintf("%s\n\n", STR(event.toString()));
-        if (!success)
-        {
-            PRINT_ERROR("%s", STR(m_outputFile.errorString()));
-            exit(1);
-        }
+    // The events we already have are sent again after a reconnect.
+    if (!m_resume.accept(event))
+        return;
 
-        m_outputFile.flush();
+    /*
+     * The recorder does not wait for the disk, so this is done before we
+     * lock the mutex the screen is drawn with.
+     */
+    if (m_recorder.isOpen() && !m_recorder.record(event) && 
+            m_recorder.failed())
+    {
+        PRINT_ERROR("%s", STR(m_recorder.errorString()));
+        exit(1);
     }
 
-    switch (m_displayMode)
+    // Filtration by event class, subclass (event-name), cluster and host.
+    if (m_eventFilter.accepts(event))
     {
-        case PrintEvents:
-            // Filtration by event class and subclass (event-name).
-            if (!options->eventTypeEnabled(event.eventTypeString()))
-                return;
-    
-            if (!options->eventNameEnabled(event.eventName()))
-                return;
-
-            break;
-
-        case WatchEvents:
-        case WatchNodes:
-        case WatchClusters:
-        case WatchJobs:
-        case WatchContainers:
-        case WatchServers:
-            break;
+        S9sMutexLocker    locker(m_mutex);
+        processEvent(event);
     }
 
-    // optional filtration by clusterId
-    if (options->clusterId() > S9S_INVALID_CLUSTER_ID
-        && options->clusterId() != event.clusterId())
+    /*
+     * The first new event after a reconnect shows that the stream is up
+     * again. If the controller did not replay the events we missed we refresh
+     * the model now, the changes made while we were subscribing are on the
+     * stream already. The stream is read by this thread, so the requests are
+     * sent on a connection of their own.
+     */
+    if (m_resume.replayMissed())
     {
-        return;
-    }
+        S9sRpcClient client = m_client.clone();
 
-    processEvent(event);
+        m_resume.resynced();
+        resync(client);
+    }
 }
 
 /**
@@ -24,6 +24,12 @@
 #include "s9srpcclient.h"
 #include "s9srpcreply.h"
 #include "s9sdisplaylist.h"
+#include "s9seventindex.h"
+#include "s9seventrecorder.h"
+#include "s9seventring.h"
+#include "s9seventcheckpoints.h"
+#include "s9seventfilter.h"
+#include "s9seventresume.h"
 
 /**
  * Implements a view that can be used to monitor objects through events.
@@ -57,6 +63,7 @@ class S9sMonitor :
                 void                *userData);
 
         int nContainers() const;
+        ulonglong nEventsIngested() const;
         S9sVector<S9sServer> servers() const;
 
         void setDisplayMode(const S9sMonitor::DisplayMode mode);
@@ -88,18 +95,33 @@ class S9sMonitor :
         void printClusters();
         void printJobs();
 
+        bool seekInputFile(const S9sString &value);
+
+    private:
+        bool loadInputIndex();
+        bool isSeekRequested() const;
+        bool replayTo(const time_t target, const bool forward);
+        void restoreState(const S9sVariantMap &snapshot);
+        void resync(S9sRpcClient &client);
+
+        const S9sEvent &nodeEvent(const int hostId) const;
+        const S9sEvent &serverEvent(const S9sString &serverId) const;
+
     private:
         S9sRpcClient                &m_client;
         S9sRpcReply                  m_lastReply;
         DisplayMode                  m_displayMode;
         S9sMap<int, S9sNode>         m_nodes;
-        S9sMap<int, S9sEvent>        m_eventsForNodes;
+        /** The sequence number of the last event about the given host. */
+        S9sMap<int, ulonglong>       m_nodeEvents;
         S9sMap<S9sString, S9sServer> m_servers;
-        S9sMap<S9sString, S9sEvent>  m_serverEvents;
+        /** The sequence number of the last event about the given server. */
+        S9sMap<S9sString, ulonglong> m_serverEvents;
         S9sMap<int, S9sCluster>      m_clusters;
         S9sMap<int, S9sJob>          m_jobs;
         S9sMap<int, time_t>          m_jobActivity;
-        S9sVector<S9sEvent>          m_events;
+        /** The history of the events, bounded by --event-history. */
+        S9sEventRing                 m_events;
 
         bool                         m_viewDebug;
         bool                         m_viewObjects;
@@ -120,7 +142,27 @@ class S9sMonitor :
 
         S9sDisplayList               m_eventListWidget;
         S9sDisplayList               m_eventViewWidget;
+        /** The first event and the mode the cached event lines belong to. */
+        ulonglong                    m_eventListSequence;
+        bool                         m_eventListDebug;
 
         S9sEvent                     m_selectedEvent;
+
+        /** The number of events processed, compare to nFramesDrawn(). */
+        ulonglong                    m_nEventsIngested;
+
+        /** Where the play back of the input file starts (--seek). */
+        S9sString                    m_seek;
+        /** The time the --seek moved the play back to, 0 without --seek. */
+        time_t                       m_seekTarget;
+        /** The time index and the checkpoints of the input file. */
+        S9sEventIndex                m_inputIndex;
+        S9sEventCheckpoints          m_inputCheckpoints;
+        bool                         m_inputIndexLoaded;
+        /** Saves the events into the output file on its own thread. */
+        S9sEventRecorder             m_recorder;
+        S9sEventFilter               m_eventFilter;
+        /** Where to resume the event stream after a reconnect. */
+        S9sEventResume               m_resume;
 };
 
@@ -29,6 +29,10 @@
 #include "s9sdatetime.h"
 #include "s9scontainer.h"
 #include "s9ssshcredentials.h"
+#include "s9srecordwriter.h"
+#include "s9seventindex.h"
+#include "s9seventfilter.h"
+#include "s9seventrecorder.h"
 
 #include <sys/ioctl.h>
 #include <stdio.h>
@@ -435,6 +439,18 @@ enum S9sOptionType
     OptionSortByTime,
     OptionOutputFile,
     OptionInputFile,
+    OptionMaxFps,
+    OptionOutputFormat,
+    OptionFields,
+    OptionAllRunning,
+    OptionPollMin,
+    OptionPollMax,
+    OptionPollJitter,
+    OptionSeek,
+    OptionBuildIndex,
+    OptionOutputFsync,
+    OptionEventHistory,
+    OptionHostPattern,
     OptionRegion,
     OptionShellCommand,
 
@@ -632,6 +648,8 @@ S9sOptions::S9sOptions() :
     {
         m_options["cluster_id"] = theString.toInt();
     }
+
+    resolveConfig();
 }
 
 /**
@@ -753,7 +771,7 @@ S9sOptions::loadStateFile()
     PRINT_LOG("State file: %s", STR(content));
     if (!m_state.parse(STR(content)))
     {
-        PRINT_LOG("Error parsing state file.");
+        PRINT_LOG_ERROR("Error parsing state file.");
         return false;
     }
 
@@ -772,7 +790,7 @@ S9sOptions::writeStateFile()
     success = file.writeTxtFile(content);
     if (!success)
     {
-        PRINT_LOG("ERROR: %s", STR(file.errorString()));
+        PRINT_LOG_ERROR("%s", STR(file.errorString()));
     }
 
     return success;
@@ -803,6 +821,118 @@ S9sOptions::getState(
  */
 bool
 S9sOptions::loadConfigFiles()
+{
+    bool success = loadConfigFilesInternal();
+
+    resolveConfig();
+    return success;
+}
+
+/**
+ * Builds the index of the configuration values, the getters are reading this
+ * index instead of searching the parsed configuration files. Both files are
+ * indexed separately (some getters need to know which file defines a value) and
+ * a merged index holds the effective value (the user's configuration file takes
+ * precedence over the system configuration file). The command line options are
+ * not part of the index, they can be changed at any time and so they are always
+ * checked first by the getters.
+ *
+ * The configuration files are not changed after they are loaded, so this
+ * method is called only when the files are (re)loaded.
+ */
+void
+S9sOptions::resolveConfig()
+{
+    m_userConfigValues.clear();
+    m_systemConfigValues.clear();
+    m_configValues.clear();
+
+    indexConfig(m_userConfig, m_userConfigValues);
+    indexConfig(m_systemConfig, m_systemConfigValues);
+
+    m_configValues = m_systemConfigValues;
+    for (ConfigIndex::const_iterator it = m_userConfigValues.begin();
+            it != m_userConfigValues.end(); ++it)
+    {
+        if (!it->second.empty())
+            m_configValues[it->first] = it->second;
+    }
+
+    /*
+     * The color and the truncate getters are called for every printed field,
+     * the standard output does not change, so we check the terminal once.
+     */
+    m_stdoutIsTerminal = isatty(fileno(stdout)) ? true : false;
+}
+
+/**
+ * Walks the parsed configuration file once and puts the values into the index.
+ * If a variable is defined more than once the first definition is used, the
+ * same way S9sConfigFile::variableValue() does.
+ */
+void
+S9sOptions::indexConfig(
+        const S9sConfigFile  &configFile,
+        ConfigIndex          &index)
+{
+    S9sVariantList variables = configFile.collectVariables("");
+
+    for (uint idx = 0u; idx < variables.size(); ++idx)
+    {
+        const S9sVariantMap &variable = variables[idx].toVariantMap();
+        S9sString            name     = variable.at("variablename").toString();
+
+        if (index.find(name) != index.end())
+            continue;
+
+        index[name] = variable.at("value").toString().unQuote();
+    }
+}
+
+/**
+ * \returns The effective value of the given configuration variable, the empty
+ *   string if it is not set in any of the configuration files.
+ */
+S9sString
+S9sOptions::configValue(
+        const S9sString &key) const
+{
+    ConfigIndex::const_iterator it = m_configValues.find(key);
+
+    return it != m_configValues.end() ? it->second : S9sString();
+}
+
+/**
+ * \returns The value of the configuration variable as it is set in the user's
+ *   configuration file.
+ */
+S9sString
+S9sOptions::userConfigValue(
+        const S9sString &key) const
+{
+    ConfigIndex::const_iterator it = m_userConfigValues.find(key);
+
+    return it != m_userConfigValues.end() ? it->second : S9sString();
+}
+
+/**
+ * \returns The value of the configuration variable as it is set in the system
+ *   configuration file.
+ */
+S9sString
+S9sOptions::systemConfigValue(
+        const S9sString &key) const
+{
+    ConfigIndex::const_iterator it = m_systemConfigValues.find(key);
+
+    return it != m_systemConfigValues.end() ? it->second : S9sString();
+}
+
+/**
+ * Loads and parses the user and the system configuration files.
+ */
+bool
+S9sOptions::loadConfigFilesInternal()
 {
     S9sFile userConfig(defaultUserConfigFileName());
     S9sFile systemConfig(defaultSystemConfigFileName());
@@ -965,9 +1095,7 @@ S9sOptions::checkController()
 
     S9sString tmp;
 
-    tmp = m_userConfig.variableValue("controller");
-    if (tmp.empty())
-        tmp = m_systemConfig.variableValue("controller");
+    tmp = configValue("controller");
 
     if (!tmp.empty())
         setController(tmp);
@@ -988,10 +1116,7 @@ S9sOptions::controllerHostName()
     {
         retval = m_options.at("controller").toString();
     } else {
-        retval = m_userConfig.variableValue("controller_host_name");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("controller_host_name");
+        retval = configValue("controller_host_name");
     }
 
     if (retval.empty())
@@ -1014,10 +1139,7 @@ S9sOptions::controllerProtocol()
     {
         retval = m_options.at("controller_protocol").toString();
     } else {
-        retval = m_userConfig.variableValue("controller_protocol");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("controller_protocol");
+        retval = configValue("controller_protocol");
     }
 
     return retval;
@@ -1036,10 +1158,10 @@ S9sOptions::controllerPort()
     {
         retval = m_options.at("controller_port").toInt();
     } else {
-        retval = m_userConfig.variableValue("controller_port").toInt();
+        retval = userConfigValue("controller_port").toInt();
 
         if (retval == 0)
-            retval = m_systemConfig.variableValue("controller_port").toInt();
+            retval = systemConfigValue("controller_port").toInt();
     }
 
     if (retval < 1)
@@ -1122,10 +1244,7 @@ S9sOptions::onlyAscii() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval.toBoolean();
@@ -1209,6 +1328,56 @@ S9sOptions::eventNameEnabled(
     return retval;
 }
 
+/**
+ * \returns The value of the --host-pattern command line option, a wildcard
+ *   pattern for the names of the hosts the printed events are about.
+ */
+S9sString
+S9sOptions::hostPattern() const
+{
+    return getString("host_pattern");
+}
+
+/**
+ * \returns The event filter compiled from the --with-event-*, --with-*-events,
+ *   --no-*-events, --cluster-id and --host-pattern command line options.
+ */
+S9sEventFilter
+S9sOptions::eventFilter()
+{
+    S9sEventFilter retval;
+    S9sVariantMap  theMap;
+
+    theMap = getVariantMap("enabled_event_types");
+    for (S9sVariantMap::const_iterator it = theMap.begin(); 
+            it != theMap.end(); ++it)
+    {
+        if (it->second.toBoolean())
+            retval.enableClass(it->first);
+    }
+    
+    theMap = getVariantMap("enabled_event_names");
+    for (S9sVariantMap::const_iterator it = theMap.begin(); 
+            it != theMap.end(); ++it)
+    {
+        if (it->second.toBoolean())
+            retval.enableName(it->first);
+    }
+    
+    theMap = getVariantMap("disabled_event_names");
+    for (S9sVariantMap::const_iterator it = theMap.begin(); 
+            it != theMap.end(); ++it)
+    {
+        if (it->second.toBoolean())
+            retval.disableName(it->first);
+    }
+
+    retval.setClusterId(clusterId());
+    retval.setHostPattern(hostPattern());
+
+    return retval;
+}
+
 /**
  * \returns True if the --density command line option was provided.
  */
@@ -1228,10 +1397,7 @@ S9sOptions::clientConnectionTimeout() const
     // Finding a string value.
     stringVal = getenv("S9S_CONNECTION_TIMEOUT");
     if (stringVal.empty())
-        stringVal = m_userConfig.variableValue(key);
-
-    if (stringVal.empty())
-        stringVal = m_systemConfig.variableValue(key);
+        stringVal = configValue(key);
 
     // Converting to integer.
     if (!stringVal.empty())
@@ -1259,10 +1425,7 @@ S9sOptions::briefLogFormat() const
     {
         retval = m_options.at("log_format").toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1278,10 +1441,7 @@ S9sOptions::longLogFormat() const
     {
         retval = m_options.at("log_format").toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1302,10 +1462,7 @@ S9sOptions::briefJobLogFormat() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1327,10 +1484,7 @@ S9sOptions::longJobLogFormat() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1351,10 +1505,7 @@ S9sOptions::longClusterFormat() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1375,10 +1526,7 @@ S9sOptions::longNodeFormat() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1399,10 +1547,7 @@ S9sOptions::shortNodeFormat() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1423,10 +1568,7 @@ S9sOptions::longBackupFormat() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1447,10 +1589,7 @@ S9sOptions::longUserFormat() const
     {
         retval = m_options.at(key).toString();
     } else {
-        retval = m_userConfig.variableValue(key);
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue(key);
+        retval = configValue(key);
     }
 
     return retval;
@@ -1732,15 +1871,79 @@ S9sOptions::logFile() const
     {
         retval = m_options.at("log_file").toString();
     } else {
-        retval = m_userConfig.variableValue("log_file");
+        retval = configValue("log_file");
+    }
 
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("log_file");
+    return retval;
+}
+
+/**
+ * \returns The minimum severity of the lines written into the log file as it
+ *   is set in the log_level configuration variable (debug, info, warning or
+ *   error).
+ */
+S9sString
+S9sOptions::logLevel() const
+{
+    S9sString retval = configValue("log_level");
+
+    if (retval.empty())
+        retval = "debug";
+
+    return retval;
+}
+
+/**
+ * \returns The size in bytes over which the log file is rotated, 0 if the log
+ *   file is never rotated. The log_file_max_size configuration variable
+ *   accepts the K, M and G suffixes.
+ */
+ulonglong
+S9sOptions::logFileMaxSize() const
+{
+    S9sString  value = configValue("log_file_max_size").trim();
+    ulonglong  retval;
+
+    if (value.empty())
+        return 0ull;
+
+    retval = value.toULongLong();
+    switch (value[value.length() - 1])
+    {
+        case 'k':
+        case 'K':
+            retval *= 1024ull;
+            break;
+
+        case 'm':
+        case 'M':
+            retval *= 1024ull * 1024ull;
+            break;
+        
+        case 'g':
+        case 'G':
+            retval *= 1024ull * 1024ull * 1024ull;
+            break;
     }
 
     return retval;
 }
 
+/**
+ * \returns How many rotated log files are kept, set by the log_file_count
+ *   configuration variable.
+ */
+int
+S9sOptions::logFileCount() const
+{
+    S9sString value = configValue("log_file_count");
+
+    if (value.empty() || value.toInt() < 0)
+        return 5;
+
+    return value.toInt();
+}
+
 /**
  * \param value the node list as a string using field separators that the
  *   S9sString::split() function can interpret.
@@ -1841,10 +2044,7 @@ S9sOptions::vendor() const
     {
         retval = m_options.at("vendor").toString();
     } else {
-        retval = m_userConfig.variableValue("vendor");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("vendor");
+        retval = configValue("vendor");
     }
 
     return retval;
@@ -2014,10 +2214,7 @@ S9sOptions::providerVersion(
     {
         retval = m_options.at("provider_version").toString();
     } else {
-        retval = m_userConfig.variableValue("provider_version");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("provider_version");
+        retval = configValue("provider_version");
     }
 
     return retval;
@@ -2058,10 +2255,7 @@ S9sOptions::osSudoPassword() const
     {
         retval = m_options.at("os_sudo_password").toString();
     } else {
-        retval = m_userConfig.variableValue("os_sudo_password");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("os_sudo_password");
+        retval = configValue("os_sudo_password");
     }
 
     return retval;
@@ -2083,10 +2277,7 @@ S9sOptions::osSudoUser() const
     {
         retval = m_options.at("os_sudo_user").toString();
     } else {
-        retval = m_userConfig.variableValue("os_sudo_user");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("os_sudo_user");
+        retval = configValue("os_sudo_user");
     }
 
     return retval;
@@ -2191,10 +2382,7 @@ S9sOptions::osUser() const
     {
         retval = m_options.at("os_user").toString();
     } else {
-        retval = m_userConfig.variableValue("os_user");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("os_user");
+        retval = configValue("os_user");
     }
 
     if (retval.empty())
@@ -2212,10 +2400,7 @@ S9sOptions::osPassword() const
     {
         retval = m_options.at("os_password").toString();
     } else {
-        retval = m_userConfig.variableValue("os_password");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("os_password");
+        retval = configValue("os_password");
     }
 
     return retval;
@@ -2237,10 +2422,7 @@ S9sOptions::osKeyFile() const
     {
         retval = m_options.at("os_key_file").toString();
     } else {
-        retval = m_userConfig.variableValue("os_key_file");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("os_key_file");
+        retval = configValue("os_key_file");
 
         if (retval.empty())
         {
@@ -2266,10 +2448,7 @@ S9sOptions::dbAdminUserName(
     {
         retval = m_options.at("db_admin_user_name").toString();
     } else {
-        retval = m_userConfig.variableValue("db_admin_user_name");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("db_admin_user_name");
+        retval = configValue("db_admin_user_name");
     }
 
     if (retval.empty())
@@ -2291,10 +2470,7 @@ S9sOptions::dbAdminPassword()
     {
         retval = m_options.at("db_admin_password").toString();
     } else {
-        retval = m_userConfig.variableValue("db_admin_password");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("db_admin_password");
+        retval = configValue("db_admin_password");
     }
     
     return retval;
@@ -2309,8 +2485,8 @@ S9sOptions::replicationUser(
 {
     std::vector<std::string> possibleValues {
         m_options.at("replication_user").toString(),
-        m_userConfig.variableValue("replication_user"),
-        m_systemConfig.variableValue("replication_user"),
+        userConfigValue("replication_user"),
+        systemConfigValue("replication_user"),
         defaultValue
     };
     
@@ -2441,9 +2617,7 @@ S9sOptions::formatDateTime(
     if (m_options.contains("date_format"))
         return value.toString(m_options.at("date_format").toString());
 
-    formatString = m_userConfig.variableValue("date_format");
-    if (formatString.empty())
-        formatString = m_systemConfig.variableValue("date_format");
+    formatString = configValue("date_format");
 
     if (!formatString.empty())
         return value.toString(formatString);
@@ -2542,10 +2716,7 @@ S9sOptions::clusterId() const
     {
         retval = m_options.at("cluster_id").toInt(S9S_INVALID_CLUSTER_ID);
     } else {
-        S9sString stringVal = m_userConfig.variableValue("default_cluster_id");
-
-        if (stringVal.empty())
-            stringVal = m_systemConfig.variableValue("default_cluster_id");
+        S9sString stringVal = configValue("default_cluster_id");
 
         if (!stringVal.empty())
             retval = stringVal.toInt(S9S_INVALID_CLUSTER_ID);
@@ -2839,10 +3010,7 @@ S9sOptions::updateFreq() const
     {
         retval = m_options.at("update_freq").toString();
     } else {
-        retval = m_userConfig.variableValue("update_freq");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("update_freq");
+        retval = configValue("update_freq");
     }
 
     if (retval.empty())
@@ -2852,6 +3020,137 @@ S9sOptions::updateFreq() const
     return retval.toInt();
 }
 
+/**
+ * \returns The maximum number of times the interactive views are allowed to
+ *   redraw the screen in one second, set by the --max-fps command line option
+ *   or the max_fps configuration variable.
+ */
+int
+S9sOptions::maxFps() const
+{
+    S9sString retval;
+
+    if (m_options.contains("max_fps"))
+    {
+        retval = m_options.at("max_fps").toString();
+    } else {
+        retval = configValue("max_fps");
+    }
+
+    if (retval.empty() || retval.toInt() < 1)
+        return 10;
+
+    return retval.toInt();
+}
+
+/**
+ * \returns How many events the interactive monitor keeps in its history, set
+ *   by the --event-history command line option or the event_history
+ *   configuration variable.
+ */
+int
+S9sOptions::eventHistory() const
+{
+    S9sString retval;
+
+    if (m_options.contains("event_history"))
+    {
+        retval = m_options.at("event_history").toString();
+    } else {
+        retval = configValue("event_history");
+    }
+
+    if (retval.empty() || retval.toInt() < 1)
+        return 3000;
+
+    return retval.toInt();
+}
+
+/**
+ * \returns The shortest delay between two polls of a job in milliseconds, set
+ *   by the --poll-min command line option or the poll_min configuration
+ *   variable.
+ */
+int
+S9sOptions::pollMin() const
+{
+    S9sString retval;
+
+    if (m_options.contains("poll_min"))
+    {
+        retval = m_options.at("poll_min").toString();
+    } else {
+        retval = configValue("poll_min");
+    }
+
+    if (retval.empty() || retval.toInt() < 1)
+        return 100;
+
+    return retval.toInt();
+}
+
+/**
+ * \returns The longest delay between two polls of a job in milliseconds, set
+ *   by the --poll-max command line option or the poll_max configuration
+ *   variable.
+ */
+int
+S9sOptions::pollMax() const
+{
+    S9sString retval;
+
+    if (m_options.contains("poll_max"))
+    {
+        retval = m_options.at("poll_max").toString();
+    } else {
+        retval = configValue("poll_max");
+    }
+
+    if (retval.empty() || retval.toInt() < 1)
+        return 1000;
+
+    return retval.toInt();
+}
+
+/**
+ * \returns The percentage of the random jitter applied to the polling delays,
+ *   set by the --poll-jitter command line option or the poll_jitter
+ *   configuration variable.
+ */
+int
+S9sOptions::pollJitter() const
+{
+    S9sString retval;
+
+    if (m_options.contains("poll_jitter"))
+    {
+        retval = m_options.at("poll_jitter").toString();
+    } else {
+        retval = configValue("poll_jitter");
+    }
+
+    if (retval.empty() || retval.toInt() < 0 || retval.toInt() > 100)
+        return 20;
+
+    return retval.toInt();
+}
+
+/**
+ * \returns How many megabytes the local cache of the statistics may use on the
+ *   disk, set by the stat_cache_size configuration variable. The cache is
+ *   disabled by default and when the value is 0.
+ */
+int
+S9sOptions::statCacheSize() const
+{
+    S9sString retval = configValue("stat_cache_size");
+
+    if (retval.empty() || retval.toInt() < 0)
+        return 0;
+
+    return retval.toInt();
+}
+
 /**
  * \returns the value set by the --cluster-name command line option.
  */
@@ -2922,15 +3221,127 @@ S9sOptions::hasJobId() const
 }
 
 /**
- * \returns The job ID as it is set by the --job-id command line option.
+ * \returns The job ID as it is set by the --job-id command line option.
+ */
+int
+S9sOptions::jobId() const
+{
+    if (m_options.contains("job_id"))
+        return m_options.at("job_id").toInt();
+
+    return -1;
+}
+
+/**
+ * \param value The argument of the --job-id option, one job ID or a comma
+ *   separated list of job IDs.
+ * \returns False if the value is not a valid list of job IDs.
+ *
+ * The first job ID is also stored as the job ID, so the operations that handle
+ * only one job keep working.
+ */
+bool
+S9sOptions::setJobIds(
+        const S9sString &value)
+{
+    S9sVariantList parts = value.split(",");
+    S9sVariantList jobIds;
+
+    for (uint idx = 0u; idx < parts.size(); ++idx)
+    {
+        S9sString part = parts[idx].toString().trim();
+
+        if (!part.looksInteger() || part.toInt() < 0)
+        {
+            m_errorMessage.sprintf(
+                    "The value '%s' is invalid for --job-id.", STR(value));
+
+            m_exitStatus = BadOptions;
+            return false;
+        }
+
+        jobIds << part.toInt();
+    }
+
+    if (jobIds.empty())
+    {
+        m_errorMessage = "The --job-id option requires a job ID.";
+        m_exitStatus = BadOptions;
+        return false;
+    }
+
+    m_options["job_id"]  = jobIds[0].toInt();
+    m_options["job_ids"] = jobIds;
+    return true;
+}
+
+/**
+ * \returns The job IDs as they are set by the --job-id command line option,
+ *   e.g. "--job-id=10,11,12".
+ */
+S9sVariantList
+S9sOptions::jobIds() const
+{
+    S9sVariantList retval;
+
+    if (m_options.contains("job_ids"))
+        retval = m_options.at("job_ids").toVariantList();
+    else if (m_options.contains("job_id"))
+        retval << m_options.at("job_id");
+
+    return retval;
+}
+
+/**
+ * \returns True if the --build-index main option was provided.
+ */
+bool
+S9sOptions::isBuildIndexRequested() const
+{
+    return getBool("build_index");
+}
+
+/**
+ * \returns The value of the --seek command line option, the time where the
+ *   play back of a recording should start.
+ */
+S9sString
+S9sOptions::seek() const
+{
+    return getString("seek");
+}
+
+/**
+ * \returns When the event recording should be synced to the disk as it is set
+ *   by the --output-fsync command line option or the output_fsync
+ *   configuration value, see S9sEventRecorder::setSyncPolicy().
  */
 int
-S9sOptions::jobId() const
+S9sOptions::outputFsync() const
 {
-    if (m_options.contains("job_id"))
-        return m_options.at("job_id").toInt();
+    S9sString value;
+    int       retval;
 
-    return -1;
+    if (m_options.contains("output_fsync"))
+    {
+        value = m_options.at("output_fsync").toString();
+    } else {
+        value = configValue("output_fsync");
+    }
+
+    if (value.empty() || !S9sEventRecorder::parseSyncPolicy(value, retval))
+        return S9sEventRecorder::SyncNever;
+
+    return retval;
+}
+
+/**
+ * \returns True if the --all-running command line option was provided.
+ */
+bool
+S9sOptions::isAllRunningRequested() const
+{
+    return getBool("all_running");
 }
 
 
@@ -3168,10 +3579,7 @@ S9sOptions::userName(
     {
         retval = m_options.at("cmon_user").toString();
     } else {
-        retval = m_userConfig.variableValue("cmon_user");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("cmon_user");
+        retval = configValue("cmon_user");
     }
 
     if (retval.empty() && tryLocalUserToo)
@@ -3191,19 +3599,19 @@ S9sOptions::password() const
     if (m_options.contains("password"))
     {
         retval = m_options.at("password").toString();
-    } else if (!m_userConfig.variableValue("cmon_user").empty())
+    } else if (!userConfigValue("cmon_user").empty())
     {
         /*
          * A username is defined in user config the we must
          * use the password from the user config
          */
-        retval = m_userConfig.variableValue("cmon_password");
+        retval = userConfigValue("cmon_password");
     } else {
         /*
          * Username is not defined in the user config, so
          * we can safely return the system's config password here
          */
-        retval = m_systemConfig.variableValue("cmon_password");
+        retval = systemConfigValue("cmon_password");
     }
 
     return retval;
@@ -3380,10 +3788,10 @@ S9sOptions::maskPasswords() const
     if (getBool(key))
         return true;
 
-    if (m_userConfig.variableValue(key).toBoolean())
+    if (userConfigValue(key).toBoolean())
         return true;
 
-    if (m_systemConfig.variableValue(key).toBoolean())
+    if (systemConfigValue(key).toBoolean())
         return true;
 
     return false;
@@ -3689,12 +4097,9 @@ S9sOptions::useInternalRepos() const
     {
         retval = m_options.at("use_internal_repos").toBoolean();
     } else {
-        retval = m_userConfig.variableValue("use_internal_repos").toBoolean();
+        retval = userConfigValue("use_internal_repos").toBoolean();
         if (!retval)
-        {
-            retval = m_systemConfig.variableValue(
-                    "use_internal_repos").toBoolean();
-        }
+            retval = systemConfigValue("use_internal_repos").toBoolean();
     }
 
     return retval;
@@ -3733,12 +4138,9 @@ S9sOptions::keepFirewall() const
     {
         retval = m_options.at("keep_firewall").toBoolean();
     } else {
-        retval = m_userConfig.variableValue("keep_firewall").toBoolean();
+        retval = userConfigValue("keep_firewall").toBoolean();
         if (!retval)
-        {
-            retval = m_systemConfig.variableValue(
-                    "keep_firewall").toBoolean();
-        }
+            retval = systemConfigValue("keep_firewall").toBoolean();
     }
 
     return retval;
@@ -3852,9 +4254,7 @@ S9sOptions::backupDir() const
     {
         retval = m_options.at("backup_directory").toString();
     } else {
-        retval = m_userConfig.variableValue("backup_directory");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("backup_directory");
+        retval = configValue("backup_directory");
     }
 
     return retval;
@@ -3880,9 +4280,7 @@ S9sOptions::snapshotRepositoryName() const
     {
         retval = m_options.at("snapshot_repository").toString();
     } else {
-        retval = m_userConfig.variableValue("snapshot_repository");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("snapshot_repository");
+        retval = configValue("snapshot_repository");
     }
 
     return retval;
@@ -3908,9 +4306,7 @@ S9sOptions::snapshotRepositoryType() const
     {
         retval = m_options.at("snapshot_repository_type").toString();
     } else {
-        retval = m_userConfig.variableValue("snapshot_repository_type");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("snapshot_repository_type");
+        retval = configValue("snapshot_repository_type");
     }
 
     return retval;
@@ -3935,9 +4331,7 @@ S9sOptions::s3bucket() const
     {
         retval = m_options.at("s3_bucket").toString();
     } else {
-        retval = m_userConfig.variableValue("s3_bucket");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("s3_bucket");
+        retval = configValue("s3_bucket");
     }
 
     return retval;
@@ -3962,9 +4356,7 @@ S9sOptions::s3region() const
     {
         retval = m_options.at("s3_region").toString();
     } else {
-        retval = m_userConfig.variableValue("s3_region");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("s3_region");
+        retval = configValue("s3_region");
     }
 
     return retval;
@@ -3988,9 +4380,7 @@ S9sOptions::s3AccessKeyId() const
     {
         retval = m_options.at("s3_access_key_id").toString();
     } else {
-        retval = m_userConfig.variableValue("s3_access_key_id");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("s3_access_key_id");
+        retval = configValue("s3_access_key_id");
     }
 
     return retval;
@@ -4014,9 +4404,7 @@ S9sOptions::s3SecretKey() const
     {
         retval = m_options.at("s3_secret_key").toString();
     } else {
-        retval = m_userConfig.variableValue("s3_secret_key");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("s3_secret_key");
+        retval = configValue("s3_secret_key");
     }
 
     return retval;
@@ -4040,9 +4428,7 @@ S9sOptions::endpoint() const
     {
         retval = m_options.at("endpoint").toString();
     } else {
-        retval = m_userConfig.variableValue("endpoint");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("endpoint");
+        retval = configValue("endpoint");
     }
 
     return retval;
@@ -4123,9 +4509,7 @@ S9sOptions::cloudProvider() const
     {
         retval = m_options.at("cloud_provider").toString();
     } else {
-        retval = m_userConfig.variableValue("cloud_provider");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("cloud_provider");
+        retval = configValue("cloud_provider");
     }
 
     return retval;
@@ -4145,9 +4529,7 @@ S9sOptions::snapshotLocation() const
     {
         retval = m_options.at("snapshot_location").toString();
     } else {
-        retval = m_userConfig.variableValue("snapshot_location");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("snapshot_location");
+        retval = configValue("snapshot_location");
     }
 
     return retval;
@@ -4166,9 +4548,7 @@ S9sOptions::storageHost() const
     {
         retval = m_options.at("storage_host").toString();
     } else {
-        retval = m_userConfig.variableValue("storage_host");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("storage_host");
+        retval = configValue("storage_host");
     }
 
     return retval;
@@ -4312,9 +4692,7 @@ S9sOptions::backupMethod() const
     {
         retval = m_options.at("backup_method").toString();
     } else {
-        retval = m_userConfig.variableValue("backup_method");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("backup_method");
+        retval = configValue("backup_method");
     }
 
     return retval;
@@ -4334,9 +4712,7 @@ S9sOptions::backupPath() const
     {
         retval = m_options.at("backup_path").toString();
     } else {
-        retval = m_userConfig.variableValue("backup_path");
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("backup_path");
+        retval = configValue("backup_path");
     }
 
     return retval;
@@ -7064,6 +7440,83 @@ S9sOptions::isJsonRequested() const
     return getBool("print_json");
 }
 
+/**
+ * \returns The format name set by the --output command line option, the empty
+ *   string if the option was not provided.
+ */
+S9sString
+S9sOptions::outputFormat() const
+{
+    return getString("output_format");
+}
+
+/**
+ * \returns True if the --output command line option was provided and the lists
+ *   should be printed as one record per line.
+ */
+bool
+S9sOptions::hasOutputFormat() const
+{
+    return m_options.contains("output_format");
+}
+
+/**
+ * \param value The argument of the --output command line option.
+ */
+bool
+S9sOptions::setOutputFormat(
+        const S9sString &value)
+{
+    if (S9sRecordWriter::formatFromString(value) == S9sRecordWriter::Invalid)
+    {
+        m_errorMessage.sprintf(
+                "The value '%s' is invalid for --output "
+                "(must be ndjson, csv or tsv).",
+                STR(value));
+
+        m_exitStatus = BadOptions;
+        return false;
+    }
+
+    m_options["output_format"] = value.toLower();
+    return true;
+}
+
+/**
+ * \returns The list of field paths set by the --fields command line option.
+ */
+S9sVariantList
+S9sOptions::outputFields() const
+{
+    S9sVariantList retval;
+
+    if (m_options.contains("output_fields"))
+        retval = m_options.at("output_fields").toVariantList();
+
+    return retval;
+}
+
+/**
+ * \param value The argument, a list of strings with , or ; as field separator.
+ */
+void
+S9sOptions::setOutputFields(
+        const S9sString &value)
+{
+    S9sVariantList fields = value.split(";,");
+    S9sVariantList trimmed;
+
+    for (uint idx = 0u; idx < fields.size(); ++idx)
+    {
+        S9sString field = fields[idx].toString().trim();
+
+        if (!field.empty())
+            trimmed << field;
+    }
+
+    m_options["output_fields"] = trimmed;
+}
+
 /**
  * \returns true if the --print-request command line option was provided when the
  *   program was started.
@@ -7214,31 +7667,28 @@ S9sOptions::extraArgument(
 bool
 S9sOptions::useSyntaxHighlight() const
 {
-    S9sString configValue;
+    S9sString stringValue;
 
     if (isBatchRequested())
         return false;
 
     if (m_options.contains("color"))
     {
-        configValue = m_options.at("color").toString();
+        stringValue = m_options.at("color").toString();
     } else {
-        configValue = m_userConfig.variableValue("color");
-
-        if (configValue.empty())
-            configValue = m_systemConfig.variableValue("color");
+        stringValue = configValue("color");
     }
 
-    if (configValue.empty())
-        configValue = "auto";
+    if (stringValue.empty())
+        stringValue = "auto";
 
-    if (configValue.toLower() == "auto")
+    if (stringValue.toLower() == "auto")
     {
         if (isBatchRequested())
             return false;
 
-        return isatty(fileno(stdout)) ? true : false;
-    } else if (configValue.toLower() == "always")
+        return m_stdoutIsTerminal;
+    } else if (stringValue.toLower() == "always")
     {
         return true;
     }
@@ -7255,28 +7705,25 @@ S9sOptions::noWrap() const
 bool
 S9sOptions::truncate()
 {
-    S9sString configValue;
+    S9sString stringValue;
 
     if (m_options.contains("truncate"))
     {
-        configValue = m_options.at("truncate").toString();
+        stringValue = m_options.at("truncate").toString();
     } else {
-        configValue = m_userConfig.variableValue("truncate");
-
-        if (configValue.empty())
-            configValue = m_systemConfig.variableValue("truncate");
+        stringValue = configValue("truncate");
     }
 
-    if (configValue.empty())
-        configValue = "auto";
+    if (stringValue.empty())
+        stringValue = "auto";
 
-    if (configValue.toLower() == "auto")
+    if (stringValue.toLower() == "auto")
     {
         if (isBatchRequested())
             return false;
 
-        return isatty(fileno(stdout)) ? true : false;
-    } else if (configValue.toLower() == "always")
+        return m_stdoutIsTerminal;
+    } else if (stringValue.toLower() == "always")
     {
         return true;
     }
@@ -7443,10 +7890,7 @@ S9sOptions::useTls()
     {
         retval = m_options.at("rpc_tls").toString();
     } else {
-        retval = m_userConfig.variableValue("rpc_tls");
-
-        if (retval.empty())
-            retval = m_systemConfig.variableValue("rpc_tls");
+        retval = configValue("rpc_tls");
     }
 
     return retval.toBoolean();
@@ -8022,6 +8466,8 @@ S9sOptions::printHelpGeneric()
 "  --log-file=PATH            The path where the s9s client puts its logs.\n"
 "  --no-header                Do not print headers.\n"
 "  --only-ascii               Do not use UTF8 characters.\n"
+"  --fields=LIST              The fields printed with the --output option.\n"
+"  --output=ndjson|csv|tsv    Print lists as one record per line.\n"
 "  --print-json               Print the sent/received JSon messages.\n"
 "  --print-request            Print the sent JSon request message.\n"
 "\n"
@@ -8050,7 +8496,7 @@ S9sOptions::printHelpJob()
 "  --list                     List the jobs.\n"
 "  --log                      Print the job log messages.\n"
 "  --success                  Create a job that does nothing and succeeds.\n"
-"  --wait                     Wait for the job referenced by the job ID.\n"
+"  --wait                     Wait for the job(s) referenced by the job ID.\n"
 "  --disable                  Disable or pause a recurring/scheduled job instance.\n"
 "  --enable                   Enable/resume a recurring/scheduled job instance.\n"
 "\n"
@@ -8058,11 +8504,16 @@ S9sOptions::printHelpJob()
 "  --cluster-name=NAME        Name of the cluster.\n"
 "\n"
 "  --from=DATE&TIME           The start of the interval to be printed.\n"
-"  --job-id=ID                The ID of the job.\n"
+"  --all-running              Wait for all the running jobs.\n"
+"  --job-id=ID[,ID...]        The ID of the job or jobs.\n"
 "  --limit=NUMBER             Controls how many jobs are printed max.\n"
 "  --offset=NUMBER            Controls the index of the first item printed.\n"
 "  --until=DATE&TIME          The end of the interval to be printed.\n"
 "\n"
+"  --poll-jitter=PERCENT      Random jitter applied to the polling delays.\n"
+"  --poll-max=MILLISECONDS    The longest delay between polls while waiting.\n"
+"  --poll-min=MILLISECONDS    The shortest delay between polls while waiting.\n"
+"\n"
 "  --show-aborted             Show aborted jobs while printing job list.\n"
 "  --show-defined             Show defined jobs while printing job list.\n"
 "  --show-failed              Show failed jobs while printing job list.\n"
@@ -8591,7 +9042,8 @@ S9sOptions::printHelpNode()
 "  --force                    Force to execute dangerous operations.\n"
 "  --bootstrap                Bootstrap starting (first) node in cluster.\n"
 "  --initial-start            Resynch node while starting or restarting it.\n"
-"  --graph=NAME               The name of the graph to show.\n"
+"  --graph=NAME[,NAME...]     The name of the graph(s) to show.\n"
+"  --follow                   Keep updating the graphs from the events.\n"
 "  --node-format=FORMAT       The format string used to print nodes.\n"
 "  --opt-group=GROUP          The configuration option group.\n"
 "  --opt-name=NAME            The name of the configuration option.\n"
@@ -8745,6 +9197,7 @@ S9sOptions::printHelpLog()
 
     printf(
 "Options for the \"log\" command:\n"
+"  --follow                   Print the log and wait for the new messages.\n"
 "  --list                     List the log messages, print the log.\n"
 "\n"
 "  --debug                    Print the debug messages too.\n"
@@ -8767,11 +9220,18 @@ S9sOptions::printHelpEvent()
 
     printf(
 "Options for the \"event\" command:\n"
+"  --build-index              Create the time index for the input file.\n"
 "  --list                     List the events as they are detected.\n"
 "  --watch                    Open an interactive UI to monitor events.\n"
 "\n"
+"  --event-history=NUMBER     The number of events kept in the event view.\n"
+"  --input-file=FILENAME      Play back the events from the input file.\n"
+"  --max-fps=NUMBER           The maximum number of screen updates per second.\n"
 "  --output-file=FILENAME     Save the events into the output file.\n"
+"  --output-fsync=POLICY      Sync the output file: never, batch or SECONDS.\n"
+"  --seek=TIME                Start the play back at the given time.\n"
 "\n"
+"  --host-pattern=PATTERN     Process events about the matching hosts only.\n"
 "  --with-event-alarm         Process alarm events.\n"
 "  --with-event-cluster       Process cluster events.\n"
 "  --with-event-debug         Process debug events.\n"
@@ -9014,6 +9474,8 @@ S9sOptions::readOptionsNode(
         { "rpc-tls",          no_argument,       0, OptionRpcTls          },
         { "long",             no_argument,       0, 'l'                   },
         { "print-json",       no_argument,       0, OptionPrintJson       },
+        { "output",           required_argument, 0, OptionOutputFormat    },
+        { "fields",           required_argument, 0, OptionFields          },
         { "print-request",    no_argument,       0, OptionPrintRequest    },
         { "color",            optional_argument, 0, OptionColor           },
         { "config-file",      required_argument, 0,  4                    },
@@ -9084,6 +9546,7 @@ S9sOptions::readOptionsNode(
 
         // Graphs...
         { "graph",            required_argument, 0, OptionGraph           }, 
+        { "follow",           no_argument,       0, 'f'                   },
         { "begin",            required_argument, 0, OptionBegin           },
         { "end",              required_argument, 0, OptionEnd             },
         
@@ -9342,6 +9805,17 @@ S9sOptions::readOptionsNode(
                 m_options["print_json"] = true;
                 break;
 
+            case OptionOutputFormat:
+                // --output=FORMAT
+                if (!setOutputFormat(optarg))
+                    return false;
+                break;
+
+            case OptionFields:
+                // --fields=LIST
+                setOutputFields(optarg);
+                break;
+
             case OptionPrintRequest:
                 // --print-request
                 m_options["print_request"] = true;
@@ -9417,6 +9891,11 @@ S9sOptions::readOptionsNode(
                 // --graph=GRAPH
                 m_options["graph"] = optarg;
                 break;
+
+            case 'f':
+                // --follow
+                m_options["follow"] = true;
+                break;
             
             case OptionBegin:
                 // --begin=DATE
@@ -9545,6 +10024,8 @@ S9sOptions::readOptionsBackup(
         { "long",             no_argument,       0, 'l'                   },
         { "password",         required_argument, 0, 'p'                   }, 
         { "print-json",       no_argument,       0, OptionPrintJson       },
+        { "output",           required_argument, 0, OptionOutputFormat    },
+        { "fields",           required_argument, 0, OptionFields          },
         { "print-request",    no_argument,       0, OptionPrintRequest    },
         { "private-key-file", required_argument, 0, OptionPrivateKeyFile  }, 
         { "rpc-tls",          no_argument,       0, OptionRpcTls          },
@@ -9878,6 +10359,17 @@ S9sOptions::readOptionsBackup(
                 m_options["print_json"] = true;
                 break;
 
+            case OptionOutputFormat:
+                // --output=FORMAT
+                if (!setOutputFormat(optarg))
+                    return false;
+                break;
+
+            case OptionFields:
+                // --fields=LIST
+                setOutputFields(optarg);
+                break;
+
             case OptionPrintRequest:
                 // --print-request
                 m_options["print_request"] = true;
@@ -10272,9 +10764,10 @@ S9sOptions::checkOptionsLog()
         return true;
 
     /*
-     * Checking if multiple operations are requested.
+     * Checking if multiple operations are requested. The --follow can be
+     * used alone or together with the --list.
      */
-    if (isListRequested())
+    if (isListRequested() || isFollowRequested())
         countOptions++;
     
     if (isCreateRequested())
@@ -10292,7 +10785,7 @@ S9sOptions::checkOptionsLog()
     } else if (countOptions == 0)
     {
         m_errorMessage = 
-            "One of the --list and --create options is mandatory.";
+            "One of the --list, --follow and --create options is mandatory.";
 
         m_exitStatus = BadOptions;
 
@@ -10322,10 +10815,13 @@ S9sOptions::checkOptionsEvent()
     if (isWatchRequested())
         countOptions++;
     
+    if (isBuildIndexRequested())
+        countOptions++;
+    
     if (countOptions > 1)
     {
         m_errorMessage = 
-            "The --list and --create "
+            "The --list, --watch and --build-index "
             "options are mutually exclusive.";
 
         m_exitStatus = BadOptions;
@@ -10334,7 +10830,36 @@ S9sOptions::checkOptionsEvent()
     } else if (countOptions == 0)
     {
         m_errorMessage = 
-            "One of the --list and --create options is mandatory.";
+            "One of the --list, --watch and --build-index options is "
+            "mandatory.";
+
+        m_exitStatus = BadOptions;
+
+        return false;
+    }
+
+    /*
+     * The index and the seeking are for the recordings.
+     */
+    if ((isBuildIndexRequested() || !seek().empty()) && inputFile().empty())
+    {
+        m_errorMessage = 
+            "The --build-index and --seek options need the --input-file "
+            "option.";
+
+        m_exitStatus = BadOptions;
+
+        return false;
+    }
+
+    /*
+     * The views of the interactive UI need the events about all the hosts to
+     * build their model, the host pattern is only for printing the events.
+     */
+    if (isWatchRequested() && !hostPattern().empty())
+    {
+        m_errorMessage = 
+            "The --host-pattern option can not be used with --watch.";
 
         m_exitStatus = BadOptions;
 
@@ -10503,6 +11028,8 @@ S9sOptions::readOptionsLog(
         { "rpc-tls",          no_argument,       0, OptionRpcTls          },
         { "long",             no_argument,       0, 'l'                   },
         { "print-json",       no_argument,       0, OptionPrintJson       },
+        { "output",           required_argument, 0, OptionOutputFormat    },
+        { "fields",           required_argument, 0, OptionFields          },
         { "print-request",    no_argument,       0, OptionPrintRequest    },
         { "color",            optional_argument, 0, OptionColor           },
         { "config-file",      required_argument, 0,  4                    },
@@ -10510,6 +11037,7 @@ S9sOptions::readOptionsLog(
 
         // Main Option
         { "list",             no_argument,       0, 'L'                   },
+        { "follow",           no_argument,       0, 'f'                   },
 
         // Cluster information
         { "cluster-id",       required_argument, 0, 'i'                   },
@@ -10540,7 +11068,7 @@ S9sOptions::readOptionsLog(
     {
         int option_index = 0;
         c = getopt_long(
-                argc, argv, "hvc:t:V", 
+                argc, argv, "hvc:t:Vf", 
                 long_options, &option_index);
 
         if (c == -1)
@@ -10603,6 +11131,11 @@ S9sOptions::readOptionsLog(
                 m_options["list"] = true;
                 break;
 
+            case 'f': 
+                // -f, --follow
+                m_options["follow"] = true;
+                break;
+
             case 4:
                 // --config-file=FILE
                 m_options["config-file"] = optarg;
@@ -10636,6 +11169,17 @@ S9sOptions::readOptionsLog(
                 m_options["print_json"] = true;
                 break;
 
+            case OptionOutputFormat:
+                // --output=FORMAT
+                if (!setOutputFormat(optarg))
+                    return false;
+                break;
+
+            case OptionFields:
+                // --fields=LIST
+                setOutputFields(optarg);
+                break;
+
             case OptionPrintRequest:
                 // --print-request
                 m_options["print_request"] = true;
@@ -10750,6 +11294,7 @@ S9sOptions::readOptionsEvent(
         // Main Option
         { "list",             no_argument,       0, 'L'                   },
         { "watch",            no_argument,       0, OptionWatch           },
+        { "build-index",      no_argument,       0, OptionBuildIndex      },
 
         // Cluster information
         { "cluster-id",       required_argument, 0, 'i'                   },
@@ -10757,6 +11302,11 @@ S9sOptions::readOptionsEvent(
         { "nodes",            required_argument, 0, OptionNodes           },
         { "output-file",      required_argument, 0, OptionOutputFile      },
         { "input-file",       required_argument, 0, OptionInputFile       },
+        { "max-fps",          required_argument, 0, OptionMaxFps          },
+        { "event-history",    required_argument, 0, OptionEventHistory    },
+        { "output-fsync",     required_argument, 0, OptionOutputFsync     },
+        { "seek",             required_argument, 0, OptionSeek            },
+        { "host-pattern",     required_argument, 0, OptionHostPattern     },
         
         { "batch",            no_argument,       0, OptionBatch           },
         { "no-header",        no_argument,       0, OptionNoHeader        },
@@ -10879,6 +11429,81 @@ S9sOptions::readOptionsEvent(
                 m_options["input_file"] = optarg;
                 break;
 
+            case OptionBuildIndex:
+                // --build-index
+                m_options["build_index"] = true;
+                break;
+
+            case OptionOutputFsync:
+                // --output-fsync=POLICY
+                {
+                    int seconds;
+
+                    if (!S9sEventRecorder::parseSyncPolicy(optarg, seconds))
+                    {
+                        m_errorMessage.sprintf(
+                                "Invalid value for the --output-fsync "
+                                "option: '%s'.", optarg);
+
+                        m_exitStatus = BadOptions;
+                        return false;
+                    }
+                }
+
+                m_options["output_fsync"] = optarg;
+                break;
+
+            case OptionHostPattern:
+                // --host-pattern=PATTERN
+                m_options["host_pattern"] = optarg;
+                break;
+
+            case OptionSeek:
+                // --seek=TIME
+                {
+                    bool   relative;
+                    time_t seconds;
+
+                    if (!S9sEventIndex::parseSeek(optarg, relative, seconds))
+                    {
+                        m_errorMessage.sprintf(
+                                "Invalid value for the --seek option: '%s'.",
+                                optarg);
+
+                        m_exitStatus = BadOptions;
+                        return false;
+                    }
+                }
+
+                m_options["seek"] = optarg;
+                break;
+
+            case OptionMaxFps:
+                // --max-fps=NUMBER
+                m_options["max_fps"] = atoi(optarg);
+                if (m_options["max_fps"].toInt() < 1)
+                {
+                    m_errorMessage = 
+                        "Invalid value for the --max-fps option.";
+                
+                    m_exitStatus = BadOptions;
+                    return false;
+                }
+                break;
+
+            case OptionEventHistory:
+                // --event-history=NUMBER
+                m_options["event_history"] = atoi(optarg);
+                if (m_options["event_history"].toInt() < 1)
+                {
+                    m_errorMessage = 
+                        "Invalid value for the --event-history option.";
+                
+                    m_exitStatus = BadOptions;
+                    return false;
+                }
+                break;
+
             case OptionBatch:
                 // --batch
                 m_options["batch"] = true;
@@ -11118,6 +11743,8 @@ S9sOptions::readOptionsAlarm(
         { "no-header",        no_argument,       0, OptionNoHeader        },
         { "password",         required_argument, 0, 'p'                   }, 
         { "print-json",       no_argument,       0, OptionPrintJson       },
+        { "output",           required_argument, 0, OptionOutputFormat    },
+        { "fields",           required_argument, 0, OptionFields          },
         { "print-request",    no_argument,       0, OptionPrintRequest    },
         { "private-key-file", required_argument, 0, OptionPrivateKeyFile  }, 
         { "rpc-tls",          no_argument,       0, OptionRpcTls          },
@@ -11234,6 +11861,17 @@ S9sOptions::readOptionsAlarm(
                 m_options["print_json"] = true;
                 break;
 
+            case OptionOutputFormat:
+                // --output=FORMAT
+                if (!setOutputFormat(optarg))
+                    return false;
+                break;
+
+            case OptionFields:
+                // --fields=LIST
+                setOutputFields(optarg);
+                break;
+
             case OptionPrintRequest:
                 // --print-request
                 m_options["print_request"] = true;
@@ -12731,6 +13369,39 @@ S9sOptions::checkOptionsJob()
             countOptions++;
     }
 
+    if (isAllRunningRequested() && hasJobId())
+    {
+        m_errorMessage = 
+            "The --all-running and --job-id options are mutually exclusive.";
+        m_exitStatus = BadOptions;
+        return false;
+    }
+
+    if ((isAllRunningRequested() || jobIds().size() > 1u) &&
+            !isWaitRequested() && !isFollowRequested())
+    {
+        m_errorMessage = 
+            "Waiting for multiple jobs requires the --wait or --follow "
+            "option.";
+        m_exitStatus = BadOptions;
+        return false;
+    }
+
+    /*
+     * The other operations work on one job, they would silently use the first
+     * ID of the list.
+     */
+    if ((isAllRunningRequested() || jobIds().size() > 1u) &&
+            (isLogRequested() || isDeleteRequested() || isCloneRequested() ||
+             isKillRequested() || isFailRequested() || isSuccessRequested() ||
+             isEnableRequested() || isDisableRequested()))
+    {
+        m_errorMessage = 
+            "Only the --wait and --follow options accept multiple job IDs.";
+        m_exitStatus = BadOptions;
+        return false;
+    }
+
     if (isDeleteRequested())
     {
         if (!hasJobId())
@@ -13743,6 +14414,8 @@ S9sOptions::readOptionsUser(
         { "rpc-tls",          no_argument,       0, OptionRpcTls          },
         { "long",             no_argument,       0, 'l'                   },
         { "print-json",       no_argument,       0, OptionPrintJson       },
+        { "output",           required_argument, 0, OptionOutputFormat    },
+        { "fields",           required_argument, 0, OptionFields          },
         { "print-request",    no_argument,       0, OptionPrintRequest    },
         { "color",            optional_argument, 0, OptionColor           },
         { "config-file",      required_argument, 0, OptionConfigFile      },
@@ -13865,6 +14538,17 @@ S9sOptions::readOptionsUser(
                 m_options["print_json"] = true;
                 break;
 
+            case OptionOutputFormat:
+                // --output=FORMAT
+                if (!setOutputFormat(optarg))
+                    return false;
+                break;
+
+            case OptionFields:
+                // --fields=LIST
+                setOutputFields(optarg);
+                break;
+
             case OptionPrintRequest:
                 // --print-request
                 m_options["print_request"] = true;
@@ -16911,6 +17595,8 @@ S9sOptions::readOptionsJob(
         { "rpc-tls",          no_argument,       0,  6                    },
         { "long",             no_argument,       0, 'l'                   },
         { "print-json",       no_argument,       0,  OptionPrintJson      },
+        { "output",           required_argument, 0, OptionOutputFormat    },
+        { "fields",           required_argument, 0, OptionFields          },
         { "print-request",    no_argument,       0,  OptionPrintRequest   },
         { "config-file",      required_argument, 0,  OptionConfigFile     },
         { "color",            optional_argument, 0,  OptionColor          },
@@ -16934,6 +17620,10 @@ S9sOptions::readOptionsJob(
         { "cluster-id",       required_argument, 0, 'i'                   },
         { "cluster-name",     required_argument, 0, 'n'                   },
         { "job-id",           required_argument, 0, OptionJobId           },
+        { "all-running",      no_argument,       0, OptionAllRunning      },
+        { "poll-min",         required_argument, 0, OptionPollMin         },
+        { "poll-max",         required_argument, 0, OptionPollMax         },
+        { "poll-jitter",      required_argument, 0, OptionPollJitter      },
         { "job-tags",         required_argument, 0, OptionJobTags         },
         { "limit",            required_argument, 0, OptionLimit           },
         { "offset",           required_argument, 0, OptionOffset          },
@@ -17089,6 +17779,17 @@ S9sOptions::readOptionsJob(
                 m_options["print_json"] = true;
                 break;
 
+            case OptionOutputFormat:
+                // --output=FORMAT
+                if (!setOutputFormat(optarg))
+                    return false;
+                break;
+
+            case OptionFields:
+                // --fields=LIST
+                setOutputFields(optarg);
+                break;
+
             case OptionPrintRequest:
                 // --print-request
                 m_options["print_request"] = true;
@@ -17100,8 +17801,54 @@ S9sOptions::readOptionsJob(
                 break;
 
             case OptionJobId:
-                // --job-id=ID
-                m_options["job_id"] = atoi(optarg);
+                // --job-id=ID[,ID...]
+                if (!setJobIds(optarg))
+                    return false;
+                break;
+
+            case OptionAllRunning:
+                // --all-running
+                m_options["all_running"] = true;
+                break;
+
+            case OptionPollMin:
+                // --poll-min=MILLISECONDS
+                m_options["poll_min"] = atoi(optarg);
+                if (m_options["poll_min"].toInt() < 1)
+                {
+                    m_errorMessage = 
+                        "Invalid value for the --poll-min option.";
+                
+                    m_exitStatus = BadOptions;
+                    return false;
+                }
+                break;
+
+            case OptionPollMax:
+                // --poll-max=MILLISECONDS
+                m_options["poll_max"] = atoi(optarg);
+                if (m_options["poll_max"].toInt() < 1)
+                {
+                    m_errorMessage = 
+                        "Invalid value for the --poll-max option.";
+                
+                    m_exitStatus = BadOptions;
+                    return false;
+                }
+                break;
+
+            case OptionPollJitter:
+                // --poll-jitter=PERCENT
+                m_options["poll_jitter"] = atoi(optarg);
+                if (m_options["poll_jitter"].toInt() < 0 ||
+                        m_options["poll_jitter"].toInt() > 100)
+                {
+                    m_errorMessage = 
+                        "Invalid value for the --poll-jitter option.";
+                
+                    m_exitStatus = BadOptions;
+                    return false;
+                }
                 break;
 
             case OptionJobTags:
@@ -18454,6 +19201,8 @@ S9sOptions::readOptionsTree(
         { "controller",       required_argument, 0, 'c'                   },
         { "long",             no_argument,       0, 'l'                   },
         { "print-json",       no_argument,       0, OptionPrintJson       },
+        { "output",           required_argument, 0, OptionOutputFormat    },
+        { "fields",           required_argument, 0, OptionFields          },
         { "print-request",    no_argument,       0, OptionPrintRequest    },
         { "color",            optional_argument, 0, OptionColor           },
         { "human-readable",   no_argument,       0, 'h'                   },
@@ -18596,6 +19345,17 @@ S9sOptions::readOptionsTree(
                 m_options["print_json"] = true;
                 break;
 
+            case OptionOutputFormat:
+                // --output=FORMAT
+                if (!setOutputFormat(optarg))
+                    return false;
+                break;
+
+            case OptionFields:
+                // --fields=LIST
+                setOutputFields(optarg);
+                break;
+
             case OptionPrintRequest:
                 // --print-request
                 m_options["print_request"] = true;
@@ -20257,10 +21017,7 @@ S9sOptions::privateKeyPath() const
 
     S9sString authKey;
     
-    authKey = m_userConfig.variableValue("auth_key");
-
-    if (authKey.empty())
-        authKey =  m_systemConfig.variableValue("auth_key");
+    authKey = configValue("auth_key");
 
     if (authKey.empty() && !userName().empty())
         authKey.sprintf("~/.s9s/%s.key", STR(userName()));
@@ -27,7 +27,10 @@
 #include "s9svariantmap.h"
 #include "s9sconfigfile.h"
 
+#include <unordered_map>
+
 class S9sDateTime;
+class S9sEventFilter;
 class S9sSshCredentials;
 
 #define PRINT_VERBOSE(...) \
@@ -119,6 +122,8 @@ class S9sOptions
         void enableEventName(const S9sString &eventName);
         void disableEventName(const S9sString &eventName);
         bool eventNameEnabled(const S9sString &eventName);
+        S9sString hostPattern() const;
+        S9sEventFilter eventFilter();
 
         bool onlyAscii() const;
         int clientConnectionTimeout() const;
@@ -162,6 +167,9 @@ class S9sOptions
         S9sString inputFile() const;
         S9sString outputFile() const;
         S9sString logFile() const;
+        S9sString logLevel() const;
+        ulonglong logFileMaxSize() const;
+        int logFileCount() const;
 
         S9sString briefJobLogFormat() const;
         S9sString briefLogFormat() const;
@@ -305,6 +313,12 @@ class S9sOptions
 
         bool encryptBackup() const;
         int updateFreq() const;
+        int maxFps() const;
+        int eventHistory() const;
+        int pollMin() const;
+        int pollMax() const;
+        int pollJitter() const;
+        int statCacheSize() const;
         S9sString type() const;
         int reportId() const;
 
@@ -322,6 +336,12 @@ class S9sOptions
 
         bool hasJobId() const;
         int jobId() const;
+        bool setJobIds(const S9sString &value);
+        S9sVariantList jobIds() const;
+        bool isAllRunningRequested() const;
+        bool isBuildIndexRequested() const;
+        S9sString seek() const;
+        int outputFsync() const;
         
         bool hasMessageId() const;
         int messageId() const;
@@ -784,6 +804,11 @@ class S9sOptions
 
         bool isLongRequested() const;
         bool isJsonRequested() const;
+        S9sString outputFormat() const;
+        bool hasOutputFormat() const;
+        bool setOutputFormat(const S9sString &value);
+        S9sVariantList outputFields() const;
+        void setOutputFields(const S9sString &value);
         bool isJsonRequestRequested() const;
         bool isTopRequested() const;
         bool isWaitRequested() const;
@@ -990,6 +1015,20 @@ class S9sOptions
         static S9sString   sm_defaultSystemConfigFileName;
         static S9sOptions *sm_instance;
 
+        bool loadConfigFilesInternal();
+        void resolveConfig();
+        
+        S9sString configValue(const S9sString &key) const;
+        S9sString userConfigValue(const S9sString &key) const;
+        S9sString systemConfigValue(const S9sString &key) const;
+
+    private:
+        typedef std::unordered_map<std::string, S9sString> ConfigIndex;
+
+        static void indexConfig(
+                const S9sConfigFile  &configFile,
+                ConfigIndex          &index);
+
     private:
         S9sMap<S9sString, OperationMode> m_modes;
         S9sFileName          m_myName;
@@ -999,6 +1038,11 @@ class S9sOptions
         S9sVariantMap        m_options;
         S9sConfigFile        m_userConfig;
         S9sConfigFile        m_systemConfig;
+        /** The configuration values indexed after the files are loaded. */
+        ConfigIndex          m_userConfigValues;
+        ConfigIndex          m_systemConfigValues;
+        ConfigIndex          m_configValues;
+        bool                 m_stdoutIsTerminal;
         S9sVariantList       m_extraArguments;
         S9sVariantMap        m_state;
         /* Reconstructed command line for debugging purposes. */
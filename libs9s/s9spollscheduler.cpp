@@ -0,0 +1,204 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9spollscheduler.h"
+
+#include "s9soptions.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/*
+ * We never wait longer than this, even if the controller asks for it.
+ */
+#define MAX_HINT_MS 60000
+
+/**
+ * \param minInterval The shortest delay in milliseconds, used at the start
+ *   and whenever the polled object changes.
+ * \param maxInterval The longest delay in milliseconds while nothing changes.
+ * \param jitterPercent The delays are shortened randomly by up to this
+ *   percentage.
+ */
+S9sPollScheduler::S9sPollScheduler(
+        const int minInterval,
+        const int maxInterval,
+        const int jitterPercent) :
+    m_minInterval(100),
+    m_maxInterval(1000),
+    m_jitterPercent(0),
+    m_interval(0),
+    m_hint(-1)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    m_seed = (unsigned int) (now.tv_nsec ^ (getpid() << 16) ^ 
+            (unsigned long) this);
+
+    setLimits(minInterval, maxInterval);
+    setJitter(jitterPercent);
+    reset();
+}
+
+/**
+ * Sets the shortest and the longest delays, the values are corrected if they
+ * are out of range or swapped.
+ */
+void
+S9sPollScheduler::setLimits(
+        const int minInterval,
+        const int maxInterval)
+{
+    m_minInterval = minInterval > 0 ? minInterval : 1;
+    m_maxInterval = maxInterval > m_minInterval ? maxInterval : m_minInterval;
+
+    if (m_interval < m_minInterval)
+        m_interval = m_minInterval;
+    else if (m_interval > m_maxInterval)
+        m_interval = m_maxInterval;
+}
+
+int
+S9sPollScheduler::minInterval() const
+{
+    return m_minInterval;
+}
+
+int
+S9sPollScheduler::maxInterval() const
+{
+    return m_maxInterval;
+}
+
+void
+S9sPollScheduler::setJitter(
+        const int jitterPercent)
+{
+    if (jitterPercent < 0)
+        m_jitterPercent = 0;
+    else if (jitterPercent > 100)
+        m_jitterPercent = 100;
+    else
+        m_jitterPercent = jitterPercent;
+}
+
+int
+S9sPollScheduler::jitter() const
+{
+    return m_jitterPercent;
+}
+
+/**
+ * \param milliseconds The delay the controller asked for before the next
+ *   request, -1 if the controller sent no such hint.
+ *
+ * The hint is used for the next delay only.
+ */
+void
+S9sPollScheduler::setHint(
+        const int milliseconds)
+{
+    if (milliseconds <= 0)
+        m_hint = -1;
+    else if (milliseconds > MAX_HINT_MS)
+        m_hint = MAX_HINT_MS;
+    else
+        m_hint = milliseconds;
+}
+
+/**
+ * Starts over from the shortest delay.
+ */
+void
+S9sPollScheduler::reset()
+{
+    m_interval = m_minInterval;
+}
+
+/**
+ * \param changed True if the polled object changed since the last poll.
+ * \returns The delay in milliseconds before the next poll.
+ */
+int
+S9sPollScheduler::nextDelay(
+        const bool changed)
+{
+    int retval;
+
+    if (changed)
+    {
+        m_interval = m_minInterval;
+    } else if (m_interval < m_maxInterval)
+    {
+        m_interval = m_interval * 2 < m_maxInterval ? 
+            m_interval * 2 : m_maxInterval;
+    }
+
+    retval = m_interval;
+
+    /*
+     * The jitter only shortens the delay so the longest delay is still the
+     * upper limit of the time it takes to notice a change.
+     */
+    if (m_jitterPercent > 0 && retval > 1)
+    {
+        int range = retval * m_jitterPercent / 100;
+
+        if (range > 0)
+            retval -= rand_r(&m_seed) % (range + 1);
+    }
+
+    if (m_hint > retval)
+        retval = m_hint;
+
+    m_hint = -1;
+
+    S9S_DEBUG("changed: %s interval: %d delay: %d", 
+            changed ? "true" : "false", m_interval, retval);
+
+    return retval;
+}
+
+/**
+ * \returns The current delay without the jitter in milliseconds.
+ */
+int
+S9sPollScheduler::interval() const
+{
+    return m_interval;
+}
+
+/**
+ * \returns A scheduler that uses the limits set by the --poll-min, --poll-max
+ *   and --poll-jitter command line options (or the configuration file).
+ */
+S9sPollScheduler
+S9sPollScheduler::fromOptions()
+{
+    S9sOptions *options = S9sOptions::instance();
+
+    return S9sPollScheduler(
+            options->pollMin(), options->pollMax(), options->pollJitter());
+}
@@ -0,0 +1,68 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sglobal.h"
+
+/**
+ * Computes the delays between the polls of a job (or anything else we have to
+ * query periodically). The polling starts fast and the delay is reset to the
+ * shortest value every time the polled object changes, so the consecutive
+ * messages of a busy job are picked up quickly. While nothing changes the
+ * delay grows exponentially up to a limit. A random jitter is applied to the
+ * delays so that the many clients that wait for the same job do not send
+ * their requests at the same moment.
+ *
+ * The controller can ask us to slow down (e.g. with a Retry-After header), the
+ * next delay is then never shorter than what the controller asked for.
+ */
+class S9sPollScheduler
+{
+    public:
+        S9sPollScheduler(
+                const int minInterval   = 100,
+                const int maxInterval   = 1000,
+                const int jitterPercent = 20);
+
+        void setLimits(const int minInterval, const int maxInterval);
+        int minInterval() const;
+        int maxInterval() const;
+
+        void setJitter(const int jitterPercent);
+        int jitter() const;
+
+        void setHint(const int milliseconds);
+
+        void reset();
+        int nextDelay(const bool changed);
+        int interval() const;
+
+        static S9sPollScheduler fromOptions();
+
+    private:
+        int             m_minInterval;
+        int             m_maxInterval;
+        int             m_jitterPercent;
+        /** The delay without the jitter. */
+        int             m_interval;
+        /** The delay the controller asked for, -1 if none. */
+        int             m_hint;
+        unsigned int    m_seed;
+};
@@ -0,0 +1,449 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9sprocesstable.h"
+
+#include "s9svariantmap.h"
+
+#include <algorithm>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+static const S9sString pidKey        = "pid";
+static const S9sString userKey       = "user";
+static const S9sString priorityKey   = "priority";
+static const S9sString virtMemKey    = "virt_mem";
+static const S9sString resMemKey     = "res_mem";
+static const S9sString cpuUsageKey   = "cpu_usage";
+static const S9sString memUsageKey   = "mem_usage";
+static const S9sString stateKey      = "state";
+static const S9sString executableKey = "executable";
+
+/**
+ * \returns The value for the given key without copying the map or inserting
+ *   the key, an invalid variant if the key is not in the map.
+ */
+static const S9sVariant &
+field(
+        const S9sVariantMap &theMap,
+        const S9sString     &key)
+{
+    static const S9sVariant invalid;
+    S9sVariantMap::const_iterator it = theMap.find(key);
+
+    if (it == theMap.end())
+        return invalid;
+
+    return it->second;
+}
+
+/**
+ * Orders the rows of the table, the rows that are equal by the key are
+ * ordered by the PID (higher first) so the order does not change between
+ * the refreshes.
+ */
+class S9sProcessTableCompare
+{
+    public:
+        S9sProcessTableCompare(
+                const S9sProcessTable          &table,
+                const S9sProcessTable::SortKey  key) :
+            m_table(table),
+            m_key(key)
+        {
+        }
+
+        bool operator()(const uint a, const uint b) const
+        {
+            switch (m_key)
+            {
+                case S9sProcessTable::SortByPid:
+                    return m_table.pid(a) < m_table.pid(b);
+
+                case S9sProcessTable::SortByCpu:
+                    if (m_table.cpuUsage(a) != m_table.cpuUsage(b))
+                        return m_table.cpuUsage(a) > m_table.cpuUsage(b);
+
+                    break;
+
+                case S9sProcessTable::SortByMemory:
+                    if (m_table.memUsage(a) != m_table.memUsage(b))
+                        return m_table.memUsage(a) > m_table.memUsage(b);
+
+                    break;
+            }
+
+            return m_table.pid(a) > m_table.pid(b);
+        }
+
+    private:
+        const S9sProcessTable          &m_table;
+        const S9sProcessTable::SortKey  m_key;
+};
+
+S9sProcessTable::S9sProcessTable()
+{
+}
+
+S9sProcessTable::~S9sProcessTable()
+{
+}
+
+void
+S9sProcessTable::clear()
+{
+    m_pid.clear();
+    m_hostIndex.clear();
+    m_userIndex.clear();
+    m_priority.clear();
+    m_virtMem.clear();
+    m_resMem.clear();
+    m_cpuUsage.clear();
+    m_memUsage.clear();
+    m_state.clear();
+    m_executable.clear();
+
+    m_hostNames.clear();
+    m_hostClusterIds.clear();
+    m_userNames.clear();
+    m_userIndices.clear();
+}
+
+/**
+ * \returns The number of processes (rows) in the table.
+ */
+uint
+S9sProcessTable::size() const
+{
+    return m_pid.size();
+}
+
+bool
+S9sProcessTable::empty() const
+{
+    return m_pid.empty();
+}
+
+/**
+ * Exchanges the content of the two tables without copying the rows. A table
+ * can be built while the other one is shown and then swapped in.
+ */
+void
+S9sProcessTable::swap(
+        S9sProcessTable &other)
+{
+    m_pid.swap(other.m_pid);
+    m_hostIndex.swap(other.m_hostIndex);
+    m_userIndex.swap(other.m_userIndex);
+    m_priority.swap(other.m_priority);
+    m_virtMem.swap(other.m_virtMem);
+    m_resMem.swap(other.m_resMem);
+    m_cpuUsage.swap(other.m_cpuUsage);
+    m_memUsage.swap(other.m_memUsage);
+    m_state.swap(other.m_state);
+    m_executable.swap(other.m_executable);
+
+    m_hostNames.swap(other.m_hostNames);
+    m_hostClusterIds.swap(other.m_hostClusterIds);
+    m_userNames.swap(other.m_userNames);
+    m_userIndices.swap(other.m_userIndices);
+}
+
+/**
+ * \param hostList The "data" of the getRunningProcesses reply: a list of hosts
+ *   with their host names and processes.
+ * \param clusterId The ID of the cluster the hosts belong to.
+ */
+void
+S9sProcessTable::appendHosts(
+        const S9sVariantList &hostList,
+        const int             clusterId)
+{
+    static const S9sString hostNameKey  = "hostname";
+    static const S9sString processesKey = "processes";
+
+    for (uint idx = 0u; idx < hostList.size(); ++idx)
+    {
+        const S9sVariantMap &host = hostList[idx].toVariantMap();
+
+        appendHost(
+                field(host, hostNameKey).toString(),
+                field(host, processesKey).toVariantList(),
+                clusterId);
+    }
+}
+
+/**
+ * \param hostName The name of the host the processes are running on.
+ * \param processList The processes as the controller sends them.
+ * \param clusterId The ID of the cluster the host belongs to.
+ */
+void
+S9sProcessTable::appendHost(
+        const S9sString      &hostName,
+        const S9sVariantList &processList,
+        const int             clusterId)
+{
+    int hostIndex = m_hostNames.size();
+
+    m_hostNames      << hostName;
+    m_hostClusterIds << clusterId;
+
+    for (uint idx = 0u; idx < processList.size(); ++idx)
+    {
+        const S9sVariantMap &process = processList[idx].toVariantMap();
+        S9sString            state   = field(process, stateKey).toString();
+
+        m_pid        << field(process, pidKey).toInt();
+        m_hostIndex  << hostIndex;
+        m_userIndex  << internUserName(field(process, userKey).toString());
+        m_priority   << field(process, priorityKey).toInt();
+        m_virtMem    << field(process, virtMemKey).toULongLong();
+        m_resMem     << field(process, resMemKey).toULongLong();
+        m_cpuUsage   << field(process, cpuUsageKey).toDouble();
+        m_memUsage   << field(process, memUsageKey).toDouble();
+        m_state      << (state.empty() ? ' ' : state[0]);
+        m_executable << field(process, executableKey).toString();
+    }
+}
+
+/**
+ * \param other The table to copy the rows from.
+ *
+ * Appends all the rows of the other table to this one. This is how the
+ * processes of many clusters are merged into one table that can be sorted as
+ * a whole. The host and user names are not decoded again, the indices are
+ * mapped to the names already stored in this table.
+ */
+void
+S9sProcessTable::append(
+        const S9sProcessTable &other)
+{
+    int             firstHost = m_hostNames.size();
+    uint            newSize   = m_pid.size() + other.m_pid.size();
+    S9sVector<int>  userIndices;
+
+    for (uint idx = 0u; idx < other.m_hostNames.size(); ++idx)
+    {
+        m_hostNames      << other.m_hostNames[idx];
+        m_hostClusterIds << other.m_hostClusterIds[idx];
+    }
+
+    for (uint idx = 0u; idx < other.m_userNames.size(); ++idx)
+        userIndices << internUserName(other.m_userNames[idx]);
+
+    m_pid.reserve(newSize);
+    m_hostIndex.reserve(newSize);
+    m_userIndex.reserve(newSize);
+    m_priority.reserve(newSize);
+    m_virtMem.reserve(newSize);
+    m_resMem.reserve(newSize);
+    m_cpuUsage.reserve(newSize);
+    m_memUsage.reserve(newSize);
+    m_state.reserve(newSize);
+    m_executable.reserve(newSize);
+
+    for (uint row = 0u; row < other.m_pid.size(); ++row)
+    {
+        m_pid        << other.m_pid[row];
+        m_hostIndex  << firstHost + other.m_hostIndex[row];
+        m_userIndex  << userIndices[other.m_userIndex[row]];
+        m_priority   << other.m_priority[row];
+        m_virtMem    << other.m_virtMem[row];
+        m_resMem     << other.m_resMem[row];
+        m_cpuUsage   << other.m_cpuUsage[row];
+        m_memUsage   << other.m_memUsage[row];
+        m_state      << other.m_state[row];
+        m_executable << other.m_executable[row];
+    }
+}
+
+int
+S9sProcessTable::pid(
+        const uint row) const
+{
+    return m_pid[row];
+}
+
+/**
+ * \returns The index of the host the process is running on, the hosts are
+ *   numbered in the order they are in the reply.
+ */
+int
+S9sProcessTable::hostIndex(
+        const uint row) const
+{
+    return m_hostIndex[row];
+}
+
+const S9sString &
+S9sProcessTable::hostName(
+        const uint row) const
+{
+    return m_hostNames[m_hostIndex[row]];
+}
+
+/**
+ * \returns The ID of the cluster the host of the process belongs to.
+ */
+int
+S9sProcessTable::clusterId(
+        const uint row) const
+{
+    return m_hostClusterIds[m_hostIndex[row]];
+}
+
+const S9sString &
+S9sProcessTable::userName(
+        const uint row) const
+{
+    return m_userNames[m_userIndex[row]];
+}
+
+int
+S9sProcessTable::priority(
+        const uint row) const
+{
+    return m_priority[row];
+}
+
+/**
+ * \returns The virtual memory size of the process in bytes.
+ */
+ulonglong
+S9sProcessTable::virtMem(
+        const uint row) const
+{
+    return m_virtMem[row];
+}
+
+/**
+ * \returns The resident memory size of the process in bytes.
+ */
+ulonglong
+S9sProcessTable::resMem(
+        const uint row) const
+{
+    return m_resMem[row];
+}
+
+double
+S9sProcessTable::cpuUsage(
+        const uint row) const
+{
+    return m_cpuUsage[row];
+}
+
+double
+S9sProcessTable::memUsage(
+        const uint row) const
+{
+    return m_memUsage[row];
+}
+
+/**
+ * \returns The state of the process as a one letter code (e.g. 'R' or 'S').
+ */
+char
+S9sProcessTable::state(
+        const uint row) const
+{
+    return m_state[row];
+}
+
+const S9sString &
+S9sProcessTable::executable(
+        const uint row) const
+{
+    return m_executable[row];
+}
+
+uint
+S9sProcessTable::nHosts() const
+{
+    return m_hostNames.size();
+}
+
+/**
+ * \param key What to sort the processes by.
+ * \param limit The number of rows needed, 0 for all the rows.
+ * \returns The row numbers in the requested order. The table itself is not
+ *   changed, only the row numbers are moved around while sorting.
+ */
+S9sVector<uint>
+S9sProcessTable::sortedRows(
+        const SortKey key,
+        const uint    limit) const
+{
+    S9sVector<uint> retval;
+
+    retval.reserve(size());
+    for (uint row = 0u; row < size(); ++row)
+        retval.push_back(row);
+
+    sortRows(retval, key, limit);
+    return retval;
+}
+
+/**
+ * \param rows The row numbers to sort, the result is placed here.
+ * \param key What to sort the processes by.
+ * \param limit The number of rows needed, 0 for all the rows.
+ *
+ * When only the first few rows are needed (e.g. the ones that fit on the
+ * screen) only those are put in order and the rest are dropped, this is much
+ * cheaper than sorting all the processes of a big cluster.
+ */
+void
+S9sProcessTable::sortRows(
+        S9sVector<uint> &rows,
+        const SortKey    key,
+        const uint       limit) const
+{
+    S9sProcessTableCompare compare(*this, key);
+
+    if (limit > 0u && limit < rows.size())
+    {
+        std::partial_sort(rows.begin(), rows.begin() + limit, rows.end(), 
+                compare);
+
+        rows.resize(limit);
+    } else {
+        std::sort(rows.begin(), rows.end(), compare);
+    }
+}
+
+int
+S9sProcessTable::internUserName(
+        const S9sString &userName)
+{
+    S9sMap<S9sString, int>::const_iterator it = m_userIndices.find(userName);
+    int index;
+
+    if (it != m_userIndices.end())
+        return it->second;
+
+    index = m_userNames.size();
+    m_userNames << userName;
+    m_userIndices[userName] = index;
+
+    return index;
+}
@@ -0,0 +1,108 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9smap.h"
+#include "s9svariantlist.h"
+#include "s9sglobal.h"
+
+/**
+ * The running processes of a cluster in a compact form: one vector for every
+ * column instead of one object (a variant map) for every process. The host
+ * and user names are stored only once, the rows refer to them by index.
+ *
+ * This is what s9s top shows, it is rebuilt on every refresh, so decoding the
+ * reply and sorting the rows has to be cheap even with many nodes.
+ */
+class S9sProcessTable
+{
+    public:
+        enum SortKey
+        {
+            SortByPid,
+            SortByCpu,
+            SortByMemory,
+        };
+
+        S9sProcessTable();
+        virtual ~S9sProcessTable();
+
+        void clear();
+        uint size() const;
+        bool empty() const;
+        void swap(S9sProcessTable &other);
+
+        void appendHosts(
+                const S9sVariantList &hostList,
+                const int             clusterId = 0);
+
+        void appendHost(
+                const S9sString      &hostName,
+                const S9sVariantList &processList,
+                const int             clusterId = 0);
+
+        void append(const S9sProcessTable &other);
+
+        int pid(const uint row) const;
+        int hostIndex(const uint row) const;
+        const S9sString &hostName(const uint row) const;
+        int clusterId(const uint row) const;
+        const S9sString &userName(const uint row) const;
+        int priority(const uint row) const;
+        ulonglong virtMem(const uint row) const;
+        ulonglong resMem(const uint row) const;
+        double cpuUsage(const uint row) const;
+        double memUsage(const uint row) const;
+        char state(const uint row) const;
+        const S9sString &executable(const uint row) const;
+
+        uint nHosts() const;
+
+        S9sVector<uint> sortedRows(
+                const SortKey key, 
+                const uint    limit = 0u) const;
+
+        void sortRows(
+                S9sVector<uint> &rows,
+                const SortKey    key,
+                const uint       limit = 0u) const;
+
+    private:
+        int internUserName(const S9sString &userName);
+
+    private:
+        S9sVector<int>        m_pid;
+        S9sVector<int>        m_hostIndex;
+        S9sVector<int>        m_userIndex;
+        S9sVector<int>        m_priority;
+        S9sVector<ulonglong>  m_virtMem;
+        S9sVector<ulonglong>  m_resMem;
+        S9sVector<double>     m_cpuUsage;
+        S9sVector<double>     m_memUsage;
+        S9sVector<char>       m_state;
+        S9sVector<S9sString>  m_executable;
+
+        S9sVector<S9sString>  m_hostNames;
+        S9sVector<int>        m_hostClusterIds;
+        S9sVector<S9sString>  m_userNames;
+        S9sMap<S9sString, int> m_userIndices;
+};
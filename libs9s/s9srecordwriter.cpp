@@ -0,0 +1,285 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9srecordwriter.h"
+
+#include "s9sformatter.h"
+
+#include <stdio.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+S9sRecordWriter::S9sRecordWriter() :
+    m_format(Invalid),
+    m_headerEnabled(true),
+    m_headerPrinted(false),
+    m_nRecords(0ull)
+{
+}
+
+/**
+ * \param format The name of the format, "ndjson", "csv" or "tsv".
+ * \param fields The paths of the fields to print, an empty list to print
+ *   everything.
+ */
+S9sRecordWriter::S9sRecordWriter(
+        const S9sString      &format,
+        const S9sVariantList &fields) :
+    m_format(formatFromString(format)),
+    m_fields(fields),
+    m_headerEnabled(true),
+    m_headerPrinted(false),
+    m_nRecords(0ull)
+{
+}
+
+S9sRecordWriter::~S9sRecordWriter()
+{
+}
+
+bool
+S9sRecordWriter::isValid() const
+{
+    return m_format != Invalid;
+}
+
+S9sRecordWriter::Format
+S9sRecordWriter::format() const
+{
+    return m_format;
+}
+
+S9sVariantList
+S9sRecordWriter::fields() const
+{
+    return m_fields;
+}
+
+/**
+ * \param enabled False to suppress the header line of the CSV/TSV output (e.g.
+ *   when the --no-header option is provided).
+ */
+void
+S9sRecordWriter::setHeaderEnabled(
+        bool enabled)
+{
+    m_headerEnabled = enabled;
+}
+
+/**
+ * \returns The line with the column names for the CSV and TSV formats, the
+ *   empty string for NDJSON (there is no header there).
+ */
+S9sString
+S9sRecordWriter::header() const
+{
+    S9sString retval;
+
+    if (m_format != Csv && m_format != Tsv)
+        return retval;
+
+    for (uint idx = 0u; idx < m_fields.size(); ++idx)
+    {
+        if (idx > 0u)
+            retval += m_format == Csv ? ',' : '\t';
+
+        retval += escape(m_fields[idx].toString());
+    }
+
+    return retval;
+}
+
+/**
+ * \param record The record to convert.
+ * \returns One line (without the line terminator) representing the record.
+ */
+S9sString
+S9sRecordWriter::toLine(
+        const S9sVariantMap &record)
+{
+    S9sString retval;
+
+    if (m_format == Ndjson)
+    {
+        S9sVariantMap projected;
+
+        if (m_fields.empty())
+            return record.toJsonString(S9sFormatNormal);
+
+        for (uint idx = 0u; idx < m_fields.size(); ++idx)
+        {
+            S9sString         path  = m_fields[idx].toString();
+            const S9sVariant &value = record.valueByPath(path);
+
+            if (!value.isInvalid())
+                projected[path] = value;
+        }
+
+        return projected.toJsonString(S9sFormatNormal);
+    }
+    
+    /*
+     * For the CSV and TSV the columns are decided when the first record is
+     * seen, all the lines have the same columns.
+     */
+    if (m_fields.empty())
+    {
+        S9sVector<S9sString> keys = record.keys();
+
+        for (uint idx = 0u; idx < keys.size(); ++idx)
+        {
+            const S9sVariant &value = record.at(keys[idx]);
+
+            if (!value.isVariantMap() && !value.isVariantList())
+                m_fields << keys[idx];
+        }
+    }
+
+    for (uint idx = 0u; idx < m_fields.size(); ++idx)
+    {
+        S9sString path = m_fields[idx].toString();
+
+        if (idx > 0u)
+            retval += m_format == Csv ? ',' : '\t';
+
+        retval += escape(toField(record.valueByPath(path)));
+    }
+
+    return retval;
+}
+
+/**
+ * Prints one record to the standard output, the header is printed before the
+ * first record.
+ */
+void
+S9sRecordWriter::write(
+        const S9sVariantMap &record)
+{
+    S9sString line = toLine(record);
+
+    if (m_headerEnabled && !m_headerPrinted && m_format != Ndjson)
+        ::printf("%s\n", STR(header()));
+
+    m_headerPrinted = true;
+    ::printf("%s\n", STR(line));
+    ++m_nRecords;
+}
+
+/**
+ * \returns How many records were written.
+ */
+ulonglong
+S9sRecordWriter::nRecords() const
+{
+    return m_nRecords;
+}
+
+/**
+ * \returns The format for the given name, S9sRecordWriter::Invalid if the
+ *   format is not known.
+ */
+S9sRecordWriter::Format
+S9sRecordWriter::formatFromString(
+        const S9sString &format)
+{
+    S9sString lower = format.toLower();
+
+    if (lower == "ndjson" || lower == "jsonl")
+        return Ndjson;
+    else if (lower == "csv")
+        return Csv;
+    else if (lower == "tsv")
+        return Tsv;
+
+    return Invalid;
+}
+
+/**
+ * Converts one value into the text of a CSV/TSV field. The structured values
+ * are printed as compact JSon strings.
+ */
+S9sString
+S9sRecordWriter::toField(
+        const S9sVariant &value) const
+{
+    if (value.isInvalid())
+        return S9sString();
+    else if (value.isVariantMap() || value.isVariantList())
+        return value.toJsonString(0, S9sFormatNormal);
+
+    return value.toString();
+}
+
+/**
+ * Quotes a field value according to RFC 4180 for CSV, escapes the tab, newline
+ * and backslash characters for TSV.
+ */
+S9sString
+S9sRecordWriter::escape(
+        const S9sString &value) const
+{
+    S9sString retval;
+
+    if (m_format == Csv)
+    {
+        if (value.find_first_of(",\"\r\n") == std::string::npos)
+            return value;
+
+        retval += '"';
+        for (uint idx = 0u; idx < value.length(); ++idx)
+        {
+            if (value[idx] == '"')
+                retval += '"';
+
+            retval += value[idx];
+        }
+
+        retval += '"';
+    } else {
+        for (uint idx = 0u; idx < value.length(); ++idx)
+        {
+            switch (value[idx])
+            {
+                case '\t':
+                    retval += "\\t";
+                    break;
+
+                case '\n':
+                    retval += "\\n";
+                    break;
+
+                case '\r':
+                    retval += "\\r";
+                    break;
+
+                case '\\':
+                    retval += "\\\\";
+                    break;
+
+                default:
+                    retval += value[idx];
+            }
+        }
+    }
+
+    return retval;
+}
@@ -0,0 +1,81 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svariant.h"
+#include "s9svariantmap.h"
+#include "s9svariantlist.h"
+
+/**
+ * Writes records (JSon objects) as machine readable lines: newline delimited
+ * JSon, comma separated or tab separated values. Every record is converted
+ * into one line as soon as it is handed over, there is no pass over the whole
+ * list before printing (e.g. to find the column widths), so any number of
+ * records can be streamed at line rate.
+ *
+ * The fields are given as paths (e.g. "host/hostname") into the records. If no
+ * fields are given the NDJSON lines hold the whole records while the CSV/TSV
+ * columns are the scalar fields of the first record.
+ */
+class S9sRecordWriter
+{
+    public:
+        enum Format
+        {
+            Invalid,
+            Ndjson,
+            Csv,
+            Tsv
+        };
+
+        S9sRecordWriter();
+        S9sRecordWriter(
+                const S9sString      &format,
+                const S9sVariantList &fields);
+
+        virtual ~S9sRecordWriter();
+
+        bool isValid() const;
+        S9sRecordWriter::Format format() const;
+        S9sVariantList fields() const;
+
+        void setHeaderEnabled(bool enabled);
+
+        S9sString header() const;
+        S9sString toLine(const S9sVariantMap &record);
+        void write(const S9sVariantMap &record);
+
+        ulonglong nRecords() const;
+
+        static S9sRecordWriter::Format formatFromString(
+                const S9sString &format);
+
+    private:
+        S9sString toField(const S9sVariant &value) const;
+        S9sString escape(const S9sString &value) const;
+
+    private:
+        Format           m_format;
+        S9sVariantList   m_fields;
+        bool             m_headerEnabled;
+        bool             m_headerPrinted;
+        ulonglong        m_nRecords;
+};
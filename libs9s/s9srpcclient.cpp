@@ -30,12 +30,14 @@
 #include "s9sfile.h"
 #include "s9ssshcredentials.h"
 #include "s9scontainer.h"
+#include "s9sstatcache.h"
 
 #include <cstring>
 #include <cstdio>
 #include <iostream> 
 #include <ctime>
 #include <regex>
+#include <sys/socket.h>
 
 //#define DEBUG
 #define WARNING
@@ -128,6 +130,26 @@ S9sRpcClient::operator= (
     return *this;
 }
 
+/**
+ * \returns A new client that connects to the same controller and uses the same
+ *   session (cookies), but has its own connection. This is needed when two
+ *   threads talk to the controller at the same time, e.g. one of them is
+ *   reading the event stream.
+ */
+S9sRpcClient
+S9sRpcClient::clone() const
+{
+    S9sRpcClient retval(
+            m_priv->m_hostName, m_priv->m_port, m_priv->m_path, 
+            m_priv->m_useTls);
+
+    retval.m_priv->m_cookies       = m_priv->m_cookies;
+    retval.m_priv->m_authenticated = m_priv->m_authenticated;
+    retval.m_priv->m_serverHeader  = m_priv->m_serverHeader;
+
+    return retval;
+}
+
 S9sString
 S9sRpcClient::hostName() const
 {
@@ -299,6 +321,9 @@ S9sRpcClient::setExitStatus()
 {
     S9sRpcReply::ErrorCode errorCode = reply().requestStatus();
 
+    if (!m_priv->m_updatesExitStatus)
+        return;
+
     if (errorCode != S9sRpcReply::Ok)
     {
         S9sOptions *options = S9sOptions::instance();
@@ -428,7 +453,7 @@ S9sRpcClient::authenticate()
     if (retval)
         PRINT_LOG("Authenticated.");
     else
-        PRINT_LOG("Authentication failed.");
+        PRINT_LOG_WARNING("Authentication failed.");
 
     return retval;
 }
@@ -732,6 +757,30 @@ S9sRpcClient::getTree(
     return executeRequest(uri, request);
 }
 
+/**
+ * \param path The path of the sub-tree to get.
+ * \param withDotDot If the ".." entries should be included.
+ *
+ * Gets only one sub-tree of the Cmon Directory Tree, the path is not taken
+ * from the command line options.
+ */
+bool
+S9sRpcClient::getTree(
+        const S9sString &path,
+        bool             withDotDot)
+{
+    S9sString      uri = "/v2/tree";
+    S9sVariantMap  request;
+    
+    request["operation"]       = "getTree";
+    request["path"]            = path;
+
+    if (withDotDot)
+        request["with_dot_dot"] = true;
+
+    return executeRequest(uri, request);
+}
+
 /**
  * \returns true if the request sent and a return is received (even if the reply
  *   is an error message).
@@ -1479,6 +1528,31 @@ S9sRpcClient::getRunningProcesses()
     return retval;
 }
 
+/**
+ * \param clusterId The ID of the cluster to get the processes from.
+ * \returns true if the request sent and a return is received (even if the reply
+ *   is an error message).
+ *
+ * The same as getRunningProcesses(), but for the given cluster and not the
+ * one that is set in the command line options. This is how s9s top gets the
+ * processes of all the clusters when showing the whole fleet.
+ */
+bool 
+S9sRpcClient::getRunningProcesses(
+        const int clusterId)
+{
+    S9sString      uri       = "/v2/process";
+    S9sVariantMap  request   = composeRequest();
+    bool           retval;
+
+    request["operation"]  = "getRunningProcesses";
+    request["cluster_id"] = clusterId;
+    
+    retval = executeRequest(uri, request);
+
+    return retval;
+}
+
 /**
  * \param clusterId the ID of the cluster for which the job instances will be
  *   fetched.
@@ -1538,6 +1612,38 @@ S9sRpcClient::getJobInstances(
     return retval;
 }
 
+/**
+ * \param clusterName The name of the cluster or the empty string.
+ * \param clusterId The ID of the cluster or a negative value for all the
+ *   clusters.
+ * \returns true if the request sent and a return is received (even if the reply
+ *   is an error message).
+ *
+ * Sends a "getJobInstances" request for the jobs that are running or waiting
+ * to be started. Unlike getJobInstances() this does not depend on the command
+ * line options, we use this when waiting for multiple jobs with one request.
+ */
+bool
+S9sRpcClient::getRunningJobInstances(
+        const S9sString  &clusterName, 
+        const int         clusterId)
+{
+    S9sString      uri = "/v2/jobs/";
+    S9sVariantMap  request;
+
+    request["operation"]    = "getJobInstances";
+    request["show_running"] = true;
+    request["show_defined"] = true;
+
+    if (S9S_CLUSTER_ID_IS_VALID(clusterId) || clusterId == 0)
+        request["cluster_id"] = clusterId;
+    
+    if (!clusterName.empty())
+        request["cluster_name"] = clusterName;
+
+    return executeRequest(uri, request, false);
+}
+
 /**
  * \param jobId the ID of the job
  * \returns true if the operation was successful, a reply is received from the
@@ -1876,6 +1982,50 @@ S9sRpcClient::getLog()
     return retval;
 }
 
+/**
+ * \param createdAfter Only the entries created after this time are requested,
+ *   or all the entries if this is empty.
+ * \param limit The maximum number of entries to get.
+ * \param offset The number of entries to skip.
+ * \param ascending True to get the oldest entries first.
+ * \param printRequest False to suppress the printing of the request even if
+ *   the --print-request is provided.
+ *
+ * Gets the log entries, this is used to follow the log: the severity is set
+ * by the command line options the same way getLog() does.
+ */
+bool
+S9sRpcClient::getLogEntries(
+        const S9sString &createdAfter,
+        const int        limit,
+        const int        offset,
+        const bool       ascending,
+        const bool       printRequest)
+{
+    S9sOptions    *options   = S9sOptions::instance();
+    S9sString      uri       = "/v2/log/";
+    S9sVariantMap  request   = composeRequest();
+
+    request["operation"]  = "getLogEntries";
+    request["ascending"]  = ascending;
+    
+    if (options->isDebug())
+        request["severity"] = "LOG_DEBUG";
+    else if (options->isWarning())
+        request["severity"] = "LOG_WARNING";
+
+    if (!createdAfter.empty())
+        request["created_after"] = createdAfter;
+
+    if (limit > 0)
+        request["limit"]  = limit;
+
+    if (offset > 0)
+        request["offset"] = offset;
+
+    return executeRequest(uri, request, printRequest);
+}
+
 /**
  * Gets the statistics about the log. Here is an example reply:
  *
@@ -3492,50 +3642,128 @@ S9sRpcClient::registerCluster()
  * \param clusterId the ID of the cluster for which the CPU information will be
  *   fetched.
  * \param statName cpustat sqlstatsum sqlstat
+ * \param useCache Use the local statistics cache if it is enabled.
  * \returns true if the request sent and a return is received (even if the reply
  *   is an error message).
  *
+ * When the cache is requested, the local statistics cache is enabled (the
+ * stat_cache_size configuration variable) and the time range is known only
+ * the time not covered by the cache is requested from the controller, the
+ * reply is then composed from the samples in the cache. The callers that poll
+ * the statistics frequently should not use the cache.
  */
 bool
 S9sRpcClient::getStats(
         const int        clusterId,
-        const S9sString &statName)
+        const S9sString &statName,
+        const bool       useCache)
 {
     S9sOptions    *options = S9sOptions::instance();
     S9sString      begin   = options->begin();
     S9sString      end     = options->end();
     S9sString      uri = "/v2/stat";
     S9sVariantMap  request;
+    S9sString      cluster;
+    S9sDateTime    dateTime;
     bool           retval;
     time_t         now = time(NULL);
+    time_t         startDate = now - 60 * 60;
+    time_t         endDate   = now;
+    bool           cacheable = useCache && options->statCacheSize() > 0;
 
     request["operation"]  = "statByName";
     request["name"]       = statName;
     request["with_hosts"] = true;
 
-    if (options->hasClusterIdOption())
-    {
-        request["cluster_id"] = clusterId;
-    } else if (options->hasClusterNameOption())
+    /*
+     * A --cluster-name on the command line wins over the default cluster ID
+     * of the configuration file.
+     */
+    if (options->hasClusterNameOption() && !options->hasClusterIdOption())
     {
         request["cluster_name"] = options->clusterName();
+        cluster = options->clusterName();
+    } else if (options->hasClusterIdOption() || 
+            S9S_CLUSTER_ID_IS_VALID(clusterId))
+    {
+        request["cluster_id"] = clusterId;
+        cluster.sprintf("%d", clusterId);
     }
 
+    // 
+    // Only the "2016-06-06T11:47:39.500Z" format is used with the cache, the
+    // other formats are left for the controller to interpret.
+    //
     if (!begin.empty())
+    {
         request["start_datetime"] = begin;
 
+        if (dateTime.parseTzFormat(begin))
+            startDate = dateTime.toTimeT();
+        else
+            cacheable = false;
+    }
+
     if (!end.empty())
+    {
         request["end_datetime"] = end;
 
+        if (!begin.empty() && dateTime.parseTzFormat(end))
+            endDate = dateTime.toTimeT();
+        else
+            cacheable = false;
+    }
+
     if (begin.empty() && end.empty())
     {
         request["startdate"]  = (ulonglong) now - 60 * 60;
         request["enddate"]    = (ulonglong) now;
     }
 
-    retval = executeRequest(uri, request);
-    
-    return retval;
+    if (!cacheable || cluster.empty() || endDate < startDate)
+        return executeRequest(uri, request);
+
+    // 
+    // Requesting only the samples the cache does not have.
+    //
+    S9sStatCache       cache(
+            S9sStatCache::defaultDirectory(),
+            options->statCacheSize() * 1024ull * 1024ull);
+    S9sVector<time_t>  starts;
+    S9sVector<time_t>  ends;
+
+    cache.load(S9sStatCache::entryName(hostName(), port(), cluster, statName));
+    cache.missingRanges(startDate, endDate, starts, ends);
+
+    request.erase("start_datetime");
+    request.erase("end_datetime");
+
+    for (uint idx = 0u; idx < starts.size(); ++idx)
+    {
+        request["startdate"]  = (ulonglong) starts[idx];
+        request["enddate"]    = (ulonglong) ends[idx];
+
+        retval = executeRequest(uri, request);
+        if (!retval || !m_priv->m_reply.isOk())
+            return retval;
+
+        cache.merge(
+                m_priv->m_reply["data"].toVariantList(), 
+                m_priv->m_reply["hosts"].toVariantList(), 
+                starts[idx], ends[idx], now);
+    }
+
+    if (!starts.empty() && !cache.save())
+        PRINT_VERBOSE("%s", STR(cache.errorString()));
+
+    m_priv->m_reply.clear();
+    m_priv->m_reply["request_status"] = "Ok";
+    m_priv->m_reply["data"]           = cache.samples(startDate, endDate);
+    m_priv->m_reply["hosts"]          = cache.hosts();
+    m_priv->m_reply["total"]          = 
+        (int) m_priv->m_reply["data"].toVariantList().size();
+
+    return true;
 }
 
 
@@ -10079,9 +10307,22 @@ S9sRpcClient::subscribeEvents(
     S9sString      uri     = "/v2/subscribe_events";
     S9sVariantMap  request = composeRequest();
 
-    // FIXME: add filters or any other arguments
     request["operation"]  = "subscribe";
 
+    /*
+     * The controllers that can filter the event stream will send only the
+     * events we need, the others ignore this and we filter on our side.
+     */
+    if (!m_priv->m_eventFilter.empty())
+        request["event_filter"] = m_priv->m_eventFilter.toVariantMap();
+
+    /*
+     * Asking for the events we missed while we were not connected. The
+     * controllers that can not replay the events send only the new ones.
+     */
+    if (!m_priv->m_eventResumePoint.empty())
+        request["resume_from"] = m_priv->m_eventResumePoint;
+
     // NOTE: this wont return (unless error happens or callback is NULL) as 
     // the JSon stream will be stopped only if the client (so S9S CLI)
     // closes the connection.
@@ -10090,6 +10331,63 @@ S9sRpcClient::subscribeEvents(
     return retval;
 }
 
+/**
+ * \param filter The filter for the events subscribeEvents() passes to the
+ *   callback function.
+ *
+ * The events the filter rejects are dropped before they are parsed, the filter
+ * is also sent to the controller in the subscribe request. The filter is only
+ * checked on the raw JSon text, so the callback function might still get a few
+ * events the filter would reject, it should check them with
+ * S9sEventFilter::accepts().
+ */
+void
+S9sRpcClient::setEventFilter(
+        const S9sEventFilter &filter)
+{
+    m_priv->m_eventFilter = filter;
+}
+
+/**
+ * \param resumePoint The creation time of the last event received (tv_sec
+ *   and tv_nsec as in the event_origins of the events), the empty map to
+ *   receive only the new events.
+ *
+ * The next subscribeEvents() asks the controller to send the events created at
+ * or after this time first. See S9sEventResume for details.
+ */
+void
+S9sRpcClient::setEventResumePoint(
+        const S9sVariantMap &resumePoint)
+{
+    m_priv->m_eventResumePoint = resumePoint;
+}
+
+/**
+ * This method can be called from an other thread to make subscribeEvents()
+ * return. The client can not be used for further requests afterwards.
+ */
+void
+S9sRpcClient::abortEventStream()
+{
+    m_priv->abortStream();
+}
+
+/**
+ * \param value False if the failures of this client should not change the exit
+ *   status of the program.
+ *
+ * The clients that are used in the background (e.g. to read the event stream
+ * while the main thread polls the controller) should not set the exit status,
+ * the main thread decides about that.
+ */
+void
+S9sRpcClient::setUpdatesExitStatus(
+        bool value)
+{
+    m_priv->m_updatesExitStatus = value;
+}
+
 /**
  * \returns true if the request sent and a return is received (even if the reply
  *   is an error message).
@@ -12979,11 +13277,18 @@ S9sRpcClient::doExecuteRequest(
     {
         PRINT_LOG("%s", STR(m_priv->m_errorString));
         PRINT_VERBOSE("Connection failed: %s", STR(m_priv->m_errorString));
-        options->setExitStatus(S9sOptions::ConnectionError);
+        if (m_priv->m_updatesExitStatus)
+            options->setExitStatus(S9sOptions::ConnectionError);
 
         setError(m_priv->m_errorString);
         return false;
     }
+
+    if (m_priv->isStreamAborted())
+    {
+        m_priv->close();
+        return false;
+    }
         
     /*
      * Printing the request we are sending.
@@ -13035,7 +13340,8 @@ S9sRpcClient::doExecuteRequest(
         m_priv->m_errorString.sprintf("Error writing socket: %m");
         m_priv->close();
 
-        options->setExitStatus(S9sOptions::ConnectionError);
+        if (m_priv->m_updatesExitStatus)
+            options->setExitStatus(S9sOptions::ConnectionError);
         setError(m_priv->m_errorString);
         return false;
     }
@@ -13073,7 +13379,8 @@ S9sRpcClient::doExecuteRequest(
                     STR(m_priv->m_hostName), m_priv->m_port,
                     m_priv->m_useTls ? "yes" : "no");
 
-            options->setExitStatus(S9sOptions::ConnectionError);
+            if (m_priv->m_updatesExitStatus)
+                options->setExitStatus(S9sOptions::ConnectionError);
             setError(m_priv->m_errorString);
             return false;
         }
@@ -13095,6 +13402,14 @@ S9sRpcClient::doExecuteRequest(
         {
             S9sVariantMap jsonRecord;
 
+            if (!m_priv->completeJSonAccepted())
+            {
+                if (!m_priv->skipRecord())
+                    break;
+
+                continue;
+            }
+
             m_priv->m_jsonReply = m_priv->getCompleteJSon();
             //S9S_WARNING("json: %s", STR(m_priv->m_jsonReply));
             //S9S_WARNING("1 Parsing json");
@@ -13111,7 +13426,8 @@ S9sRpcClient::doExecuteRequest(
                         STR(m_priv->m_jsonReply));
                 PRINT_ERROR("%s", STR(m_priv->m_errorString));
 
-                options->setExitStatus(S9sOptions::ConnectionError);
+                if (m_priv->m_updatesExitStatus)
+                    options->setExitStatus(S9sOptions::ConnectionError);
                 setError(m_priv->m_errorString);
 
                 return false;
@@ -13125,6 +13441,13 @@ S9sRpcClient::doExecuteRequest(
 
         if (isJSonStream)
         {
+            // Somebody wants us to stop reading the stream.
+            if (m_priv->isStreamAborted())
+            {
+                m_priv->close();
+                return true;
+            }
+
             // If we read no data in streaming mode that simply means the
             // connection ended by the server.
             if (readLength == 0)
@@ -13177,7 +13500,8 @@ S9sRpcClient::doExecuteRequest(
                 STR(m_priv->m_hostName), m_priv->m_port,
                 m_priv->m_useTls ? "yes" : "no");
 
-        options->setExitStatus(S9sOptions::ConnectionError);
+        if (m_priv->m_updatesExitStatus)
+            options->setExitStatus(S9sOptions::ConnectionError);
         setError(m_priv->m_errorString);
         return false;
     }
@@ -13188,7 +13512,8 @@ S9sRpcClient::doExecuteRequest(
         PRINT_VERBOSE("Error in reply: \n%s\n", STR(m_priv->m_jsonReply));
 
         m_priv->m_errorString.sprintf("Error parsing JSON reply.");
-        options->setExitStatus(S9sOptions::ConnectionError);
+        if (m_priv->m_updatesExitStatus)
+            options->setExitStatus(S9sOptions::ConnectionError);
         setError(m_priv->m_errorString);
 
         return false;
@@ -13462,6 +13787,20 @@ S9sRpcClient::serverVersion() const
     return "";
 }
 
+/**
+ * \returns How long the controller asked us to wait before polling it again
+ *   in milliseconds (the Retry-After header of the last reply) or -1 if the
+ *   controller sent no such hint.
+ */
+int
+S9sRpcClient::pollIntervalHint() const
+{
+    if (m_priv)
+        return m_priv->m_retryAfter;
+
+    return -1;
+}
+
 bool
 S9sRpcClient::detectVersion()
 {
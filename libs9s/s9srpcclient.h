@@ -23,6 +23,7 @@
 #include "s9srpcreply.h"
 
 class S9sRpcClientPrivate;
+class S9sEventFilter;
 class S9sUser;
 
 typedef void (*S9sJSonHandler)(const S9sVariantMap &jsonMessage, void *userData);
@@ -44,6 +45,8 @@ class S9sRpcClient
 
         S9sRpcClient &operator=(const S9sRpcClient &rhs);
 
+        S9sRpcClient clone() const;
+
         S9sString hostName() const;
         int port() const;
         bool useTls() const;
@@ -56,6 +59,7 @@ class S9sRpcClient
 
         bool detectVersion();
         S9sString serverVersion() const;
+        int pollIntervalHint() const;
 
         const S9sRpcReply &reply() const;
         void setExitStatus();
@@ -82,6 +86,7 @@ class S9sRpcClient
         bool getTopQueries();
 
         bool getTree(bool withDotDot = false);
+        bool getTree(const S9sString &path, bool withDotDot);
         bool getDatabases();
 
         
@@ -171,7 +176,8 @@ class S9sRpcClient
         
         bool getStats(
                 const int        clusterId,
-                const S9sString &statName);
+                const S9sString &statName,
+                const bool       useCache = false);
 
         bool getCpuStats(const int clusterId);
         bool getSqlStats(const int clusterId);
@@ -182,12 +188,17 @@ class S9sRpcClient
         bool getMemoryStats(const int clusterId);
 
         bool getRunningProcesses();
+        bool getRunningProcesses(const int clusterId);
 
         // Methods related to jobs.
         bool getJobInstances(
                 const S9sString  &clusterName, 
                 const int         clusterId);
 
+        bool getRunningJobInstances(
+                const S9sString  &clusterName, 
+                const int         clusterId);
+
         bool deleteJobInstance(const int jobId);
         bool killJobInstance(const int jobId);
         bool cloneJobInstance(const int jobId);
@@ -249,6 +260,11 @@ class S9sRpcClient
                 S9sJSonHandler  callbackFunction,
                 void           *userData);
 
+        void setEventFilter(const S9sEventFilter &filter);
+        void setEventResumePoint(const S9sVariantMap &resumePoint);
+        void abortEventStream();
+        void setUpdatesExitStatus(bool value);
+
         bool deleteAccount();
         bool createDatabase();
         bool createDeleteDatabaseJob();
@@ -399,6 +415,13 @@ class S9sRpcClient
                 const bool printRequest = true);
 
         bool getLog();
+        bool getLogEntries(
+                const S9sString &createdAfter,
+                const int        limit,
+                const int        offset,
+                const bool       ascending,
+                const bool       printRequest = true);
+
         bool getLogStatistics();
         bool getAlarms();
         bool getAlarm();
@@ -31,7 +31,10 @@ S9sRpcClientPrivate::S9sRpcClientPrivate() :
     m_ssl(0),
     m_callbackFunction(0),
     m_callbackUserData(0),
-    m_authenticated(false)
+    m_streamAborted(false),
+    m_updatesExitStatus(true),
+    m_authenticated(false),
+    m_retryAfter(-1)
 {
 }
 
@@ -99,6 +102,8 @@ S9sRpcClientPrivate::connect(
     struct timeval timeout;
     struct sockaddr_in server;
     bool   success;
+    bool   aborted;
+    int    socketFd;
 
     PRINT_LOG("%p: Connecting to '%s:%d'.", this, STR(m_hostName), m_port);
 
@@ -121,13 +126,29 @@ S9sRpcClientPrivate::connect(
     }
 
     PRINT_VERBOSE("\n+++ Connecting to %s:%d...", STR(m_hostName), m_port);
-    m_socketFd = socket(AF_INET, SOCK_STREAM, 0);
-    if (m_socketFd == -1)
+    socketFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (socketFd == -1)
     {
         m_errorString.sprintf("Error creating socket: %m");
         PRINT_VERBOSE("ERROR: %s", STR(m_errorString));
         return false;
     }
+
+    /*
+     * The socket is published under the lock, so the abortStream() either
+     * finds it and shuts it down or sets the flag before we check it here.
+     */
+    m_socketMutex.lock();
+    m_socketFd = socketFd;
+    aborted    = m_streamAborted;
+    m_socketMutex.unlock();
+
+    if (aborted)
+    {
+        m_errorString = "The connection was aborted.";
+        close();
+        return false;
+    }
     
     PRINT_LOG("%p: Created socket %d.", this, m_socketFd);
 
@@ -177,7 +198,7 @@ S9sRpcClientPrivate::connect(
             {
                 int timeout = S9sOptions::instance()->clientConnectionTimeout();
 
-                PRINT_LOG("Connect to %s:%d failed: Timeout (%ds).", 
+                PRINT_LOG_WARNING("Connect to %s:%d failed: Timeout (%ds).", 
                         STR(m_hostName), m_port, timeout);
 
                 m_errorString.sprintf(
@@ -186,7 +207,7 @@ S9sRpcClientPrivate::connect(
                 
                 PRINT_VERBOSE("%s", STR(m_errorString));
             } else {
-                PRINT_LOG("Connect to %s:%d failed(%d): %m.", 
+                PRINT_LOG_WARNING("Connect to %s:%d failed(%d): %m.", 
                         STR(m_hostName), m_port,
                         errno);
 
@@ -303,9 +324,41 @@ S9sRpcClientPrivate::close()
         m_sslContext = 0;
     }
 
+    m_socketMutex.lock();
     ::shutdown(m_socketFd, SHUT_RDWR);
     ::close(m_socketFd);
     m_socketFd = -1;
+    m_socketMutex.unlock();
+}
+
+/**
+ * Called from an other thread to stop reading the event stream. The flag is
+ * set first, then the socket is shut down if it is connected, so the thread
+ * reading the stream either returns from the read or finds the flag right
+ * after it connected.
+ */
+void
+S9sRpcClientPrivate::abortStream()
+{
+    m_socketMutex.lock();
+    m_streamAborted = true;
+
+    if (m_socketFd >= 0)
+        ::shutdown(m_socketFd, SHUT_RDWR);
+
+    m_socketMutex.unlock();
+}
+
+bool
+S9sRpcClientPrivate::isStreamAborted()
+{
+    bool retval;
+
+    m_socketMutex.lock();
+    retval = m_streamAborted;
+    m_socketMutex.unlock();
+
+    return retval;
 }
 
 /**
@@ -418,6 +471,20 @@ S9sRpcClientPrivate::parseHeaders()
 
     if (regexp == buffer.substr(lastIdx))
         m_serverHeader = regexp[1];
+
+    /*
+     * The controller might ask us to slow down with a Retry-After header (in
+     * seconds), we look for it only in the headers, not in the body. The
+     * header names are case insensitive and the name has to start the line,
+     * so e.g. an X-Retry-After header is not taken.
+     */
+    m_retryAfter = -1;
+    lastIdx      = buffer.find("\r\n\r\n");
+    regexp       = S9sRegExp("(^|\n)Retry-After:[ \t]*([0-9]+)");
+    regexp.setIgnoreCase(true);
+
+    if (lastIdx > 0 && regexp == buffer.substr(0, lastIdx))
+        m_retryAfter = regexp[2].toInt() * 1000;
 }
 
 /**
@@ -812,6 +879,37 @@ S9sRpcClientPrivate::getCompleteJSon() const
     return retval;
 }
 
+/**
+ * \returns False if the event filter surely rejects the next JSon string in
+ *   the buffer, so it should be skipped without parsing it.
+ *
+ * This method can be used only when JSon streaming is processed, the record is
+ * found the same way getCompleteJSon() finds it, but it is not copied.
+ */
+bool
+S9sRpcClientPrivate::completeJSonAccepted() const
+{
+    size_t begin = 0;
+    size_t end;
+
+    if (m_eventFilter.empty() || m_buffer == NULL)
+        return true;
+
+    if (m_dataSize > 0 && m_buffer[0] == '\036')
+        begin = 1;
+
+    for (end = begin; end < m_dataSize; ++end)
+    {
+        if (m_buffer[end] == '\036')
+            break;
+
+        if (m_buffer[end] == '\n' && end > begin && m_buffer[end - 1] == '\n')
+            break;
+    }
+
+    return m_eventFilter.acceptsRaw(m_buffer + begin, end - begin);
+}
+
 /**
  * \returns True if the JSon string was removed from the buffer.
  *
@@ -10,7 +10,9 @@
 #include "s9srpcreply.h"
 #include "s9svariantmap.h"
 #include "s9scontroller.h"
+#include "s9seventfilter.h"
 #include "s9srpcclient.h"
+#include "s9smutex.h"
 
 class S9sRpcClientPrivate
 {
@@ -34,8 +36,12 @@ class S9sRpcClientPrivate
 
         bool hasCompleteJSon() const;
         S9sString getCompleteJSon() const;
+        bool completeJSonAccepted() const;
         bool skipRecord();
 
+        void abortStream();
+        bool isStreamAborted();
+
     private:
         void clearBuffer();
         void ensureHasBuffer(size_t size);
@@ -72,7 +78,20 @@ class S9sRpcClientPrivate
 
         S9sJSonHandler  m_callbackFunction;
         void           *m_callbackUserData;
+        /** The events that are rejected here are never parsed. */
+        S9sEventFilter  m_eventFilter;
+        /** Where the event stream should start, empty for the live events. */
+        S9sVariantMap   m_eventResumePoint;
+        /** Set by abortStream() to stop reading the event stream. */
+        bool            m_streamAborted;
+        /** Protects the m_socketFd and the m_streamAborted. */
+        S9sMutex        m_socketMutex;
+        /** False if the failures of this client should not be reported in
+         * the exit status of the program. */
+        bool            m_updatesExitStatus;
         bool            m_authenticated;
+        /** The Retry-After of the last reply in milliseconds or -1. */
+        int             m_retryAfter;
         
         S9sVariantList  m_controllers;
         S9sVector<S9sController> m_servers;
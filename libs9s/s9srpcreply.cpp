@@ -42,6 +42,7 @@
 #include "s9spkginfo.h"
 #include "s9scontroller.h"
 #include "s9sjob.h"
+#include "s9srecordwriter.h"
 #include "s9scontainer.h"
 #include "s9sstringlist.h"
 #include "s9sreplication.h"
@@ -2235,6 +2236,80 @@ S9sRpcReply::printJsonFormat() const
         
 }
 
+/**
+ * \param records The list of records (JSon objects) to print.
+ *
+ * Prints the records as requested by the --output and --fields command line
+ * options, one record per line. The lines are printed as the list is walked,
+ * no formatting pass is made over the list before the printing.
+ */
+void
+S9sRpcReply::printRecords(
+        const S9sVariantList &records) const
+{
+    S9sOptions      *options = S9sOptions::instance();
+    S9sRecordWriter  writer(options->outputFormat(), options->outputFields());
+
+    writer.setHeaderEnabled(!options->isNoHeaderRequested());
+    
+    for (uint idx = 0u; idx < records.size(); ++idx)
+        writer.write(records[idx].toVariantMap());
+}
+
+/**
+ * Prints the hosts of all the clusters in the reply as records, one host per
+ * line. 
+ */
+void
+S9sRpcReply::printNodeRecords()
+{
+    S9sOptions      *options = S9sOptions::instance();
+    S9sRecordWriter  writer(options->outputFormat(), options->outputFields());
+    S9sVariantList   theList = clusters();
+
+    writer.setHeaderEnabled(!options->isNoHeaderRequested());
+    
+    for (uint idx = 0u; idx < theList.size(); ++idx)
+    {
+        S9sVariantMap  theMap = theList[idx].toVariantMap();
+        S9sVariantList hosts  = theMap["hosts"].toVariantList();
+
+        for (uint idx1 = 0u; idx1 < hosts.size(); ++idx1)
+            writer.write(hosts[idx1].toVariantMap());
+    }
+}
+
+/**
+ * Prints the entries of the CDT in the reply as records. The tree is walked
+ * depth first, every entry is printed as one line without the sub-items.
+ */
+void
+S9sRpcReply::printObjectRecords() const
+{
+    S9sOptions      *options = S9sOptions::instance();
+    S9sRecordWriter  writer(options->outputFormat(), options->outputFields());
+
+    writer.setHeaderEnabled(!options->isNoHeaderRequested());
+    
+    if (contains("cdt"))
+        printObjectRecords(writer, at("cdt").toVariantMap());
+}
+
+void
+S9sRpcReply::printObjectRecords(
+        S9sRecordWriter     &writer,
+        const S9sVariantMap &entry) const
+{
+    S9sVariantMap  record  = entry;
+    S9sVariantList entries = entry.valueByPath("sub_items").toVariantList();
+
+    record.erase("sub_items");
+    writer.write(record);
+
+    for (uint idx = 0u; idx < entries.size(); ++idx)
+        printObjectRecords(writer, entries[idx].toVariantMap());
+}
+
 /**
  * This is a simple output function that we can call to print a short message
  * when a new job is registered on the server. This prints the job ID that is
@@ -2921,6 +2996,10 @@ S9sRpcReply::printJobList()
     {
         printJsonFormat();
         return;
+    } else if (options->hasOutputFormat())
+    {
+        printRecords(jobs());
+        return;
     }
     
     printDebugMessages();
@@ -3334,6 +3413,13 @@ S9sRpcReply::printBackupList()
     } else if (!isOk())
     {
         PRINT_ERROR("%s", STR(errorString()));
+    } else if (options->hasOutputFormat())
+    {
+        // One is RPC 1.0, the other is 2.0.
+        if (contains("data"))
+            printRecords(operator[]("data").toVariantList());
+        else
+            printRecords(operator[]("backup_records").toVariantList());
     } else if (options->hasBackupFormat())
     {
         printBackupListFormatString(options->isLongRequested());
@@ -3781,6 +3867,8 @@ S9sRpcReply::printNodeList()
         printDebugMessages();
     } else if (!isOk())
         PRINT_ERROR("%s", STR(errorString()));
+    else if (options->hasOutputFormat())
+        printNodeRecords();
     else if (options->isStatRequested())
         printNodesStat();
     else if (options->isLongRequested())
@@ -3920,12 +4008,38 @@ S9sRpcReply::printLogList()
 
     if (options->isJsonRequested())
         printJsonFormat();
+    else if (options->hasOutputFormat())
+        printLogRecords();
     else if (options->isLongRequested())
         printLogLong();
     else 
         printLogBrief();
 }
 
+/**
+ * Prints the log entries as records in chronological order, the same order
+ * the other log formats use.
+ */
+void
+S9sRpcReply::printLogRecords()
+{
+    S9sOptions      *options = S9sOptions::instance();
+    S9sRecordWriter  writer(options->outputFormat(), options->outputFields());
+    const S9sVariantList &variantList = 
+        operator[]("log_entries").toVariantList();
+
+    writer.setHeaderEnabled(!options->isNoHeaderRequested());
+
+    if (variantList.empty() && contains("log_entry"))
+    {
+        writer.write(operator[]("log_entry").toVariantMap());
+        return;
+    }
+
+    for (uint idx = variantList.size(); idx > 0u; --idx)
+        writer.write(variantList[idx - 1].toVariantMap());
+}
+
 void
 S9sRpcReply::printLogBrief()
 {
@@ -5065,6 +5179,8 @@ S9sRpcReply::printAlarmList()
         printJsonFormat();
     else if (!isOk())
         PRINT_ERROR("%s", STR(errorString()));
+    else if (options->hasOutputFormat())
+        printRecords(alarms());
     else //if (options->isLongRequested())
         // FIXME: We have no brief list for alarms.
         printAlarmListLong();
@@ -7757,6 +7873,9 @@ S9sRpcReply::printObjectTree()
     if (!isOk())
     {
         PRINT_ERROR("%s", STR(errorString()));
+    } else if (options->hasOutputFormat())
+    {
+        printObjectRecords();
     } else if (options->isLongRequested())
     {
         printObjectTreeBrief();
@@ -7773,7 +7892,7 @@ S9sRpcReply::printObjectTree()
  */
 void 
 S9sRpcReply::printObjectTreeBrief(
-        S9sTreeNode          node,
+        const S9sTreeNode   &node,
         int                  recursionLevel,
         S9sString            indentString,
         bool                 isLast)
@@ -7782,7 +7901,6 @@ S9sRpcReply::printObjectTreeBrief(
     bool            onlyAscii = options->onlyAscii();
     S9sString       name;
     S9sVector<S9sTreeNode> childNodes = node.childNodes();
-
     S9sString       indent;
 
     // It looks better if we print the full path on the first item when the
@@ -7867,13 +7985,13 @@ S9sRpcReply::printObjectTreeBrief(
 
     for (uint idx = 0; idx < childNodes.size(); ++idx)
     {
-        S9sTreeNode  &childNode = childNodes[idx];
-        bool          last  = true;
+        const S9sTreeNode &childNode = childNodes[idx];
+        bool               last  = true;
     
         // Checking if this will be the last child we print.
         for (uint idx1 = idx + 1; idx1 < childNodes.size(); ++idx1)
         {
-            S9sTreeNode &nextChild = childNodes[idx1];
+            const S9sTreeNode &nextChild = childNodes[idx1];
 
             if (nextChild.name().startsWith(".") && !options->isAllRequested())
                 continue;
@@ -7903,7 +8021,7 @@ S9sRpcReply::printObjectTreeBrief(
 
 void
 S9sRpcReply::walkObjectTree(
-        S9sTreeNode     node)
+        const S9sTreeNode &node)
 {
     S9sOptions             *options   = S9sOptions::instance();
     S9sVector<S9sTreeNode>  childNodes = node.childNodes();
@@ -7919,7 +8037,7 @@ S9sRpcReply::walkObjectTree(
 
     for (uint idx = 0; idx < childNodes.size(); ++idx)
     {
-        S9sTreeNode &child = childNodes[idx];
+        const S9sTreeNode &child = childNodes[idx];
         
         if (child.name().startsWith(".") && !options->isAllRequested())
             continue;
@@ -7945,7 +8063,7 @@ S9sRpcReply::walkObjectTree(
  */
 void 
 S9sRpcReply::printObjectListLong(
-        S9sTreeNode          node,
+        const S9sTreeNode   &node,
         int                  recursionLevel,
         S9sString            indentString)
 {
@@ -8061,7 +8179,7 @@ recursive_print:
     {
         for (uint idx = 0; idx < childNodes.size(); ++idx)
         {
-            S9sTreeNode &child = childNodes[idx];
+            const S9sTreeNode &child = childNodes[idx];
             
             if (child.name().startsWith(".") && !options->isAllRequested())
                 continue;
@@ -8073,25 +8191,17 @@ recursive_print:
 
 void 
 S9sRpcReply::printObjectListBrief(
-        S9sVariantMap        entry,
+        const S9sTreeNode   &node,
         int                  recursionLevel,
         S9sString            indentString,
         bool                 isLast)
 {
-    S9sTreeNode     node      = entry;
     S9sOptions     *options   = S9sOptions::instance();
     bool            recursive = options->isRecursiveRequested();
     bool            directory = options->isDirectoryRequested();
-    S9sString       path      = entry["item_path"].toString();
-    S9sString       spec      = entry["item_spec"].toString();
-    S9sString       type      = entry["item_type"].toString();
-    S9sVariantList  entries   = entry["sub_items"].toVariantList();
-    S9sString       owner     = entry["owner_user_name"].toString();
-    S9sString       group     = entry["owner_group_name"].toString();
-    S9sString       acl       = entry["item_acl"].toString();
-    S9sString       fullPath;
+    S9sString       type      = node.typeName();
+    S9sVector<S9sTreeNode> childNodes = node.childNodes();
     S9sString       name;
-    S9sString       sizeString;
 
     // If the first level is the directory, we skip it if we are not requested
     // to print the directory itself.
@@ -8106,20 +8216,8 @@ S9sRpcReply::printObjectListBrief(
 
     //printf("%3d ", recursionLevel);
 
-    if (owner.empty())
-        owner.sprintf("%d", entry["owner_user_id"].toInt());
-    
-    if (group.empty())
-        group.sprintf("%d", entry["owner_group_id"].toInt());
-
-    fullPath = path;
-    if (!fullPath.endsWith("/"))
-        fullPath += "/";
-
-    fullPath += node.name();
-
     if (options->fullPathRequested())
-        name = fullPath;
+        name = node.fullPath();
     else
         name = node.name();
  
@@ -8188,12 +8286,12 @@ S9sRpcReply::printObjectListBrief(
 
 recursive_print:
     {
-        for (uint idx = 0; idx < entries.size(); ++idx)
+        for (uint idx = 0; idx < childNodes.size(); ++idx)
         {
-            S9sVariantMap child = entries[idx].toVariantMap();
-            bool          last = idx + 1 >= entries.size();
+            const S9sTreeNode &child = childNodes[idx];
+            bool               last = idx + 1 >= childNodes.size();
        
-            if (child["item_name"].toString().startsWith(".") && 
+            if (child.property("item_name").toString().startsWith(".") && 
                     !options->isAllRequested())
             {
                 continue;
@@ -8209,8 +8307,7 @@ recursive_print:
 S9sTreeNode
 S9sRpcReply::tree()
 {
-    S9sVariantMap entry =  operator[]("cdt").toVariantMap();
-    S9sTreeNode   node(entry);
+    S9sTreeNode node(operator[]("cdt").toVariantMap());
 
     return node;
 }
@@ -8221,8 +8318,8 @@ S9sRpcReply::tree()
 void
 S9sRpcReply::printObjectTreeBrief()
 {
-    S9sVariantMap entry =  operator[]("cdt").toVariantMap();
-    S9sTreeNode   node(entry);
+    S9sTreeNode node(operator[]("cdt").toVariantMap());
+
     printObjectTreeBrief(node, 0, "", false);
 }
 
@@ -8240,6 +8337,9 @@ S9sRpcReply::printObjectList()
     } else if (!isOk())
     {
         PRINT_ERROR("%s", STR(errorString()));
+    } else if (options->hasOutputFormat())
+    {
+        printObjectRecords();
     } else if (options->isLongRequested())
     {
         printObjectListLong();
@@ -8265,8 +8365,7 @@ void
 S9sRpcReply::printObjectListLong()
 {
     S9sOptions     *options = S9sOptions::instance();
-    S9sVariantMap   entry   =  operator[]("cdt").toVariantMap();
-    S9sTreeNode     node(entry);
+    S9sTreeNode     node(operator[]("cdt").toVariantMap());
 
     if (options->isJsonRequested())
     {
@@ -8313,7 +8412,7 @@ void
 S9sRpcReply::printObjectListBrief()
 {
     S9sOptions     *options = S9sOptions::instance();
-    S9sVariantMap   entry   =  operator[]("cdt").toVariantMap();
+    S9sTreeNode     node(operator[]("cdt").toVariantMap());
 
     if (options->isJsonRequested())
     {
@@ -8324,9 +8423,9 @@ S9sRpcReply::printObjectListBrief()
     m_numberOfObjects = 0;
     m_numberOfFolders = 0;
 
-    walkObjectTree(entry);
+    walkObjectTree(node);
 
-    printObjectListBrief(entry, 0, "", false);
+    printObjectListBrief(node, 0, "", false);
 }
 
 /**
@@ -8689,11 +8788,11 @@ bool
 S9sRpcReply::createGraph(
         S9sVector<S9sCmonGraph *> &graphs, 
         S9sNode                   &host,
+        const S9sString           &graphType,
         const S9sString           &filterName,
         const S9sVariant          &filterValue)
 {
     S9sOptions           *options = S9sOptions::instance();
-    S9sString             graphType = options->graph().toLower();
     bool                  syntaxHighlight = options->useSyntaxHighlight();
     const S9sVariantList &data = operator[]("data").toVariantList();
     S9sCmonGraph         *graph = NULL;
@@ -8736,7 +8835,8 @@ S9sRpcReply::createGraph(
 bool
 S9sRpcReply::createGraph(
         S9sVector<S9sCmonGraph *> &graphs,
-        S9sNode                   &host)
+        S9sNode                   &host,
+        const S9sString           &graphType)
 {
     const S9sVariantList &data = operator[]("data").toVariantList();
     S9sVariant            firstSample = data.empty() ? S9sVariant() : data[0];
@@ -8773,11 +8873,13 @@ S9sRpcReply::createGraph(
     S9S_DEBUG("filterValues.size() = %u", filterValues.size());
     if (filterValues.empty())
     {
-        success = createGraph(graphs, host, filterName, S9sVariant());
+        success = createGraph(
+                graphs, host, graphType, filterName, S9sVariant());
     } else {
         for (uint idx = 0; idx < filterValues.size(); ++idx)
         {
-            success = createGraph(graphs, host, filterName, filterValues[idx]);
+            success = createGraph(
+                    graphs, host, graphType, filterName, filterValues[idx]);
             if (!success)
                 break;
         }
@@ -8792,12 +8894,9 @@ S9sRpcReply::createGraph(
 bool
 S9sRpcReply::printGraph()
 {
-    S9sOptions      *options       = S9sOptions::instance();
-    int              terminalWidth = options->terminalWidth();
-    int              clusterId     = options->clusterId();
-    S9sVariantList   hostList      = operator[]("hosts").toVariantList();
-    bool             success       = false;
-    S9sVector<S9sCmonGraph *> graphs;
+    S9sOptions                     *options = S9sOptions::instance();
+    S9sVector<S9sRpcReply *>        replies;
+    S9sVector<S9sString>            graphTypes;
 
     S9S_DEBUG("Printing graphs.");
     if (options->isJsonRequested())
@@ -8806,6 +8905,39 @@ S9sRpcReply::printGraph()
         return true;
     }
 
+    replies    << this;
+    graphTypes << options->graph().toLower();
+
+    return printGraphs(replies, graphTypes);
+}
+
+/**
+ * \param replies The replies of the statByName requests, one for every graph
+ *   type.
+ * \param graphTypes The names of the graphs to create.
+ * \param graphs The place where the graphs are created, the caller should
+ *   destroy them.
+ * \returns true if all the graphs were created.
+ *
+ * Creates the graphs for all the hosts of the cluster the user is interested
+ * in, the graphs of one host are next to each other.
+ */
+bool
+S9sRpcReply::createGraphs(
+        const S9sVector<S9sRpcReply *> &replies,
+        const S9sVector<S9sString>     &graphTypes,
+        S9sVector<S9sCmonGraph *>      &graphs)
+{
+    S9sOptions      *options       = S9sOptions::instance();
+    int              clusterId     = options->clusterId();
+    S9sVariantList   hostList;
+    bool             success       = false;
+
+    if (replies.empty())
+        return false;
+
+    hostList = replies[0]->operator[]("hosts").toVariantList();
+
     /*
      * Going through the hosts, creating graphs for them.
      */
@@ -8831,11 +8963,41 @@ S9sRpcReply::printGraph()
         }
 
         //printf("h: %s id: %d\n", STR(host.hostName()), host.id());
-        success = createGraph(graphs, host);
+        for (uint idx1 = 0u; idx1 < replies.size(); ++idx1)
+        {
+            success = replies[idx1]->createGraph(
+                    graphs, host, graphTypes[idx1]);
+            if (!success)
+                break;
+        }
+
         if (!success)
             break;
     }
 
+    return success;
+}
+
+/**
+ * \param replies The replies holding the statistics for the graphs.
+ * \param graphTypes The graph types, one for every reply, the same reply can
+ *   be used for multiple graph types.
+ *
+ * Creates the graphs for every host and every graph type and prints them side
+ * by side, as many in one row as fits the terminal. The graphs of one host
+ * are next to each other. The hosts are taken from the first reply.
+ */
+bool
+S9sRpcReply::printGraphs(
+        const S9sVector<S9sRpcReply *> &replies,
+        const S9sVector<S9sString>     &graphTypes)
+{
+    S9sOptions      *options       = S9sOptions::instance();
+    int              terminalWidth = options->terminalWidth();
+    bool             success;
+    S9sVector<S9sCmonGraph *> graphs;
+
+    success = createGraphs(replies, graphTypes, graphs);
 
     int sumWidth = 0; 
     int nPrinted = 0;
@@ -9802,21 +9964,7 @@ S9sRpcReply::printCpuStat()
     S9sVariantList  theList = operator[]("data").toVariantList();
     S9sVariantMap   listMap;
 
-    for (uint idx = 0; idx < theList.size(); ++idx)
-    {
-        S9sVariantMap theMap  = theList[idx].toVariantMap();
-        S9sString     key     = theMap["samplekey"].toString();
-        ulonglong     created = theMap["created"].toULongLong();
-
-        if (!listMap.contains(key))
-        {
-            listMap[key] = theMap;
-            continue;
-        }
-
-        if (listMap[key]["created"].toULongLong() < created)
-            listMap[key] = theMap;
-    }
+    listMap = newestSamples(theList);
 
     foreach (const S9sVariant variant, listMap)
     {
@@ -11400,7 +11548,9 @@ S9sRpcReply::printUserList()
         return;
     }
 
-    if (options->isStatRequested())
+    if (options->hasOutputFormat())
+        printRecords(users());
+    else if (options->isStatRequested())
         printUsersStat();
     else if (options->isLongRequested())
         printUserListLong();
@@ -11709,6 +11859,35 @@ S9sRpcReply::printUserListLong()
         printf("Total: %d\n", operator[]("total").toInt());
 }
 
+/**
+ * \param statList The "data" of a statByName reply.
+ * \returns The newest sample for every sample key, the controller may send
+ *   more than one sample for the same core or host.
+ */
+S9sVariantMap
+S9sRpcReply::newestSamples(
+        const S9sVariantList &statList)
+{
+    S9sVariantMap retval;
+
+    for (uint idx = 0u; idx < statList.size(); ++idx)
+    {
+        const S9sVariantMap &sample  = statList[idx].toVariantMap();
+        S9sString            key     = sample.valueByPath("samplekey").toString();
+        ulonglong            created = sample.valueByPath("created").toULongLong();
+
+        if (retval.contains(key) && 
+                retval[key]["created"].toULongLong() >= created)
+        {
+            continue;
+        }
+
+        retval[key] = sample;
+    }
+
+    return retval;
+}
+
 void
 S9sRpcReply::printCpuStatLine1()
 {
@@ -11727,21 +11906,7 @@ S9sRpcReply::printCpuStatLine1()
     double           steal = 0.0;
 
 
-    for (uint idx = 0; idx < theList.size(); ++idx)
-    {
-        S9sVariantMap theMap  = theList[idx].toVariantMap();
-        S9sString     key     = theMap["samplekey"].toString();
-        ulonglong     created = theMap["created"].toULongLong();
-
-        if (!listMap.contains(key))
-        {
-            listMap[key] = theMap;
-            continue;
-        }
-
-        if (listMap[key]["created"].toULongLong() < created)
-            listMap[key] = theMap;
-    }
+    listMap = newestSamples(theList);
 
     if (syntaxHighlight)
     {
@@ -11782,13 +11947,13 @@ S9sRpcReply::printCpuStatLine1()
     wait  *= 100.0;
     steal *= 100.0;
     
-    printf("%s%d%s hosts, ", numberStart, (int)hostIds.size(), numberEnd);
-    printf("%s%d%s cores,", numberStart, (int)listMap.size(), numberEnd);
-    printf("%s%5.1f%s us,",  numberStart, user, numberEnd);
-    printf("%s%5.1f%s sy,", numberStart, sys, numberEnd);
-    printf("%s%5.1f%s id,",  numberStart, idle, numberEnd);
-    printf("%s%5.1f%s wa,", numberStart, wait, numberEnd);
-    printf("%s%5.1f%s st,", numberStart, steal, numberEnd);
+    s9s_printf("%s%d%s hosts, ", numberStart, (int)hostIds.size(), numberEnd);
+    s9s_printf("%s%d%s cores,", numberStart, (int)listMap.size(), numberEnd);
+    s9s_printf("%s%5.1f%s us,",  numberStart, user, numberEnd);
+    s9s_printf("%s%5.1f%s sy,", numberStart, sys, numberEnd);
+    s9s_printf("%s%5.1f%s id,",  numberStart, idle, numberEnd);
+    s9s_printf("%s%5.1f%s wa,", numberStart, wait, numberEnd);
+    s9s_printf("%s%5.1f%s st,", numberStart, steal, numberEnd);
 }
 
 /**
@@ -11838,21 +12003,7 @@ S9sRpcReply::printMemoryStatLine1()
         numberEnd   = TERM_NORMAL;
     }
 
-    for (uint idx = 0; idx < theList.size(); ++idx)
-    {
-        S9sVariantMap theMap  = theList[idx].toVariantMap();
-        S9sString     key     = theMap["samplekey"].toString();
-        ulonglong     created = theMap["created"].toULongLong();
-
-        if (!listMap.contains(key))
-        {
-            listMap[key] = theMap;
-            continue;
-        }
-
-        if (listMap[key]["created"].toULongLong() < created)
-            listMap[key] = theMap;
-    }
+    listMap = newestSamples(theList);
     
     foreach (const S9sVariant variant, listMap)
     {
@@ -11873,12 +12024,12 @@ S9sRpcReply::printMemoryStatLine1()
     sumBuffers /= 1024 * 1024 * 1024.0;
     sumCached  /= 1024 * 1024 * 1024.0;
 
-    printf("GiB Mem : ");
-    printf("%s%.1f%s total, ",   numberStart, sumTotal, numberEnd);
-    printf("%s%.1f%s free, ",    numberStart, sumFree, numberEnd);
-    printf("%s%.1f%s used, ",    numberStart, sumTotal - (sumFree + sumBuffers + sumCached), numberEnd);
-    printf("%s%.1f%s buffers, ", numberStart, sumBuffers, numberEnd);
-    printf("%s%.1f%s cached",    numberStart, sumCached, numberEnd);
+    s9s_printf("GiB Mem : ");
+    s9s_printf("%s%.1f%s total, ",   numberStart, sumTotal, numberEnd);
+    s9s_printf("%s%.1f%s free, ",    numberStart, sumFree, numberEnd);
+    s9s_printf("%s%.1f%s used, ",    numberStart, sumTotal - (sumFree + sumBuffers + sumCached), numberEnd);
+    s9s_printf("%s%.1f%s buffers, ", numberStart, sumBuffers, numberEnd);
+    s9s_printf("%s%.1f%s cached",    numberStart, sumCached, numberEnd);
 }
 
 void
@@ -11899,21 +12050,7 @@ S9sRpcReply::printMemoryStatLine2()
         numberEnd   = TERM_NORMAL;
     }
 
-    for (uint idx = 0; idx < theList.size(); ++idx)
-    {
-        S9sVariantMap theMap  = theList[idx].toVariantMap();
-        S9sString     key     = theMap["samplekey"].toString();
-        ulonglong     created = theMap["created"].toULongLong();
-
-        if (!listMap.contains(key))
-        {
-            listMap[key] = theMap;
-            continue;
-        }
-
-        if (listMap[key]["created"].toULongLong() < created)
-            listMap[key] = theMap;
-    }
+    listMap = newestSamples(theList);
     
     foreach (const S9sVariant variant, listMap)
     {
@@ -11928,10 +12065,10 @@ S9sRpcReply::printMemoryStatLine2()
     sumTotal   /= 1024 * 1024 * 1024;
     sumFree    /= 1024 * 1024 * 1024;
 
-    printf("GiB Swap: ");
-    printf("%s%llu%s total, ", numberStart, sumTotal, numberEnd);
-    printf("%s%llu%s used, ",  numberStart, sumTotal - sumFree, numberEnd);
-    printf("%s%llu%s free, ",  numberStart, sumFree, numberEnd);
+    s9s_printf("GiB Swap: ");
+    s9s_printf("%s%llu%s total, ", numberStart, sumTotal, numberEnd);
+    s9s_printf("%s%llu%s used, ",  numberStart, sumTotal - sumFree, numberEnd);
+    s9s_printf("%s%llu%s free, ",  numberStart, sumFree, numberEnd);
 }
 
 /**
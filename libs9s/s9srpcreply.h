@@ -33,6 +33,7 @@ class S9sUser;
 class S9sServer;
 class S9sTreeNode;
 class S9sDbGrowthReport;
+class S9sRecordWriter;
 
 class S9sRpcReply : public S9sVariantMap
 {
@@ -91,6 +92,9 @@ class S9sRpcReply : public S9sVariantMap
         void printCheckHostsReply();
         void printJobStarted();
         void printJsonFormat() const;
+        void printRecords(const S9sVariantList &records) const;
+        void printNodeRecords();
+        void printObjectRecords() const;
 
         void printJobLog();
         void printJobLogBrief(const char *format = NULL);
@@ -225,6 +229,7 @@ class S9sRpcReply : public S9sVariantMap
         void printProcessListTop(const int maxLines = -1);
         void printCpuStat();
         void printCpuStatLine1();
+        static S9sVariantMap newestSamples(const S9sVariantList &statList);
         void printMemoryStatLine1();
         void printMemoryStatLine2();
 
@@ -259,18 +264,18 @@ class S9sRpcReply : public S9sVariantMap
                 bool                 isLast);
 
         void printObjectTreeBrief(
-                S9sTreeNode          node,
+                const S9sTreeNode   &node,
                 int                  recursionLevel,
                 S9sString            indentString,
                 bool                 isLast);
         
         void printObjectListLong(
-                S9sTreeNode          node,
+                const S9sTreeNode   &node,
                 int                  recursionLevel,
                 S9sString            indentString);
         
         void printObjectListBrief(
-                S9sVariantMap        entry,
+                const S9sTreeNode   &node,
                 int                  recursionLevel,
                 S9sString            indentString,
                 bool                 isLast);
@@ -308,13 +313,25 @@ class S9sRpcReply : public S9sVariantMap
         static const char *fileColorEnd();
        
         bool printGraph();
+        
+        static bool printGraphs(
+                const S9sVector<S9sRpcReply *> &replies,
+                const S9sVector<S9sString>     &graphTypes);
+
+        static bool createGraphs(
+                const S9sVector<S9sRpcReply *> &replies,
+                const S9sVector<S9sString>     &graphTypes,
+                S9sVector<S9sCmonGraph *>      &graphs);
+
         bool createGraph(
                 S9sVector<S9sCmonGraph *> &graphs, 
-                S9sNode                   &host);
+                S9sNode                   &host,
+                const S9sString           &graphType);
 
         bool createGraph(
                 S9sVector<S9sCmonGraph *> &graphs, 
                 S9sNode                   &host,
+                const S9sString           &graphType,
                 const S9sString           &filterName,
                 const S9sVariant          &filterValue);
         
@@ -324,7 +341,12 @@ class S9sRpcReply : public S9sVariantMap
     private:
         void printServersStat();
 
+        void printObjectRecords(
+                S9sRecordWriter     &writer,
+                const S9sVariantMap &entry) const;
+
         
+        void printLogRecords();
         void printLogBrief();
         void printLogLong();
 
@@ -435,7 +457,7 @@ class S9sRpcReply : public S9sVariantMap
         const char *greyColorEnd() const;
 
     private:
-        void walkObjectTree(S9sTreeNode node);
+        void walkObjectTree(const S9sTreeNode &node);
 
     private:
         S9sFormat         m_ownerFormat;
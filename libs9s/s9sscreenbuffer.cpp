@@ -0,0 +1,1025 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9sscreenbuffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/**
+ * If an unchanged gap between two changed cells is shorter than this we simply
+ * re-send the unchanged cells, it is cheaper than a cursor addressing sequence.
+ */
+#define MAX_REWRITE_GAP 4
+
+/**
+ * Trailing blanks shorter than this are sent as spaces, longer ones are
+ * cleared with an erase to end of line sequence.
+ */
+#define MIN_ERASE_LENGTH 4
+
+static const S9sScreenCell sm_emptyCell;
+
+/**
+ * \returns The unicode code point of the first character of the UTF-8 string
+ *   and sets the length to the number of bytes the character occupies.
+ */
+static uint
+decodeUtf8(
+        const unsigned char *data,
+        size_t               available,
+        size_t              &length)
+{
+    unsigned char c = data[0];
+    uint          retval;
+
+    if (c < 0x80)
+    {
+        length = 1;
+        return c;
+    } else if ((c & 0xe0) == 0xc0)
+    {
+        length = 2;
+        retval = c & 0x1f;
+    } else if ((c & 0xf0) == 0xe0)
+    {
+        length = 3;
+        retval = c & 0x0f;
+    } else if ((c & 0xf8) == 0xf0)
+    {
+        length = 4;
+        retval = c & 0x07;
+    } else {
+        // Not a valid lead byte.
+        length = 1;
+        return '?';
+    }
+
+    if (length > available)
+    {
+        length = available;
+        return '?';
+    }
+
+    for (size_t idx = 1; idx < length; ++idx)
+    {
+        if ((data[idx] & 0xc0) != 0x80)
+        {
+            length = idx;
+            return '?';
+        }
+
+        retval = (retval << 6) | (data[idx] & 0x3f);
+    }
+
+    return retval;
+}
+
+/**
+ * \returns True if the code point does not occupy a cell of its own but
+ *   modifies the previous character (combining marks, variation selectors, zero
+ *   width joiners and such).
+ */
+static bool
+isCombining(
+        uint codePoint)
+{
+    return
+        (codePoint >= 0x0300  && codePoint <= 0x036f)  ||
+        (codePoint >= 0x200b  && codePoint <= 0x200d)  ||
+        (codePoint >= 0x20d0  && codePoint <= 0x20ff)  ||
+        (codePoint >= 0xfe00  && codePoint <= 0xfe0f)  ||
+        (codePoint >= 0x1f3fb && codePoint <= 0x1f3ff);
+}
+
+/******************************************************************************
+ * S9sScreenAttr
+ */
+S9sScreenAttr::S9sScreenAttr() :
+    m_flags(0u),
+    m_foreground(-1),
+    m_background(-1)
+{
+}
+
+bool
+S9sScreenAttr::operator==(
+        const S9sScreenAttr &rhs) const
+{
+    return
+        m_flags      == rhs.m_flags &&
+        m_foreground == rhs.m_foreground &&
+        m_background == rhs.m_background;
+}
+
+bool
+S9sScreenAttr::operator!=(
+        const S9sScreenAttr &rhs) const
+{
+    return !(*this == rhs);
+}
+
+void
+S9sScreenAttr::reset()
+{
+    m_flags      = 0u;
+    m_foreground = -1;
+    m_background = -1;
+}
+
+/**
+ * \returns The attributes the terminal uses when it erases cells while these
+ *   attributes are set: only the background color is kept.
+ */
+S9sScreenAttr
+S9sScreenAttr::background() const
+{
+    S9sScreenAttr retval;
+
+    retval.m_background = m_background;
+    return retval;
+}
+
+/**
+ * \param parameters The parameter part of an SGR sequence, e.g. "1;38;5;17".
+ *
+ * Modifies the attributes the same way the terminal would when receiving the
+ * "\033[<parameters>m" sequence.
+ */
+void
+S9sScreenAttr::applySgr(
+        const S9sString &parameters)
+{
+    S9sVector<int> values;
+    S9sString      number;
+
+    for (uint idx = 0u; idx <= parameters.length(); ++idx)
+    {
+        char c = idx < parameters.length() ? parameters[idx] : ';';
+
+        if (c == ';' || c == ':')
+        {
+            values.push_back(number.empty() ? 0 : atoi(STR(number)));
+            number.clear();
+        } else {
+            number += c;
+        }
+    }
+
+    for (uint idx = 0u; idx < values.size(); ++idx)
+    {
+        int value = values[idx];
+
+        if (value == 0)
+            reset();
+        else if (value == 1)
+            m_flags |= Bold;
+        else if (value == 2)
+            m_flags |= Dim;
+        else if (value == 3)
+            m_flags |= Italic;
+        else if (value == 4)
+            m_flags |= Underline;
+        else if (value == 5)
+            m_flags |= Blink;
+        else if (value == 7)
+            m_flags |= Inverse;
+        else if (value == 8)
+            m_flags |= Hidden;
+        else if (value == 9)
+            m_flags |= Strike;
+        else if (value == 21 || value == 22)
+            m_flags &= ~(Bold | Dim);
+        else if (value == 23)
+            m_flags &= ~Italic;
+        else if (value == 24)
+            m_flags &= ~Underline;
+        else if (value == 25)
+            m_flags &= ~Blink;
+        else if (value == 27)
+            m_flags &= ~Inverse;
+        else if (value == 28)
+            m_flags &= ~Hidden;
+        else if (value == 29)
+            m_flags &= ~Strike;
+        else if (value >= 30 && value <= 37)
+            m_foreground = value - 30;
+        else if (value == 39)
+            m_foreground = -1;
+        else if (value >= 40 && value <= 47)
+            m_background = value - 40;
+        else if (value == 49)
+            m_background = -1;
+        else if (value >= 90 && value <= 97)
+            m_foreground = value - 90 + 8;
+        else if (value >= 100 && value <= 107)
+            m_background = value - 100 + 8;
+        else if (value == 38 || value == 48)
+        {
+            int color = -1;
+
+            if (idx + 2 < values.size() && values[idx + 1] == 5)
+            {
+                color = values[idx + 2] & 0xff;
+                idx  += 2;
+            } else if (idx + 4 < values.size() && values[idx + 1] == 2)
+            {
+                color = 0x1000000 |
+                    ((values[idx + 2] & 0xff) << 16) |
+                    ((values[idx + 3] & 0xff) << 8)  |
+                    (values[idx + 4] & 0xff);
+
+                idx += 4;
+            } else {
+                break;
+            }
+
+            if (value == 38)
+                m_foreground = color;
+            else
+                m_background = color;
+        }
+    }
+}
+
+static void
+appendColor(
+        S9sString  &retval,
+        int         color,
+        bool        isBackground)
+{
+    S9sString tmp;
+
+    if (color < 0)
+        return;
+
+    if (color < 8)
+        tmp.sprintf(";%d", (isBackground ? 40 : 30) + color);
+    else if (color < 16)
+        tmp.sprintf(";%d", (isBackground ? 100 : 90) + color - 8);
+    else if (color < 256)
+        tmp.sprintf(";%d;5;%d", isBackground ? 48 : 38, color);
+    else
+        tmp.sprintf(";%d;2;%d;%d;%d", isBackground ? 48 : 38,
+                (color >> 16) & 0xff, (color >> 8) & 0xff, color & 0xff);
+
+    retval += tmp;
+}
+
+/**
+ * \returns An SGR sequence that sets these attributes regardless of what
+ *   attributes the terminal had before.
+ */
+S9sString
+S9sScreenAttr::toSgr() const
+{
+    S9sString retval = "\033[0";
+
+    if (m_flags & Bold)
+        retval += ";1";
+
+    if (m_flags & Dim)
+        retval += ";2";
+
+    if (m_flags & Italic)
+        retval += ";3";
+
+    if (m_flags & Underline)
+        retval += ";4";
+
+    if (m_flags & Blink)
+        retval += ";5";
+
+    if (m_flags & Inverse)
+        retval += ";7";
+
+    if (m_flags & Hidden)
+        retval += ";8";
+
+    if (m_flags & Strike)
+        retval += ";9";
+
+    appendColor(retval, m_foreground, false);
+    appendColor(retval, m_background, true);
+
+    retval += "m";
+    return retval;
+}
+
+/******************************************************************************
+ * S9sScreenCell
+ */
+S9sScreenCell::S9sScreenCell() :
+    m_glyph(" ")
+{
+}
+
+bool
+S9sScreenCell::operator==(
+        const S9sScreenCell &rhs) const
+{
+    return m_attr == rhs.m_attr && m_glyph == rhs.m_glyph;
+}
+
+bool
+S9sScreenCell::operator!=(
+        const S9sScreenCell &rhs) const
+{
+    return !(*this == rhs);
+}
+
+/**
+ * \returns True if the terminal might print the glyph wider than one cell, so
+ *   we can not know for sure where the cursor is after printing it.
+ */
+bool
+S9sScreenCell::isAmbiguousWidth() const
+{
+    const unsigned char *data = (const unsigned char *) m_glyph.c_str();
+    size_t               length;
+    uint                 codePoint;
+
+    if (data[0] < 0x80)
+        return false;
+
+    codePoint = decodeUtf8(data, m_glyph.length(), length);
+
+    // Sequences with combining characters, e.g. emoji presentation.
+    if (length < m_glyph.length())
+        return true;
+
+    // The box drawing characters are narrow, we use them a lot.
+    if (codePoint >= 0x2500 && codePoint <= 0x25ff)
+        return false;
+
+    return codePoint >= 0x1100;
+}
+
+/******************************************************************************
+ * S9sScreenBuffer
+ */
+S9sScreenBuffer::S9sScreenBuffer() :
+    m_width(0),
+    m_height(0),
+    m_invalid(true),
+    m_cursorX(0),
+    m_cursorY(0),
+    m_cursorVisible(false),
+    m_terminalX(-1),
+    m_terminalY(-1),
+    m_terminalAttrKnown(false),
+    m_terminalCursorVisible(false),
+    m_bytesGenerated(0ull),
+    m_bytesWritten(0ull),
+    m_nFrames(0ull)
+{
+}
+
+S9sScreenBuffer::~S9sScreenBuffer()
+{
+}
+
+/**
+ * Sets the size of the screen measured in characters. If the size changes the
+ * whole screen will be re-sent in the next render.
+ */
+void
+S9sScreenBuffer::setSize(
+        int width,
+        int height)
+{
+    if (width < 0)
+        width = 0;
+
+    if (height < 0)
+        height = 0;
+
+    if (width == m_width && height == m_height)
+        return;
+
+    m_width  = width;
+    m_height = height;
+
+    m_backBuffer.assign(m_width * m_height, S9sScreenCell());
+    m_frontBuffer.assign(m_width * m_height, S9sScreenCell());
+
+    if (m_cursorX >= m_width)
+        m_cursorX = m_width > 0 ? m_width - 1 : 0;
+
+    if (m_cursorY >= m_height)
+        m_cursorY = m_height > 0 ? m_height - 1 : 0;
+
+    invalidate();
+}
+
+int
+S9sScreenBuffer::width() const
+{
+    return m_width;
+}
+
+int
+S9sScreenBuffer::height() const
+{
+    return m_height;
+}
+
+/**
+ * Forgets what the terminal shows, so the next render will clear the screen and
+ * send every cell. This should be called when something else was writing to
+ * the terminal.
+ */
+void
+S9sScreenBuffer::invalidate()
+{
+    m_invalid = true;
+}
+
+void
+S9sScreenBuffer::parse(
+        const S9sString &data)
+{
+    parse(data.c_str(), data.length());
+}
+
+/**
+ * \param data The text with the terminal escape sequences as the views are
+ *   painting it.
+ * \param length The number of bytes in the data.
+ *
+ * Interprets the output of the views into the back buffer the same way the
+ * terminal would interpret it.
+ */
+void
+S9sScreenBuffer::parse(
+        const char *data,
+        size_t      length)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    size_t               idx   = 0;
+
+    m_bytesGenerated += length;
+
+    while (idx < length)
+    {
+        unsigned char c = bytes[idx];
+
+        if (c == 0x1b)
+        {
+            if (idx + 1 >= length)
+                break;
+
+            if (bytes[idx + 1] == '[')
+            {
+                // CSI: parameter bytes then one final byte.
+                size_t    end = idx + 2;
+                S9sString parameters;
+
+                while (end < length && bytes[end] >= 0x20 && bytes[end] < 0x40)
+                    parameters += (char) bytes[end++];
+
+                if (end >= length)
+                    break;
+
+                processCsi(parameters, (char) bytes[end]);
+                idx = end + 1;
+            } else if (bytes[idx + 1] == ']')
+            {
+                // OSC: terminated by BEL or ST, this is the window title.
+                size_t end = idx + 2;
+
+                while (end < length)
+                {
+                    if (bytes[end] == 0x07)
+                        break;
+
+                    if (bytes[end] == 0x1b && end + 1 < length &&
+                            bytes[end + 1] == '\\')
+                    {
+                        ++end;
+                        break;
+                    }
+
+                    ++end;
+                }
+
+                if (end >= length)
+                    break;
+
+                m_title = S9sString(std::string(data + idx, end - idx + 1));
+                idx     = end + 1;
+            } else {
+                m_passThrough += std::string(data + idx, 2);
+                idx += 2;
+            }
+
+            continue;
+        }
+
+        if (c == '\r')
+        {
+            m_cursorX = 0;
+        } else if (c == '\n')
+        {
+            if (m_cursorY + 1 < m_height)
+                ++m_cursorY;
+        } else if (c == '\t')
+        {
+            m_cursorX = (m_cursorX / 8 + 1) * 8;
+            if (m_cursorX >= m_width)
+                m_cursorX = m_width > 0 ? m_width - 1 : 0;
+        } else if (c == '\b')
+        {
+            if (m_cursorX > 0)
+                --m_cursorX;
+        } else if (c < 0x20 || c == 0x7f)
+        {
+            // Other control characters (e.g. the bell) are ignored.
+        } else {
+            size_t      charLength;
+            uint        codePoint;
+            std::string glyph;
+
+            codePoint = decodeUtf8(bytes + idx, length - idx, charLength);
+            glyph     = std::string(data + idx, charLength);
+
+            if (isCombining(codePoint))
+                appendToPreviousGlyph(glyph);
+            else
+                putGlyph(glyph);
+
+            idx += charLength;
+            continue;
+        }
+
+        ++idx;
+    }
+}
+
+S9sScreenCell &
+S9sScreenBuffer::backCell(
+        int column,
+        int row)
+{
+    return m_backBuffer[row * m_width + column];
+}
+
+/**
+ * Puts one character at the cursor position and moves the cursor. The automatic
+ * line wrap is off on our screens, so at the right edge the cursor stays in the
+ * last column.
+ */
+void
+S9sScreenBuffer::putGlyph(
+        const std::string &glyph)
+{
+    if (m_width <= 0 || m_height <= 0)
+        return;
+
+    if (m_cursorX >= m_width)
+        m_cursorX = m_width - 1;
+
+    S9sScreenCell &cell = backCell(m_cursorX, m_cursorY);
+
+    cell.m_glyph = glyph;
+    cell.m_attr  = m_attr;
+
+    if (m_cursorX + 1 < m_width)
+        ++m_cursorX;
+}
+
+void
+S9sScreenBuffer::appendToPreviousGlyph(
+        const std::string &glyph)
+{
+    int column = m_cursorX > 0 ? m_cursorX - 1 : 0;
+
+    if (m_width <= 0 || m_height <= 0)
+        return;
+
+    if (column >= m_width)
+        column = m_width - 1;
+
+    backCell(column, m_cursorY).m_glyph += glyph;
+}
+
+void
+S9sScreenBuffer::eraseCells(
+        int row,
+        int fromColumn,
+        int toColumn)
+{
+    S9sScreenCell blank;
+
+    if (row < 0 || row >= m_height)
+        return;
+
+    blank.m_attr = m_attr.background();
+
+    if (fromColumn < 0)
+        fromColumn = 0;
+
+    for (int column = fromColumn; column <= toColumn && column < m_width;
+            ++column)
+    {
+        backCell(column, row) = blank;
+    }
+}
+
+void
+S9sScreenBuffer::processCsi(
+        const S9sString &parameters,
+        char             finalChar)
+{
+    int p0 = 0, p1 = 0;
+
+    // The private modes, we only care about the cursor visibility.
+    if (parameters.startsWith("?"))
+    {
+        if (parameters == "?25" && finalChar == 'h')
+            m_cursorVisible = true;
+        else if (parameters == "?25" && finalChar == 'l')
+            m_cursorVisible = false;
+        else
+            m_passThrough += "\033[" + parameters + finalChar;
+
+        return;
+    }
+
+    if (finalChar == 'm')
+    {
+        m_attr.applySgr(parameters);
+        return;
+    }
+
+    if (!parameters.empty())
+    {
+        const char *separator = strchr(STR(parameters), ';');
+
+        p0 = atoi(STR(parameters));
+        if (separator != NULL)
+            p1 = atoi(separator + 1);
+    }
+
+    switch (finalChar)
+    {
+        case 'H':
+        case 'f':
+            m_cursorY = (p0 > 0 ? p0 : 1) - 1;
+            m_cursorX = (p1 > 0 ? p1 : 1) - 1;
+            break;
+
+        case 'A':
+            m_cursorY -= p0 > 0 ? p0 : 1;
+            break;
+
+        case 'B':
+            m_cursorY += p0 > 0 ? p0 : 1;
+            break;
+
+        case 'C':
+            m_cursorX += p0 > 0 ? p0 : 1;
+            break;
+
+        case 'D':
+            m_cursorX -= p0 > 0 ? p0 : 1;
+            break;
+
+        case 'G':
+            m_cursorX = (p0 > 0 ? p0 : 1) - 1;
+            break;
+
+        case 'd':
+            m_cursorY = (p0 > 0 ? p0 : 1) - 1;
+            break;
+
+        case 'K':
+            if (p0 == 0)
+                eraseCells(m_cursorY, m_cursorX, m_width - 1);
+            else if (p0 == 1)
+                eraseCells(m_cursorY, 0, m_cursorX);
+            else
+                eraseCells(m_cursorY, 0, m_width - 1);
+            break;
+
+        case 'J':
+            if (p0 == 0)
+            {
+                eraseCells(m_cursorY, m_cursorX, m_width - 1);
+                for (int row = m_cursorY + 1; row < m_height; ++row)
+                    eraseCells(row, 0, m_width - 1);
+            } else if (p0 == 1)
+            {
+                for (int row = 0; row < m_cursorY; ++row)
+                    eraseCells(row, 0, m_width - 1);
+
+                eraseCells(m_cursorY, 0, m_cursorX);
+            } else {
+                for (int row = 0; row < m_height; ++row)
+                    eraseCells(row, 0, m_width - 1);
+            }
+            break;
+
+        default:
+            m_passThrough += "\033[" + parameters + finalChar;
+            return;
+    }
+
+    // Keeping the cursor on the screen.
+    if (m_cursorX < 0)
+        m_cursorX = 0;
+    else if (m_cursorX >= m_width)
+        m_cursorX = m_width > 0 ? m_width - 1 : 0;
+
+    if (m_cursorY < 0)
+        m_cursorY = 0;
+    else if (m_cursorY >= m_height)
+        m_cursorY = m_height > 0 ? m_height - 1 : 0;
+}
+
+void
+S9sScreenBuffer::moveTo(
+        int        column,
+        int        row,
+        S9sString &output)
+{
+    S9sString sequence;
+
+    if (column == m_terminalX && row == m_terminalY)
+        return;
+
+    sequence.sprintf("\033[%d;%dH", row + 1, column + 1);
+    output      += sequence;
+    m_terminalX  = column;
+    m_terminalY  = row;
+}
+
+void
+S9sScreenBuffer::setAttr(
+        const S9sScreenAttr &attr,
+        S9sString           &output)
+{
+    if (m_terminalAttrKnown && attr == m_terminalAttr)
+        return;
+
+    output              += attr.toSgr();
+    m_terminalAttr       = attr;
+    m_terminalAttrKnown  = true;
+}
+
+/**
+ * Sends the changed cells of one row. If the row has characters in it that
+ * might be printed wider than one cell the whole row is sent sequentially,
+ * because we can not address the cells after such a character.
+ *
+ * \returns True if something was sent.
+ */
+bool
+S9sScreenBuffer::renderRow(
+        int        row,
+        S9sString &output)
+{
+    S9sScreenCell *back  = &m_backBuffer[row * m_width];
+    S9sScreenCell *front = &m_frontBuffer[row * m_width];
+    int            first = -1;
+    int            last  = -1;
+    bool           ambiguous = false;
+    int            blankStart;
+
+    for (int column = 0; column < m_width; ++column)
+    {
+        if (back[column] != front[column])
+        {
+            if (first < 0)
+                first = column;
+
+            last = column;
+        }
+
+        if (!ambiguous &&
+                (back[column].isAmbiguousWidth() ||
+                 front[column].isAmbiguousWidth()))
+        {
+            ambiguous = true;
+        }
+    }
+
+    if (first < 0)
+        return false;
+
+    if (ambiguous)
+    {
+        first = 0;
+        last  = m_width - 1;
+    }
+
+    /*
+     * Finding the trailing blanks we can send as one erase sequence.
+     */
+    blankStart = m_width;
+    while (blankStart > 0)
+    {
+        const S9sScreenCell &cell = back[blankStart - 1];
+
+        if (cell.m_glyph != " " ||
+                cell.m_attr != cell.m_attr.background() ||
+                cell.m_attr != back[m_width - 1].m_attr)
+        {
+            break;
+        }
+
+        --blankStart;
+    }
+
+    if (last < blankStart || m_width - blankStart < MIN_ERASE_LENGTH)
+        blankStart = m_width;
+    else
+        last = blankStart - 1;
+
+    /*
+     * Sending the changed cells.
+     */
+    if (ambiguous)
+        moveTo(0, row, output);
+
+    for (int column = first; column <= last; ++column)
+    {
+        if (!ambiguous && back[column] == front[column])
+        {
+            int next = column;
+
+            while (next <= last && back[next] == front[next])
+                ++next;
+
+            if (next > last)
+                break;
+
+            if (next - column > MAX_REWRITE_GAP ||
+                    m_terminalX != column || m_terminalY != row)
+            {
+                column = next - 1;
+                continue;
+            }
+        }
+
+        if (!ambiguous)
+            moveTo(column, row, output);
+
+        setAttr(back[column].m_attr, output);
+        output += back[column].m_glyph;
+        front[column] = back[column];
+
+        if (ambiguous || column + 1 >= m_width)
+            m_terminalX = -1;
+        else
+            ++m_terminalX;
+    }
+
+    if (blankStart < m_width)
+    {
+        if (!ambiguous)
+            moveTo(blankStart, row, output);
+
+        setAttr(back[blankStart].m_attr, output);
+        output += "\033[K";
+
+        for (int column = blankStart; column < m_width; ++column)
+            front[column] = back[column];
+    }
+
+    if (ambiguous)
+        m_terminalX = -1;
+
+    return true;
+}
+
+/**
+ * \returns The bytes that should be sent to the terminal so that it shows what
+ *   is in the back buffer.
+ *
+ * Compares the back buffer with what the terminal shows and creates the
+ * sequences that update only the cells that are changed.
+ */
+S9sString
+S9sScreenBuffer::render()
+{
+    S9sString retval;
+
+    if (m_invalid)
+    {
+        m_terminalAttr.reset();
+        m_terminalAttrKnown = true;
+        m_terminalX         = 0;
+        m_terminalY         = 0;
+        m_terminalTitle.clear();
+        m_frontBuffer.assign(m_width * m_height, S9sScreenCell());
+        m_invalid           = false;
+
+        retval += m_terminalAttr.toSgr();
+        retval += "\033[H\033[2J";
+    }
+
+    retval += m_passThrough;
+    m_passThrough.clear();
+
+    if (m_title != m_terminalTitle)
+    {
+        retval += m_title;
+        m_terminalTitle = m_title;
+    }
+
+    for (int row = 0; row < m_height; ++row)
+        renderRow(row, retval);
+
+    if (m_cursorVisible)
+    {
+        moveTo(m_cursorX, m_cursorY, retval);
+
+        if (!m_terminalCursorVisible)
+            retval += TERM_CURSOR_ON;
+    } else if (m_terminalCursorVisible)
+    {
+        retval += TERM_CURSOR_OFF;
+    }
+
+    m_terminalCursorVisible = m_cursorVisible;
+
+    m_bytesWritten += retval.length();
+    ++m_nFrames;
+
+    return retval;
+}
+
+/**
+ * \returns The characters of one line in the back buffer without the
+ *   attributes.
+ */
+S9sString
+S9sScreenBuffer::lineAt(
+        int row) const
+{
+    S9sString retval;
+
+    if (row < 0 || row >= m_height)
+        return retval;
+
+    for (int column = 0; column < m_width; ++column)
+        retval += m_backBuffer[row * m_width + column].m_glyph;
+
+    return retval;
+}
+
+const S9sScreenCell &
+S9sScreenBuffer::cellAt(
+        int column,
+        int row) const
+{
+    if (column < 0 || column >= m_width || row < 0 || row >= m_height)
+        return sm_emptyCell;
+
+    return m_backBuffer[row * m_width + column];
+}
+
+/**
+ * \returns How many bytes the views painted since the buffer was created.
+ */
+ulonglong
+S9sScreenBuffer::bytesGenerated() const
+{
+    return m_bytesGenerated;
+}
+
+/**
+ * \returns How many bytes were actually sent to the terminal.
+ */
+ulonglong
+S9sScreenBuffer::bytesWritten() const
+{
+    return m_bytesWritten;
+}
+
+ulonglong
+S9sScreenBuffer::nFrames() const
+{
+    return m_nFrames;
+}
@@ -0,0 +1,155 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9sglobal.h"
+
+/**
+ * The text attributes (colors, bold, inverse, etc.) of one character cell on
+ * the terminal screen.
+ */
+class S9sScreenAttr
+{
+    public:
+        enum Flag
+        {
+            Bold      = 0x01,
+            Dim       = 0x02,
+            Italic    = 0x04,
+            Underline = 0x08,
+            Blink     = 0x10,
+            Inverse   = 0x20,
+            Hidden    = 0x40,
+            Strike    = 0x80,
+        };
+
+        S9sScreenAttr();
+
+        bool operator==(const S9sScreenAttr &rhs) const;
+        bool operator!=(const S9sScreenAttr &rhs) const;
+
+        void reset();
+        void applySgr(const S9sString &parameters);
+        S9sScreenAttr background() const;
+        S9sString toSgr() const;
+
+    public:
+        uint   m_flags;
+        /** Foreground color, -1 for default, 0-255 palette, 0x1xxxxxx rgb. */
+        int    m_foreground;
+        /** Background color, same encoding as the foreground. */
+        int    m_background;
+};
+
+/**
+ * One character cell on the screen. The glyph is stored as an UTF-8 string so
+ * that combining characters and variation selectors stay together with the
+ * base character they belong to.
+ */
+class S9sScreenCell
+{
+    public:
+        S9sScreenCell();
+
+        bool operator==(const S9sScreenCell &rhs) const;
+        bool operator!=(const S9sScreenCell &rhs) const;
+
+        bool isAmbiguousWidth() const;
+
+    public:
+        std::string     m_glyph;
+        S9sScreenAttr   m_attr;
+};
+
+/**
+ * A back-buffer/front-buffer character grid for the screen oriented UIs. The
+ * frames the views are painting (text with terminal escape sequences) are
+ * interpreted into the back buffer, then only the cells that are different
+ * from what the terminal already shows are sent to the terminal using cursor
+ * addressing sequences.
+ */
+class S9sScreenBuffer
+{
+    public:
+        S9sScreenBuffer();
+        virtual ~S9sScreenBuffer();
+
+        void setSize(int width, int height);
+        int width() const;
+        int height() const;
+
+        void invalidate();
+
+        void parse(const char *data, size_t length);
+        void parse(const S9sString &data);
+
+        S9sString render();
+
+        S9sString lineAt(int row) const;
+        const S9sScreenCell &cellAt(int column, int row) const;
+
+        ulonglong bytesGenerated() const;
+        ulonglong bytesWritten() const;
+        ulonglong nFrames() const;
+
+    private:
+        S9sScreenCell &backCell(int column, int row);
+        void putGlyph(const std::string &glyph);
+        void appendToPreviousGlyph(const std::string &glyph);
+        void eraseCells(int row, int fromColumn, int toColumn);
+        void processCsi(const S9sString &parameters, char finalChar);
+        bool renderRow(int row, S9sString &output);
+        void moveTo(int column, int row, S9sString &output);
+        void setAttr(const S9sScreenAttr &attr, S9sString &output);
+
+    private:
+        int                          m_width;
+        int                          m_height;
+
+        /** What the views painted. */
+        S9sVector<S9sScreenCell>     m_backBuffer;
+        /** What we believe the terminal currently shows. */
+        S9sVector<S9sScreenCell>     m_frontBuffer;
+        bool                         m_invalid;
+
+        /** Parser state: the cursor position and the current attributes. */
+        int                          m_cursorX;
+        int                          m_cursorY;
+        S9sScreenAttr                m_attr;
+        bool                         m_cursorVisible;
+        S9sString                    m_title;
+
+        /** Sequences we do not interpret, sent to the terminal unchanged. */
+        S9sString                    m_passThrough;
+
+        /** Terminal state: where the cursor is and what attributes are set. */
+        int                          m_terminalX;
+        int                          m_terminalY;
+        S9sScreenAttr                m_terminalAttr;
+        bool                         m_terminalAttrKnown;
+        bool                         m_terminalCursorVisible;
+        S9sString                    m_terminalTitle;
+
+        ulonglong                    m_bytesGenerated;
+        ulonglong                    m_bytesWritten;
+        ulonglong                    m_nFrames;
+};
@@ -259,8 +259,8 @@ S9sSpreadsheet::print() const
     /*
      * Printing the header line.
      */
-    ::printf("     ");
-    ::printf("%s", headerColorBegin());
+    s9s_printf("     ");
+    s9s_printf("%s", headerColorBegin());
 
     thisColumn = 5;
     for (uint col = m_firstVisibleColumn; col < 32; ++col)
@@ -275,32 +275,32 @@ S9sSpreadsheet::print() const
         label += 'A' + col;
         
         for (uint n = 0; n < (theWidth - label.length()) / 2; ++n, ++nChars)
-            ::printf(" ");
+            s9s_printf(" ");
 
-        ::printf("%s", STR(label));
+        s9s_printf("%s", STR(label));
         nChars += label.length();
         
         for (; nChars < theWidth; ++nChars)
-            ::printf(" ");
+            s9s_printf(" ");
 
         thisColumn += theWidth;
     }
 
     for (;thisColumn < (int)m_screenColumns;++thisColumn)
-        ::printf(" ");
+        s9s_printf(" ");
 
     //::printf("%s", TERM_ERASE_EOL);
-    ::printf("%s", headerColorEnd());
-    ::printf("\r\n");
+    s9s_printf("%s", headerColorEnd());
+    s9s_printf("\r\n");
 
     /*
      *
      */
     for (uint row = m_firstVisibleRow; row <= (uint)lastVisibleRow(); ++row)
     {
-        ::printf("%s", headerColorBegin());
-        ::printf(" %3u ", row + 1);
-        ::printf("%s", headerColorEnd());
+        s9s_printf("%s", headerColorBegin());
+        s9s_printf(" %3u ", row + 1);
+        s9s_printf("%s", headerColorEnd());
 
         for (uint col = m_firstVisibleColumn; col <= (uint)lastVisibleColumn(); ++col)
         {
@@ -311,33 +311,33 @@ S9sSpreadsheet::print() const
                 theValue.resize(theWidth);
 
             // 
-            ::printf("%s", cellBegin(0, col, row));
+            s9s_printf("%s", cellBegin(0, col, row));
 
             //
             // Printing the cell content.
             //
             if (!isAlignRight(0, col, row))
             {
-                ::printf("%s", STR(theValue));
+                s9s_printf("%s", STR(theValue));
                 if (theWidth > (int)theValue.length())
                 {
                     for (uint n = 0; n < theWidth - theValue.length(); ++n)
-                        ::printf(" ");
+                        s9s_printf(" ");
                 }
             } else {
                 if (theWidth > (int)theValue.length())
                 {
                     for (uint n = 0; n < theWidth - theValue.length(); ++n)
-                        ::printf(" ");
+                        s9s_printf(" ");
                 }
-                ::printf("%s", STR(theValue));
+                s9s_printf("%s", STR(theValue));
             }
             
             // 
-            ::printf("%s", cellEnd(0, col, row));
+            s9s_printf("%s", cellEnd(0, col, row));
         }
         
-        ::printf("\r\n");
+        s9s_printf("\r\n");
     }
 }
 
@@ -0,0 +1,754 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9sstatcache.h"
+
+#include "s9sfile.h"
+#include "s9sdir.h"
+#include "s9smutexlocker.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <utime.h>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/**
+ * The samples created in the last settleTime seconds are not considered
+ * covered by the cache, they are requested again the next time.
+ */
+const int S9sStatCache::settleTime = 60;
+
+/**
+ * The longest time range one entry of the cache holds.
+ */
+const int S9sStatCache::maxSpan = 7 * 24 * 60 * 60;
+
+S9sMutex S9sStatCache::sm_mutex;
+
+/**
+ * \param directory The directory where the entries of the cache are stored.
+ * \param maxSize The number of bytes the cache may use on the disk.
+ */
+S9sStatCache::S9sStatCache(
+        const S9sString &directory,
+        const ulonglong  maxSize) :
+    m_directory(S9sDir(directory).path()),
+    m_maxSize(maxSize),
+    m_begin(0),
+    m_end(0)
+{
+}
+
+S9sStatCache::~S9sStatCache()
+{
+}
+
+S9sString
+S9sStatCache::defaultDirectory()
+{
+    return S9sString("~/.s9s/stats");
+}
+
+/**
+ * \returns The name of the cache entry that holds the given statistics. The
+ *   characters that are not safe in a file name are replaced.
+ */
+S9sString
+S9sStatCache::entryName(
+        const S9sString &controller,
+        const int        port,
+        const S9sString &cluster,
+        const S9sString &statName)
+{
+    S9sString retval;
+
+    retval.sprintf("%s-%d-%s-%s", 
+            STR(controller), port, STR(cluster), STR(statName));
+
+    for (uint idx = 0u; idx < retval.size(); ++idx)
+    {
+        char c = retval[idx];
+
+        if (!isalnum(c) && c != '-' && c != '.' && c != '_')
+            retval[idx] = '_';
+    }
+
+    if (retval.startsWith("."))
+        retval[0] = '_';
+
+    return retval;
+}
+
+/**
+ * \param entryName The name of the entry as entryName() returns it.
+ * \returns true if the entry was found and loaded.
+ *
+ * Loads the index and the samples of the entry. If the entry does not exist or
+ * it is damaged the cache will be empty, so all the samples will be requested
+ * from the controller.
+ */
+bool
+S9sStatCache::load(
+        const S9sString &entryName)
+{
+    S9sMutexLocker  locker(sm_mutex);
+    S9sString       indexPath;
+    S9sString       content;
+    S9sVariantMap   index;
+    S9sVariantList  hostIds;
+
+    clear();
+    m_entryName = entryName;
+    indexPath   = S9sFile::buildPath(entryPath(), "index");
+
+    if (!S9sFile::fileExists(indexPath))
+        return false;
+
+    if (!S9sFile(indexPath).readTxtFile(content) || 
+            !index.parse(STR(content)))
+    {
+        m_errorString.sprintf("Failed to load '%s'.", STR(indexPath));
+        return false;
+    }
+
+    m_begin   = index["begin"].toTimeT();
+    m_end     = index["end"].toTimeT();
+    m_hosts   = index["hosts"].toVariantList();
+    hostIds   = index["host_ids"].toVariantList();
+
+    for (uint idx = 0u; idx < hostIds.size(); ++idx)
+    {
+        if (!loadHost(hostIds[idx].toInt()))
+        {
+            clear();
+            m_entryName = entryName;
+            return false;
+        }
+    }
+
+    // The index file shows when the entry was used the last time.
+    utime(STR(indexPath), NULL);
+    return true;
+}
+
+/**
+ * Saves the index and the samples of the hosts that are changed since the
+ * entry is loaded, then removes the least recently used entries if the cache
+ * is too big.
+ */
+bool
+S9sStatCache::save()
+{
+    S9sMutexLocker  locker(sm_mutex);
+    S9sDir          dir(entryPath());
+    S9sVariantMap   index;
+    S9sVariantList  hostIds;
+    S9sVariantList  files;
+
+    if (m_maxSize == 0ull || m_entryName.empty())
+        return false;
+
+    if (!dir.exists() && !dir.mkdir())
+    {
+        m_errorString = dir.errorString();
+        return false;
+    }
+
+    for (S9sMap<int, HostSamples>::const_iterator it = m_samples.begin();
+            it != m_samples.end(); ++it)
+    {
+        const HostSamples       &samples = it->second;
+        S9sMap<S9sString, int>   columnIndex;
+        S9sVector<S9sString>     columns;
+        S9sString                content;
+        bool                     first = true;
+
+        hostIds << it->first;
+
+        if (!m_changed.contains(it->first))
+            continue;
+
+        // 
+        // The samples are written as one block: the field names once and every
+        // sample as a list of values.
+        //
+        for (HostSamples::const_iterator sIt = samples.begin(); 
+                sIt != samples.end(); ++sIt)
+        {
+            for (SampleRows::const_iterator rIt = sIt->second.begin();
+                    rIt != sIt->second.end(); ++rIt)
+            {
+                S9sVector<S9sString> keys = rIt->second.keys();
+
+                for (uint idx = 0u; idx < keys.size(); ++idx)
+                {
+                    if (keys[idx] != "hostid")
+                        columnIndex[keys[idx]] = 0;
+                }
+            }
+        }
+
+        columns = columnIndex.keys();
+
+        content.sprintf("{\n\"hostid\": %d,\n\"columns\": [", it->first);
+        for (uint idx = 0u; idx < columns.size(); ++idx)
+        {
+            if (idx > 0u)
+                content += ", ";
+
+            content += "\"" + columns[idx].escape() + "\"";
+        }
+
+        content += "],\n\"rows\": [\n";
+
+        for (HostSamples::const_iterator sIt = samples.begin(); 
+                sIt != samples.end(); ++sIt)
+        {
+            for (SampleRows::const_iterator rIt = sIt->second.begin();
+                    rIt != sIt->second.end(); ++rIt)
+            {
+                S9sVariantMap sample = rIt->second;
+
+                content += first ? "[" : ",\n[";
+                first    = false;
+
+                for (uint idx = 0u; idx < columns.size(); ++idx)
+                {
+                    const S9sVariant &value = sample[columns[idx]];
+                    S9sString         valueString;
+
+                    if (idx > 0u)
+                        content += ",";
+
+                    // The %g format of the variant would lose precision.
+                    if (value.isDouble())
+                        valueString.sprintf("%.17g", value.toDouble());
+                    else 
+                        valueString = value.toJsonString(0, S9sFormatNormal);
+
+                    content += valueString;
+                }
+
+                content += "]";
+            }
+        }
+
+        content += "\n]\n}\n";
+
+        if (!writeFile(hostFileName(it->first), content))
+            return false;
+    }
+
+    m_changed.clear();
+
+    // Removing the samples of the hosts we do not have any more.
+    S9sFile::listFiles(entryPath(), files, true);
+    for (uint idx = 0u; idx < files.size(); ++idx)
+    {
+        S9sString path = files[idx].toString();
+        bool      found = false;
+
+        if (!path.endsWith(".samples"))
+            continue;
+
+        for (uint idx1 = 0u; idx1 < hostIds.size(); ++idx1)
+        {
+            if (path == hostFileName(hostIds[idx1].toInt()))
+            {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            unlink(STR(path));
+    }
+
+    index["begin"]    = (ulonglong) m_begin;
+    index["end"]      = (ulonglong) m_end;
+    index["hosts"]    = m_hosts;
+    index["host_ids"] = hostIds;
+
+    if (!writeFile(
+                S9sFile::buildPath(entryPath(), "index"),
+                index.toJsonString(S9sFormatNormal) + "\n"))
+    {
+        return false;
+    }
+
+    removeOldEntries();
+    return true;
+}
+
+/**
+ * \returns The beginning of the time range covered by the cache, 0 if the
+ *   cache is empty.
+ */
+time_t
+S9sStatCache::begin() const
+{
+    return m_begin;
+}
+
+/**
+ * \returns The end of the time range covered by the cache, 0 if the cache is
+ *   empty.
+ */
+time_t
+S9sStatCache::end() const
+{
+    return m_end;
+}
+
+/**
+ * \param begin The beginning of the time range the samples are needed for.
+ * \param end The end of the time range the samples are needed for.
+ * \param starts The beginnings of the ranges that are not covered.
+ * \param ends The ends of the ranges that are not covered.
+ *
+ * Finds the time ranges that has to be requested from the controller to have
+ * all the samples between begin and end. These are the ranges before and after
+ * the time range covered by the cache or the whole range if it does not
+ * overlap the cached range.
+ */
+void
+S9sStatCache::missingRanges(
+        const time_t        begin,
+        const time_t        end,
+        S9sVector<time_t>  &starts,
+        S9sVector<time_t>  &ends) const
+{
+    starts.clear();
+    ends.clear();
+
+    if (m_end <= m_begin || end < m_begin || begin > m_end)
+    {
+        starts << begin;
+        ends   << end;
+        return;
+    }
+
+    if (begin < m_begin)
+    {
+        starts << begin;
+        ends   << m_begin;
+    }
+
+    if (end > m_end)
+    {
+        starts << m_end;
+        ends   << end;
+    }
+}
+
+/**
+ * \param samples The samples received from the controller.
+ * \param hosts The list of hosts received from the controller.
+ * \param begin The beginning of the time range the samples were requested for.
+ * \param end The end of the time range the samples were requested for.
+ * \param now The current time, the samples of the last settleTime seconds are
+ *   not considered final.
+ *
+ * Merges the samples received from the controller into the cache. If the time
+ * range does not overlap the range covered by the cache the old samples are
+ * dropped, the cache always covers one contiguous range.
+ */
+void
+S9sStatCache::merge(
+        const S9sVariantList &samples,
+        const S9sVariantList &hosts,
+        const time_t          begin,
+        const time_t          end,
+        const time_t          now)
+{
+    time_t settled = end < now - settleTime ? end : now - settleTime;
+
+    if (m_end <= m_begin || end < m_begin || begin > m_end)
+    {
+        m_samples.clear();
+        m_begin = begin;
+        m_end   = settled;
+    } else {
+        if (begin < m_begin)
+            m_begin = begin;
+
+        if (settled > m_end)
+            m_end = settled;
+    }
+
+    if (m_end <= m_begin)
+    {
+        m_begin = 0;
+        m_end   = 0;
+    }
+
+    if (!hosts.empty())
+        m_hosts = hosts;
+
+    for (uint idx = 0u; idx < samples.size(); ++idx)
+    {
+        S9sVariantMap sample  = samples[idx].toVariantMap();
+        int           hostId  = sample["hostid"].toInt();
+        time_t        created = sample["created"].toTimeT();
+
+        m_samples[hostId][created][sampleKey(sample)] = sample;
+        m_changed[hostId] = true;
+    }
+
+    // 
+    // One entry should not grow forever, we keep the last maxSpan seconds.
+    //
+    if (m_end - m_begin > maxSpan)
+    {
+        m_begin = m_end - maxSpan;
+
+        for (S9sMap<int, HostSamples>::iterator it = m_samples.begin();
+                it != m_samples.end(); ++it)
+        {
+            HostSamples &hostSamples = it->second;
+
+            if (hostSamples.empty() || hostSamples.begin()->first >= m_begin)
+                continue;
+
+            hostSamples.erase(
+                    hostSamples.begin(), hostSamples.lower_bound(m_begin));
+
+            m_changed[it->first] = true;
+        }
+    }
+}
+
+/**
+ * \returns The samples of all the hosts created between begin and end ordered
+ *   by the creation time, the same way the controller sends them.
+ */
+S9sVariantList
+S9sStatCache::samples(
+        const time_t begin,
+        const time_t end) const
+{
+    S9sMap<time_t, S9sVariantList> byTime;
+    S9sVariantList                 retval;
+
+    for (S9sMap<int, HostSamples>::const_iterator it = m_samples.begin();
+            it != m_samples.end(); ++it)
+    {
+        const HostSamples           &hostSamples = it->second;
+        HostSamples::const_iterator  sIt;
+
+        for (sIt = hostSamples.lower_bound(begin); 
+                sIt != hostSamples.end() && sIt->first <= end; ++sIt)
+        {
+            for (SampleRows::const_iterator rIt = sIt->second.begin();
+                    rIt != sIt->second.end(); ++rIt)
+            {
+                byTime[sIt->first] << rIt->second;
+            }
+        }
+    }
+
+    for (S9sMap<time_t, S9sVariantList>::const_iterator it = byTime.begin();
+            it != byTime.end(); ++it)
+    {
+        for (uint idx = 0u; idx < it->second.size(); ++idx)
+            retval << it->second[idx];
+    }
+
+    return retval;
+}
+
+/**
+ * \returns The list of hosts as the controller sent it the last time.
+ */
+S9sVariantList
+S9sStatCache::hosts() const
+{
+    return m_hosts;
+}
+
+/**
+ * \returns How many samples the cache holds.
+ */
+int
+S9sStatCache::nSamples() const
+{
+    int retval = 0;
+
+    for (S9sMap<int, HostSamples>::const_iterator it = m_samples.begin();
+            it != m_samples.end(); ++it)
+    {
+        for (HostSamples::const_iterator sIt = it->second.begin();
+                sIt != it->second.end(); ++sIt)
+        {
+            retval += sIt->second.size();
+        }
+    }
+
+    return retval;
+}
+
+/**
+ * Removes the least recently used entries until the cache is not larger than
+ * the maximum size.
+ *
+ * \returns How many bytes the cache uses after the eviction.
+ */
+ulonglong
+S9sStatCache::evict()
+{
+    S9sMutexLocker  locker(sm_mutex);
+
+    return removeOldEntries();
+}
+
+S9sString
+S9sStatCache::errorString() const
+{
+    return m_errorString;
+}
+
+/**
+ * \returns The string that tells apart the samples of one host created at the
+ *   same time.
+ *
+ * The controller sends one sample for every CPU core, every partition and
+ * every network interface with the same creation time, the graphs select them
+ * by these fields. The statistics that have one sample per host get an empty
+ * key.
+ */
+S9sString
+S9sStatCache::sampleKey(
+        const S9sVariantMap &sample)
+{
+    static const char *fieldNames[] = 
+    {
+        "cpuid", "device", "mountpoint", "interface", NULL
+    };
+    S9sString retval;
+
+    for (int idx = 0; fieldNames[idx] != NULL; ++idx)
+    {
+        if (!sample.contains(fieldNames[idx]))
+            continue;
+
+        retval += fieldNames[idx];
+        retval += "=";
+        retval += sample.at(fieldNames[idx]).toString();
+        retval += ";";
+    }
+
+    return retval;
+}
+
+void
+S9sStatCache::clear()
+{
+    m_entryName.clear();
+    m_begin = 0;
+    m_end   = 0;
+    m_hosts.clear();
+    m_samples.clear();
+    m_changed.clear();
+}
+
+S9sString
+S9sStatCache::entryPath() const
+{
+    return S9sFile::buildPath(m_directory, m_entryName);
+}
+
+S9sString
+S9sStatCache::hostFileName(
+        const int hostId) const
+{
+    S9sString fileName;
+
+    fileName.sprintf("%d.samples", hostId);
+    return S9sFile::buildPath(entryPath(), fileName);
+}
+
+/**
+ * Loads the block of samples of one host.
+ */
+bool
+S9sStatCache::loadHost(
+        const int hostId)
+{
+    S9sString       path = hostFileName(hostId);
+    S9sString       content;
+    S9sVariantMap   block;
+    S9sVariantList  columns;
+    S9sVariantList  rows;
+    HostSamples    &hostSamples = m_samples[hostId];
+
+    if (!S9sFile(path).readTxtFile(content) || !block.parse(STR(content)))
+    {
+        m_errorString.sprintf("Failed to load '%s'.", STR(path));
+        return false;
+    }
+
+    columns = block["columns"].toVariantList();
+    rows    = block["rows"].toVariantList();
+
+    for (uint idx = 0u; idx < rows.size(); ++idx)
+    {
+        const S9sVariantList &row = rows[idx].toVariantList();
+        S9sVariantMap         sample;
+
+        sample["hostid"] = hostId;
+        for (uint column = 0u; 
+                column < columns.size() && column < row.size(); ++column)
+        {
+            if (row[column].isInvalid())
+                continue;
+
+            sample[columns[column].toString()] = row[column];
+        }
+
+        hostSamples[sample["created"].toTimeT()][sampleKey(sample)] = sample;
+    }
+
+    return true;
+}
+
+/**
+ * Writes a file of the cache in a temporary file and renames it, so the other
+ * processes never read a partially written file.
+ */
+bool
+S9sStatCache::writeFile(
+        const S9sString &path,
+        const S9sString &content)
+{
+    S9sString tmpPath;
+    S9sFile   file;
+
+    tmpPath.sprintf("%s.%d.tmp", STR(path), getpid());
+    file = S9sFile(tmpPath);
+
+    if (!file.writeTxtFile(content))
+    {
+        m_errorString = file.errorString();
+        unlink(STR(tmpPath));
+        return false;
+    }
+
+    if (rename(STR(tmpPath), STR(path)) != 0)
+    {
+        m_errorString.sprintf("Unable to rename '%s': %m", STR(tmpPath));
+        unlink(STR(tmpPath));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \returns The number of bytes the files of one entry are using.
+ */
+ulonglong
+S9sStatCache::entrySize(
+        const S9sString &path,
+        time_t          &lastUsed)
+{
+    S9sVariantList  files;
+    ulonglong       retval = 0ull;
+    struct stat     ss;
+
+    lastUsed = 0;
+    S9sFile::listFiles(path, files, true);
+
+    for (uint idx = 0u; idx < files.size(); ++idx)
+    {
+        S9sString fileName = files[idx].toString();
+
+        if (stat(STR(fileName), &ss) != 0)
+            continue;
+
+        retval += ss.st_size;
+        if (fileName.endsWith("/index"))
+            lastUsed = ss.st_mtime;
+    }
+
+    return retval;
+}
+
+void
+S9sStatCache::removeEntry(
+        const S9sString &path)
+{
+    S9sVariantList  files;
+
+    S9sFile::listFiles(path, files, true);
+    for (uint idx = 0u; idx < files.size(); ++idx)
+        unlink(STR(files[idx].toString()));
+
+    rmdir(STR(path));
+}
+
+/**
+ * Removes the entries that were used the longest time ago until the cache fits
+ * into the maximum size. The caller has to hold the lock.
+ */
+ulonglong
+S9sStatCache::removeOldEntries()
+{
+    S9sVariantList                  entries;
+    S9sMap<time_t, S9sVariantList>  byLastUsed;
+    S9sMap<S9sString, ulonglong>    sizes;
+    ulonglong                       total = 0ull;
+
+    S9sFile::listFiles(m_directory, entries, true, false, true);
+
+    for (uint idx = 0u; idx < entries.size(); ++idx)
+    {
+        S9sString path = entries[idx].toString();
+        time_t    lastUsed;
+
+        if (!S9sDir::exists(path))
+            continue;
+
+        sizes[path]   = entrySize(path, lastUsed);
+        total        += sizes[path];
+        byLastUsed[lastUsed] << path;
+    }
+
+    for (S9sMap<time_t, S9sVariantList>::iterator it = byLastUsed.begin();
+            it != byLastUsed.end() && total > m_maxSize; ++it)
+    {
+        for (uint idx = 0u; idx < it->second.size(); ++idx)
+        {
+            S9sString path = it->second[idx].toString();
+
+            if (total <= m_maxSize)
+                break;
+
+            S9S_DEBUG("Removing '%s'.", STR(path));
+            removeEntry(path);
+            total -= sizes[path];
+        }
+    }
+
+    return total;
+}
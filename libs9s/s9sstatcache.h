@@ -0,0 +1,126 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9smap.h"
+#include "s9svariantmap.h"
+#include "s9smutex.h"
+
+#include <time.h>
+
+/**
+ * A local, on-disk cache of the statistical samples the controller sends for
+ * the statByName requests. Every entry of the cache belongs to one controller,
+ * cluster and statistics name and it is stored in its own directory under
+ * ~/.s9s/stats: the "index" file holds the list of hosts and the time range
+ * the entry covers, the samples of every host are in a separate file. The
+ * samples are stored in blocks: the names of the fields are listed once as
+ * "columns" and every sample is one row of values.
+ *
+ * The cache covers one contiguous time range, so only the time before and
+ * after this range has to be requested from the controller. The last
+ * settleTime seconds are never considered covered, the samples that arrive
+ * late are requested again. One entry holds at most maxSpan seconds of
+ * samples and when the size of the cache exceeds the limit the entries that
+ * were not used for the longest time are removed.
+ */
+class S9sStatCache
+{
+    public:
+        S9sStatCache(
+                const S9sString &directory,
+                const ulonglong  maxSize);
+
+        virtual ~S9sStatCache();
+
+        static S9sString defaultDirectory();
+
+        static S9sString entryName(
+                const S9sString &controller,
+                const int        port,
+                const S9sString &cluster,
+                const S9sString &statName);
+
+        bool load(const S9sString &entryName);
+        bool save();
+
+        time_t begin() const;
+        time_t end() const;
+
+        void missingRanges(
+                const time_t        begin,
+                const time_t        end,
+                S9sVector<time_t>  &starts,
+                S9sVector<time_t>  &ends) const;
+
+        void merge(
+                const S9sVariantList &samples,
+                const S9sVariantList &hosts,
+                const time_t          begin,
+                const time_t          end,
+                const time_t          now);
+
+        S9sVariantList samples(
+                const time_t begin, 
+                const time_t end) const;
+
+        S9sVariantList hosts() const;
+        int nSamples() const;
+
+        ulonglong evict();
+        S9sString errorString() const;
+
+        static S9sString sampleKey(const S9sVariantMap &sample);
+
+        static const int settleTime;
+        static const int maxSpan;
+
+    private:
+        /** The rows of one host created at the same time by sampleKey(). */
+        typedef S9sMap<S9sString, S9sVariantMap> SampleRows;
+        /** The samples of one host by the creation time. */
+        typedef S9sMap<time_t, SampleRows> HostSamples;
+
+        void clear();
+        S9sString entryPath() const;
+        S9sString hostFileName(const int hostId) const;
+        bool loadHost(const int hostId);
+        bool writeFile(const S9sString &path, const S9sString &content);
+        static ulonglong entrySize(const S9sString &path, time_t &lastUsed);
+        static void removeEntry(const S9sString &path);
+        ulonglong removeOldEntries();
+
+    private:
+        S9sString                                  m_directory;
+        ulonglong                                  m_maxSize;
+        S9sString                                  m_entryName;
+        time_t                                     m_begin;
+        time_t                                     m_end;
+        S9sVariantList                             m_hosts;
+        /** The samples by host ID, creation time and sample key. */
+        S9sMap<int, HostSamples>                   m_samples;
+        /** The hosts that has new samples that are not saved yet. */
+        S9sMap<int, bool>                          m_changed;
+        S9sString                                  m_errorString;
+
+        static S9sMutex                            sm_mutex;
+};
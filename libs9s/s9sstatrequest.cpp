@@ -0,0 +1,136 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9sstatrequest.h"
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/**
+ * \param client The client to send the request with, the request uses a clone
+ *   of it, so it has its own connection.
+ * \param clusterId The cluster the statistics are requested for.
+ * \param statName The name of the statistics (e.g. "cpustat").
+ */
+S9sStatRequest::S9sStatRequest(
+        const S9sRpcClient &client, 
+        const int           clusterId,
+        const S9sString    &statName) :
+    m_client(client.clone()),
+    m_clusterId(clusterId),
+    m_statName(statName),
+    m_running(false),
+    m_success(false)
+{
+}
+
+S9sStatRequest::~S9sStatRequest()
+{
+    wait();
+}
+
+S9sString
+S9sStatRequest::statName() const
+{
+    return m_statName;
+}
+
+/**
+ * Starts sending the request on a new thread. If the thread can not be
+ * created the request is executed here.
+ */
+void
+S9sStatRequest::start()
+{
+    wait();
+
+    m_success = false;
+    m_running = pthread_create(
+            &m_thread, NULL, S9sStatRequest::entryPoint, this) == 0;
+
+    if (!m_running)
+    {
+        S9S_WARNING("Could not start a thread, sending the request here.");
+        execute();
+    }
+}
+
+/**
+ * Waits until the request finishes.
+ *
+ * \returns True if the request was sent and a reply was received.
+ */
+bool
+S9sStatRequest::wait()
+{
+    if (m_running)
+    {
+        pthread_join(m_thread, NULL);
+        m_running = false;
+    }
+
+    return m_success;
+}
+
+/**
+ * Sets the exit status of the program from the reply, should be called from
+ * the main thread after wait().
+ */
+void
+S9sStatRequest::setExitStatus()
+{
+    m_client.setExitStatus();
+}
+
+S9sRpcReply &
+S9sStatRequest::reply()
+{
+    return m_reply;
+}
+
+/**
+ * \returns The error message if the request could not be sent or the reply
+ *   is an error reply.
+ */
+S9sString
+S9sStatRequest::errorString() const
+{
+    if (!m_success)
+        return m_client.errorString();
+
+    return m_reply.errorString();
+}
+
+void *
+S9sStatRequest::entryPoint(
+        void *pointer)
+{
+    S9sStatRequest *request = (S9sStatRequest *) pointer;
+
+    request->execute();
+    return NULL;
+}
+
+void
+S9sStatRequest::execute()
+{
+    m_success = m_client.getStats(m_clusterId, m_statName, true);
+    m_reply   = m_client.reply();
+}
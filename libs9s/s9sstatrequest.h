@@ -0,0 +1,64 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9srpcclient.h"
+#include "s9srpcreply.h"
+#include "s9sstring.h"
+
+#include <pthread.h>
+
+/**
+ * One statByName request sent to the controller on its own thread with its
+ * own connection, so the statistics needed by several graphs can be fetched
+ * at the same time.
+ */
+class S9sStatRequest
+{
+    public:
+        S9sStatRequest(
+                const S9sRpcClient &client, 
+                const int           clusterId,
+                const S9sString    &statName);
+
+        virtual ~S9sStatRequest();
+
+        S9sString statName() const;
+
+        void start();
+        bool wait();
+        void setExitStatus();
+
+        S9sRpcReply &reply();
+        S9sString errorString() const;
+
+    private:
+        static void *entryPoint(void *pointer);
+        void execute();
+
+    private:
+        S9sRpcClient      m_client;
+        int               m_clusterId;
+        S9sString         m_statName;
+        pthread_t         m_thread;
+        bool              m_running;
+        bool              m_success;
+        S9sRpcReply       m_reply;
+};
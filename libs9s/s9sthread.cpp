@@ -10,6 +10,12 @@
 #include "s9sdebug.h"
 
 
+S9sThread::S9sThread() :
+    m_state(Created),
+    m_retval(0)
+{
+}
+
 /**
  * \returns true if the thread was successfully started, false on an error
  *
@@ -19,15 +25,32 @@ bool
 S9sThread::start()
 {
     S9S_DEBUG("");
+    m_state = Running;
     if (pthread_create(&m_thread, NULL, S9sThread::threadEntryPoint, this))
     {
         S9S_WARNING("pthread_create() failed: %m");
+        m_state = Created;
         return false;
     }
 
     return true;
 }
 
+/**
+ * Asks the thread to stop and waits until it ends. The exec() should check
+ * shouldStop() from time to time.
+ */
+void
+S9sThread::stop()
+{
+    if (m_state == Created || m_state == Stopped)
+        return;
+
+    m_state = Stopping;
+    pthread_join(m_thread, NULL);
+    m_state = Stopped;
+}
+
 int
 S9sThread::exec()
 {
@@ -52,7 +75,6 @@ S9sThread::shouldStop() const
 void
 S9sThread::run()
 {
-    m_state = Running;
     m_retval = exec();
     m_state = Stopping;
 }
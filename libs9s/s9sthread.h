@@ -8,7 +8,10 @@
 class S9sThread
 {
     public:
+        S9sThread();
+
         bool start();
+        void stop();
 
     protected:
         enum State 
@@ -0,0 +1,460 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9stopfleet.h"
+
+#include "s9svariantmap.h"
+#include "s9srpcreply.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+/*
+ * A cluster is also considered busy if its CPU usage changed this much (in
+ * percentage points) since the previous poll.
+ */
+#define CPU_CHANGE_THRESHOLD 10.0
+
+/**
+ * Orders the clusters of the fleet by CPU or memory usage (higher first) or
+ * by their IDs. Clusters that are equal by the key are ordered by the ID.
+ */
+class S9sTopFleetCompare
+{
+    public:
+        S9sTopFleetCompare(
+                const S9sTopFleet              &fleet,
+                const S9sProcessTable::SortKey  key) :
+            m_fleet(fleet),
+            m_key(key)
+        {
+        }
+
+        bool operator()(const int a, const int b) const
+        {
+            const S9sTopFleetCluster &clusterA = m_fleet.cluster(a);
+            const S9sTopFleetCluster &clusterB = m_fleet.cluster(b);
+
+            switch (m_key)
+            {
+                case S9sProcessTable::SortByPid:
+                    break;
+
+                case S9sProcessTable::SortByCpu:
+                    if (clusterA.m_cpuUsage != clusterB.m_cpuUsage)
+                        return clusterA.m_cpuUsage > clusterB.m_cpuUsage;
+
+                    break;
+
+                case S9sProcessTable::SortByMemory:
+                    if (clusterA.m_memUsed != clusterB.m_memUsed)
+                        return clusterA.m_memUsed > clusterB.m_memUsed;
+
+                    break;
+            }
+
+            return a < b;
+        }
+
+    private:
+        const S9sTopFleet              &m_fleet;
+        const S9sProcessTable::SortKey  m_key;
+};
+
+/**
+ * Orders the cluster IDs by the time they should be polled.
+ */
+class S9sTopFleetDueCompare
+{
+    public:
+        S9sTopFleetDueCompare(
+                const S9sTopFleet &fleet) :
+            m_fleet(fleet)
+        {
+        }
+
+        bool operator()(const int a, const int b) const
+        {
+            longlong nextA = m_fleet.cluster(a).m_nextPoll;
+            longlong nextB = m_fleet.cluster(b).m_nextPoll;
+
+            if (nextA != nextB)
+                return nextA < nextB;
+
+            return a < b;
+        }
+
+    private:
+        const S9sTopFleet &m_fleet;
+};
+
+S9sTopFleetCluster::S9sTopFleetCluster() :
+    m_clusterId(0),
+    m_nHosts(0),
+    m_nCores(0),
+    m_cpuUsage(-1.0),
+    m_memTotal(0ull),
+    m_memUsed(0ull),
+    m_nextPoll(0ll),
+    m_lastUpdate(0ll),
+    m_nPolls(0),
+    m_nFailures(0)
+{
+}
+
+S9sTopFleet::S9sTopFleet() :
+    m_minInterval(10000),
+    m_maxInterval(80000),
+    m_jitterPercent(20),
+    m_busyThreshold(50.0)
+{
+}
+
+S9sTopFleet::~S9sTopFleet()
+{
+}
+
+/**
+ * \param minInterval The shortest delay between two polls of a cluster in
+ *   milliseconds, this is how often the busy clusters are polled.
+ * \param maxInterval The longest delay in milliseconds, the idle clusters are
+ *   polled less and less often until this limit is reached.
+ */
+void
+S9sTopFleet::setIntervals(
+        const int minInterval,
+        const int maxInterval)
+{
+    S9sMap<int, S9sTopFleetCluster>::iterator it;
+
+    m_minInterval = minInterval;
+    m_maxInterval = maxInterval;
+
+    for (it = m_clusters.begin(); it != m_clusters.end(); ++it)
+        it->second.m_scheduler.setLimits(m_minInterval, m_maxInterval);
+}
+
+void
+S9sTopFleet::setJitter(
+        const int jitterPercent)
+{
+    S9sMap<int, S9sTopFleetCluster>::iterator it;
+
+    m_jitterPercent = jitterPercent;
+
+    for (it = m_clusters.begin(); it != m_clusters.end(); ++it)
+        it->second.m_scheduler.setJitter(m_jitterPercent);
+}
+
+/**
+ * \param percent The CPU usage above which a cluster is considered busy.
+ */
+void
+S9sTopFleet::setBusyThreshold(
+        const double percent)
+{
+    m_busyThreshold = percent;
+}
+
+/**
+ * \param clusterList The "clusters" of the getAllClusterInfo reply.
+ * \param now The current time.
+ *
+ * Updates the list of the clusters in the fleet. The clusters that are new
+ * will be polled as soon as possible, the clusters that are not in the list
+ * any more are removed together with their processes.
+ */
+void
+S9sTopFleet::setClusters(
+        const S9sVariantList &clusterList,
+        const longlong        now)
+{
+    S9sMap<int, S9sTopFleetCluster>  clusters;
+
+    for (uint idx = 0u; idx < clusterList.size(); ++idx)
+    {
+        const S9sVariantMap &clusterMap = clusterList[idx].toVariantMap();
+        int                  clusterId;
+
+        clusterId = clusterMap.valueByPath("cluster_id").toInt();
+        if (clusterId <= 0)
+            continue;
+
+        if (m_clusters.contains(clusterId))
+        {
+            std::swap(clusters[clusterId], m_clusters[clusterId]);
+        } else {
+            S9sTopFleetCluster &cluster = clusters[clusterId];
+
+            cluster.m_clusterId = clusterId;
+            cluster.m_scheduler = S9sPollScheduler(
+                    m_minInterval, m_maxInterval, m_jitterPercent);
+            cluster.m_nextPoll  = now;
+        }
+        
+        clusters[clusterId].m_clusterName = 
+            clusterMap.valueByPath("cluster_name").toString();
+
+        clusters[clusterId].m_state = 
+            clusterMap.valueByPath("state").toString();
+    }
+
+    m_clusters.swap(clusters);
+}
+
+uint
+S9sTopFleet::nClusters() const
+{
+    return m_clusters.size();
+}
+
+/**
+ * \returns The number of hosts the processes were received from.
+ */
+uint
+S9sTopFleet::nHosts() const
+{
+    S9sMap<int, S9sTopFleetCluster>::const_iterator it;
+    uint retval = 0u;
+
+    for (it = m_clusters.begin(); it != m_clusters.end(); ++it)
+        retval += it->second.m_processes.nHosts();
+
+    return retval;
+}
+
+uint
+S9sTopFleet::nProcesses() const
+{
+    S9sMap<int, S9sTopFleetCluster>::const_iterator it;
+    uint retval = 0u;
+
+    for (it = m_clusters.begin(); it != m_clusters.end(); ++it)
+        retval += it->second.m_processes.size();
+
+    return retval;
+}
+
+bool
+S9sTopFleet::hasCluster(
+        const int clusterId) const
+{
+    return m_clusters.contains(clusterId);
+}
+
+/**
+ * \returns The cluster with the given ID, the cluster must be in the fleet
+ *   (see hasCluster()).
+ */
+const S9sTopFleetCluster &
+S9sTopFleet::cluster(
+        const int clusterId) const
+{
+    return m_clusters.find(clusterId)->second;
+}
+
+/**
+ * \param now The current time.
+ * \returns The IDs of the clusters that should be polled now, the one that is
+ *   waiting for the longest time first.
+ */
+S9sVector<int> 
+S9sTopFleet::dueClusters(
+        const longlong now) const
+{
+    S9sMap<int, S9sTopFleetCluster>::const_iterator it;
+    S9sVector<int> retval;
+
+    for (it = m_clusters.begin(); it != m_clusters.end(); ++it)
+    {
+        if (it->second.m_nextPoll <= now)
+            retval << it->first;
+    }
+
+    std::sort(retval.begin(), retval.end(), S9sTopFleetDueCompare(*this));
+    return retval;
+}
+
+/**
+ * \param clusterId The cluster that was polled.
+ * \param cpuStats The "data" of the CPU statistics reply.
+ * \param memoryStats The "data" of the memory statistics reply.
+ * \param processes The processes of the cluster, the table is swapped in, the
+ *   previous processes of the cluster are returned in it.
+ * \param now The current time.
+ *
+ * Stores the data received for one cluster and schedules the next poll of the
+ * cluster. The clusters that are busy (or the load of which changed a lot)
+ * are polled again soon, the idle clusters are polled less and less often.
+ */
+void
+S9sTopFleet::update(
+        const int             clusterId,
+        const S9sVariantList &cpuStats,
+        const S9sVariantList &memoryStats,
+        S9sProcessTable      &processes,
+        const longlong        now)
+{
+    S9sVariantMap        samples;
+    S9sMap<int, bool>    hostIds;
+    double               previousCpuUsage;
+    double               idle = 0.0;
+    bool                 busy;
+
+    if (!m_clusters.contains(clusterId))
+        return;
+
+    S9sTopFleetCluster &cluster = m_clusters[clusterId];
+
+    previousCpuUsage = cluster.m_cpuUsage;
+
+    /*
+     * The CPU usage is the average of the cores.
+     */
+    samples = S9sRpcReply::newestSamples(cpuStats);
+    for (S9sVariantMap::const_iterator it = samples.begin(); 
+            it != samples.end(); ++it)
+    {
+        const S9sVariantMap &sample = it->second.toVariantMap();
+
+        idle += sample.valueByPath("idle").toDouble();
+        hostIds[sample.valueByPath("hostid").toInt()] = true;
+    }
+
+    cluster.m_nCores   = samples.size();
+    cluster.m_nHosts   = hostIds.empty() ? 
+        processes.nHosts() : hostIds.size();
+    cluster.m_cpuUsage = samples.empty() ? 
+        -1.0 : 100.0 * (1.0 - idle / samples.size());
+
+    /*
+     * The memory is the sum of the hosts.
+     */
+    cluster.m_memTotal = 0ull;
+    cluster.m_memUsed  = 0ull;
+
+    samples = S9sRpcReply::newestSamples(memoryStats);
+    for (S9sVariantMap::const_iterator it = samples.begin(); 
+            it != samples.end(); ++it)
+    {
+        const S9sVariantMap &sample = it->second.toVariantMap();
+        ulonglong  total   = sample.valueByPath("ramtotal").toULongLong();
+        ulonglong  free    = sample.valueByPath("ramfree").toULongLong();
+        ulonglong  buffers = sample.valueByPath("rambuffers").toULongLong();
+        ulonglong  cached  = sample.valueByPath("ramcached").toULongLong();
+
+        cluster.m_memTotal += total;
+        if (total > free + buffers + cached)
+            cluster.m_memUsed += total - (free + buffers + cached);
+    }
+
+    cluster.m_processes.swap(processes);
+
+    busy = isBusy(cluster, previousCpuUsage);
+    cluster.m_nextPoll   = now + cluster.m_scheduler.nextDelay(busy);
+    cluster.m_lastUpdate = now;
+    cluster.m_nPolls++;
+
+    S9S_DEBUG("cluster %d cpu %g busy %s next poll in %lld ms", 
+            clusterId, cluster.m_cpuUsage, busy ? "true" : "false",
+            cluster.m_nextPoll - now);
+}
+
+/**
+ * \param clusterId The cluster that could not be polled.
+ * \param now The current time.
+ *
+ * The data of the cluster is kept, the next poll is delayed the same way as
+ * if the cluster was idle.
+ */
+void
+S9sTopFleet::failed(
+        const int      clusterId,
+        const longlong now)
+{
+    if (!m_clusters.contains(clusterId))
+        return;
+
+    S9sTopFleetCluster &cluster = m_clusters[clusterId];
+
+    cluster.m_nextPoll = now + cluster.m_scheduler.nextDelay(false);
+    cluster.m_nFailures++;
+}
+
+/**
+ * \param table The table that will hold the processes of all the clusters.
+ */
+void
+S9sTopFleet::merge(
+        S9sProcessTable &table) const
+{
+    S9sMap<int, S9sTopFleetCluster>::const_iterator it;
+
+    table.clear();
+
+    for (it = m_clusters.begin(); it != m_clusters.end(); ++it)
+        table.append(it->second.m_processes);
+}
+
+/**
+ * \param key By what the clusters should be ordered, SortByPid orders them by
+ *   their IDs.
+ * \returns The IDs of the clusters in the requested order.
+ */
+S9sVector<int> 
+S9sTopFleet::rankedClusters(
+        const S9sProcessTable::SortKey key) const
+{
+    S9sVector<int> retval = m_clusters.keys();
+
+    std::sort(retval.begin(), retval.end(), S9sTopFleetCompare(*this, key));
+    return retval;
+}
+
+/**
+ * \returns The time of the monotonic clock in milliseconds.
+ */
+longlong
+S9sTopFleet::currentMillis()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (longlong) now.tv_sec * 1000ll + now.tv_nsec / 1000000;
+}
+
+bool
+S9sTopFleet::isBusy(
+        const S9sTopFleetCluster &cluster,
+        const double              previousCpuUsage) const
+{
+    if (cluster.m_cpuUsage < 0.0)
+        return false;
+
+    if (cluster.m_cpuUsage >= m_busyThreshold)
+        return true;
+
+    return previousCpuUsage >= 0.0 && 
+        fabs(cluster.m_cpuUsage - previousCpuUsage) >= CPU_CHANGE_THRESHOLD;
+}
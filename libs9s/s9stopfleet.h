@@ -0,0 +1,115 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9sstring.h"
+#include "s9svector.h"
+#include "s9smap.h"
+#include "s9svariantlist.h"
+#include "s9sprocesstable.h"
+#include "s9spollscheduler.h"
+#include "s9sglobal.h"
+
+/**
+ * What s9s top knows about one cluster when it shows the whole fleet: the
+ * aggregated CPU and memory statistics, the running processes and when the
+ * cluster should be polled again.
+ */
+class S9sTopFleetCluster
+{
+    public:
+        S9sTopFleetCluster();
+
+    public:
+        int                m_clusterId;
+        S9sString          m_clusterName;
+        S9sString          m_state;
+
+        /** The number of hosts and cores in the CPU statistics. */
+        int                m_nHosts;
+        int                m_nCores;
+        /** The average CPU usage of the cores in percent, -1 if not known. */
+        double             m_cpuUsage;
+        ulonglong          m_memTotal;
+        ulonglong          m_memUsed;
+        S9sProcessTable    m_processes;
+
+        S9sPollScheduler   m_scheduler;
+        /** When to poll the cluster next, the clock of currentMillis(). */
+        longlong           m_nextPoll;
+        /** When the data was last received, 0 if never. */
+        longlong           m_lastUpdate;
+        int                m_nPolls;
+        int                m_nFailures;
+};
+
+/**
+ * The state of the fleet view of s9s top. The class decides which clusters
+ * should be polled (busy clusters more often than the idle ones), aggregates
+ * the statistics received for the clusters and merges the processes of all
+ * the clusters into one table. The class does not communicate with the
+ * controller, the times are passed as milliseconds of currentMillis().
+ */
+class S9sTopFleet
+{
+    public:
+        S9sTopFleet();
+        virtual ~S9sTopFleet();
+
+        void setIntervals(const int minInterval, const int maxInterval);
+        void setJitter(const int jitterPercent);
+        void setBusyThreshold(const double percent);
+
+        void setClusters(const S9sVariantList &clusterList, const longlong now);
+
+        uint nClusters() const;
+        uint nHosts() const;
+        uint nProcesses() const;
+        bool hasCluster(const int clusterId) const;
+        const S9sTopFleetCluster &cluster(const int clusterId) const;
+
+        S9sVector<int> dueClusters(const longlong now) const;
+
+        void update(
+                const int             clusterId,
+                const S9sVariantList &cpuStats,
+                const S9sVariantList &memoryStats,
+                S9sProcessTable      &processes,
+                const longlong        now);
+
+        void failed(const int clusterId, const longlong now);
+
+        void merge(S9sProcessTable &table) const;
+
+        S9sVector<int> rankedClusters(const S9sProcessTable::SortKey key) const;
+
+        static longlong currentMillis();
+
+    private:
+        bool isBusy(const S9sTopFleetCluster &cluster, 
+                const double previousCpuUsage) const;
+
+    private:
+        S9sMap<int, S9sTopFleetCluster>  m_clusters;
+        int                              m_minInterval;
+        int                              m_maxInterval;
+        int                              m_jitterPercent;
+        double                           m_busyThreshold;
+};
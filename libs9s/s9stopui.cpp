@@ -26,6 +26,7 @@
 #include "s9ssqlprocess.h"
 
 #include <cstdio>
+#include <algorithm>
 #include <unistd.h>
 #include <cstring>
 #include <ctime>
@@ -34,26 +35,78 @@
 #define WARNING
 #include "s9sdebug.h"
         
+/*
+ * How many clusters are polled at the same time in the fleet view.
+ */
+#define FLEET_CONCURRENCY 4
+
 struct termios orig_termios;
 
+/**
+ * \returns The milliseconds passed since the given time of the monotonic
+ *   clock.
+ */
+static int
+millisecondsSince(
+        const struct timespec &start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - start.tv_sec) * 1000 + 
+        (now.tv_nsec - start.tv_nsec) / 1000000;
+}
+
 S9sTopUi::S9sTopUi(
         S9sRpcClient       &client,
         S9sTopUi::ViewMode  viewMode) :
     S9sDisplay(true),
     m_viewMode(viewMode),
     m_client(client),
+    m_clientsAuthenticated(false),
     m_nReplies(0),
+    m_clusterRequest(S9sTopUiRequest::GetCluster),
+    m_cpuStatsRequest(S9sTopUiRequest::GetCpuStats),
+    m_memoryStatsRequest(S9sTopUiRequest::GetMemoryStats),
+    m_processRequest(S9sTopUiRequest::GetRunningProcesses),
     m_clustersReplyReceived(0),
+    m_clusterMillis(0),
+    m_statsMillis(0),
+    m_processMillis(0),
+    m_decodeMillis(0),
+    m_refreshMillis(0),
+    m_visibleRowsValid(false),
+    m_visibleRowsOrder(CpuUsage),
+    m_visibleRowsLimit(0),
     m_clusterId(0),
+    m_fleetNPolled(0u),
     m_sortOrder(CpuUsage),
     m_communicating(false),
     m_viewDebug(false),
     m_reloadRequested(false)
 {
+    setClients();
+
+    /*
+     * Without a cluster we show the processes of all the clusters.
+     */
+    if (m_viewMode == OsProcesses)
+    {
+        S9sOptions *options = S9sOptions::instance();
+
+        if (!S9S_CLUSTER_ID_IS_VALID(options->clusterId()) && 
+                !options->hasClusterNameOption())
+        {
+            m_viewMode = FleetProcesses;
+        }
+    }
 }
 
 S9sTopUi::~S9sTopUi()
 {
+    for (uint idx = 0u; idx < m_fleetWorkers.size(); ++idx)
+        delete m_fleetWorkers[idx];
 }
 
 /**
@@ -163,39 +216,46 @@ S9sTopUi::printHeader()
     S9sDateTime dt = S9sDateTime::currentDateTime();
     S9sString   title;
 
-    if (!m_clusterName.empty())
+    if (m_viewMode == FleetProcesses)
+    {
+        title = "fleet (s9s top)";
+        s9s_printf("%s%s%s", "\033]0;", STR(title), "\007");
+    } else if (!m_clusterName.empty())
     {
         title.sprintf("%s (s9s top)", STR(m_clusterName));
-        printf("%s%s%s", "\033]0;", STR(title), "\007");
+        s9s_printf("%s%s%s", "\033]0;", STR(title), "\007");
     }
 
     title = "S9S TOP";
-    ::printf("%s%s%s ", TERM_SCREEN_TITLE_BOLD, STR(title), TERM_SCREEN_TITLE);
-    ::printf("%c ", rotatingCharacter());
-    ::printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
+    s9s_printf("%s%s%s ", TERM_SCREEN_TITLE_BOLD, STR(title), TERM_SCREEN_TITLE);
+    s9s_printf("%c ", rotatingCharacter());
+    s9s_printf("%s ", STR(dt.toString(S9sDateTime::LongTimeFormat)));
 
     // Printing the network activity character.
     if (m_communicating || m_reloadRequested)
-        ::printf("❌ ");
+        s9s_printf("❌ ");
     else
-        ::printf("⟳ ");
+        s9s_printf("⟳ ");
 
-    if (m_nReplies > 0)
+    if (m_nReplies > 0 && m_viewMode == FleetProcesses)
+    {
+        s9s_printf("Fleet - %u clusters ", m_fleet.nClusters());
+    } else if (m_nReplies > 0)
     {
-        ::printf("%s - ", STR(m_clusterName));
-        ::printf("%s ", STR(m_clustersReply.clusterStatusText(m_clusterId)));
+        s9s_printf("%s - ", STR(m_clusterName));
+        s9s_printf("%s ", STR(m_clustersReply.clusterStatusText(m_clusterId)));
 
     } else {
-        ::printf("            ");
+        s9s_printf("            ");
     }
    
     // If we are in debug mode we print a few internals that help us in
     // development.
     if (m_viewDebug)
     {
-        ::printf("0x%02x ",      lastKeyCode());
-        ::printf("%02dx%02d ",   width(), height());
-        ::printf("%02d:%03d,%03d ", m_lastButton, m_lastX, m_lastY);
+        s9s_printf("0x%02x ",      lastKeyCode());
+        s9s_printf("%02dx%02d ",   width(), height());
+        s9s_printf("%02d:%03d,%03d ", m_lastButton, m_lastX, m_lastY);
     }
         
     printNewLine();
@@ -221,10 +281,131 @@ S9sTopUi::printHeader()
             case SqlProcesses:
                 printSqlProcesses(height() - 6);
                 break;
+
+            case FleetProcesses:
+                {
+                    int nLines;
+
+                    s9s_printf("%u clusters, %u hosts, %u processes", 
+                            m_fleet.nClusters(), m_fleet.nHosts(),
+                            m_fleet.nProcesses());
+                    printNewLine();
+
+                    nLines = printFleetClusters((height() - 4) / 3);
+                    printProcesses(height() - 4 - nLines);
+                }
+                break;
         }
     }
 }
 
+/**
+ * \param maxLines How many lines we are allowed to print.
+ * \returns How many lines were printed.
+ *
+ * Prints the aggregated statistics of the clusters in the fleet view, the
+ * clusters are ordered the same way as the processes.
+ */
+int
+S9sTopUi::printFleetClusters(
+        int maxLines)
+{
+    S9sVector<int>  clusterIds = m_fleet.rankedClusters(sortKey());
+    longlong        now        = S9sTopFleet::currentMillis();
+    S9sFormat       idFormat;
+    S9sFormat       nameFormat(clusterColorBegin(), clusterColorEnd());
+    S9sFormat       stateFormat;
+    S9sFormat       hostsFormat;
+    S9sFormat       cpuFormat;
+    S9sFormat       memUsedFormat;
+    S9sFormat       memTotalFormat;
+    S9sFormat       processesFormat;
+    S9sFormat       ageFormat;
+    int             nLines = 0;
+
+    if (maxLines < 2 || clusterIds.empty())
+        return 0;
+
+    if ((int) clusterIds.size() > maxLines - 1)
+        clusterIds.resize(maxLines - 1);
+
+    idFormat.widen("CID");
+    nameFormat.widen("NAME");
+    stateFormat.widen("STATE");
+    hostsFormat.widen("HOSTS");
+    cpuFormat.widen("%CPU");
+    memUsedFormat.widen("USED");
+    memTotalFormat.widen("TOTAL");
+    processesFormat.widen("PROCS");
+    ageFormat.widen("AGE");
+
+    hostsFormat.setRightJustify();
+    cpuFormat.setRightJustify();
+    memUsedFormat.setRightJustify();
+    memTotalFormat.setRightJustify();
+    processesFormat.setRightJustify();
+    ageFormat.setRightJustify();
+
+    for (uint idx = 0u; idx < clusterIds.size(); ++idx)
+    {
+        const S9sTopFleetCluster &cluster = m_fleet.cluster(clusterIds[idx]);
+
+        idFormat.widen(cluster.m_clusterId);
+        nameFormat.widen(cluster.m_clusterName);
+        stateFormat.widen(cluster.m_state);
+        hostsFormat.widen(cluster.m_nHosts);
+        processesFormat.widen((int) cluster.m_processes.size());
+    }
+
+    s9s_printf("%s", TERM_SCREEN_HEADER);
+    idFormat.printf("CID", false);
+    nameFormat.printf("NAME", false);
+    stateFormat.printf("STATE", false);
+    hostsFormat.printf("HOSTS", false);
+    cpuFormat.printf("%CPU", false);
+    memUsedFormat.printf("USED", false);
+    memTotalFormat.printf("TOTAL", false);
+    processesFormat.printf("PROCS", false);
+    ageFormat.printf("AGE", false);
+    printNewLine();
+    ++nLines;
+
+    for (uint idx = 0u; idx < clusterIds.size(); ++idx)
+    {
+        const S9sTopFleetCluster &cluster = m_fleet.cluster(clusterIds[idx]);
+        S9sString                 memUsed;
+        S9sString                 memTotal;
+        S9sString                 age;
+
+        memUsed.sprintf("%.1fG", cluster.m_memUsed / 1073741824.0);
+        memTotal.sprintf("%.1fG", cluster.m_memTotal / 1073741824.0);
+
+        if (cluster.m_lastUpdate > 0ll)
+            age.sprintf("%llds", (now - cluster.m_lastUpdate) / 1000ll);
+        else
+            age = "-";
+
+        idFormat.printf(cluster.m_clusterId);
+        nameFormat.printf(cluster.m_clusterName);
+        stateFormat.printf(cluster.m_state);
+        hostsFormat.printf(cluster.m_nHosts);
+
+        if (cluster.m_cpuUsage >= 0.0)
+            cpuFormat.printf(percentString(cluster.m_cpuUsage));
+        else
+            cpuFormat.printf("-");
+
+        memUsedFormat.printf(memUsed);
+        memTotalFormat.printf(memTotal);
+        processesFormat.printf((int) cluster.m_processes.size());
+        ageFormat.printf(age);
+        printNewLine();
+        ++nLines;
+    }
+
+    return nLines;
+}
+
 /**
  * \param maxLines How many lines we are allowed to print.
  *
@@ -234,7 +415,6 @@ void
 S9sTopUi::printSqlProcesses(
         int maxLines)
 {
-    S9sOptions     *options = S9sOptions::instance();
     S9sFormat       pidFormat;
     S9sFormat       commandFormat;
     S9sFormat       timeFormat;
@@ -243,41 +423,18 @@ S9sTopUi::printSqlProcesses(
     S9sFormat       instanceFormat;
     int             nLines;
 
-    sort(m_sqlProcesses.begin(), m_sqlProcesses.end(), 
-            S9sSqlProcess::compareSqlProcess);
-
-    nLines = 0;
-    for (uint idx = 0u; idx < m_sqlProcesses.size(); ++idx)
-    {
-        S9sSqlProcess &process = m_sqlProcesses[idx];
-        int            pid = process.pid();
-        S9sString      command = process.command();
-        int            time = process.time();
-        S9sString      user = process.userName();
-        S9sString      query = process.query("");
-        S9sString      hostName = process.hostName();
-        S9sString      instance = process.instance();
-        
-        if (!options->isStringMatchExtraArguments(query))
-            continue;
-
-        if (!options->isStringMatchToServerOption(instance))
-            continue;
-
-        if (!options->isStringMatchToClientOption(hostName))
-            continue;
+    updateVisibleRows(maxLines);
 
-        pidFormat.widen(pid);
-        userFormat.widen(user);
-        hostNameFormat.widen(hostName);
-        instanceFormat.widen(instance);
-        commandFormat.widen(command);
-        timeFormat.widen(time);
-
-        if (maxLines > 0 && nLines + 1 >= maxLines)
-            break;
-
-        ++nLines;
+    for (uint idx = 0u; idx < m_visibleRows.size(); ++idx)
+    {
+        const S9sSqlProcess &process = m_sqlProcesses[m_visibleRows[idx]];
+
+        pidFormat.widen(process.pid());
+        userFormat.widen(process.userName());
+        hostNameFormat.widen(process.hostName());
+        instanceFormat.widen(process.instance());
+        commandFormat.widen(process.command());
+        timeFormat.widen(process.time());
     }
 
     // Better to use a wider column than flickering.
@@ -287,59 +444,40 @@ S9sTopUi::printSqlProcesses(
     hostNameFormat.widen("192.168.00.91:37950");
 
     nLines = 0;
-    for (uint idx = 0u; idx < m_sqlProcesses.size(); ++idx)
-    {
-        S9sSqlProcess &process = m_sqlProcesses[idx];
-        int            pid = process.pid();
-        S9sString      user = process.userName();
-        S9sString      query = process.query("");
-        S9sString      hostName = process.hostName();
-        S9sString      instance = process.instance();
-        S9sString      command = process.command();
-        int            time = process.time();
-
-        if (!options->isStringMatchExtraArguments(query))
-            continue;
-        
-        if (!options->isStringMatchToServerOption(instance))
-            continue;
-
-        if (!options->isStringMatchToClientOption(hostName))
-            continue;
+    for (uint idx = 0u; idx < m_visibleRows.size(); ++idx)
+    {
+        const S9sSqlProcess &process = m_sqlProcesses[m_visibleRows[idx]];
+        S9sString            query = process.query("");
 
         query.replace("(\n", "(");
         query.replace("\n ", " ");
         query.replace("\n", "\\n");
 
-        pidFormat.printf(pid);
-        commandFormat.printf(command);
-        timeFormat.printf(time);
+        pidFormat.printf(process.pid());
+        commandFormat.printf(process.command());
+        timeFormat.printf(process.time());
 
-        ::printf("%s", XTERM_COLOR_ORANGE);
-        userFormat.printf(user);
-        ::printf("%s", TERM_NORMAL);
+        s9s_printf("%s", XTERM_COLOR_ORANGE);
+        userFormat.printf(process.userName());
+        s9s_printf("%s", TERM_NORMAL);
 
 
-        ::printf("%s", XTERM_COLOR_GREEN);
-        hostNameFormat.printf(hostName);
-        ::printf("%s", TERM_NORMAL);
+        s9s_printf("%s", XTERM_COLOR_GREEN);
+        hostNameFormat.printf(process.hostName());
+        s9s_printf("%s", TERM_NORMAL);
 
-        instanceFormat.printf(instance);
+        instanceFormat.printf(process.instance());
 
         if (!query.empty())
         {
-            ::printf("%s",  XTERM_COLOR_SQL);
-            ::printf("%s ", STR(query));
-            ::printf("%s",  TERM_NORMAL);
+            s9s_printf("%s",  XTERM_COLOR_SQL);
+            s9s_printf("%s ", STR(query));
+            s9s_printf("%s",  TERM_NORMAL);
         } else {
-            ::printf("- ");
+            s9s_printf("- ");
         }
 
         printNewLine();
-        
-        if (maxLines > 0 && nLines + 1 >= maxLines)
-            break;
-
         ++nLines;
     }
    
@@ -348,34 +486,123 @@ S9sTopUi::printSqlProcesses(
 
 }
 
-static bool 
-compareProcessPid(
-        const S9sProcess &a,
-        const S9sProcess &b)
+/**
+ * Orders the SQL processes by the instance and the PID using the keys that
+ * are extracted from the processes when they are received.
+ */
+class S9sSqlProcessCompare
 {
-    return a.pid() < b.pid();
-}
+    public:
+        S9sSqlProcessCompare(
+                const S9sVector<S9sString> &instances,
+                const S9sVector<int>       &pids) :
+            m_instances(instances),
+            m_pids(pids)
+        {
+        }
 
-static bool 
-compareProcessCpu(
-        const S9sProcess &a,
-        const S9sProcess &b)
+        bool operator()(const uint a, const uint b) const
+        {
+            int result = m_instances[a].compare(m_instances[b]);
+
+            if (result != 0)
+                return result < 0;
+
+            return m_pids[a] < m_pids[b];
+        }
+
+    private:
+        const S9sVector<S9sString> &m_instances;
+        const S9sVector<int>       &m_pids;
+};
+
+/**
+ * \param maxLines How many processes fit on the screen, 0 if there is no
+ *   limit.
+ *
+ * Finds the processes that are shown on the screen and puts them in order.
+ * Only the visible processes are sorted, and the result is kept until new
+ * data arrives, the sort order or the size of the screen changes, so most of
+ * the redraws do not sort at all. Should be called with the mutex locked.
+ */
+void
+S9sTopUi::updateVisibleRows(
+        int maxLines)
 {
-    if (a.cpuUsage() == b.cpuUsage())
-        return a.pid() > b.pid();
+    S9sOptions *options = S9sOptions::instance();
+    uint        limit   = maxLines > 0 ? (uint) maxLines : 0u;
+
+    if (m_visibleRowsValid && m_visibleRowsOrder == m_sortOrder &&
+            m_visibleRowsLimit == maxLines)
+    {
+        return;
+    }
+
+    m_visibleRows.clear();
+
+    switch (m_viewMode)
+    {
+        case OsProcesses:
+        case FleetProcesses:
+            for (uint row = 0u; row < m_processes.size(); ++row)
+            {
+                const S9sString &executable = m_processes.executable(row);
+
+                if (options->isStringMatchExtraArguments(executable))
+                    m_visibleRows.push_back(row);
+            }
+
+            m_processes.sortRows(m_visibleRows, sortKey(), limit);
+            break;
+
+        case SqlProcesses:
+            {
+                S9sSqlProcessCompare compare(m_sqlInstances, m_sqlPids);
+
+                m_visibleRows = m_sqlRows;
+
+                if (limit > 0u && limit < m_visibleRows.size())
+                {
+                    std::partial_sort(
+                            m_visibleRows.begin(), 
+                            m_visibleRows.begin() + limit,
+                            m_visibleRows.end(), compare);
+
+                    m_visibleRows.resize(limit);
+                } else {
+                    std::sort(
+                            m_visibleRows.begin(), m_visibleRows.end(), 
+                            compare);
+                }
+            }
+            break;
+    }
 
-    return a.cpuUsage() > b.cpuUsage();
+    m_visibleRowsValid = true;
+    m_visibleRowsOrder = m_sortOrder;
+    m_visibleRowsLimit = maxLines;
 }
 
-static bool 
-compareProcessMem(
-        const S9sProcess &a,
-        const S9sProcess &b)
+/**
+ * \returns How the process table should be sorted for the sort order the user
+ *   selected.
+ */
+S9sProcessTable::SortKey
+S9sTopUi::sortKey() const
 {
-    if (a.memUsage() == b.memUsage())
-        return a.pid() > b.pid();
+    switch (m_sortOrder)
+    {
+        case PidOrder:
+            return S9sProcessTable::SortByPid;
+
+        case CpuUsage:
+            return S9sProcessTable::SortByCpu;
+
+        case MemUsage:
+            return S9sProcessTable::SortByMemory;
+    }
 
-    return a.memUsage() > b.memUsage();
+    return S9sProcessTable::SortByCpu;
 }
 
 /**
@@ -388,7 +615,8 @@ void
 S9sTopUi::printProcesses(
         int maxLines)
 {
-    S9sOptions     *options = S9sOptions::instance();
+    bool            showCluster = m_viewMode == FleetProcesses;
+    S9sFormat       clusterFormat;
     S9sFormat       pidFormat;
     S9sFormat       userFormat(userColorBegin(), userColorEnd());
     S9sFormat       hostFormat(XTERM_COLOR_GREEN, TERM_NORMAL);
@@ -399,57 +627,27 @@ S9sTopUi::printProcesses(
     S9sFormat       cpuFormat;
     S9sFormat       memFormat;
     S9sFormat       commandFormat("\033[1;2m\033[38;5;46m", TERM_NORMAL);
-    int             nLines;
-
-    switch (m_sortOrder)
-    {
-        case PidOrder:
-            sort(m_processes.begin(), m_processes.end(), compareProcessPid);
-            break;
 
-        case CpuUsage:
-            sort(m_processes.begin(), m_processes.end(), compareProcessCpu);
-            break;
+    updateVisibleRows(maxLines);
 
-        case MemUsage:
-            sort(m_processes.begin(), m_processes.end(), compareProcessMem);
-            break;
-    }
-    
     /*
      * Collecting data.
      */
-    nLines = 0;
-    for (uint idx = 0u; idx < m_processes.size(); ++idx)
-    {
-        const S9sProcess  &process = m_processes[idx];
-        int           pid        = process.pid();
-        S9sString     user       = process.userName();
-        S9sString     hostName   = process.hostName();
-        int           priority   = process.priority();
-        S9sString     rss        = process.resMem("");
-        S9sString     virtMem    = process.virtMem("");
-        S9sString     cpuUsage   = process.cpuUsage("");
-        S9sString     memUsage   = process.memUsage("");
-        S9sString     executable = process.executable();
-
-        if (!options->isStringMatchExtraArguments(executable))
-            continue;
-
-        pidFormat.widen(pid);
-        userFormat.widen(user);
-        hostFormat.widen(hostName);
-        priorityFormat.widen(priority);
-        virtFormat.widen(virtMem);
-        resFormat.widen(rss);
-        cpuFormat.widen(cpuUsage);
-        memFormat.widen(memUsage);
+    for (uint idx = 0u; idx < m_visibleRows.size(); ++idx)
+    {
+        uint              row        = m_visibleRows[idx];
+        const S9sString  &executable = m_processes.executable(row);
+
+        clusterFormat.widen(m_processes.clusterId(row));
+        pidFormat.widen(m_processes.pid(row));
+        userFormat.widen(m_processes.userName(row));
+        hostFormat.widen(m_processes.hostName(row));
+        priorityFormat.widen(m_processes.priority(row));
+        virtFormat.widen(memoryString(m_processes.virtMem(row)));
+        resFormat.widen(memoryString(m_processes.resMem(row)));
+        cpuFormat.widen(percentString(m_processes.cpuUsage(row)));
+        memFormat.widen(percentString(m_processes.memUsage(row)));
         commandFormat.widen(executable);
-
-        if (maxLines > 0 && nLines + 1 >= maxLines)
-            break;
-
-        ++nLines;
     }
 
     // Flickering of the widths is a bit annyoying, so we introduce some minimal
@@ -463,6 +661,7 @@ S9sTopUi::printProcesses(
     
     if (!m_processes.empty())
     {
+        clusterFormat.widen("CID");
         pidFormat.widen("PID");
         userFormat.widen("USER");
         hostFormat.widen("HOST");
@@ -474,7 +673,11 @@ S9sTopUi::printProcesses(
         memFormat.widen("%MEM");
         commandFormat.widen("COMMAND");
 
-        printf("%s", TERM_SCREEN_HEADER);
+        s9s_printf("%s", TERM_SCREEN_HEADER);
+
+        if (showCluster)
+            clusterFormat.printf("CID", false);
+
         pidFormat.printf("PID", false);
         userFormat.printf("USER", false);
         hostFormat.printf("HOST", false);
@@ -488,47 +691,54 @@ S9sTopUi::printProcesses(
         printNewLine();
     }
     
-    nLines = 0;
-    for (uint idx = 0u; idx < m_processes.size(); ++idx)
+    for (uint idx = 0u; idx < m_visibleRows.size(); ++idx)
     {
-        const S9sProcess  &process = m_processes[idx];
-        int           pid        = process.pid();
-        S9sString     user       = process.userName();
-        S9sString     hostName   = process.hostName();
-        int           priority   = process.priority();
-
-        S9sString     cpuUsage   = process.cpuUsage("");
-        S9sString     memUsage   = process.memUsage("");
-        S9sString     state      = process.state();
+        uint              row        = m_visibleRows[idx];
+        const S9sString  &executable = m_processes.executable(row);
 
-        S9sString     rss        = process.resMem("");
-        S9sString     virtMem    = process.virtMem("");
-        S9sString     executable = process.executable();
-        
-        if (!options->isStringMatchExtraArguments(executable))
-            continue;
+        if (showCluster)
+            clusterFormat.printf(m_processes.clusterId(row));
 
-        pidFormat.printf(pid);
-        userFormat.printf(user);
-        hostFormat.printf(hostName);
-        priorityFormat.printf(priority);
+        pidFormat.printf(m_processes.pid(row));
+        userFormat.printf(m_processes.userName(row));
+        hostFormat.printf(m_processes.hostName(row));
+        priorityFormat.printf(m_processes.priority(row));
 
-        virtFormat.printf(virtMem);
-        resFormat.printf(rss);
+        virtFormat.printf(memoryString(m_processes.virtMem(row)));
+        resFormat.printf(memoryString(m_processes.resMem(row)));
 
-        printf("%1s ", STR(state));
-        cpuFormat.printf(cpuUsage);
-        memFormat.printf(memUsage);
+        s9s_printf("%c ", m_processes.state(row));
+        cpuFormat.printf(percentString(m_processes.cpuUsage(row)));
+        memFormat.printf(percentString(m_processes.memUsage(row)));
         commandFormat.printf(executable);
 
         printNewLine();
-        if (maxLines > 0 && nLines + 1 >= maxLines)
-            break;
-
-        ++nLines;
     }
 }
 
+/**
+ * \returns The memory size in kilobytes as it is shown in the process list.
+ */
+S9sString
+S9sTopUi::memoryString(
+        const ulonglong bytes)
+{
+    S9sString retval;
+
+    retval.sprintf("%llu", bytes / 1024);
+    return retval;
+}
+
+S9sString
+S9sTopUi::percentString(
+        const double percent)
+{
+    S9sString retval;
+
+    retval.sprintf("%6.2f", percent);
+    return retval;
+}
+
 void
 S9sTopUi::printFooter()
 {
@@ -538,18 +748,41 @@ S9sTopUi::printFooter()
     // Goint to the last line.
     for (;m_lineCounter < height() - 1; ++m_lineCounter)
     {
-        ::printf("\n\r");
-        ::printf("%s", TERM_ERASE_EOL);
+        s9s_printf("\n\r");
+        s9s_printf("%s", TERM_ERASE_EOL);
     } 
 
-    ::printf("%s ", normal);
-    ::printf("%sC%s-CPU Order ", bold, normal);
-    ::printf("%sM%s-Memory Order ", bold, normal);
-    ::printf("%sQ%s-Quit ", bold, normal);
+    s9s_printf("%s ", normal);
+    s9s_printf("%sC%s-CPU Order ", bold, normal);
+    s9s_printf("%sM%s-Memory Order ", bold, normal);
+    s9s_printf("%sQ%s-Quit ", bold, normal);
+
+    // How long the stages of the last refresh took.
+    if (m_viewMode == OsProcesses && m_nReplies > 0)
+    {
+        s9s_printf(" ");
+
+        if (m_clusterMillis > 0)
+            s9s_printf("cluster %dms ", m_clusterMillis);
+
+        s9s_printf("stats %dms ", m_statsMillis);
+        s9s_printf("ps %dms ", m_processMillis);
+        s9s_printf("decode %dms ", m_decodeMillis);
+        s9s_printf("total %dms ", m_refreshMillis);
+    } else if (m_viewMode == FleetProcesses && m_nReplies > 0)
+    {
+        s9s_printf(" ");
+
+        if (m_clusterMillis > 0)
+            s9s_printf("clusters %dms ", m_clusterMillis);
+
+        s9s_printf("polled %u/%u ", m_fleetNPolled, m_fleet.nClusters());
+        s9s_printf("total %dms ", m_refreshMillis);
+    }
 
     // No new-line at the end, this is the last line.
-    ::printf("%s", TERM_ERASE_EOL);
-    ::printf("%s", TERM_NORMAL);
+    s9s_printf("%s", TERM_ERASE_EOL);
+    s9s_printf("%s", TERM_NORMAL);
     fflush(stdout);
 }
 
@@ -562,16 +795,29 @@ S9sTopUi::executeTop()
     bool         success;
     time_t       startTime;
 
-    if (clusterId <= 0)
+    if (clusterId <= 0 && m_viewMode != FleetProcesses)
     {
         PRINT_ERROR("The cluster ID is invalid while executing 'top'.");
         exit(1);
     }
 
+    /*
+     * In the fleet view the busy clusters are polled with the update
+     * frequency, the idle ones less often. We check every second if there is
+     * a cluster to poll.
+     */
+    if (m_viewMode == FleetProcesses)
+    {
+        m_fleet.setIntervals(updateFreq * 1000, updateFreq * 8000);
+        updateFreq = 1;
+    }
+
     for (;;)
     {
         startTime = time(NULL);
 
+        authenticate();
+
         switch  (m_viewMode)
         {
             case OsProcesses:
@@ -581,6 +827,10 @@ S9sTopUi::executeTop()
             case SqlProcesses:
                 success = getSqlProcesses();
                 break;
+
+            case FleetProcesses:
+                success = getFleetProcesses();
+                break;
         }
 
         if (!success)
@@ -591,6 +841,57 @@ S9sTopUi::executeTop()
     }
 }
 
+/**
+ * Gives the requests and the fleet workers new clones of the client, so they
+ * use the session the client has now. Should be called when no request is
+ * running.
+ */
+void
+S9sTopUi::setClients()
+{
+    m_clusterRequest.setClient(m_client.clone());
+    m_cpuStatsRequest.setClient(m_client.clone());
+    m_memoryStatsRequest.setClient(m_client.clone());
+    m_processRequest.setClient(m_client.clone());
+
+    for (uint idx = 0u; idx < m_fleetWorkers.size(); ++idx)
+        m_fleetWorkers[idx]->setClient(m_client);
+
+    m_clientsAuthenticated = m_client.isAuthenticated();
+}
+
+/**
+ * The requests are sent on clones of the client and the clones only have the
+ * session they were created with. If the controller found the session expired
+ * on any of the connections we log in again with the client and clone it
+ * again, so the new session reaches every connection.
+ */
+void
+S9sTopUi::authenticate()
+{
+    bool expired;
+
+    // Without a session there is nothing to renew.
+    if (!m_clientsAuthenticated)
+        return;
+
+    expired = !m_client.isAuthenticated();
+    expired = expired || !m_clusterRequest.isAuthenticated();
+    expired = expired || !m_cpuStatsRequest.isAuthenticated();
+    expired = expired || !m_memoryStatsRequest.isAuthenticated();
+    expired = expired || !m_processRequest.isAuthenticated();
+
+    for (uint idx = 0u; idx < m_fleetWorkers.size(); ++idx)
+        expired = expired || !m_fleetWorkers[idx]->isAuthenticated();
+
+    if (!expired)
+        return;
+
+    PRINT_LOG("The session expired, authenticating again.");
+    if (m_client.maybeAuthenticate() && m_client.isAuthenticated())
+        setClients();
+}
+
 /**
  * \returns True if everything went well, false on communication error.
  *
@@ -598,104 +899,54 @@ S9sTopUi::executeTop()
  * method will send multiple requests and will get more than the list of
  * processes, but the important part is that this is what we use to refresh the
  * data from the controller when showing the OS processes.
+ *
+ * The requests are sent at the same time on their own connections, the
+ * processes are decoded on the thread that received them and the new data is
+ * swapped in at once so the screen never shows a half updated state.
  */
 bool
 S9sTopUi::getProcesses()
 {
     S9sMutexLocker         locker(m_networkMutex);
     S9sOptions            *options     = S9sOptions::instance();
-    S9sVariantList         hostList;
-    S9sString              clusterStatusText;
-    S9sRpcReply            reply;
-    S9sRpcReply            clustersReply;
-    time_t                 clustersReplyReceived;
-    S9sRpcReply            cpuStatsReply;
-    S9sRpcReply            memoryStatsReply;
-    S9sRpcReply            processReply;
-    S9sVector<S9sProcess>  processes;
+    bool                   needCluster;
     int                    clusterId;
     S9sString              clusterName;
+    struct timespec        startTime;
     bool                   success = true;
 
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
     m_communicating   = true;
     m_reloadRequested = false;
 
     /*
-     * The cluster information.
+     * The cluster information is only refreshed from time to time, the
+     * statistics and the processes every time.
      */
-    clustersReplyReceived = m_clustersReplyReceived;
     clusterId   = options->clusterId();
     clusterName = options->clusterName();
+    needCluster = time(NULL) - m_clustersReplyReceived > 30;
 
-    if (time(NULL) - clustersReplyReceived > 30)
-    {
-        success = m_client.getCluster(clusterName, clusterId);
-
-        // If the user aborted download.
-        if (!m_communicating)
-            return true;
-
-        clustersReply = m_client.reply();
-        if (!success)
-            return success;
-
-        clustersReplyReceived = time(NULL);
-    } else {
-        clustersReply = m_clustersReply;
-    }
+    if (needCluster)
+        m_clusterRequest.start(clusterName, clusterId);
 
-    /*
-     * The CPU statistics.
-     */
-    m_client.getCpuStats(clusterId);
-    
-    // If the user aborted download.
-    if (!m_communicating)
-        return true;
-
-    cpuStatsReply = m_client.reply();
-    
-    /*
-     * The memory statistics.
-     */
-    m_client.getMemoryStats(clusterId);
+    m_cpuStatsRequest.start(clusterName, clusterId);
+    m_memoryStatsRequest.start(clusterName, clusterId);
+    m_processRequest.start(clusterName, clusterId);
 
-    // If the user aborted download.
-    if (!m_communicating)
-        return true;
+    if (needCluster)
+        success = m_clusterRequest.wait();
 
-    memoryStatsReply = m_client.reply();
-    
-    /*
-     * Getting the list of the running processes.
-     */
-    m_client.getRunningProcesses();
+    m_cpuStatsRequest.wait();
+    m_memoryStatsRequest.wait();
+    m_processRequest.wait();
     
     // If the user aborted download.
     if (!m_communicating)
         return true;
 
-    processReply = m_client.reply();
-    hostList = processReply["data"].toVariantList();
-    for (uint idx = 0u; idx < hostList.size(); ++idx)
-    {
-        S9sString hostName = hostList[idx]["hostname"].toString();
-        S9sVariantList processList = hostList[idx]["processes"].toVariantList();
-    
-        for (uint idx1 = 0u; idx1 < processList.size(); ++idx1)
-        {
-            S9sVariantMap processMap = processList[idx1].toVariantMap();
-            S9sProcess    process;
-
-            processMap["hostname"] = hostName;
-            process = processMap;
-            processes << process;
-        }
-
-        // If the user aborted download.
-        if (!m_communicating)
-            return true;
-    }
+    if (!success)
+        return success;
 
     /*
      * Pushing the received data into the object so that the screen refresh can
@@ -703,15 +954,30 @@ S9sTopUi::getProcesses()
      */
     m_mutex.lock(); 
 
-    m_clustersReply         = clustersReply;
-    m_clustersReplyReceived = clustersReplyReceived;
-    m_cpuStatsReply         = cpuStatsReply;
-    m_memoryStatsReply      = memoryStatsReply;
-    m_processReply          = processReply;
-    m_processes             = processes;
+    if (needCluster)
+    {
+        m_clustersReply         = m_clusterRequest.reply();
+        m_clustersReplyReceived = time(NULL);
+        m_clusterMillis         = m_clusterRequest.requestMillis();
+    } else {
+        m_clusterMillis         = 0;
+    }
+
+    m_cpuStatsReply         = m_cpuStatsRequest.reply();
+    m_memoryStatsReply      = m_memoryStatsRequest.reply();
+    m_processes.swap(m_processRequest.processes());
+    m_visibleRowsValid      = false;
     m_clusterId             = clusterId;
     m_clusterName           = m_clustersReply.clusterName(m_clusterId);
 
+    m_statsMillis           = m_cpuStatsRequest.requestMillis();
+    if (m_memoryStatsRequest.requestMillis() > m_statsMillis)
+        m_statsMillis = m_memoryStatsRequest.requestMillis();
+
+    m_processMillis         = m_processRequest.requestMillis();
+    m_decodeMillis          = m_processRequest.decodeMillis();
+    m_refreshMillis         = millisecondsSince(startTime);
+
     m_communicating         = false;
     m_nReplies++;
     m_refreshCounter++;
@@ -725,10 +991,13 @@ bool
 S9sTopUi::getSqlProcesses()
 {
     S9sMutexLocker         locker(m_networkMutex);
-    //S9sOptions            *options     = S9sOptions::instance();
+    S9sOptions            *options     = S9sOptions::instance();
     S9sRpcReply            getSqlProcessesReply;
     S9sVariantList         variantList;
     S9sVector<S9sSqlProcess> processList;
+    S9sVector<S9sString>   instances;
+    S9sVector<int>         pids;
+    S9sVector<uint>        rows;
 
     m_communicating   = true;
     m_reloadRequested = false;
@@ -736,16 +1005,33 @@ S9sTopUi::getSqlProcesses()
     m_client.getSqlProcesses();
     getSqlProcessesReply = m_client.reply();
 
+    /*
+     * The sort keys and the filters are evaluated here once, not on every
+     * redraw of the screen.
+     */
     variantList = getSqlProcessesReply["processes"].toVariantList();
     for (size_t idx = 0; idx < variantList.size(); ++idx)
     {
         S9sSqlProcess process = variantList[idx].toVariantMap();
 
         processList << process;
+        instances   << process.instance();
+        pids        << process.pid();
+
+        if (options->isStringMatchExtraArguments(process.query("")) &&
+                options->isStringMatchToServerOption(process.instance()) &&
+                options->isStringMatchToClientOption(process.hostName()))
+        {
+            rows << (uint) idx;
+        }
     }
 
     m_mutex.lock();     
-    m_sqlProcesses = processList;
+    m_sqlProcesses.swap(processList);
+    m_sqlInstances.swap(instances);
+    m_sqlPids.swap(pids);
+    m_sqlRows.swap(rows);
+    m_visibleRowsValid = false;
     m_nReplies++;
     m_refreshCounter++;
     m_mutex.unlock();
@@ -753,3 +1039,418 @@ S9sTopUi::getSqlProcesses()
     m_communicating   = false;
     return true;
 }
+
+/**
+ * \returns True if everything went well, false on communication error.
+ *
+ * Gets the processes of all the clusters for the fleet view. Only the
+ * clusters that are due are polled, by a few workers at the same time, and
+ * the processes of the clusters are merged into one table when the polls are
+ * finished. The list of the clusters is refreshed from time to time.
+ */
+bool
+S9sTopUi::getFleetProcesses()
+{
+    S9sMutexLocker         locker(m_networkMutex);
+    struct timespec        startTime;
+    S9sVector<int>         dueClusters;
+    uint                   nWorkers;
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    m_communicating   = true;
+    m_reloadRequested = false;
+
+    if (time(NULL) - m_clustersReplyReceived > 30)
+    {
+        S9sRpcReply reply;
+
+        if (!m_client.getClusters())
+        {
+            m_communicating = false;
+            return false;
+        }
+
+        reply = m_client.reply();
+
+        m_mutex.lock(); 
+        m_clustersReply         = reply;
+        m_clustersReplyReceived = time(NULL);
+        m_clusterMillis         = millisecondsSince(startTime);
+        m_fleet.setClusters(
+                reply["clusters"].toVariantList(), 
+                S9sTopFleet::currentMillis());
+        m_mutex.unlock();
+    } else {
+        m_clusterMillis = 0;
+    }
+
+    dueClusters = m_fleet.dueClusters(S9sTopFleet::currentMillis());
+    if (dueClusters.empty())
+    {
+        m_communicating = false;
+        return true;
+    }
+
+    m_fleetQueueMutex.lock();
+    m_fleetQueue = dueClusters;
+    m_fleetQueueMutex.unlock();
+
+    /*
+     * The workers have their own connections that are kept between the
+     * refreshes.
+     */
+    nWorkers = dueClusters.size() < FLEET_CONCURRENCY ? 
+        dueClusters.size() : FLEET_CONCURRENCY;
+
+    while (m_fleetWorkers.size() < nWorkers)
+        m_fleetWorkers << new S9sTopUiFleetWorker(this, m_client);
+
+    for (uint idx = 0u; idx < nWorkers; ++idx)
+        m_fleetWorkers[idx]->start();
+
+    for (uint idx = 0u; idx < nWorkers; ++idx)
+        m_fleetWorkers[idx]->wait();
+
+    m_mutex.lock(); 
+    m_fleet.merge(m_processes);
+    m_visibleRowsValid = false;
+    m_fleetNPolled     = dueClusters.size();
+    m_refreshMillis    = millisecondsSince(startTime);
+    m_communicating    = false;
+    m_nReplies++;
+    m_refreshCounter++;
+    m_mutex.unlock();
+
+    return true;
+}
+
+/**
+ * \param clusterId The ID of the next cluster to poll.
+ * \returns False if there are no more clusters to poll.
+ *
+ * Called by the fleet workers on their own threads.
+ */
+bool
+S9sTopUi::nextFleetCluster(
+        int &clusterId)
+{
+    S9sMutexLocker locker(m_fleetQueueMutex);
+
+    if (m_fleetQueue.empty())
+        return false;
+
+    clusterId = m_fleetQueue[0];
+    m_fleetQueue.erase(m_fleetQueue.begin());
+
+    return true;
+}
+
+/**
+ * Called by the fleet workers on their own threads when a cluster is polled.
+ * The data is stored right away, so the statistics of the clusters are shown
+ * as they arrive.
+ */
+void
+S9sTopUi::fleetClusterPolled(
+        const int           clusterId,
+        const bool          success,
+        const S9sRpcReply  &cpuStatsReply,
+        const S9sRpcReply  &memoryStatsReply,
+        S9sProcessTable    &processes)
+{
+    static const S9sString dataKey = "data";
+    longlong now = S9sTopFleet::currentMillis();
+
+    m_mutex.lock(); 
+
+    if (success)
+    {
+        m_fleet.update(
+                clusterId, 
+                cpuStatsReply.valueByPath(dataKey).toVariantList(),
+                memoryStatsReply.valueByPath(dataKey).toVariantList(),
+                processes, now);
+    } else {
+        m_fleet.failed(clusterId, now);
+    }
+
+    m_mutex.unlock();
+}
+
+S9sTopUiRequest::S9sTopUiRequest(
+        const Operation operation) :
+    m_operation(operation),
+    m_running(false),
+    m_clusterId(0),
+    m_success(false),
+    m_requestMillis(0),
+    m_decodeMillis(0)
+{
+}
+
+S9sTopUiRequest::~S9sTopUiRequest()
+{
+    wait();
+}
+
+/**
+ * \param client The client to send the request with, it should have its own
+ *   connection (see S9sRpcClient::clone()).
+ */
+void
+S9sTopUiRequest::setClient(
+        const S9sRpcClient &client)
+{
+    m_client = client;
+}
+
+/**
+ * \returns False if the controller found the session of the connection
+ *   expired.
+ */
+bool
+S9sTopUiRequest::isAuthenticated() const
+{
+    return m_client.isAuthenticated();
+}
+
+/**
+ * Starts sending the request on a new thread. If the thread can not be
+ * created the request is executed here.
+ */
+void
+S9sTopUiRequest::start(
+        const S9sString &clusterName,
+        const int        clusterId)
+{
+    wait();
+
+    m_clusterName = clusterName;
+    m_clusterId   = clusterId;
+    m_success     = false;
+
+    m_running = pthread_create(
+            &m_thread, NULL, S9sTopUiRequest::entryPoint, this) == 0;
+
+    if (!m_running)
+    {
+        PRINT_LOG("Could not start a thread for s9s top, going on without.");
+        execute();
+    }
+}
+
+/**
+ * Waits until the request finishes.
+ *
+ * \returns True if the request was sent and a reply was received.
+ */
+bool
+S9sTopUiRequest::wait()
+{
+    if (m_running)
+    {
+        pthread_join(m_thread, NULL);
+        m_running = false;
+    }
+
+    return m_success;
+}
+
+const S9sRpcReply &
+S9sTopUiRequest::reply() const
+{
+    return m_reply;
+}
+
+/**
+ * \returns The processes decoded from the reply of the GetRunningProcesses
+ *   request. The table can be swapped out, the next request fills a new one.
+ */
+S9sProcessTable &
+S9sTopUiRequest::processes()
+{
+    return m_processes;
+}
+
+/**
+ * \returns How long it took to send the request and receive the reply.
+ */
+int
+S9sTopUiRequest::requestMillis() const
+{
+    return m_requestMillis;
+}
+
+/**
+ * \returns How long it took to decode the processes from the reply.
+ */
+int
+S9sTopUiRequest::decodeMillis() const
+{
+    return m_decodeMillis;
+}
+
+void *
+S9sTopUiRequest::entryPoint(
+        void *pointer)
+{
+    S9sTopUiRequest *request = (S9sTopUiRequest *) pointer;
+
+    request->execute();
+    return NULL;
+}
+
+void
+S9sTopUiRequest::execute()
+{
+    struct timespec startTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    switch (m_operation)
+    {
+        case GetCluster:
+            m_success = m_client.getCluster(m_clusterName, m_clusterId);
+            break;
+
+        case GetCpuStats:
+            m_success = m_client.getCpuStats(m_clusterId);
+            break;
+
+        case GetMemoryStats:
+            m_success = m_client.getMemoryStats(m_clusterId);
+            break;
+
+        case GetRunningProcesses:
+            m_success = m_client.getRunningProcesses(m_clusterId);
+            break;
+    }
+
+    m_reply         = m_client.reply();
+    m_requestMillis = millisecondsSince(startTime);
+
+    if (m_operation == GetRunningProcesses)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+        m_processes.clear();
+        m_processes.appendHosts(m_reply["data"].toVariantList(), m_clusterId);
+
+        m_decodeMillis = millisecondsSince(startTime);
+
+        // The processes are decoded, the reply is not needed any more.
+        m_reply = S9sRpcReply();
+    }
+}
+
+/**
+ * \param ui The UI that provides the clusters to poll and receives the data.
+ * \param client The requests of the worker use their own clones of this
+ *   client.
+ */
+S9sTopUiFleetWorker::S9sTopUiFleetWorker(
+        S9sTopUi           *ui,
+        const S9sRpcClient &client) :
+    m_ui(ui),
+    m_running(false),
+    m_cpuStatsRequest(S9sTopUiRequest::GetCpuStats),
+    m_memoryStatsRequest(S9sTopUiRequest::GetMemoryStats),
+    m_processRequest(S9sTopUiRequest::GetRunningProcesses)
+{
+    setClient(client);
+}
+
+S9sTopUiFleetWorker::~S9sTopUiFleetWorker()
+{
+    wait();
+}
+
+/**
+ * \param client The client the requests of the worker are cloned from.
+ */
+void
+S9sTopUiFleetWorker::setClient(
+        const S9sRpcClient &client)
+{
+    m_cpuStatsRequest.setClient(client.clone());
+    m_memoryStatsRequest.setClient(client.clone());
+    m_processRequest.setClient(client.clone());
+}
+
+bool
+S9sTopUiFleetWorker::isAuthenticated() const
+{
+    return 
+        m_cpuStatsRequest.isAuthenticated() &&
+        m_memoryStatsRequest.isAuthenticated() &&
+        m_processRequest.isAuthenticated();
+}
+
+/**
+ * Starts polling the clusters on a new thread. If the thread can not be
+ * created the clusters are polled here.
+ */
+void
+S9sTopUiFleetWorker::start()
+{
+    wait();
+
+    m_running = pthread_create(
+            &m_thread, NULL, S9sTopUiFleetWorker::entryPoint, this) == 0;
+
+    if (!m_running)
+    {
+        PRINT_LOG("Could not start a thread for s9s top, going on without.");
+        execute();
+    }
+}
+
+/**
+ * Waits until the worker finished polling the clusters.
+ */
+void
+S9sTopUiFleetWorker::wait()
+{
+    if (m_running)
+    {
+        pthread_join(m_thread, NULL);
+        m_running = false;
+    }
+}
+
+void *
+S9sTopUiFleetWorker::entryPoint(
+        void *pointer)
+{
+    S9sTopUiFleetWorker *worker = (S9sTopUiFleetWorker *) pointer;
+
+    worker->execute();
+    return NULL;
+}
+
+/**
+ * The three requests of one cluster are sent at the same time, the clusters
+ * are polled one after the other.
+ */
+void
+S9sTopUiFleetWorker::execute()
+{
+    int  clusterId;
+    bool success;
+
+    while (m_ui->nextFleetCluster(clusterId))
+    {
+        m_cpuStatsRequest.start("", clusterId);
+        m_memoryStatsRequest.start("", clusterId);
+        m_processRequest.start("", clusterId);
+
+        success = m_cpuStatsRequest.wait();
+        success = m_memoryStatsRequest.wait() && success;
+        success = m_processRequest.wait() && success;
+
+        m_ui->fleetClusterPolled(
+                clusterId, success, 
+                m_cpuStatsRequest.reply(), m_memoryStatsRequest.reply(),
+                m_processRequest.processes());
+    }
+}
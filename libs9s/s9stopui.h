@@ -23,12 +23,96 @@
 
 #include "s9sdisplay.h"
 #include "s9sformatter.h"
+#include "s9srpcclient.h"
 #include "s9srpcreply.h"
-#include "s9sprocess.h"
+#include "s9sprocesstable.h"
+#include "s9stopfleet.h"
 #include "s9ssqlprocess.h"
 #include "s9svector.h"
 
-class S9sRpcClient;
+#include <pthread.h>
+
+/**
+ * One request of the s9s top refresh. Every request has its own connection to
+ * the controller and is executed on its own thread, so the requests of one
+ * refresh are all waiting for the controller at the same time.
+ */
+class S9sTopUiRequest
+{
+    public:
+        enum Operation
+        {
+            GetCluster,
+            GetCpuStats,
+            GetMemoryStats,
+            GetRunningProcesses,
+        };
+
+        S9sTopUiRequest(const Operation operation);
+        virtual ~S9sTopUiRequest();
+
+        void setClient(const S9sRpcClient &client);
+        bool isAuthenticated() const;
+
+        void start(const S9sString &clusterName, const int clusterId);
+        bool wait();
+
+        const S9sRpcReply &reply() const;
+        S9sProcessTable &processes();
+        int requestMillis() const;
+        int decodeMillis() const;
+
+    private:
+        static void *entryPoint(void *pointer);
+        void execute();
+
+    private:
+        Operation         m_operation;
+        S9sRpcClient      m_client;
+        pthread_t         m_thread;
+        bool              m_running;
+        S9sString         m_clusterName;
+        int               m_clusterId;
+        bool              m_success;
+        S9sRpcReply       m_reply;
+        /** The processes decoded on the request thread. */
+        S9sProcessTable   m_processes;
+        int               m_requestMillis;
+        int               m_decodeMillis;
+};
+
+class S9sTopUi;
+
+/**
+ * Polls the clusters of the fleet view one after the other on its own thread
+ * until there are no more clusters waiting to be polled. A few workers are
+ * running at the same time, so the number of requests the controller has to
+ * serve at once does not grow with the number of clusters.
+ */
+class S9sTopUiFleetWorker
+{
+    public:
+        S9sTopUiFleetWorker(S9sTopUi *ui, const S9sRpcClient &client);
+        virtual ~S9sTopUiFleetWorker();
+
+        void setClient(const S9sRpcClient &client);
+        bool isAuthenticated() const;
+
+        void start();
+        void wait();
+
+    private:
+        static void *entryPoint(void *pointer);
+        void execute();
+
+    private:
+        S9sTopUi         *m_ui;
+        pthread_t         m_thread;
+        bool              m_running;
+        S9sTopUiRequest   m_cpuStatsRequest;
+        S9sTopUiRequest   m_memoryStatsRequest;
+        S9sTopUiRequest   m_processRequest;
+};
 
 /*
  * http://stackoverflow.com/questions/905060/non-blocking-getch-ncurses
@@ -51,6 +135,8 @@ class S9sTopUi :
             OsProcesses,
             // Showing the top SQL processes...
             SqlProcesses,
+            // Showing the top OS processes of all the clusters...
+            FleetProcesses,
         };
 
         S9sTopUi(
@@ -69,31 +155,81 @@ class S9sTopUi :
         virtual void printHeader();
         virtual void printFooter();
         
+        void setClients();
+        void authenticate();
+
         bool getProcesses();
         bool getSqlProcesses();
+        bool getFleetProcesses();
         void printProcesses(int maxLines);
         void printSqlProcesses(int maxLines);
+        int printFleetClusters(int maxLines);
+        void updateVisibleRows(int maxLines);
+        S9sProcessTable::SortKey sortKey() const;
+
+        bool nextFleetCluster(int &clusterId);
+        void fleetClusterPolled(
+                const int           clusterId,
+                const bool          success,
+                const S9sRpcReply  &cpuStatsReply,
+                const S9sRpcReply  &memoryStatsReply,
+                S9sProcessTable    &processes);
+
+        static S9sString memoryString(const ulonglong bytes);
+        static S9sString percentString(const double percent);
 
     private:
         ViewMode               m_viewMode;
         S9sRpcClient          &m_client;
+        /** The client had a session when the requests got their clones. */
+        bool                   m_clientsAuthenticated;
         int                    m_nReplies;
 
         S9sMutex               m_networkMutex;        
+        S9sTopUiRequest        m_clusterRequest;
+        S9sTopUiRequest        m_cpuStatsRequest;
+        S9sTopUiRequest        m_memoryStatsRequest;
+        S9sTopUiRequest        m_processRequest;
         S9sRpcReply            m_clustersReply;
         time_t                 m_clustersReplyReceived;
         S9sRpcReply            m_cpuStatsReply;
         S9sRpcReply            m_memoryStatsReply;
-        S9sRpcReply            m_processReply;
-        S9sVector<S9sProcess>     m_processes;
+        S9sProcessTable        m_processes;
+        /** How long the stages of the last refresh took in milliseconds. */
+        int                    m_clusterMillis;
+        int                    m_statsMillis;
+        int                    m_processMillis;
+        int                    m_decodeMillis;
+        int                    m_refreshMillis;
         S9sVector<S9sSqlProcess>  m_sqlProcesses;
+        /** The sort keys of the SQL processes, extracted once per refresh. */
+        S9sVector<S9sString>      m_sqlInstances;
+        S9sVector<int>            m_sqlPids;
+        /** The SQL processes that pass the command line filters. */
+        S9sVector<uint>           m_sqlRows;
+        
+        /** The rows shown, kept until the data or the sort order changes. */
+        S9sVector<uint>        m_visibleRows;
+        bool                   m_visibleRowsValid;
+        SortOrder              m_visibleRowsOrder;
+        int                    m_visibleRowsLimit;
         int                       m_clusterId;
         S9sString                 m_clusterName;
 
+        /** The clusters and their processes in the fleet view. */
+        S9sTopFleet                      m_fleet;
+        S9sVector<S9sTopUiFleetWorker *> m_fleetWorkers;
+        /** The clusters waiting to be polled by the workers. */
+        S9sMutex                         m_fleetQueueMutex;
+        S9sVector<int>                   m_fleetQueue;
+        uint                             m_fleetNPolled;
+
         SortOrder              m_sortOrder;
         bool                   m_communicating;
         bool                   m_viewDebug;
         bool                   m_reloadRequested;
+
+    friend class S9sTopUiFleetWorker;
 };
 
 
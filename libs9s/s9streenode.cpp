@@ -18,27 +18,77 @@
  * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "s9streenode.h"
+#include "s9streenode_p.h"
 
 //#define DEBUG
 //#define WARNING
 #include "s9sdebug.h"
 
 S9sTreeNode::S9sTreeNode() :
-    m_childNodesParsed(false)
+    m_priv(new S9sTreeNodePrivate),
+    m_index(0)
 {
-    m_properties["class_name"] = "CmonTreeNode";
 }
  
+/**
+ * \param properties The node with its sub-tree as the tree RPC returns it.
+ *
+ * Builds the tree, the new node is the root of the tree.
+ */
 S9sTreeNode::S9sTreeNode(
         const S9sVariantMap &properties) :
-    m_properties(properties),
-    m_childNodesParsed(false)
+    m_priv(new S9sTreeNodePrivate(properties)),
+    m_index(0)
+{
+}
+
+S9sTreeNode::S9sTreeNode(
+        const S9sTreeNode &orig) :
+    m_priv(orig.m_priv),
+    m_index(orig.m_index)
+{
+    m_priv->ref();
+}
+
+/**
+ * A node pointing into an existing tree.
+ */
+S9sTreeNode::S9sTreeNode(
+        S9sTreeNodePrivate *priv,
+        const int           index) :
+    m_priv(priv),
+    m_index(index)
 {
-    m_properties["class_name"] = "CmonTreeNode";
+    m_priv->ref();
 }
 
 S9sTreeNode::~S9sTreeNode()
 {
+    if (m_priv->unRef() == 0)
+        delete m_priv;
+
+    m_priv = 0;
+}
+
+/**
+ * Assignment operator that utilises the implicit sharing this class uses.
+ */
+S9sTreeNode &
+S9sTreeNode::operator=(
+        const S9sTreeNode &rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    rhs.m_priv->ref();
+
+    if (m_priv->unRef() == 0)
+        delete m_priv;
+
+    m_priv  = rhs.m_priv;
+    m_index = rhs.m_index;
+
+    return *this;
 }
 
 S9sTreeNode &
@@ -50,10 +100,15 @@ S9sTreeNode::operator=(
     return *this;
 }
 
+/**
+ * \returns The node with its whole sub-tree in the form the tree RPC returns
+ *   it. This has to copy the sub-tree, so it should not be used while walking
+ *   the tree.
+ */
 S9sVariantMap
 S9sTreeNode::toVariantMap() const
 {
-    return m_properties;
+    return m_priv->toVariantMap(m_index);
 }
 
 /**
@@ -63,7 +118,7 @@ bool
 S9sTreeNode::hasProperty(
         const S9sString &key) const
 {
-    return m_properties.contains(key);
+    return m_priv->m_properties[m_index].contains(key);
 }
 
 /**
@@ -74,35 +129,35 @@ S9sVariant
 S9sTreeNode::property(
         const S9sString &name) const
 {
-    if (m_properties.contains(name))
-        return m_properties.at(name);
-
-    return S9sVariant();
+    return field(name);
 }
 
 /**
  * \param properties The properties to be set as a name -> value mapping.
  *
  * Sets all the properties in one step. All the existing properties will be
- * deleted, then the new properties set.
+ * deleted, then the new properties set. The node will be the root of a new
+ * tree built from the "sub_items" of the properties, the tree the node was
+ * pointing into is not changed.
  */
 void
 S9sTreeNode::setProperties(
         const S9sVariantMap &properties)
 {
-    m_properties = properties;
+    S9sTreeNodePrivate *priv = new S9sTreeNodePrivate(properties);
+
+    if (m_priv->unRef() == 0)
+        delete m_priv;
+
+    m_priv  = priv;
+    m_index = 0;
 }
 
 S9sString
 S9sTreeNode::name() const
 {
-    S9sString retval = property("item_name").toString();
-
     // Root node has no name, just a path.
-    if (retval.empty())
-        retval = property("item_path").toString();
-
-    return retval;
+    return m_priv->name(m_index);
 }
 
 S9sString
@@ -220,23 +275,25 @@ S9sTreeNode::typeName() const
 int
 S9sTreeNode::typeAsChar() const
 {
-    if (type() == "folder")
+    S9sString theType = type();
+
+    if (theType == "folder")
         return 'd';
-    else if (type() == "file")
+    else if (theType == "file")
         return '-';
-    else if (type() == "cluster")
+    else if (theType == "cluster")
         return 'c';
-    else if (type() == "node")
+    else if (theType == "node")
         return 'n';
-    else if (type() == "server")
+    else if (theType == "server")
         return 's';
-    else if (type() == "user")
+    else if (theType == "user")
         return 'u';
-    else if (type() == "group")
+    else if (theType == "group")
         return 'g';
-    else if (type() == "container")
+    else if (theType == "container")
         return 'c';
-    else if (type() == "database")
+    else if (theType == "database")
         return 'b';
 
     return '?';
@@ -296,51 +353,70 @@ S9sTreeNode::isDatabase() const
     return type() == "database";
 }
 
+/**
+ * \returns True if the node has a child with the given name.
+ */
 bool
 S9sTreeNode::hasChild(
         const S9sString &name)
 {
-    S9sVector<S9sTreeNode> nodes = childNodes();
+    return m_priv->childIndex(m_index, name) >= 0;
+}
 
-    for (uint idx = 0u; idx < nodes.size(); ++idx)
-    {
-        if (nodes[idx].name() == name)
-            return true;
-    }
+/**
+ * \returns False for the root of the tree, true for every other node.
+ */
+bool
+S9sTreeNode::hasParent() const
+{
+    return m_priv->m_parents[m_index] >= 0;
+}
 
-    return false;
+/**
+ * \returns The parent of the node or the node itself if this is the root of
+ *   the tree.
+ */
+S9sTreeNode
+S9sTreeNode::parent() const
+{
+    int parentIndex = m_priv->m_parents[m_index];
+
+    if (parentIndex < 0)
+        return *this;
+
+    return S9sTreeNode(m_priv, parentIndex);
 }
 
-const S9sVector<S9sTreeNode> &
+/**
+ * \returns The children of the node. The nodes are pointing into the same
+ *   tree, so this does not copy the sub-trees of the children.
+ */
+S9sVector<S9sTreeNode>
 S9sTreeNode::childNodes() const
 {
-    if (!m_childNodesParsed)
-    {
-        S9sVariantList  variantList = property("sub_items").toVariantList();
-        
-        for (uint idx = 0; idx < variantList.size(); ++idx)
-            m_childNodes << S9sTreeNode(variantList[idx].toVariantMap());
+    S9sVector<S9sTreeNode> retval;
+    int                    first = m_priv->m_firstChildren[m_index];
+    int                    count = m_priv->m_nChildren[m_index];
 
-        m_childNodesParsed = true;
-    }
+    retval.reserve(count);
+    for (int idx = 0; idx < count; ++idx)
+        retval.push_back(S9sTreeNode(m_priv, first + idx));
 
-    return m_childNodes;
+    return retval;
 }
 
 int
 S9sTreeNode::nChildren() const
 {
-    return (int) childNodes().size();
+    return m_priv->m_nChildren[m_index];
 }
 
 S9sTreeNode
 S9sTreeNode::childNode(
         int idx) const
 {
-    const S9sVector<S9sTreeNode> &children = S9sTreeNode::childNodes();
-
-    if (idx >= 0 && idx < (int) children.size())
-        return children[idx];
+    if (idx >= 0 && idx < nChildren())
+        return S9sTreeNode(m_priv, m_priv->m_firstChildren[m_index] + idx);
 
     return S9sTreeNode();
 }
@@ -358,9 +434,13 @@ S9sTreeNode::pathExists(
 }
 
 /**
- * \param path The starting point of the sub-tree to return.
+ * \param path The starting point of the sub-tree to return relative to this
+ *   node.
  * \param retval The place where the function returns the sub-tree.
  * \returns True if the sub-tree found.
+ *
+ * Every element of the path is looked up in the index of the tree, so this
+ * does not depend on how many children the nodes on the path have.
  */
 bool
 S9sTreeNode::subTree(
@@ -368,6 +448,7 @@ S9sTreeNode::subTree(
         S9sTreeNode       &retval) const
 {
     S9sVariantList pathList = path.split("/");
+    int            index    = m_index;
 
     if (pathList.size() > 0u)
     {
@@ -375,52 +456,82 @@ S9sTreeNode::subTree(
             pathList.takeFirst();
     }
 
-    if (pathList.size() == 0u)
+    for (uint idx = 0u; idx < pathList.size(); ++idx)
     {
-        retval = *this;
-        return true;
+        index = m_priv->childIndex(index, pathList[idx].toString());
+        
+        // The next item was not found.
+        if (index < 0)
+            return false;
     }
 
-    return subTree(pathList, retval);
+    retval = S9sTreeNode(m_priv, index);
+    return true;
 }
 
 /**
- * Overloaded private method for the recursive call.
+ * \param path The path of the sub-tree to replace relative to this node.
+ * \param subTree The new sub-tree.
+ * \returns True if the path was found and the sub-tree was replaced.
+ *
+ * Builds a new tree from the sub-tree of this node with one sub-tree
+ * replaced, this node will be the root of the new tree. This is how the
+ * parts of the tree that are reloaded from the controller are merged into
+ * the tree we already have. The original tree is not changed, the other
+ * nodes pointing into it are still valid.
  */
 bool
-S9sTreeNode::subTree(
-        const S9sVariantList  &pathList,
-        S9sTreeNode           &retval) const 
+S9sTreeNode::replaceSubTree(
+        const S9sString   &path, 
+        const S9sTreeNode &subTree)
 {
-    // This can never happen, this is just a check against takeFirst() crash.
-    if (pathList.empty())
+    S9sTreeNode         replaced;
+    S9sTreeNodePrivate *priv;
+
+    if (!S9sTreeNode::subTree(path, replaced))
         return false;
 
-    /*
-     * We take the first element on the path.
-     */
-    S9sVariantList reducedList = pathList;
-    S9sString      nextName    = reducedList.takeFirst().toString();
-    const S9sVector<S9sTreeNode> &children = childNodes();
-       
-    for (uint idx = 0u; idx < children.size(); ++idx)
-    {
-        const S9sTreeNode &child = children[idx];
-
-        if (child.name() == nextName)
-        {
-            // We found the next level belonging to the next element in the 
-            // path.
-            if (reducedList.empty())
-            {
-                retval = child;
-                return true;
-            }
-            
-            return child.subTree(reducedList, retval);
-        }
-    }
+    priv = new S9sTreeNodePrivate(
+            *m_priv, m_index, replaced.m_index, 
+            *subTree.m_priv, subTree.m_index);
+
+    if (m_priv->unRef() == 0)
+        delete m_priv;
+
+    m_priv  = priv;
+    m_index = 0;
+
+    return true;
+}
+
+/**
+ * \returns True if the two nodes have the same properties and the same
+ *   sub-trees.
+ */
+bool
+S9sTreeNode::isEqual(
+        const S9sTreeNode &other) const
+{
+    if (m_priv == other.m_priv && m_index == other.m_index)
+        return true;
+
+    return m_priv->isEqual(m_index, *other.m_priv, other.m_index);
+}
+
+/**
+ * \returns The property of the node without copying it, an invalid variant
+ *   if the node has no such property.
+ */
+const S9sVariant &
+S9sTreeNode::field(
+        const S9sString &key) const
+{
+    static const S9sVariant        invalid;
+    const S9sVariantMap           &properties = m_priv->m_properties[m_index];
+    S9sVariantMap::const_iterator  it = properties.find(key);
+
+    if (it == properties.end())
+        return invalid;
 
-    // The next item was not found.
-    return false;
+    return it->second;
 }
@@ -21,18 +21,26 @@
 
 #include "s9svariantmap.h"
 
+class S9sTreeNodePrivate;
+
 /**
  * A class that represents a node in the CDT as they are returned by the tree
  * RPC. 
+ *
+ * The nodes are lightweight handles: the tree is stored only once (see
+ * S9sTreeNodePrivate) and shared by all the nodes that are pointing into it,
+ * so copying a node or getting its children does not copy the sub-tree.
  */
 class S9sTreeNode
 {
     public:
         S9sTreeNode();
         S9sTreeNode(const S9sVariantMap &properties);
+        S9sTreeNode(const S9sTreeNode &orig);
 
         virtual ~S9sTreeNode();
 
+        S9sTreeNode &operator=(const S9sTreeNode &rhs);
         S9sTreeNode &operator=(const S9sVariantMap &rhs);
 
         S9sVariantMap toVariantMap() const;
@@ -71,22 +79,27 @@ class S9sTreeNode
         int nChildren() const;
         bool hasChild(const S9sString &name);
 
+        bool hasParent() const;
+        S9sTreeNode parent() const;
 
         S9sTreeNode childNode(int idx) const;
 
-        const S9sVector<S9sTreeNode> &childNodes() const;
+        S9sVector<S9sTreeNode> childNodes() const;
 
         bool pathExists(const S9sString &path);
         bool subTree(const S9sString &path, S9sTreeNode &retval) const;
 
+        bool replaceSubTree(
+                const S9sString   &path, 
+                const S9sTreeNode &subTree);
+
+        bool isEqual(const S9sTreeNode &other) const;
+
     private:
-        bool subTree(
-                const S9sVariantList  &pathList,
-                S9sTreeNode           &retval) const;
+        S9sTreeNode(S9sTreeNodePrivate *priv, const int index);
+        const S9sVariant &field(const S9sString &key) const;
 
     private:
-        S9sVariantMap                    m_properties;
-        mutable S9sVector<S9sTreeNode>   m_childNodes;
-        mutable bool                     m_childNodesParsed;
+        S9sTreeNodePrivate    *m_priv;
+        int                    m_index;
 };
-
@@ -0,0 +1,364 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9streenode_p.h"
+
+//#define DEBUG
+//#define WARNING
+#include "s9sdebug.h"
+
+static const S9sString subItemsKey  = "sub_items";
+static const S9sString classNameKey = "class_name";
+static const S9sString itemNameKey  = "item_name";
+static const S9sString itemPathKey  = "item_path";
+
+/**
+ * \returns The value for the given key without copying the map or inserting
+ *   the key, an invalid variant if the key is not in the map.
+ */
+static const S9sVariant &
+field(
+        const S9sVariantMap &theMap,
+        const S9sString     &key)
+{
+    static const S9sVariant invalid;
+    S9sVariantMap::const_iterator it = theMap.find(key);
+
+    if (it == theMap.end())
+        return invalid;
+
+    return it->second;
+}
+
+/**
+ * Creates a tree with only one node (with no properties but the class name).
+ */
+S9sTreeNodePrivate::S9sTreeNodePrivate() :
+    m_referenceCounter(1)
+{
+    build(S9sVariantMap());
+}
+
+/**
+ * \param root The root of the tree as the tree RPC returns it, the children
+ *   are in the "sub_items" list.
+ */
+S9sTreeNodePrivate::S9sTreeNodePrivate(
+        const S9sVariantMap &root) :
+    m_referenceCounter(1)
+{
+    build(root);
+}
+
+/**
+ * \param orig The tree to copy.
+ * \param rootIndex The node of the original tree that will be the root of
+ *   the new tree.
+ * \param replacedIndex The node of the original tree the sub-tree of which is
+ *   replaced.
+ * \param subTree The tree that holds the new sub-tree.
+ * \param subTreeIndex The root of the new sub-tree.
+ *
+ * Creates a copy of a tree with one sub-tree replaced. The trees are not
+ * changed, they might be shared with other nodes.
+ */
+S9sTreeNodePrivate::S9sTreeNodePrivate(
+        const S9sTreeNodePrivate &orig,
+        const int                 rootIndex,
+        const int                 replacedIndex,
+        const S9sTreeNodePrivate &subTree,
+        const int                 subTreeIndex) :
+    m_referenceCounter(1)
+{
+    build(orig, rootIndex, replacedIndex, subTree, subTreeIndex);
+}
+
+S9sTreeNodePrivate::~S9sTreeNodePrivate()
+{
+}
+
+void 
+S9sTreeNodePrivate::ref()
+{
+	++m_referenceCounter;
+}
+
+int 
+S9sTreeNodePrivate::unRef()
+{
+	return --m_referenceCounter;
+}
+
+uint
+S9sTreeNodePrivate::size() const
+{
+    return m_properties.size();
+}
+
+/**
+ * \param parent The index of the parent node.
+ * \param name The name of the child.
+ * \returns The index of the first child of the parent with the given name, -1
+ *   if the parent has no such child.
+ */
+int
+S9sTreeNodePrivate::childIndex(
+        const int        parent,
+        const S9sString &name) const
+{
+    std::unordered_map<std::string, int>::const_iterator it;
+    
+    it = m_childIndex.find(childKey(parent, name));
+    if (it == m_childIndex.end())
+        return -1;
+
+    return it->second;
+}
+
+/**
+ * \returns The name of the node, the root node has no name, its path is used
+ *   instead.
+ */
+S9sString
+S9sTreeNodePrivate::name(
+        const int index) const
+{
+    const S9sVariantMap &properties = m_properties[index];
+    S9sString            retval;
+
+    retval = field(properties, itemNameKey).toString();
+    if (retval.empty())
+        retval = field(properties, itemPathKey).toString();
+
+    return retval;
+}
+
+/**
+ * \returns The node with its whole sub-tree in the form the tree RPC returns
+ *   it.
+ */
+S9sVariantMap
+S9sTreeNodePrivate::toVariantMap(
+        const int index) const
+{
+    S9sVariantMap retval = m_properties[index];
+
+    if (m_nChildren[index] > 0)
+    {
+        S9sVariantList children;
+
+        for (int idx = 0; idx < m_nChildren[index]; ++idx)
+            children << toVariantMap(m_firstChildren[index] + idx);
+
+        retval[subItemsKey] = children;
+    }
+
+    return retval;
+}
+
+/**
+ * \returns True if the sub-tree of the node is the same as the sub-tree of
+ *   the node in the other tree: the nodes have the same properties and the
+ *   same children in the same order.
+ */
+bool
+S9sTreeNodePrivate::isEqual(
+        const int                 index,
+        const S9sTreeNodePrivate &other,
+        const int                 otherIndex) const
+{
+    S9sVector<int> indices;
+    S9sVector<int> otherIndices;
+
+    indices      << index;
+    otherIndices << otherIndex;
+
+    for (uint idx = 0u; idx < indices.size(); ++idx)
+    {
+        int node      = indices[idx];
+        int otherNode = otherIndices[idx];
+
+        if (m_nChildren[node] != other.m_nChildren[otherNode])
+            return false;
+
+        if (m_properties[node] != other.m_properties[otherNode])
+            return false;
+
+        for (int child = 0; child < m_nChildren[node]; ++child)
+        {
+            indices      << m_firstChildren[node] + child;
+            otherIndices << other.m_firstChildren[otherNode] + child;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Builds the flat representation of the tree. The nodes are visited level by
+ * level (breadth first), so the children of every node are appended one after
+ * the other. Every node is copied only once and without its sub-tree, so this
+ * takes linear time and memory.
+ */
+void
+S9sTreeNodePrivate::build(
+        const S9sVariantMap &root)
+{
+    S9sVector<const S9sVariantMap *> sources;
+
+    sources << &root;
+    appendNode(root, -1);
+
+    for (uint index = 0u; index < sources.size(); ++index)
+    {
+        const S9sVariantList &children = 
+            field(*sources[index], subItemsKey).toVariantList();
+
+        m_firstChildren[index] = m_properties.size();
+        m_nChildren[index]     = children.size();
+
+        for (uint idx = 0u; idx < children.size(); ++idx)
+        {
+            const S9sVariantMap &child = children[idx].toVariantMap();
+            int                  childIndex;
+
+            sources << &child;
+            childIndex = appendNode(child, index);
+
+            // If more children have the same name the first one is found.
+            m_childIndex.insert(
+                    std::make_pair(
+                        childKey(index, name(childIndex)), childIndex));
+        }
+    }
+
+    S9S_DEBUG("%u nodes", size());
+}
+
+/**
+ * Builds the tree by copying an other tree and replacing one of its sub-trees
+ * on the way. This is the same breadth first walk as the one that builds the
+ * tree from the reply, only the nodes are taken from the two trees.
+ */
+void
+S9sTreeNodePrivate::build(
+        const S9sTreeNodePrivate &orig,
+        const int                 rootIndex,
+        const int                 replacedIndex,
+        const S9sTreeNodePrivate &subTree,
+        const int                 subTreeIndex)
+{
+    S9sVector<const S9sTreeNodePrivate *> trees;
+    S9sVector<int>                        indices;
+    /** True for the nodes that are copied from the new sub-tree. */
+    S9sVector<bool>                       replaced;
+
+    if (rootIndex == replacedIndex)
+    {
+        trees    << &subTree;
+        indices  << subTreeIndex;
+        replaced << true;
+    } else {
+        trees    << &orig;
+        indices  << rootIndex;
+        replaced << false;
+    }
+
+    appendNode(trees[0]->m_properties[indices[0]], -1);
+
+    for (uint index = 0u; index < trees.size(); ++index)
+    {
+        const S9sTreeNodePrivate *tree  = trees[index];
+        int                       first = tree->m_firstChildren[indices[index]];
+        int                       count = tree->m_nChildren[indices[index]];
+
+        m_firstChildren[index] = m_properties.size();
+        m_nChildren[index]     = count;
+
+        for (int idx = 0; idx < count; ++idx)
+        {
+            const S9sTreeNodePrivate *childTree   = tree;
+            int                       sourceIndex = first + idx;
+            bool                      isReplaced  = replaced[index];
+            int                       childIndex;
+
+            if (!isReplaced && sourceIndex == replacedIndex)
+            {
+                childTree   = &subTree;
+                sourceIndex = subTreeIndex;
+                isReplaced  = true;
+            }
+
+            trees    << childTree;
+            indices  << sourceIndex;
+            replaced << isReplaced;
+
+            childIndex = appendNode(
+                    childTree->m_properties[sourceIndex], index);
+
+            m_childIndex.insert(
+                    std::make_pair(
+                        childKey(index, name(childIndex)), childIndex));
+        }
+    }
+}
+
+/**
+ * Appends one node to the tree, the "sub_items" property is not copied.
+ */
+int
+S9sTreeNodePrivate::appendNode(
+        const S9sVariantMap &properties,
+        const int            parent)
+{
+    S9sVariantMap::const_iterator  it;
+    int                            retval = m_properties.size();
+
+    m_properties.push_back(S9sVariantMap());
+    m_parents       << parent;
+    m_firstChildren << 0;
+    m_nChildren     << 0;
+
+    S9sVariantMap &copy = m_properties.back();
+
+    for (it = properties.begin(); it != properties.end(); ++it)
+    {
+        if (it->first == subItemsKey)
+            continue;
+
+        copy.insert(copy.end(), *it);
+    }
+
+    copy[classNameKey] = "CmonTreeNode";
+
+    return retval;
+}
+
+S9sString
+S9sTreeNodePrivate::childKey(
+        const int        parent,
+        const S9sString &name)
+{
+    S9sString retval;
+
+    retval.sprintf("%d/", parent);
+    retval += name;
+
+    return retval;
+}
@@ -0,0 +1,89 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "s9svariantmap.h"
+#include "s9svector.h"
+
+#include <string>
+#include <unordered_map>
+
+/**
+ * The tree the S9sTreeNode objects are pointing into. Every node of the tree
+ * is stored only once in a flat form: the properties of the node (without the
+ * "sub_items"), the index of the parent and the indices of the children. The
+ * children of a node are stored next to each other, so the node only needs to
+ * know where its first child is and how many children it has.
+ *
+ * The tree is built once and never changed, so it can be shared between all
+ * the nodes that are pointing into it.
+ */
+class S9sTreeNodePrivate
+{
+    public:
+        S9sTreeNodePrivate();
+        S9sTreeNodePrivate(const S9sVariantMap &root);
+        S9sTreeNodePrivate(
+                const S9sTreeNodePrivate &orig,
+                const int                 rootIndex,
+                const int                 replacedIndex,
+                const S9sTreeNodePrivate &subTree,
+                const int                 subTreeIndex);
+
+        ~S9sTreeNodePrivate();
+
+        void ref();
+        int unRef();
+
+        uint size() const;
+        int childIndex(const int parent, const S9sString &name) const;
+        S9sString name(const int index) const;
+        S9sVariantMap toVariantMap(const int index) const;
+
+        bool isEqual(
+                const int                 index,
+                const S9sTreeNodePrivate &other,
+                const int                 otherIndex) const;
+
+    private:
+        void build(const S9sVariantMap &root);
+        void build(
+                const S9sTreeNodePrivate &orig,
+                const int                 rootIndex,
+                const int                 replacedIndex,
+                const S9sTreeNodePrivate &subTree,
+                const int                 subTreeIndex);
+
+        int appendNode(const S9sVariantMap &properties, const int parent);
+        static S9sString childKey(const int parent, const S9sString &name);
+
+    private:
+        int                          m_referenceCounter;
+
+        S9sVector<S9sVariantMap>     m_properties;
+        S9sVector<int>               m_parents;
+        S9sVector<int>               m_firstChildren;
+        S9sVector<int>               m_nChildren;
+
+        /** The index of the child by the parent index and the child name. */
+        std::unordered_map<std::string, int>  m_childIndex;
+
+        friend class S9sTreeNode;
+};
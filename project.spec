@@ -15,6 +15,7 @@ BuildRequires: unzip
 BuildRequires: automake
 BuildRequires: gcc-c++
 BuildRequires: openssl-devel
+BuildRequires: zlib-devel
 BuildRequires: flex
 BuildRequires: gdb
 BuildRequires: sed
@@ -78,6 +78,22 @@ runTest ut_s9sregexp $@
 runTest ut_s9soptions $@
 runTest ut_s9srpcclient $@
 runTest ut_s9sconfigfile $@
+runTest ut_s9sscreenbuffer $@
+runTest ut_s9srecordwriter $@
+runTest ut_s9slogwriter $@
+runTest ut_s9sjobwaiter $@
+runTest ut_s9slogfollower $@
+runTest ut_s9seventcheckpoints $@
+runTest ut_s9seventfilter $@
+runTest ut_s9seventindex $@
+runTest ut_s9seventrecorder $@
+runTest ut_s9seventresume $@
+runTest ut_s9seventring $@
+runTest ut_s9sprocesstable $@
+runTest ut_s9stopfleet $@
+runTest ut_s9streenode $@
+runTest ut_s9sbrowser $@
+runTest ut_s9sstatcache $@
 
 echo
 echo
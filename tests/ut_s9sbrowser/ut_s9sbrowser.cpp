@@ -0,0 +1,227 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9sbrowser.h"
+
+#include "s9sbrowser.h"
+#include "s9sdisplay.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sBrowser::UtS9sBrowser()
+{
+}
+
+UtS9sBrowser::~UtS9sBrowser()
+{
+}
+
+bool
+UtS9sBrowser::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testLineCache,       retval);
+    PERFORM_TEST(testSelectionByName, retval);
+    PERFORM_TEST(testSearch,          retval);
+
+    return retval;
+}
+
+/**
+ * The formatted lines are kept until the items or the width change and only
+ * the lines around the visible part of the list are kept.
+ */
+bool
+UtS9sBrowser::testLineCache()
+{
+    S9sDisplayList list;
+    S9sString      line;
+
+    list.setSize(80, 12);
+    list.setNumberOfItems(100);
+    S9S_COMPARE(list.listHeight(), 12);
+    S9S_VERIFY(!list.cachedLine(0, line));
+
+    list.setCachedLine(0, "line0");
+    list.setCachedLine(10, "line10");
+    S9S_VERIFY(list.cachedLine(0, line));
+    S9S_COMPARE(line, "line0");
+    S9S_VERIFY(list.cachedLine(10, line));
+    S9S_COMPARE(line, "line10");
+
+    // New items at the end do not change the lines we have.
+    list.setNumberOfItems(200);
+    S9S_VERIFY(list.cachedLine(10, line));
+
+    // Removed items are dropped.
+    list.setNumberOfItems(5);
+    S9S_VERIFY(list.cachedLine(0, line));
+    S9S_VERIFY(!list.cachedLine(10, line));
+
+    // The width changes the format.
+    list.setSize(100, 12);
+    S9S_VERIFY(!list.cachedLine(0, line));
+    list.setCachedLine(0, "line0");
+    S9S_VERIFY(list.cachedLine(0, line));
+
+    list.invalidateLines();
+    S9S_VERIFY(!list.cachedLine(0, line));
+
+    // Scrolling away drops the invisible lines.
+    list.setNumberOfItems(1000);
+    for (int idx = 0; idx < 12; ++idx)
+        list.setCachedLine(idx, "line");
+
+    list.setSelectionIndex(500);
+    list.ensureSelectionVisible();
+    for (int idx = 480; idx <= 500; ++idx)
+        list.setCachedLine(idx, "line");
+
+    S9S_VERIFY(!list.cachedLine(0, line));
+    S9S_VERIFY(list.cachedLine(500, line));
+
+    return true;
+}
+
+bool
+UtS9sBrowser::testSelectionByName()
+{
+    S9sBrowser browser;
+
+    browser.setCdt(createFolder(1000));
+    S9S_COMPARE(browser.numberOfItems(), 1000);
+
+    browser.setSelectionIndexByName("file0500");
+    S9S_COMPARE(browser.selectionIndex(), 500);
+    S9S_COMPARE(browser.selectedNode().name(), "file0500");
+
+    browser.setSelectionIndexByName("nosuchfile");
+    S9S_COMPARE(browser.selectionIndex(), 0);
+
+    return true;
+}
+
+/**
+ * Typing a name after the '/' key moves the selection to the first entry
+ * starting with the typed characters.
+ */
+bool
+UtS9sBrowser::testSearch()
+{
+    S9sBrowser browser;
+
+    browser.setCdt(createFolder(20000));
+    browser.setSize(80, 24);
+    browser.setHasFocus(true);
+    S9S_VERIFY(!browser.isSearching());
+    
+    browser.processKey('/');
+    S9S_VERIFY(browser.isSearching());
+
+    browser.processKey('f');
+    S9S_COMPARE(browser.selectionIndex(), 0);
+
+    browser.processKey('i');
+    browser.processKey('l');
+    browser.processKey('e');
+    browser.processKey('1');
+    browser.processKey('2');
+    browser.processKey('3');
+    S9S_COMPARE(browser.selectionIndex(), 12300);
+    
+    browser.processKey('4');
+    browser.processKey('5');
+    S9S_COMPARE(browser.selectionIndex(), 12345);
+
+    // No match, the selection stays.
+    browser.processKey('x');
+    S9S_COMPARE(browser.selectionIndex(), 12345);
+
+    browser.processKey(S9S_KEY_BACKSPACE);
+    browser.processKey(S9S_KEY_BACKSPACE);
+    S9S_COMPARE(browser.selectionIndex(), 12340);
+
+    // The index is also used when selecting by name.
+    browser.setSelectionIndexByName("file19999");
+    S9S_COMPARE(browser.selectionIndex(), 19999);
+    
+    browser.processKey(S9S_KEY_ENTER);
+    S9S_VERIFY(!browser.isSearching());
+    S9S_VERIFY(browser.activatedNodeFullPath().empty());
+
+    // Other keys end the search and are processed as usual.
+    browser.processKey('/');
+    S9S_VERIFY(browser.processSearchKey('f'));
+    S9S_VERIFY(!browser.processSearchKey(S9S_KEY_F10));
+    S9S_VERIFY(!browser.isSearching());
+
+    // A new list, a new index.
+    browser.setCdt(createFolder(10));
+    browser.processKey('/');
+    browser.processKey('f');
+    browser.processKey('i');
+    browser.processKey('l');
+    browser.processKey('e');
+    browser.processKey('0');
+    browser.processKey('0');
+    browser.processKey('0');
+    browser.processKey('9');
+    S9S_COMPARE(browser.selectionIndex(), 9);
+
+    return true;
+}
+
+/**
+ * \returns A tree with one folder in the root holding the given number of
+ *   files with zero padded names, so the alphabetical order is the same as the
+ *   order of the files.
+ */
+S9sVariantMap
+UtS9sBrowser::createFolder(
+        const int nEntries)
+{
+    S9sVariantList files;
+    S9sVariantMap  root;
+    S9sString      format;
+
+    format.sprintf("file%%0%dd", nEntries >= 10000 ? 5 : 4);
+
+    for (int idx = 0; idx < nEntries; ++idx)
+    {
+        S9sVariantMap file;
+        S9sString     name;
+
+        name.sprintf(STR(format), idx);
+
+        file["item_path"] = "/";
+        file["item_name"] = name;
+        file["item_type"] = "File";
+        files << file;
+    }
+
+    root["item_path"] = "/";
+    root["item_type"] = "Folder";
+    root["sub_items"] = files;
+
+    return root;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sBrowser)
@@ -0,0 +1,405 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9seventcheckpoints.h"
+
+#include "s9seventcheckpoints.h"
+#include "s9seventrecorder.h"
+#include "s9seventindex.h"
+#include "s9sevent.h"
+#include "s9sdatetime.h"
+#include "s9sfile.h"
+#include "s9svariantmap.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+/*
+ * The recording has one event every second, every event is about one of the
+ * ten hosts.
+ */
+#define N_EVENTS 3000
+#define N_HOSTS  10
+
+UtS9sEventCheckpoints::UtS9sEventCheckpoints() :
+    m_startTime(1700000000)
+{
+    m_recordingPath.sprintf("/tmp/ut_s9seventcheckpoints_%d.json", getpid());
+}
+
+UtS9sEventCheckpoints::~UtS9sEventCheckpoints()
+{
+    unlink(STR(m_recordingPath));
+    unlink(STR(S9sEventIndex::indexFileName(m_recordingPath)));
+    unlink(STR(S9sEventCheckpoints::checkpointFileName(m_recordingPath)));
+}
+
+bool
+UtS9sEventCheckpoints::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testSnapshot,      retval);
+    PERFORM_TEST(testBuild,         retval);
+    PERFORM_TEST(testRecorder,      retval);
+    PERFORM_TEST(testAppend,        retval);
+    PERFORM_TEST(testAppendNoCheckpoints, retval);
+    PERFORM_TEST(testPruneJobs,     retval);
+
+    return retval;
+}
+
+/**
+ * The objects saved into a snapshot and restored from it.
+ */
+bool
+UtS9sEventCheckpoints::testSnapshot()
+{
+    S9sMap<int, S9sCluster>       clusters;
+    S9sMap<int, S9sNode>          nodes;
+    S9sMap<int, S9sJob>           jobs;
+    S9sMap<S9sString, S9sServer>  servers;
+    S9sVariantMap                 snapshot;
+
+    for (int idx = 0; idx < 25; ++idx)
+    {
+        S9sEventCheckpoints::applyEvent(
+                createEvent(idx), clusters, nodes, jobs, servers);
+    }
+
+    S9S_COMPARE((int) nodes.size(), N_HOSTS);
+    S9S_COMPARE(nodes[5].property("counter").toInt(), 24);
+
+    snapshot = S9sEventCheckpoints::snapshot(clusters, nodes, jobs, servers);
+    nodes.clear();
+
+    S9S_VERIFY(snapshot.parse(STR(snapshot.toString())));
+    S9sEventCheckpoints::restore(snapshot, clusters, nodes, jobs, servers);
+    S9S_COMPARE((int) nodes.size(), N_HOSTS);
+    S9S_COMPARE(nodes[5].hostName(), "host5");
+    S9S_COMPARE(nodes[5].property("counter").toInt(), 24);
+    S9S_COMPARE(nodes[1].property("counter").toInt(), 20);
+    S9S_VERIFY(clusters.empty());
+
+    return true;
+}
+
+/**
+ * Building the checkpoints for a recording, then restoring the state at a
+ * given time from a checkpoint and the events after it. The result must be
+ * the same as what processing all the events gives.
+ */
+bool
+UtS9sEventCheckpoints::testBuild()
+{
+    S9sEventCheckpoints   checkpoints(100, 100000);
+    S9sEventCheckpoints   loaded;
+    S9sMap<int, S9sNode>  fromCheckpoint;
+    S9sMap<int, S9sNode>  fromStart;
+    S9sMap<int, S9sCluster>       clusters;
+    S9sMap<int, S9sJob>           jobs;
+    S9sMap<S9sString, S9sServer>  servers;
+    S9sVariantMap         snapshot;
+    time_t                target = m_startTime + 1555;
+    int                   index;
+
+    S9S_VERIFY(createRecording(N_EVENTS));
+    S9S_VERIFY(checkpoints.build(m_recordingPath));
+    S9S_COMPARE((int) checkpoints.size(), N_EVENTS / 100);
+
+    S9S_VERIFY(loaded.load(
+                S9sEventCheckpoints::checkpointFileName(m_recordingPath)));
+    S9S_COMPARE((int) loaded.size(), N_EVENTS / 100);
+    S9S_VERIFY(loaded.find(m_startTime) < 0);
+
+    index = loaded.find(target);
+    S9S_COMPARE(index, 14);
+    S9S_VERIFY(loaded.created(index) < target);
+
+    S9S_VERIFY(loaded.read(index, snapshot));
+    S9sEventCheckpoints::restore(
+            snapshot, clusters, fromCheckpoint, jobs, servers);
+
+    S9S_VERIFY(replayNodes(loaded.offset(index), target, fromCheckpoint));
+    S9S_VERIFY(replayNodes(0, target, fromStart));
+
+    S9S_COMPARE((int) fromCheckpoint.size(), N_HOSTS);
+    for (int hostId = 1; hostId <= N_HOSTS; ++hostId)
+    {
+        S9S_COMPARE(
+                fromCheckpoint[hostId].property("counter").toInt(),
+                fromStart[hostId].property("counter").toInt());
+    }
+
+    return true;
+}
+
+/**
+ * The recorder takes the checkpoints while recording, they point to the
+ * event after the one processed last.
+ */
+bool
+UtS9sEventCheckpoints::testRecorder()
+{
+    S9sEventRecorder     recorder;
+    S9sEventCheckpoints  checkpoints;
+    S9sString            path;
+    S9sFile              file;
+    S9sEvent             event;
+
+    path.sprintf("/tmp/ut_s9seventcheckpoints_rec_%d.json", getpid());
+    S9S_VERIFY(recorder.open(path));
+
+    for (int idx = 0; idx < N_EVENTS; ++idx)
+        S9S_VERIFY(recorder.record(createEvent(idx)));
+
+    recorder.close();
+
+    S9S_VERIFY(checkpoints.load(
+                S9sEventCheckpoints::checkpointFileName(path)));
+    S9S_VERIFY(checkpoints.size() > 0u);
+
+    file = S9sFile(path);
+    S9S_VERIFY(file.seek(checkpoints.offset(0)));
+    S9S_VERIFY(file.readEvent(event));
+    S9S_COMPARE(
+            (int) event.created().toTimeT(), 
+            (int) checkpoints.created(0) + 1);
+
+    unlink(STR(path));
+    unlink(STR(S9sEventIndex::indexFileName(path)));
+    unlink(STR(S9sEventCheckpoints::checkpointFileName(path)));
+
+    return true;
+}
+
+/**
+ * Recording again into an existing file, the checkpoints taken in the new
+ * session have the objects of the earlier session too.
+ */
+bool
+UtS9sEventCheckpoints::testAppend()
+{
+    S9sEventRecorder              recorder;
+    S9sEventCheckpoints           checkpoints;
+    S9sMap<int, S9sCluster>       clusters;
+    S9sMap<int, S9sNode>          nodes;
+    S9sMap<int, S9sJob>           jobs;
+    S9sMap<S9sString, S9sServer>  servers;
+    S9sVariantMap                 snapshot;
+    S9sString                     path;
+    uint                          nCheckpoints;
+
+    path.sprintf("/tmp/ut_s9seventcheckpoints_app_%d.json", getpid());
+    
+    // The first session ends with events after the last checkpoint.
+    S9S_VERIFY(recorder.open(path));
+    for (int idx = 0; idx < 1500; ++idx)
+        S9S_VERIFY(recorder.record(createEvent(idx)));
+
+    recorder.close();
+    S9S_VERIFY(checkpoints.load(
+                S9sEventCheckpoints::checkpointFileName(path)));
+
+    nCheckpoints = checkpoints.size();
+    S9S_VERIFY(nCheckpoints > 0u);
+    S9S_VERIFY(checkpoints.created(nCheckpoints - 1) < m_startTime + 1499);
+
+    // The second session has events only about a new host.
+    S9S_VERIFY(recorder.open(path));
+    for (int idx = 1500; idx < 2500; ++idx)
+        S9S_VERIFY(recorder.record(createEvent(idx, N_HOSTS + 1)));
+
+    recorder.close();
+    S9S_VERIFY(checkpoints.load(
+                S9sEventCheckpoints::checkpointFileName(path)));
+    S9S_VERIFY(checkpoints.size() > nCheckpoints);
+
+    S9S_VERIFY(checkpoints.read(checkpoints.size() - 1, snapshot));
+    S9sEventCheckpoints::restore(snapshot, clusters, nodes, jobs, servers);
+    S9S_COMPARE((int) nodes.size(), N_HOSTS + 1);
+    S9S_COMPARE(nodes[1].property("counter").toInt(), 1490);
+    S9S_VERIFY(nodes[N_HOSTS + 1].property("counter").toInt() >= 1500);
+
+    unlink(STR(path));
+    unlink(STR(S9sEventIndex::indexFileName(path)));
+    unlink(STR(S9sEventCheckpoints::checkpointFileName(path)));
+
+    return true;
+}
+
+/**
+ * Appending a recording that has no checkpoint file: the checkpoints are
+ * built from the recording, so the later ones have the objects of the events
+ * recorded before.
+ */
+bool
+UtS9sEventCheckpoints::testAppendNoCheckpoints()
+{
+    S9sEventRecorder              recorder;
+    S9sEventCheckpoints           checkpoints;
+    S9sMap<int, S9sCluster>       clusters;
+    S9sMap<int, S9sNode>          nodes;
+    S9sMap<int, S9sJob>           jobs;
+    S9sMap<S9sString, S9sServer>  servers;
+    S9sVariantMap                 snapshot;
+    S9sString                     path;
+
+    path.sprintf("/tmp/ut_s9seventcheckpoints_nockp_%d.json", getpid());
+    
+    S9S_VERIFY(recorder.open(path));
+    for (int idx = 0; idx < 1500; ++idx)
+        S9S_VERIFY(recorder.record(createEvent(idx)));
+
+    recorder.close();
+    unlink(STR(S9sEventCheckpoints::checkpointFileName(path)));
+
+    S9S_VERIFY(recorder.open(path));
+    for (int idx = 1500; idx < 2500; ++idx)
+        S9S_VERIFY(recorder.record(createEvent(idx, N_HOSTS + 1)));
+
+    recorder.close();
+    S9S_VERIFY(checkpoints.load(
+                S9sEventCheckpoints::checkpointFileName(path)));
+    S9S_VERIFY(checkpoints.size() > 0u);
+
+    S9S_VERIFY(checkpoints.read(checkpoints.size() - 1, snapshot));
+    S9sEventCheckpoints::restore(snapshot, clusters, nodes, jobs, servers);
+    S9S_COMPARE((int) nodes.size(), N_HOSTS + 1);
+    S9S_COMPARE(nodes[1].property("counter").toInt(), 1490);
+
+    unlink(STR(path));
+    unlink(STR(S9sEventIndex::indexFileName(path)));
+    unlink(STR(S9sEventCheckpoints::checkpointFileName(path)));
+
+    return true;
+}
+
+/**
+ * Only the last finished jobs are kept, the running jobs are all kept.
+ */
+bool
+UtS9sEventCheckpoints::testPruneJobs()
+{
+    S9sMap<int, S9sJob> jobs;
+    int                 nFinished = S9sEventCheckpoints::maxFinishedJobs + 50;
+
+    for (int idx = 1; idx <= nFinished + 5; ++idx)
+    {
+        S9sVariantMap job;
+
+        job["job_id"] = idx;
+        job["status"] = idx == 1 || idx > nFinished ? "RUNNING" : "FINISHED";
+        jobs[idx] = S9sJob(job);
+    }
+
+    S9sEventCheckpoints::pruneJobs(jobs);
+    S9S_COMPARE(
+            (int) jobs.size(), 
+            (int) S9sEventCheckpoints::maxFinishedJobs + 6);
+    S9S_VERIFY(jobs.contains(1));
+    S9S_VERIFY(!jobs.contains(2));
+    S9S_VERIFY(jobs.contains(nFinished));
+    S9S_VERIFY(jobs.contains(nFinished + 5));
+
+    return true;
+}
+
+S9sEvent
+UtS9sEventCheckpoints::createEvent(
+        int idx,
+        int hostId)
+{
+    S9sVariantMap event;
+    S9sVariantMap origins;
+    S9sVariantMap specifics;
+    S9sVariantMap host;
+    S9sString     hostName;
+
+    if (hostId <= 0)
+        hostId = idx % N_HOSTS + 1;
+
+    hostName.sprintf("host%d", hostId);
+
+    origins["tv_sec"]        = (ulonglong) (m_startTime + idx);
+    origins["tv_nsec"]       = 0;
+
+    host["class_name"]       = "CmonHost";
+    host["hostId"]           = hostId;
+    host["hostname"]         = hostName;
+    host["counter"]          = idx;
+    specifics["host"]        = host;
+
+    event["class_name"]      = "CmonEvent";
+    event["event_class"]     = "EventHost";
+    event["event_name"]      = "Changed";
+    event["event_origins"]   = origins;
+    event["event_specifics"] = specifics;
+
+    return S9sEvent(event);
+}
+
+bool
+UtS9sEventCheckpoints::createRecording(
+        int nEvents)
+{
+    FILE *stream = fopen(STR(m_recordingPath), "w");
+
+    if (stream == NULL)
+        return false;
+
+    for (int idx = 0; idx < nEvents; ++idx)
+        fprintf(stream, "%s\n\n", STR(createEvent(idx).toString()));
+
+    fclose(stream);
+    return true;
+}
+
+/**
+ * Processes the events of the recording from the given offset up to the
+ * target time.
+ */
+bool
+UtS9sEventCheckpoints::replayNodes(
+        const off_t           offset,
+        const time_t          target,
+        S9sMap<int, S9sNode> &nodes)
+{
+    S9sFile                       file(m_recordingPath);
+    S9sEvent                      event;
+    S9sMap<int, S9sCluster>       clusters;
+    S9sMap<int, S9sJob>           jobs;
+    S9sMap<S9sString, S9sServer>  servers;
+
+    if (!file.seek(offset))
+        return false;
+
+    while (file.readEvent(event) && event.created().toTimeT() < target)
+    {
+        S9sEventCheckpoints::applyEvent(
+                event, clusters, nodes, jobs, servers);
+    }
+
+    return true;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sEventCheckpoints)
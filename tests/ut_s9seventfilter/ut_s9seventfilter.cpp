@@ -0,0 +1,274 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9seventfilter.h"
+
+#include "s9seventfilter.h"
+#include "s9sevent.h"
+#include "s9scluster.h"
+#include "s9svariantmap.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sEventFilter::UtS9sEventFilter()
+{
+}
+
+UtS9sEventFilter::~UtS9sEventFilter()
+{
+}
+
+bool
+UtS9sEventFilter::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testEmpty,         retval);
+    PERFORM_TEST(testClassAndName,  retval);
+    PERFORM_TEST(testClusterId,     retval);
+    PERFORM_TEST(testHostPattern,   retval);
+    PERFORM_TEST(testUndecided,     retval);
+    PERFORM_TEST(testVariantMap,    retval);
+
+    return retval;
+}
+
+/**
+ * The filter without conditions accepts everything.
+ */
+bool
+UtS9sEventFilter::testEmpty()
+{
+    S9sEventFilter filter;
+    S9sEvent       event = createEvent("EventJob", "Created", 1, "");
+
+    S9S_VERIFY(filter.empty());
+    S9S_VERIFY(filter.acceptsRaw(event.toString()));
+    S9S_VERIFY(filter.acceptsRaw("garbage"));
+    S9S_VERIFY(filter.accepts(event));
+
+    filter.setClusterId(0);
+    S9S_VERIFY(!filter.empty());
+
+    filter.clear();
+    S9S_VERIFY(filter.empty());
+
+    return true;
+}
+
+/**
+ * Filtering by the event class and the event name, both on the raw record and
+ * on the parsed event.
+ */
+bool
+UtS9sEventFilter::testClassAndName()
+{
+    S9sEventFilter filter;
+    S9sEvent       jobCreated = createEvent("EventJob", "Created", 1, "");
+    S9sEvent       jobEnded   = createEvent("EventJob", "Ended", 1, "");
+    S9sEvent       logMessage = createEvent("EventLog", "LogMessage", 1, "");
+
+    filter.enableClass("EventJob");
+    S9S_VERIFY(filter.acceptsRaw(jobCreated.toString()));
+    S9S_VERIFY(filter.acceptsRaw(jobEnded.toString()));
+    S9S_VERIFY(!filter.acceptsRaw(logMessage.toString()));
+    S9S_VERIFY(filter.accepts(jobCreated));
+    S9S_VERIFY(!filter.accepts(logMessage));
+
+    filter.disableName("Ended");
+    S9S_VERIFY(filter.acceptsRaw(jobCreated.toString()));
+    S9S_VERIFY(!filter.acceptsRaw(jobEnded.toString()));
+    S9S_VERIFY(!filter.accepts(jobEnded));
+
+    filter.clear();
+    filter.enableName("LogMessage");
+    S9S_VERIFY(!filter.acceptsRaw(jobCreated.toString()));
+    S9S_VERIFY(filter.acceptsRaw(logMessage.toString()));
+    S9S_VERIFY(filter.accepts(logMessage));
+
+    // The compact form as the controller sends it.
+    S9S_VERIFY(!filter.acceptsRaw(
+            "{\"class_name\":\"CmonEvent\",\"event_class\":\"EventJob\","
+            "\"event_name\":\"Created\"}"));
+    
+    S9S_VERIFY(filter.acceptsRaw(
+            "{\"class_name\":\"CmonEvent\",\"event_class\":\"EventLog\","
+            "\"event_name\":\"LogMessage\"}"));
+
+    return true;
+}
+
+/**
+ * The cluster ID is checked in event_specifics, the cluster IDs deeper in the
+ * event (e.g. in the job) are not mistaken for it.
+ */
+bool
+UtS9sEventFilter::testClusterId()
+{
+    S9sEventFilter filter;
+    S9sString      record;
+
+    filter.setClusterId(5);
+    S9S_VERIFY(filter.acceptsRaw(
+                createEvent("EventJob", "Created", 5, "").toString()));
+    S9S_VERIFY(!filter.acceptsRaw(
+                createEvent("EventJob", "Created", 3, "").toString()));
+    S9S_VERIFY(filter.accepts(createEvent("EventJob", "Created", 5, "")));
+    S9S_VERIFY(!filter.accepts(createEvent("EventJob", "Created", 3, "")));
+
+    record = 
+        "{\"event_class\":\"EventJob\",\"event_specifics\":"
+        "{\"job\":{\"cluster_id\":5,\"tags\":[1,2]},\"cluster_id\":3}}";
+    S9S_VERIFY(!filter.acceptsRaw(record));
+    
+    record = 
+        "{\"event_class\":\"EventJob\",\"event_specifics\":"
+        "{\"job\":{\"cluster_id\":3},\"cluster_id\":5}}";
+    S9S_VERIFY(filter.acceptsRaw(record));
+    
+    // The controller itself is cluster 0, that is a valid filter too.
+    filter.setClusterId(0);
+    S9S_VERIFY(filter.acceptsRaw(
+                createEvent("EventJob", "Created", 0, "").toString()));
+    S9S_VERIFY(!filter.acceptsRaw(
+                createEvent("EventJob", "Created", 5, "").toString()));
+
+    return true;
+}
+
+/**
+ * Filtering by the name of the host the event is about.
+ */
+bool
+UtS9sEventFilter::testHostPattern()
+{
+    S9sEventFilter filter;
+    S9sEvent       event1 = createEvent("EventHost", "Changed", 1, "db1");
+    S9sEvent       event2 = createEvent("EventHost", "Changed", 1, "web1");
+    S9sEvent       event3 = createEvent("EventJob", "Changed", 1, "");
+
+    filter.setHostPattern("db*");
+    S9S_VERIFY(filter.acceptsRaw(event1.toString()));
+    S9S_VERIFY(!filter.acceptsRaw(event2.toString()));
+    S9S_VERIFY(filter.accepts(event1));
+    S9S_VERIFY(!filter.accepts(event2));
+
+    // No host in the event: only the parsed event can be rejected.
+    S9S_VERIFY(filter.acceptsRaw(event3.toString()));
+    S9S_VERIFY(!filter.accepts(event3));
+
+    return true;
+}
+
+/**
+ * The raw check only rejects what it is sure about.
+ */
+bool
+UtS9sEventFilter::testUndecided()
+{
+    S9sEventFilter filter;
+
+    filter.enableClass("EventJob");
+    filter.setClusterId(1);
+
+    // Not an event, e.g. the reply to the subscribe request.
+    S9S_VERIFY(filter.acceptsRaw(
+            "{\"class_name\":\"CmonRpcReply\",\"request_status\":\"Ok\"}"));
+
+    // Escape sequences in the value.
+    S9S_VERIFY(filter.acceptsRaw("{\"event_class\":\"Event\\u004cog\"}"));
+
+    // Truncated record.
+    S9S_VERIFY(filter.acceptsRaw("{\"event_class\":\"EventL"));
+
+    // The same key deeper in the event is not the event class.
+    S9S_VERIFY(filter.acceptsRaw(
+            "{\"event_specifics\":{\"event_class\":\"EventLog\"}}"));
+    
+    // Strings with brackets and quotes do not confuse the nesting.
+    S9S_VERIFY(!filter.acceptsRaw(
+            "{\"message\":\"a { \\\" [ b\",\"event_class\":\"EventLog\"}"));
+
+    return true;
+}
+
+/**
+ * The form the filter is sent to the controller.
+ */
+bool
+UtS9sEventFilter::testVariantMap()
+{
+    S9sEventFilter filter;
+    S9sVariantMap  theMap;
+
+    S9S_VERIFY(filter.toVariantMap().empty());
+
+    filter.enableClass("EventJob");
+    filter.enableClass("EventJob");
+    filter.disableName("Ended");
+    filter.setClusterId(5);
+    filter.setHostPattern("db*");
+    
+    theMap = filter.toVariantMap();
+    S9S_COMPARE((int) theMap["event_classes"].toVariantList().size(), 1);
+    S9S_COMPARE(theMap["event_classes"][0].toString(), "EventJob");
+    S9S_COMPARE(theMap["disabled_event_names"][0].toString(), "Ended");
+    S9S_VERIFY(!theMap.contains("event_names"));
+    S9S_COMPARE(theMap["cluster_id"].toInt(), 5);
+    S9S_COMPARE(theMap["host_pattern"].toString(), "db*");
+
+    return true;
+}
+
+S9sEvent
+UtS9sEventFilter::createEvent(
+        const S9sString &eventClass,
+        const S9sString &eventName,
+        int              clusterId,
+        const S9sString &hostName)
+{
+    S9sVariantMap event;
+    S9sVariantMap specifics;
+    S9sVariantMap job;
+
+    job["class_name"]        = "CmonJobInstance";
+    job["cluster_id"]        = clusterId + 100;
+
+    specifics["job"]         = job;
+    specifics["cluster_id"]  = clusterId;
+
+    if (!hostName.empty())
+    {
+        S9sVariantMap host;
+
+        host["class_name"]   = "CmonHost";
+        host["hostname"]     = hostName;
+        specifics["host"]    = host;
+    }
+
+    event["class_name"]      = "CmonEvent";
+    event["event_class"]     = eventClass;
+    event["event_name"]      = eventName;
+    event["event_specifics"] = specifics;
+
+    return S9sEvent(event);
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sEventFilter)
@@ -0,0 +1,215 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9seventindex.h"
+
+#include "s9seventindex.h"
+#include "s9sevent.h"
+#include "s9sdatetime.h"
+#include "s9sfile.h"
+#include "s9svariantmap.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+/*
+ * The recording has one event every second.
+ */
+#define N_EVENTS 1000
+
+UtS9sEventIndex::UtS9sEventIndex() :
+    m_startTime(1700000000)
+{
+    m_recordingPath.sprintf("/tmp/ut_s9seventindex_%d.json", getpid());
+}
+
+UtS9sEventIndex::~UtS9sEventIndex()
+{
+    unlink(STR(m_recordingPath));
+    unlink(STR(S9sEventIndex::indexFileName(m_recordingPath)));
+}
+
+bool
+UtS9sEventIndex::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testParseSeek,     retval);
+    PERFORM_TEST(testFind,          retval);
+    PERFORM_TEST(testBuild,         retval);
+    PERFORM_TEST(testSaveLoad,      retval);
+
+    return retval;
+}
+
+/**
+ * The relative and the absolute forms of the --seek option.
+ */
+bool
+UtS9sEventIndex::testParseSeek()
+{
+    bool   relative;
+    time_t seconds;
+
+    S9S_VERIFY(S9sEventIndex::parseSeek("+90", relative, seconds));
+    S9S_VERIFY(relative);
+    S9S_COMPARE((int) seconds, 90);
+
+    S9S_VERIFY(S9sEventIndex::parseSeek("+12:30", relative, seconds));
+    S9S_COMPARE((int) seconds, 750);
+
+    S9S_VERIFY(S9sEventIndex::parseSeek("+1:00:05", relative, seconds));
+    S9S_COMPARE((int) seconds, 3605);
+
+    S9S_VERIFY(!S9sEventIndex::parseSeek("+1:75", relative, seconds));
+    S9S_VERIFY(!S9sEventIndex::parseSeek("+abc", relative, seconds));
+    S9S_VERIFY(!S9sEventIndex::parseSeek("yesterday", relative, seconds));
+
+    S9S_VERIFY(S9sEventIndex::parseSeek(
+                "2024-05-01T10:00:00.000Z", relative, seconds));
+    S9S_VERIFY(!relative);
+    S9S_VERIFY(seconds > 0);
+
+    return true;
+}
+
+/**
+ * The index is sparse, the binary search returns the last indexed event at
+ * or before the target.
+ */
+bool
+UtS9sEventIndex::testFind()
+{
+    S9sEventIndex index(10);
+
+    for (int idx = 0; idx < 100; ++idx)
+        index.add(1000 + idx, idx * 100);
+
+    S9S_COMPARE((int) index.size(), 10);
+    S9S_COMPARE((int) index.firstTime(), 1000);
+    S9S_COMPARE((int) index.lastTime(), 1090);
+
+    S9S_COMPARE((int) index.find(500),  0);
+    S9S_COMPARE((int) index.find(1000), 0);
+    S9S_COMPARE((int) index.find(1015), 1000);
+    S9S_COMPARE((int) index.find(1020), 2000);
+    S9S_COMPARE((int) index.find(5000), 9000);
+
+    return true;
+}
+
+/**
+ * Building the index for a recording and reading the recording from the
+ * offset found.
+ */
+bool
+UtS9sEventIndex::testBuild()
+{
+    S9sEventIndex index;
+    S9sFile       file(m_recordingPath);
+    S9sEvent      event;
+    time_t        target = m_startTime + 555;
+    time_t        created;
+
+    S9S_VERIFY(createRecording(N_EVENTS));
+    S9S_VERIFY(index.build(m_recordingPath));
+    S9S_COMPARE((int) index.size(), N_EVENTS / 10);
+    S9S_COMPARE((int) index.firstTime(), (int) m_startTime);
+
+    S9S_VERIFY(file.seek(index.find(target)));
+    S9S_VERIFY(file.readEvent(event));
+
+    created = event.created().toTimeT();
+    S9S_VERIFY(created <= target);
+    S9S_VERIFY(created > target - index.interval());
+
+    return true;
+}
+
+/**
+ * The index saved and loaded back is the same, an index that does not match
+ * the recording is rebuilt.
+ */
+bool
+UtS9sEventIndex::testSaveLoad()
+{
+    S9sString     indexPath = S9sEventIndex::indexFileName(m_recordingPath);
+    S9sEventIndex index;
+    S9sEventIndex loaded;
+    S9sFile       file(indexPath);
+
+    S9S_VERIFY(createRecording(N_EVENTS));
+    S9S_VERIFY(index.build(m_recordingPath));
+    S9S_VERIFY(index.save(indexPath));
+
+    S9S_VERIFY(loaded.load(indexPath));
+    S9S_COMPARE((int) loaded.size(), (int) index.size());
+    S9S_COMPARE((int) loaded.lastOffset(), (int) index.lastOffset());
+    S9S_COMPARE((int) loaded.find(m_startTime + 333), 
+            (int) index.find(m_startTime + 333));
+
+    // A broken index is not loaded, it is built again.
+    S9S_VERIFY(file.writeTxtFile("garbage\n"));
+    S9S_VERIFY(!loaded.load(indexPath));
+    S9S_VERIFY(loaded.loadOrBuild(m_recordingPath));
+    S9S_COMPARE((int) loaded.size(), (int) index.size());
+    S9S_VERIFY(loaded.load(indexPath));
+
+    return true;
+}
+
+/**
+ * Creates a recording the way "s9s event --output-file" does.
+ */
+bool
+UtS9sEventIndex::createRecording(
+        int nEvents)
+{
+    FILE *stream = fopen(STR(m_recordingPath), "w");
+
+    if (stream == NULL)
+        return false;
+
+    for (int idx = 0; idx < nEvents; ++idx)
+    {
+        S9sVariantMap event;
+        S9sVariantMap origins;
+        S9sVariantMap specifics;
+
+        origins["tv_sec"]        = (ulonglong) (m_startTime + idx);
+        origins["tv_nsec"]       = 0;
+        specifics["message"]     = "Something happened.";
+
+        event["class_name"]      = "CmonEvent";
+        event["event_class"]     = "EventLog";
+        event["event_name"]      = "LogMessage";
+        event["event_origins"]   = origins;
+        event["event_specifics"] = specifics;
+
+        fprintf(stream, "%s\n\n", STR(event.toString()));
+    }
+
+    fclose(stream);
+    return true;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sEventIndex)
@@ -0,0 +1,296 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9seventrecorder.h"
+
+#include "s9seventrecorder.h"
+#include "s9seventindex.h"
+#include "s9seventcheckpoints.h"
+#include "s9sevent.h"
+#include "s9sdatetime.h"
+#include "s9sfile.h"
+#include "s9svariantmap.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+/*
+ * The recording has one event every second.
+ */
+#define N_EVENTS 300
+
+UtS9sEventRecorder::UtS9sEventRecorder() :
+    m_startTime(1700000000)
+{
+}
+
+UtS9sEventRecorder::~UtS9sEventRecorder()
+{
+}
+
+bool
+UtS9sEventRecorder::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testSyncPolicy,    retval);
+    PERFORM_TEST(testRecord,        retval);
+    PERFORM_TEST(testDrops,         retval);
+    PERFORM_TEST(testCompressed,    retval);
+    PERFORM_TEST(testAppend,        retval);
+
+    return retval;
+}
+
+/**
+ * The values of the --output-fsync option.
+ */
+bool
+UtS9sEventRecorder::testSyncPolicy()
+{
+    int seconds;
+
+    S9S_VERIFY(S9sEventRecorder::parseSyncPolicy("never", seconds));
+    S9S_COMPARE(seconds, (int) S9sEventRecorder::SyncNever);
+
+    S9S_VERIFY(S9sEventRecorder::parseSyncPolicy("batch", seconds));
+    S9S_COMPARE(seconds, (int) S9sEventRecorder::SyncBatch);
+    
+    S9S_VERIFY(S9sEventRecorder::parseSyncPolicy("5", seconds));
+    S9S_COMPARE(seconds, 5);
+
+    S9S_VERIFY(!S9sEventRecorder::parseSyncPolicy("0", seconds));
+    S9S_VERIFY(!S9sEventRecorder::parseSyncPolicy("always", seconds));
+    S9S_VERIFY(!S9sEventRecorder::parseSyncPolicy("", seconds));
+
+    return true;
+}
+
+/**
+ * Records the events through the writer thread, then reads them back and
+ * checks the time index written while recording.
+ */
+bool
+UtS9sEventRecorder::testRecord()
+{
+    S9sString path;
+
+    path.sprintf("/tmp/ut_s9seventrecorder_%d.json", getpid());
+    S9S_VERIFY(recordAndCheck(path));
+    removeRecording(path);
+
+    return true;
+}
+
+/**
+ * With a very small queue some events are dropped, but every event that was
+ * accepted must be in the recording and the caller is never blocked.
+ */
+bool
+UtS9sEventRecorder::testDrops()
+{
+    S9sEventRecorder recorder(1u);
+    S9sString        path;
+    int              nEvents = 10000;
+
+    path.sprintf("/tmp/ut_s9seventrecorder_drops_%d.json", getpid());
+
+    S9S_VERIFY(recorder.open(path));
+    for (int idx = 0; idx < nEvents; ++idx)
+        recorder.record(createEvent(idx));
+
+    recorder.close();
+    S9S_VERIFY(!recorder.failed());
+    S9S_COMPARE(
+            (int) (recorder.nRecorded() + recorder.nDropped()), nEvents);
+    S9S_COMPARE(countEvents(path), (int) recorder.nRecorded());
+    S9S_VERIFY(recorder.nBatches() > 0ull);
+    S9S_VERIFY(!recorder.record(createEvent(0)));
+
+    removeRecording(path);
+    return true;
+}
+
+/**
+ * The compressed recording, read back through S9sFile with the same
+ * (uncompressed) offsets in the index.
+ */
+bool
+UtS9sEventRecorder::testCompressed()
+{
+    S9sEventRecorder recorder;
+    S9sString        path;
+
+    path.sprintf("/tmp/ut_s9seventrecorder_%d.json.gz", getpid());
+
+    if (!S9sFile::compressionSupported())
+    {
+        S9S_VERIFY(!recorder.open(path));
+        S9S_VERIFY(!recorder.errorString().empty());
+        return true;
+    }
+
+    S9S_VERIFY(recordAndCheck(path));
+    removeRecording(path);
+
+    return true;
+}
+
+/**
+ * Recording again into an existing file keeps the index of the events
+ * recorded earlier.
+ */
+bool
+UtS9sEventRecorder::testAppend()
+{
+    S9sEventRecorder recorder;
+    S9sEventIndex    index;
+    S9sFile          file;
+    S9sEvent         event;
+    S9sString        path;
+    off_t            offset;
+
+    path.sprintf("/tmp/ut_s9seventrecorder_append_%d.json", getpid());
+    S9S_VERIFY(recordAndCheck(path));
+
+    S9S_VERIFY(recorder.open(path));
+    for (int idx = N_EVENTS; idx < 2 * N_EVENTS; ++idx)
+        S9S_VERIFY(recorder.record(createEvent(idx)));
+
+    recorder.close();
+    S9S_VERIFY(!recorder.failed());
+    S9S_COMPARE(countEvents(path), 2 * N_EVENTS);
+
+    S9S_VERIFY(index.load(S9sEventIndex::indexFileName(path)));
+    S9S_COMPARE((int) index.size(), 2 * N_EVENTS / 10);
+
+    // An event from the first session.
+    file   = S9sFile(path);
+    offset = index.find(m_startTime + 155);
+    S9S_VERIFY(file.seek(offset));
+    S9S_VERIFY(file.readEvent(event));
+    S9S_COMPARE(
+            (int) event.created().toTimeT(), (int) (m_startTime + 150));
+    
+    // An event from the second session.
+    file   = S9sFile(path);
+    offset = index.find(m_startTime + N_EVENTS + 25);
+    S9S_VERIFY(file.seek(offset));
+    S9S_VERIFY(file.readEvent(event));
+    S9S_COMPARE(
+            (int) event.created().toTimeT(), 
+            (int) (m_startTime + N_EVENTS + 20));
+
+    removeRecording(path);
+    return true;
+}
+
+/**
+ * Records N_EVENTS events into the given file and checks the recording and
+ * the index.
+ */
+bool
+UtS9sEventRecorder::recordAndCheck(
+        const S9sString &path)
+{
+    S9sEventRecorder recorder;
+    S9sEventIndex    index;
+    S9sFile          file(path);
+    S9sEvent         event;
+    off_t            offset;
+
+    recorder.setSyncPolicy(S9sEventRecorder::SyncBatch);
+    S9S_VERIFY(recorder.open(path));
+    S9S_VERIFY(recorder.isOpen());
+
+    for (int idx = 0; idx < N_EVENTS; ++idx)
+        S9S_VERIFY(recorder.record(createEvent(idx)));
+
+    recorder.close();
+    S9S_VERIFY(!recorder.isOpen());
+    S9S_VERIFY(!recorder.failed());
+    S9S_COMPARE((int) recorder.nRecorded(), N_EVENTS);
+    S9S_COMPARE((int) recorder.nDropped(), 0);
+    S9S_COMPARE(countEvents(path), N_EVENTS);
+
+    /*
+     * The index has one entry for every ten seconds and points to the
+     * beginning of the event.
+     */
+    S9S_VERIFY(index.load(S9sEventIndex::indexFileName(path)));
+    S9S_COMPARE((int) index.size(), N_EVENTS / 10);
+
+    offset = index.find(m_startTime + 155);
+    S9S_VERIFY(offset > 0);
+    S9S_VERIFY(file.seek(offset));
+    S9S_VERIFY(file.readEvent(event));
+    S9S_COMPARE(
+            (int) event.created().toTimeT(), (int) (m_startTime + 150));
+
+    return true;
+}
+
+S9sEvent
+UtS9sEventRecorder::createEvent(
+        int idx)
+{
+    S9sVariantMap event;
+    S9sVariantMap origins;
+    S9sVariantMap specifics;
+
+    origins["tv_sec"]        = (ulonglong) (m_startTime + idx);
+    origins["tv_nsec"]       = 0;
+    specifics["message"]     = "Something happened.";
+
+    event["class_name"]      = "CmonEvent";
+    event["event_class"]     = "EventLog";
+    event["event_name"]      = "LogMessage";
+    event["event_origins"]   = origins;
+    event["event_specifics"] = specifics;
+
+    return S9sEvent(event);
+}
+
+int
+UtS9sEventRecorder::countEvents(
+        const S9sString &path)
+{
+    S9sFile  file(path);
+    S9sEvent event;
+    int      retval = 0;
+
+    while (file.readEvent(event))
+        ++retval;
+
+    return retval;
+}
+
+void
+UtS9sEventRecorder::removeRecording(
+        const S9sString &path)
+{
+    unlink(STR(path));
+    unlink(STR(S9sEventIndex::indexFileName(path)));
+    unlink(STR(S9sEventCheckpoints::checkpointFileName(path)));
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sEventRecorder)
@@ -0,0 +1,193 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9seventresume.h"
+
+#include "s9seventresume.h"
+#include "s9sevent.h"
+#include "s9svariantmap.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sEventResume::UtS9sEventResume()
+{
+}
+
+UtS9sEventResume::~UtS9sEventResume()
+{
+}
+
+bool
+UtS9sEventResume::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testResumePoint,   retval);
+    PERFORM_TEST(testReplay,        retval);
+    PERFORM_TEST(testNoReplay,      retval);
+    PERFORM_TEST(testReplayChanges, retval);
+
+    return retval;
+}
+
+/**
+ * The resume point is the creation time of the newest event received.
+ */
+bool
+UtS9sEventResume::testResumePoint()
+{
+    S9sEventResume resume;
+    S9sVariantMap  point;
+
+    S9S_VERIFY(!resume.hasResumePoint());
+    S9S_VERIFY(resume.resumePoint().empty());
+
+    S9S_VERIFY(resume.accept(createEvent(100, 5)));
+    S9S_VERIFY(resume.accept(createEvent(101, 0)));
+    
+    // Live events are accepted even if they are out of order.
+    S9S_VERIFY(resume.accept(createEvent(100, 7)));
+    S9S_COMPARE((int) resume.nReceived(), 3);
+
+    point = resume.resumePoint();
+    S9S_VERIFY(resume.hasResumePoint());
+    S9S_COMPARE(point["tv_sec"].toInt(), 101);
+    S9S_COMPARE(point["tv_nsec"].toInt(), 0);
+
+    resume.clear();
+    S9S_VERIFY(!resume.hasResumePoint());
+
+    return true;
+}
+
+/**
+ * The controller replays the events from the resume point, the events we
+ * already have are dropped.
+ */
+bool
+UtS9sEventResume::testReplay()
+{
+    S9sEventResume resume;
+
+    S9S_VERIFY(resume.accept(createEvent(100, 1)));
+    S9S_VERIFY(resume.accept(createEvent(100, 2)));
+
+    resume.reconnect();
+    S9S_VERIFY(!resume.replaySupported());
+    S9S_VERIFY(!resume.accept(createEvent(100, 1)));
+    S9S_VERIFY(!resume.accept(createEvent(100, 2)));
+    S9S_VERIFY(resume.replaySupported());
+
+    // The events we missed, then the live ones.
+    S9S_VERIFY(resume.accept(createEvent(100, 3)));
+    S9S_VERIFY(resume.accept(createEvent(100, 2)));
+    S9S_VERIFY(!resume.replayMissed());
+
+    S9S_COMPARE((int) resume.nDuplicates(), 2);
+    S9S_COMPARE((int) resume.nReceived(), 4);
+    S9S_COMPARE((int) resume.nReconnects(), 1);
+    S9S_COMPARE(resume.resumePoint()["tv_nsec"].toInt(), 3);
+
+    return true;
+}
+
+/**
+ * The controller does not replay, the first event after the reconnect is
+ * newer than what we have.
+ */
+bool
+UtS9sEventResume::testNoReplay()
+{
+    S9sEventResume resume;
+
+    // Reconnecting before any event arrived.
+    resume.reconnect();
+    S9S_VERIFY(resume.accept(createEvent(100, 0)));
+
+    resume.reconnect();
+    S9S_VERIFY(!resume.replayMissed());
+    S9S_VERIFY(resume.accept(createEvent(200, 0)));
+    S9S_VERIFY(!resume.replaySupported());
+    S9S_VERIFY(resume.replayMissed());
+    S9S_COMPARE((int) resume.nDuplicates(), 0);
+
+    resume.resynced();
+    S9S_VERIFY(!resume.replayMissed());
+
+    // Events without creation time are always accepted.
+    resume.reconnect();
+    S9S_VERIFY(resume.accept(S9sEvent()));
+    S9S_VERIFY(!resume.accept(createEvent(200, 0)));
+    
+    return true;
+}
+
+/**
+ * Whether the controller replays the events is decided on every connection,
+ * we might reconnect to a different controller.
+ */
+bool
+UtS9sEventResume::testReplayChanges()
+{
+    S9sEventResume resume;
+
+    S9S_VERIFY(resume.accept(createEvent(100, 0)));
+
+    resume.reconnect();
+    S9S_VERIFY(!resume.accept(createEvent(100, 0)));
+    S9S_VERIFY(resume.accept(createEvent(101, 0)));
+    S9S_VERIFY(resume.replaySupported());
+    S9S_VERIFY(!resume.replayMissed());
+
+    resume.reconnect();
+    S9S_VERIFY(!resume.replaySupported());
+    S9S_VERIFY(resume.accept(createEvent(300, 0)));
+    S9S_VERIFY(!resume.replaySupported());
+    S9S_VERIFY(resume.replayMissed());
+
+    resume.resynced();
+    resume.reconnect();
+    S9S_VERIFY(!resume.accept(createEvent(300, 0)));
+    S9S_VERIFY(resume.replaySupported());
+    S9S_VERIFY(!resume.replayMissed());
+
+    return true;
+}
+
+S9sEvent
+UtS9sEventResume::createEvent(
+        int seconds,
+        int nanoseconds)
+{
+    S9sVariantMap event;
+    S9sVariantMap origins;
+
+    origins["tv_sec"]      = (ulonglong) seconds;
+    origins["tv_nsec"]     = (ulonglong) nanoseconds;
+
+    event["class_name"]    = "CmonEvent";
+    event["event_class"]   = "EventLog";
+    event["event_name"]    = "LogMessage";
+    event["event_origins"] = origins;
+
+    return S9sEvent(event);
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sEventResume)
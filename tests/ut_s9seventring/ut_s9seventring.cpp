@@ -0,0 +1,188 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9seventring.h"
+
+#include "s9seventring.h"
+#include "s9sevent.h"
+#include "s9sdatetime.h"
+#include "s9svariantmap.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sEventRing::UtS9sEventRing()
+{
+}
+
+UtS9sEventRing::~UtS9sEventRing()
+{
+}
+
+bool
+UtS9sEventRing::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testAppend,        retval);
+    PERFORM_TEST(testWrapAround,    retval);
+    PERFORM_TEST(testFind,          retval);
+    PERFORM_TEST(testSetCapacity,   retval);
+
+    return retval;
+}
+
+/**
+ * Adding events while the history is not full yet.
+ */
+bool
+UtS9sEventRing::testAppend()
+{
+    S9sEventRing ring(10u);
+
+    S9S_VERIFY(ring.empty());
+    S9S_COMPARE((int) ring.capacity(), 10);
+
+    for (int idx = 0; idx < 5; ++idx)
+        S9S_COMPARE((int) ring.append(createEvent(idx)), idx);
+
+    S9S_COMPARE((int) ring.size(), 5);
+    S9S_COMPARE(eventIndex(ring[0]), 0);
+    S9S_COMPARE(eventIndex(ring[4]), 4);
+    S9S_COMPARE((int) ring.firstSequence(), 0);
+    S9S_COMPARE((int) ring.nextSequence(), 5);
+
+    return true;
+}
+
+/**
+ * When the history is full the oldest event is overwritten and the index 0
+ * always means the oldest event we have.
+ */
+bool
+UtS9sEventRing::testWrapAround()
+{
+    S9sEventRing ring(10u);
+
+    for (int idx = 0; idx < 25; ++idx)
+        ring.append(createEvent(idx));
+
+    S9S_COMPARE((int) ring.size(), 10);
+    S9S_COMPARE((int) ring.firstSequence(), 15);
+    
+    for (uint idx = 0u; idx < ring.size(); ++idx)
+        S9S_COMPARE(eventIndex(ring.at(idx)), 15 + (int) idx);
+
+    ring.clear();
+    S9S_VERIFY(ring.empty());
+    S9S_COMPARE((int) ring.append(createEvent(25)), 25);
+    S9S_COMPARE(eventIndex(ring[0]), 25);
+
+    return true;
+}
+
+/**
+ * The sequence numbers are used to find the events later, the events that
+ * are overwritten are not found.
+ */
+bool
+UtS9sEventRing::testFind()
+{
+    S9sEventRing     ring(3u);
+    ulonglong        first, last;
+    const S9sEvent  *event;
+
+    first = ring.append(createEvent(0));
+    for (int idx = 1; idx < 4; ++idx)
+        last = ring.append(createEvent(idx));
+
+    S9S_VERIFY(!ring.contains(first));
+    S9S_VERIFY(ring.find(first) == NULL);
+
+    S9S_VERIFY(ring.contains(last));
+    event = ring.find(last);
+    S9S_VERIFY(event != NULL);
+    S9S_COMPARE(eventIndex(*event), 3);
+
+    S9S_VERIFY(ring.find(last + 1) == NULL);
+
+    return true;
+}
+
+/**
+ * Changing the capacity keeps the newest events.
+ */
+bool
+UtS9sEventRing::testSetCapacity()
+{
+    S9sEventRing ring(10u);
+
+    for (int idx = 0; idx < 15; ++idx)
+        ring.append(createEvent(idx));
+
+    ring.setCapacity(4u);
+    S9S_COMPARE((int) ring.size(), 4);
+    S9S_COMPARE(eventIndex(ring[0]), 11);
+    S9S_COMPARE(eventIndex(ring[3]), 14);
+    S9S_VERIFY(ring.find(14) != NULL);
+    S9S_VERIFY(ring.find(10) == NULL);
+
+    ring.append(createEvent(15));
+    S9S_COMPARE((int) ring.size(), 4);
+    S9S_COMPARE(eventIndex(ring[0]), 12);
+    S9S_COMPARE(eventIndex(ring[3]), 15);
+
+    ring.setCapacity(8u);
+    ring.append(createEvent(16));
+    S9S_COMPARE((int) ring.size(), 5);
+    S9S_COMPARE(eventIndex(ring[0]), 12);
+    S9S_COMPARE(eventIndex(ring[4]), 16);
+
+    return true;
+}
+
+S9sEvent
+UtS9sEventRing::createEvent(
+        int idx)
+{
+    S9sVariantMap event;
+    S9sVariantMap origins;
+
+    origins["tv_sec"]      = (ulonglong) (1700000000 + idx);
+    origins["tv_nsec"]     = 0;
+
+    event["class_name"]    = "CmonEvent";
+    event["event_class"]   = "EventLog";
+    event["event_name"]    = "LogMessage";
+    event["event_origins"] = origins;
+
+    return S9sEvent(event);
+}
+
+/**
+ * \returns The index the event was created with.
+ */
+int
+UtS9sEventRing::eventIndex(
+        const S9sEvent &event)
+{
+    return (int) (event.created().toTimeT() - 1700000000);
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sEventRing)
@@ -20,6 +20,8 @@
 #include "ut_s9sgraph.h"
 
 #include "s9sgraph.h"
+#include "s9scmongraph.h"
+#include "s9sgraphfollower.h"
 
 #include <math.h>
 
@@ -45,6 +47,14 @@ UtS9sGraph::runTest(const char *testName)
     PERFORM_TEST(testCreate04,      retval);
     PERFORM_TEST(testCreate05,      retval);
     PERFORM_TEST(testLabel01,       retval);
+    PERFORM_TEST(testDownsample,    retval);
+    PERFORM_TEST(testUpsample,      retval);
+    PERFORM_TEST(testLargestTriangle, retval);
+    PERFORM_TEST(testDensity,       retval);
+    PERFORM_TEST(testLargeData,     retval);
+    PERFORM_TEST(testLive,          retval);
+    PERFORM_TEST(testLiveSamples,   retval);
+    PERFORM_TEST(testGraphList,     retval);
 
     return retval;
 }
@@ -152,4 +162,348 @@ UtS9sGraph::testLabel01()
     return true;
 }
 
+/**
+ * 100 values into 10 columns, every column gets 10 values.
+ */
+bool
+UtS9sGraph::testDownsample()
+{
+    S9sVector<double> original;
+    S9sVector<double> normalized;
+
+    for (int idx = 0; idx < 100; ++idx)
+        original.push_back(idx);
+
+    S9sGraph::downsample(original, normalized, 10, S9sGraph::Max);
+    S9S_COMPARE((int) normalized.size(), 10);
+    S9S_COMPARE(normalized[0], 9.0);
+    S9S_COMPARE(normalized[9], 99.0);
+
+    S9sGraph::downsample(original, normalized, 10, S9sGraph::Min);
+    S9S_COMPARE(normalized[0], 0.0);
+    S9S_COMPARE(normalized[9], 90.0);
+
+    S9sGraph::downsample(original, normalized, 10, S9sGraph::Average);
+    S9S_COMPARE(normalized[0], 4.5);
+    S9S_COMPARE(normalized[5], 54.5);
+
+    // Not divisible, still every value is in exactly one column.
+    original.resize(95);
+    S9sGraph::downsample(original, normalized, 10, S9sGraph::Max);
+    S9S_COMPARE((int) normalized.size(), 10);
+    S9S_COMPARE(normalized[9], 94.0);
+    
+    // No data.
+    original.clear();
+    S9sGraph::downsample(original, normalized, 10, S9sGraph::Max);
+    S9S_COMPARE((int) normalized.size(), 10);
+    S9S_COMPARE(normalized[9], 0.0);
+
+    return true;
+}
+
+/**
+ * If there are fewer values than columns the values are repeated.
+ */
+bool
+UtS9sGraph::testUpsample()
+{
+    S9sVector<double> original;
+    S9sVector<double> normalized;
+
+    original.push_back(1.0);
+    original.push_back(2.0);
+    original.push_back(3.0);
+
+    S9sGraph::downsample(original, normalized, 6, S9sGraph::Average);
+    S9S_COMPARE((int) normalized.size(), 6);
+    S9S_COMPARE(normalized[0], 1.0);
+    S9S_COMPARE(normalized[1], 1.0);
+    S9S_COMPARE(normalized[2], 2.0);
+    S9S_COMPARE(normalized[3], 2.0);
+    S9S_COMPARE(normalized[4], 3.0);
+    S9S_COMPARE(normalized[5], 3.0);
+
+    S9sGraph::downsample(
+            original, normalized, 6, S9sGraph::LargestTriangle);
+    S9S_COMPARE(normalized[5], 3.0);
+
+    return true;
+}
+
+/**
+ * A single spike in a flat series: the average hides it, the
+ * largest-triangle-three-buckets keeps it, and also keeps the first and the
+ * last values.
+ */
+bool
+UtS9sGraph::testLargestTriangle()
+{
+    S9sVector<double> original;
+    S9sVector<double> normalized;
+    double            biggest = 0.0;
+
+    for (int idx = 0; idx < 1000; ++idx)
+        original.push_back(idx == 517 ? 100.0 : 1.0);
+    
+    original[0]   = 5.0;
+    original[999] = 7.0;
+
+    S9sGraph::downsample(original, normalized, 20, S9sGraph::Average);
+    for (uint idx = 0u; idx < normalized.size(); ++idx)
+        biggest = normalized[idx] > biggest ? normalized[idx] : biggest;
+
+    S9S_VERIFY(biggest < 5.0);
+    
+    biggest = 0.0;
+    S9sGraph::downsample(
+            original, normalized, 20, S9sGraph::LargestTriangle);
+
+    S9S_COMPARE((int) normalized.size(), 20);
+    for (uint idx = 0u; idx < normalized.size(); ++idx)
+        biggest = normalized[idx] > biggest ? normalized[idx] : biggest;
+
+    S9S_COMPARE(biggest, 100.0);
+    S9S_COMPARE(normalized[0], 5.0);
+    S9S_COMPARE(normalized[19], 7.0);
+
+    return true;
+}
+
+bool
+UtS9sGraph::testDensity()
+{
+    S9sVector<double> original;
+    S9sVector<double> normalized;
+    double            minimum;
+    double            maximum;
+
+    for (int idx = 0; idx < 10; ++idx)
+        original.push_back(idx);
+
+    S9sGraph::densityFunction(original, normalized, 10, minimum, maximum);
+    S9S_COMPARE((int) normalized.size(), 10);
+    S9S_COMPARE(minimum, 0.0);
+    S9S_COMPARE(maximum, 9.0);
+
+    for (uint idx = 0u; idx < normalized.size(); ++idx)
+        S9S_COMPARE(normalized[idx], 10.0);
+
+    // All the same values.
+    original.assign(5, 3.0);
+    S9sGraph::densityFunction(original, normalized, 10, minimum, maximum);
+    S9S_COMPARE(minimum, 3.0);
+    S9S_COMPARE(maximum, 4.0);
+    S9S_COMPARE(normalized[0], 100.0);
+
+    return true;
+}
+
+/**
+ * Four weeks of 10 second samples drawn by the graph itself.
+ */
+bool
+UtS9sGraph::testLargeData()
+{
+    S9sGraph graph;
+    int      nValues = 4 * 7 * 24 * 360;
+
+    graph.setColor(false);
+
+    for (int idx = 0; idx < nValues; ++idx)
+        graph.appendValue((double) (idx % 360));
+
+    graph.setAggregateType(S9sGraph::Max);
+    graph.realize();
+
+    S9S_COMPARE(graph.nValues(), nValues);
+    S9S_COMPARE(graph.max().toDouble(), 359.0);
+    S9S_COMPARE(graph.nColumns(), 46);
+    S9S_COMPARE(graph.nRows(), 11);
+
+    return true;
+}
+
+/**
+ * The live graph keeps a fixed number of samples, the new ones push the oldest
+ * ones out.
+ */
+bool
+UtS9sGraph::testLive()
+{
+    S9sGraph graph;
+
+    graph.setColor(false);
+    graph.setAggregateType(S9sGraph::Max);
+    graph.setInterval(1000, 1790);
+
+    for (int idx = 0; idx < 80; ++idx)
+        graph.appendValue((double) idx);
+
+    // The history is kept, two samples in each of the 40 columns.
+    graph.setLive();
+    graph.realize();
+    S9S_VERIFY(graph.isLive());
+    S9S_COMPARE(graph.samplesPerColumn(), 2);
+    S9S_COMPARE(graph.nValues(), 80);
+    S9S_COMPARE(graph.max().toDouble(), 79.0);
+
+    // The ring is full, the new value replaces the oldest.
+    graph.appendLiveValue(1000.0, 1800);
+    graph.realize();
+    S9S_COMPARE(graph.nValues(), 80);
+    S9S_COMPARE(graph.max().toDouble(), 1000.0);
+
+    // Pushing everything out of the ring.
+    for (int idx = 0; idx < 80; ++idx)
+        graph.appendLiveValue(1.0, 1810 + idx * 10);
+
+    graph.realize();
+    S9S_COMPARE(graph.nValues(), 80);
+    S9S_COMPARE(graph.max().toDouble(), 1.0);
+
+    // Going live again with a different column size keeps the samples.
+    graph.setLive(4);
+    S9S_COMPARE(graph.samplesPerColumn(), 4);
+    S9S_COMPARE(graph.nValues(), 80);
+    S9S_COMPARE(graph.max().toDouble(), 1.0);
+
+    // An empty graph starts with one sample in every column.
+    S9sGraph empty;
+
+    empty.setLive();
+    S9S_COMPARE(empty.samplesPerColumn(), 1);
+    S9S_COMPARE(empty.nValues(), 0);
+
+    empty.appendLiveValue(3.0, 1000);
+    empty.realize();
+    S9S_COMPARE(empty.nValues(), 1);
+    S9S_COMPARE(empty.max().toDouble(), 3.0);
+
+    return true;
+}
+
+/**
+ * The samples of the measurement events find their way into the graph of the
+ * host they belong to.
+ */
+bool
+UtS9sGraph::testLiveSamples()
+{
+    S9sVariantMap  hostMap;
+    S9sVariantMap  cpuSample;
+    S9sVariantMap  diskSample;
+    S9sVariantMap  diskInfo;
+    S9sVariantMap  specifics;
+    S9sVariantMap  origins;
+    S9sVariantMap  eventMap;
+    S9sVariantList measurements;
+    S9sVariantList partitions;
+    S9sVariantList samples;
+    S9sCmonGraph   graph;
+    S9sEvent       event;
+
+    hostMap["class_name"]   = "CmonHost";
+    hostMap["hostId"]       = 3;
+    hostMap["hostname"]     = "192.168.0.127";
+
+    cpuSample["class_name"] = "CmonCpuStats";
+    cpuSample["cpuid"]      = 0;
+    cpuSample["cpumhz"]     = 2400.0;
+    
+    diskSample["class_name"] = "CmonDiskStats";
+    diskSample["hostid"]     = 3;
+    diskSample["created"]    = 1500000000;
+
+    partitions   << diskSample;
+    diskInfo["class_name"]  = "CmonDiskInfo";
+    diskInfo["partitions"]  = partitions;
+
+    measurements << cpuSample;
+    measurements << diskInfo;
+
+    specifics["host"]         = hostMap;
+    specifics["measurements"] = measurements;
+    origins["tv_sec"]         = 1500000010;
+
+    eventMap["class_name"]     = "CmonEvent";
+    eventMap["event_class"]    = "EventHost";
+    eventMap["event_name"]     = "Measurements";
+    eventMap["event_origins"]  = origins;
+    eventMap["event_specifics"] = specifics;
+    event = eventMap;
+
+    samples = S9sGraphFollower::measurementSamples(event);
+    S9S_COMPARE((int) samples.size(), 2);
+    S9S_COMPARE(samples[0]["hostid"].toInt(), 3);
+    S9S_COMPARE((int) samples[0]["created"].toTimeT(), 1500000010);
+    S9S_COMPARE(samples[1]["class_name"].toString(), "CmonDiskStats");
+    S9S_COMPARE((int) samples[1]["created"].toTimeT(), 1500000000);
+
+    graph.setColor(false);
+    graph.setGraphType("cpughz");
+    graph.setNode(S9sNode(hostMap));
+    graph.setLive();
+
+    S9S_VERIFY(graph.appendLiveSample(samples[0].toVariantMap()));
+    S9S_VERIFY(!graph.appendLiveSample(samples[1].toVariantMap()));
+    S9S_COMPARE(graph.nValues(), 1);
+    S9S_COMPARE(graph.max().toDouble(), 2.4);
+
+    // An other host.
+    cpuSample["hostid"]  = 4;
+    cpuSample["created"] = 1500000020;
+    S9S_VERIFY(!graph.appendLiveSample(cpuSample));
+
+    graph.realize();
+    S9S_COMPARE(graph.nValues(), 1);
+
+    return true;
+}
+
+/**
+ * The list in the --graph option: the graphs using the same statistics share
+ * one request, an invalid name or an empty item makes the whole list invalid.
+ */
+bool
+UtS9sGraph::testGraphList()
+{
+    S9sVector<S9sString> graphTypes;
+    S9sVector<S9sString> statNames;
+    S9sVector<int>       statIndices;
+    S9sString            errorString;
+
+    S9S_VERIFY(S9sCmonGraph::parseGraphList(
+                "cpuUser, cpuSys,memfree", graphTypes, statNames, statIndices,
+                errorString));
+
+    S9S_COMPARE((int) graphTypes.size(), 3);
+    S9S_COMPARE(graphTypes[0], "cpuuser");
+    S9S_COMPARE(graphTypes[1], "cpusys");
+    S9S_COMPARE(graphTypes[2], "memfree");
+
+    S9S_COMPARE((int) statNames.size(), 2);
+    S9S_COMPARE(statNames[0], "cpustat");
+    S9S_COMPARE(statNames[1], "memorystat");
+
+    S9S_COMPARE((int) statIndices.size(), 3);
+    S9S_COMPARE(statIndices[0], 0);
+    S9S_COMPARE(statIndices[1], 0);
+    S9S_COMPARE(statIndices[2], 1);
+
+    S9S_VERIFY(!S9sCmonGraph::parseGraphList(
+                "cpuuser,nosuchgraph", graphTypes, statNames, statIndices,
+                errorString));
+    S9S_VERIFY(errorString.find("nosuchgraph") != std::string::npos);
+
+    S9S_VERIFY(!S9sCmonGraph::parseGraphList(
+                "cpuuser,", graphTypes, statNames, statIndices,
+                errorString));
+
+    S9S_VERIFY(!S9sCmonGraph::parseGraphList(
+                "", graphTypes, statNames, statIndices, errorString));
+
+    return true;
+}
+
 S9S_UNIT_TEST_MAIN(UtS9sGraph)
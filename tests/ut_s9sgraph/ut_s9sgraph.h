@@ -33,5 +33,13 @@ class UtS9sGraph : public S9sUnitTest
         bool testCreate04();
         bool testCreate05();
         bool testLabel01();
+        bool testDownsample();
+        bool testUpsample();
+        bool testLargestTriangle();
+        bool testDensity();
+        bool testLargeData();
+        bool testLive();
+        bool testLiveSamples();
+        bool testGraphList();
 };
 
@@ -0,0 +1,516 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9sjobwaiter.h"
+
+#include "s9sbusinesslogic.h"
+#include "s9spollscheduler.h"
+#include "s9soptions.h"
+#include "s9srpcclient.h"
+#include "s9svariantmap.h"
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+#define JOB_ID 42
+
+/******************************************************************************
+ *
+ */
+S9sStandInController::S9sStandInController(
+        const int jobId) :
+    m_jobId(jobId),
+    m_listenFd(-1),
+    m_port(0),
+    m_refuseEvents(false),
+    m_finished(false),
+    m_finishedTime(0.0),
+    m_nPolls(0)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+S9sStandInController::~S9sStandInController()
+{
+    stop();
+    pthread_mutex_destroy(&m_mutex);
+}
+
+bool
+S9sStandInController::start()
+{
+    struct sockaddr_in address;
+    socklen_t          length = sizeof(address);
+
+    m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenFd < 0)
+        return false;
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = 0;
+
+    if (bind(m_listenFd, (struct sockaddr *) &address, sizeof(address)) != 0 ||
+            listen(m_listenFd, 16) != 0 ||
+            getsockname(m_listenFd, (struct sockaddr *) &address, &length) != 0)
+    {
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    m_port = ntohs(address.sin_port);
+    return pthread_create(
+            &m_thread, NULL, S9sStandInController::acceptEntryPoint, 
+            this) == 0;
+}
+
+void
+S9sStandInController::stop()
+{
+    if (m_listenFd < 0)
+        return;
+
+    shutdown(m_listenFd, SHUT_RDWR);
+    close(m_listenFd);
+    pthread_join(m_thread, NULL);
+    m_listenFd = -1;
+
+    pthread_mutex_lock(&m_mutex);
+    for (uint idx = 0u; idx < m_subscribers.size(); ++idx)
+        close(m_subscribers[idx]);
+
+    m_subscribers.clear();
+    pthread_mutex_unlock(&m_mutex);
+}
+
+int
+S9sStandInController::port() const
+{
+    return m_port;
+}
+
+void
+S9sStandInController::setRefuseEvents(
+        bool value)
+{
+    m_refuseEvents = value;
+}
+
+/**
+ * \returns True if a client subscribed to the events within the timeout.
+ */
+bool
+S9sStandInController::waitForSubscriber(
+        int timeoutMs)
+{
+    for (; timeoutMs > 0; timeoutMs -= 10)
+    {
+        bool found;
+
+        pthread_mutex_lock(&m_mutex);
+        found = !m_subscribers.empty();
+        pthread_mutex_unlock(&m_mutex);
+
+        if (found)
+            return true;
+
+        usleep(10000);
+    }
+
+    return false;
+}
+
+/**
+ * Changes the state of the job to finished and notifies the subscribers.
+ */
+void
+S9sStandInController::finishJob()
+{
+    S9sString event;
+
+    event.sprintf(
+            "\036{"
+            "\"class_name\": \"CmonEvent\", "
+            "\"event_class\": \"EventJob\", "
+            "\"event_name\": \"Changed\", "
+            "\"event_specifics\": { \"job\": { "
+            "\"class_name\": \"CmonJobInstance\", "
+            "\"job_id\": %d, \"status\": \"FINISHED\" } } }\n\n", 
+            m_jobId);
+
+    pthread_mutex_lock(&m_mutex);
+    m_finished     = true;
+    m_finishedTime = now();
+
+    for (uint idx = 0u; idx < m_subscribers.size(); ++idx)
+    {
+        if (::write(m_subscribers[idx], STR(event), event.length()) < 0)
+            S9S_WARNING("write: %m");
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+int
+S9sStandInController::nPolls()
+{
+    int retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_nPolls;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+double
+S9sStandInController::finishedTime()
+{
+    double retval;
+
+    pthread_mutex_lock(&m_mutex);
+    retval = m_finishedTime;
+    pthread_mutex_unlock(&m_mutex);
+
+    return retval;
+}
+
+double
+S9sStandInController::now()
+{
+    struct timespec value;
+
+    clock_gettime(CLOCK_MONOTONIC, &value);
+    return value.tv_sec + value.tv_nsec / 1e9;
+}
+
+void
+S9sStandInController::acceptLoop()
+{
+    for (;;)
+    {
+        int       *socketFd = new int;
+        pthread_t  thread;
+
+        *socketFd = accept(m_listenFd, NULL, NULL);
+        if (*socketFd < 0)
+        {
+            delete socketFd;
+            break;
+        }
+
+        // The context of the connection is the controller and the socket.
+        void **context = new void *[2];
+        context[0] = this;
+        context[1] = socketFd;
+
+        pthread_create(
+                &thread, NULL, S9sStandInController::connectionEntryPoint, 
+                context);
+
+        pthread_detach(thread);
+    }
+}
+
+/**
+ * Reads one HTTP request and answers it. The connections that subscribed to
+ * the events are kept open.
+ */
+void
+S9sStandInController::handleConnection(
+        int socketFd)
+{
+    S9sString     data;
+    S9sString     body;
+    S9sString     reply;
+    S9sVariantMap request;
+    char          buffer[4096];
+    size_t        headerEnd = std::string::npos;
+    size_t        contentLength = 0;
+
+    for (;;)
+    {
+        ssize_t length = ::read(socketFd, buffer, sizeof(buffer));
+
+        if (length <= 0)
+        {
+            close(socketFd);
+            return;
+        }
+
+        data += std::string(buffer, length);
+        if (headerEnd == std::string::npos)
+        {
+            headerEnd = data.find("\r\n\r\n");
+            if (headerEnd != std::string::npos)
+            {
+                size_t pos = data.find("Content-Length: ");
+
+                if (pos != std::string::npos)
+                    contentLength = atoi(data.c_str() + pos + 16);
+            }
+        }
+
+        if (headerEnd != std::string::npos && 
+                data.length() >= headerEnd + 4 + contentLength)
+        {
+            break;
+        }
+    }
+
+    body = data.substr(headerEnd + 4);
+    request.parse(STR(body));
+
+    if (data.startsWith("POST /v2/subscribe_events"))
+    {
+        if (m_refuseEvents)
+        {
+            sendReply(socketFd, 
+                    "{ \"request_status\": \"AccessDenied\", "
+                    "\"error_string\": \"Events are not available.\" }");
+        } else {
+            pthread_mutex_lock(&m_mutex);
+            m_subscribers << socketFd;
+            pthread_mutex_unlock(&m_mutex);
+        }
+
+        return;
+    } else if (request["operation"] == "getJobInstance")
+    {
+        pthread_mutex_lock(&m_mutex);
+        ++m_nPolls;
+        reply.sprintf(
+                "{ \"request_status\": \"Ok\", \"job\": { "
+                "\"class_name\": \"CmonJobInstance\", \"job_id\": %d, "
+                "\"title\": \"Stand-in job\", \"status\": \"%s\", "
+                "\"progress_percent\": 50 } }",
+                m_jobId, m_finished ? "FINISHED" : "RUNNING");
+        pthread_mutex_unlock(&m_mutex);
+
+        sendReply(socketFd, reply);
+    } else {
+        sendReply(socketFd, "{ \"request_status\": \"Ok\" }");
+    }
+}
+
+void
+S9sStandInController::sendReply(
+        int              socketFd,
+        const S9sString &body)
+{
+    S9sString message;
+
+    message.sprintf(
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: %u\r\n"
+            "\r\n"
+            "%s",
+            (uint) body.length(), STR(body));
+
+    if (::write(socketFd, STR(message), message.length()) < 0)
+        S9S_WARNING("write: %m");
+
+    close(socketFd);
+}
+
+void *
+S9sStandInController::acceptEntryPoint(
+        void *pointer)
+{
+    ((S9sStandInController *) pointer)->acceptLoop();
+    return NULL;
+}
+
+void *
+S9sStandInController::connectionEntryPoint(
+        void *pointer)
+{
+    void                 **context    = (void **) pointer;
+    S9sStandInController  *controller = (S9sStandInController *) context[0];
+    int                   *socketFd   = (int *) context[1];
+
+    controller->handleConnection(*socketFd);
+
+    delete socketFd;
+    delete[] context;
+    return NULL;
+}
+
+/******************************************************************************
+ *
+ */
+UtS9sJobWaiter::UtS9sJobWaiter()
+{
+}
+
+UtS9sJobWaiter::~UtS9sJobWaiter()
+{
+}
+
+bool
+UtS9sJobWaiter::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testEventStream,   retval);
+    PERFORM_TEST(testFallback,      retval);
+    PERFORM_TEST(testPollScheduler, retval);
+
+    return retval;
+}
+
+/**
+ * The controller sends an event when the job is finished, the waiting should
+ * end right after that.
+ */
+bool
+UtS9sJobWaiter::testEventStream()
+{
+    S9sStandInController controller(JOB_ID);
+    double               latency;
+
+    S9S_VERIFY(controller.start());
+    S9S_VERIFY(waitForJob(controller, latency));
+
+    printf("  Event stream: %.1f ms from job finish to exit, %d polls.\n",
+            latency * 1000.0, controller.nPolls());
+
+    S9S_VERIFY(latency < 0.4);
+    S9S_VERIFY(controller.nPolls() <= 4);
+    S9S_COMPARE(S9sOptions::instance()->exitStatus(), 0);
+
+    return true;
+}
+
+/**
+ * The controller refuses to send events, the job is polled.
+ */
+bool
+UtS9sJobWaiter::testFallback()
+{
+    S9sStandInController controller(JOB_ID);
+    double               latency;
+
+    controller.setRefuseEvents(true);
+    S9S_VERIFY(controller.start());
+    S9S_VERIFY(waitForJob(controller, latency));
+
+    printf("  Polling: %.1f ms from job finish to exit, %d polls.\n",
+            latency * 1000.0, controller.nPolls());
+
+    S9S_VERIFY(latency < 1.1);
+    S9S_COMPARE(S9sOptions::instance()->exitStatus(), 0);
+
+    return true;
+}
+
+/**
+ * The delays start short, grow while nothing changes, the jitter only
+ * shortens them and the hint of the controller is honoured.
+ */
+bool
+UtS9sJobWaiter::testPollScheduler()
+{
+    S9sPollScheduler schedule(100, 1000, 0);
+    int              delay;
+
+    S9S_COMPARE(schedule.nextDelay(true),  100);
+    S9S_COMPARE(schedule.nextDelay(false), 200);
+    S9S_COMPARE(schedule.nextDelay(false), 400);
+    S9S_COMPARE(schedule.nextDelay(false), 800);
+    S9S_COMPARE(schedule.nextDelay(false), 1000);
+    S9S_COMPARE(schedule.nextDelay(false), 1000);
+    S9S_COMPARE(schedule.nextDelay(true),  100);
+
+    // The controller asks us to slow down, but only for one poll.
+    schedule.setHint(3000);
+    S9S_COMPARE(schedule.nextDelay(true),  3000);
+    S9S_COMPARE(schedule.nextDelay(true),  100);
+
+    // With jitter the delays are between 80% and 100% of the interval.
+    schedule.setJitter(20);
+    for (int idx = 0; idx < 100; ++idx)
+    {
+        delay = schedule.nextDelay(false);
+        S9S_VERIFY(delay >= schedule.interval() * 80 / 100);
+        S9S_VERIFY(delay <= schedule.interval());
+    }
+
+    S9S_COMPARE(schedule.interval(), 1000);
+
+    // Swapped limits are corrected.
+    schedule.setLimits(500, 100);
+    S9S_COMPARE(schedule.minInterval(), 500);
+    S9S_COMPARE(schedule.maxInterval(), 500);
+
+    return true;
+}
+
+static void *
+finishJobLater(
+        void *pointer)
+{
+    S9sStandInController *controller = (S9sStandInController *) pointer;
+    double                started    = S9sStandInController::now();
+
+    controller->waitForSubscriber(1000);
+    while (S9sStandInController::now() - started < 1.5)
+        usleep(10000);
+
+    controller->finishJob();
+    return NULL;
+}
+
+/**
+ * Waits for the job of the stand-in controller the same way the s9s program
+ * does, the job is finished by the controller 1.5 seconds later.
+ *
+ * \param latency The time between the job finished and the waiting returned
+ *   in seconds.
+ */
+bool
+UtS9sJobWaiter::waitForJob(
+        S9sStandInController &controller,
+        double               &latency)
+{
+    S9sRpcClient      client("127.0.0.1", controller.port(), "", false);
+    S9sBusinessLogic  logic;
+    pthread_t         thread;
+
+    if (pthread_create(&thread, NULL, finishJobLater, &controller) != 0)
+        return false;
+
+    logic.waitForJob(0, JOB_ID, client);
+    latency = S9sStandInController::now() - controller.finishedTime();
+
+    pthread_join(thread, NULL);
+    return controller.finishedTime() > 0.0;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sJobWaiter)
@@ -0,0 +1,88 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "s9sunittest.h"
+
+#include "s9sstring.h"
+#include "s9svector.h"
+
+#include <pthread.h>
+
+/**
+ * A stand-in for the controller: accepts HTTP connections on the loopback
+ * interface, answers the getJobInstance requests about one job and sends
+ * events about the job to the clients that subscribed to the events.
+ */
+class S9sStandInController
+{
+    public:
+        S9sStandInController(const int jobId);
+        virtual ~S9sStandInController();
+
+        bool start();
+        void stop();
+        int port() const;
+
+        void setRefuseEvents(bool value);
+        bool waitForSubscriber(int timeoutMs);
+        void finishJob();
+
+        int nPolls();
+        double finishedTime();
+
+        static double now();
+
+    private:
+        void acceptLoop();
+        void handleConnection(int socketFd);
+        void sendReply(int socketFd, const S9sString &body);
+
+        static void *acceptEntryPoint(void *pointer);
+        static void *connectionEntryPoint(void *pointer);
+
+    private:
+        int               m_jobId;
+        int               m_listenFd;
+        int               m_port;
+        pthread_t         m_thread;
+        pthread_mutex_t   m_mutex;
+        bool              m_refuseEvents;
+        bool              m_finished;
+        double            m_finishedTime;
+        int               m_nPolls;
+        S9sVector<int>    m_subscribers;
+};
+
+class UtS9sJobWaiter : public S9sUnitTest
+{
+    public:
+        UtS9sJobWaiter();
+        virtual ~UtS9sJobWaiter();
+        virtual bool runTest(const char *testName = 0);
+    
+    protected:
+        bool testEventStream();
+        bool testFallback();
+        bool testPollScheduler();
+
+    private:
+        bool waitForJob(
+                S9sStandInController &controller,
+                double               &latency);
+};
@@ -0,0 +1,174 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9slogfollower.h"
+
+#include "s9slogfollower.h"
+#include "s9srpcclient.h"
+#include "s9svariantmap.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sLogFollower::UtS9sLogFollower()
+{
+}
+
+UtS9sLogFollower::~UtS9sLogFollower()
+{
+}
+
+bool
+UtS9sLogFollower::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testAcceptPage,    retval);
+    PERFORM_TEST(testBoundary,      retval);
+    PERFORM_TEST(testCreatedFormat, retval);
+
+    return retval;
+}
+
+/**
+ * The entries that were already returned are dropped, the high-water mark
+ * moves with the new entries.
+ */
+bool
+UtS9sLogFollower::testAcceptPage()
+{
+    S9sRpcClient   client("127.0.0.1", 9500, "", false);
+    S9sLogFollower follower(client);
+    S9sVariantList entries;
+
+    entries = follower.acceptPage(page(1, 5, "2024-05-01T10:00:01.000Z"));
+    S9S_COMPARE((int) entries.size(), 5);
+    S9S_COMPARE(follower.lastMessageId(), 5);
+    S9S_COMPARE(follower.lastCreated(), "2024-05-01T10:00:01.000Z");
+
+    // The same page again: nothing new.
+    entries = follower.acceptPage(page(1, 5, "2024-05-01T10:00:01.000Z"));
+    S9S_COMPARE((int) entries.size(), 0);
+    S9S_COMPARE((int) follower.nDuplicates(), 5);
+
+    // Newer entries.
+    entries = follower.acceptPage(page(6, 7, "2024-05-01T10:00:02.000Z"));
+    S9S_COMPARE((int) entries.size(), 2);
+    S9S_COMPARE(follower.lastMessageId(), 7);
+    S9S_COMPARE(follower.lastCreated(), "2024-05-01T10:00:02.000Z");
+
+    // Older entries are dropped.
+    entries = follower.acceptPage(page(3, 4, "2024-05-01T10:00:01.000Z"));
+    S9S_COMPARE((int) entries.size(), 0);
+    S9S_COMPARE((int) follower.nDuplicates(), 7);
+
+    return true;
+}
+
+/**
+ * The controller sends again the entries created at the high-water mark (the
+ * created_after is not exclusive), only the ones we have not seen yet should
+ * be returned.
+ */
+bool
+UtS9sLogFollower::testBoundary()
+{
+    S9sRpcClient   client("127.0.0.1", 9500, "", false);
+    S9sLogFollower follower(client);
+    S9sVariantList entries;
+    S9sVariantList overlapping;
+
+    follower.setCreatedAfter("2024-05-01T10:00:00.000Z");
+
+    entries = follower.acceptPage(page(10, 12, "2024-05-01T10:00:05.000Z"));
+    S9S_COMPARE((int) entries.size(), 3);
+
+    // Two old ones at the boundary, one new with the same time, two newer.
+    overlapping  = page(11, 13, "2024-05-01T10:00:05.000Z");
+    overlapping << page(14, 15, "2024-05-01T10:00:06.000Z");
+
+    entries = follower.acceptPage(overlapping);
+    S9S_COMPARE((int) entries.size(), 3);
+    S9S_COMPARE(entries[0].toVariantMap().at("log_id").toInt(), 13);
+    S9S_COMPARE(entries[2].toVariantMap().at("log_id").toInt(), 15);
+    S9S_COMPARE((int) follower.nDuplicates(), 2);
+
+    return true;
+}
+
+/**
+ * The high-water mark set from the --from option is not in the format the
+ * controller uses, so the times are compared parsed, not as strings.
+ */
+bool
+UtS9sLogFollower::testCreatedFormat()
+{
+    S9sRpcClient   client("127.0.0.1", 9500, "", false);
+    S9sLogFollower follower(client);
+    S9sVariantList entries;
+
+    follower.setCreatedAfter("2024-05-01 10:00:03");
+
+    entries = follower.acceptPage(page(1, 2, "2024-05-01T10:00:01.000Z"));
+    S9S_COMPARE((int) entries.size(), 0);
+    S9S_COMPARE((int) follower.nDuplicates(), 2);
+
+    entries = follower.acceptPage(page(3, 4, "2024-05-01T10:00:05.000Z"));
+    S9S_COMPARE((int) entries.size(), 2);
+    S9S_COMPARE(follower.lastCreated(), "2024-05-01T10:00:05.000Z");
+
+    // Milliseconds count too.
+    entries = follower.acceptPage(page(5, 5, "2024-05-01T10:00:05.500Z"));
+    S9S_COMPARE((int) entries.size(), 1);
+    entries = follower.acceptPage(page(6, 6, "2024-05-01T10:00:05.250Z"));
+    S9S_COMPARE((int) entries.size(), 0);
+
+    return true;
+}
+
+/**
+ * Creates log entries the way the controller sends them.
+ */
+S9sVariantList 
+UtS9sLogFollower::page(
+        int         firstId,
+        int         lastId,
+        const char *created)
+{
+    S9sVariantList retval;
+
+    for (int id = firstId; id <= lastId; ++id)
+    {
+        S9sVariantMap entry;
+        S9sVariantMap specifics;
+
+        specifics["message_text"] = "Message";
+        
+        entry["log_id"]        = id;
+        entry["created"]       = created;
+        entry["severity"]      = "LOG_INFO";
+        entry["log_specifics"] = specifics;
+
+        retval << entry;
+    }
+
+    return retval;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sLogFollower)
@@ -0,0 +1,258 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9slogwriter.h"
+
+#include "s9slogwriter.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sLogWriter::UtS9sLogWriter()
+{
+}
+
+UtS9sLogWriter::~UtS9sLogWriter()
+{
+}
+
+bool
+UtS9sLogWriter::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testLevel,         retval);
+    PERFORM_TEST(testWrite,         retval);
+    PERFORM_TEST(testRotate,        retval);
+    PERFORM_TEST(testRotateFailure, retval);
+    PERFORM_TEST(testLongLine,      retval);
+
+    return retval;
+}
+
+bool
+UtS9sLogWriter::testLevel()
+{
+    S9sLogWriter writer;
+    S9sLogLevel  level = LogDebug;
+
+    S9S_VERIFY(S9sLogWriter::levelFromString("Warning", level));
+    S9S_COMPARE(level, LogWarning);
+    S9S_VERIFY(S9sLogWriter::levelFromString("error", level));
+    S9S_COMPARE(level, LogError);
+    S9S_VERIFY(!S9sLogWriter::levelFromString("verbose", level));
+    S9S_COMPARE(level, LogError);
+
+    // Nothing is enabled while the file is not open.
+    S9S_VERIFY(!writer.isEnabled(LogError));
+    
+    S9S_COMPARE(S9sString(S9sLogWriter::levelName(LogDebug)), "DEBUG");
+    S9S_COMPARE(S9sString(S9sLogWriter::levelName(LogInfo)), "INFO");
+
+    return true;
+}
+
+/**
+ * Many lines through a small buffer, so the producer has to wait for the
+ * background thread several times. Everything has to be in the file after a
+ * flush() and nothing under the log level.
+ */
+bool
+UtS9sLogWriter::testWrite()
+{
+    S9sString    path;
+    S9sLogWriter writer(1024);
+
+    path.sprintf("/tmp/ut_s9slogwriter.%d.log", getpid());
+    unlink(STR(path));
+
+    S9S_VERIFY(writer.open(path));
+    writer.setLevel(LogInfo);
+
+    for (int idx = 0; idx < 2000; ++idx)
+    {
+        S9sString message;
+
+        message.sprintf("This is line %d.", idx);
+        writer.write(LogInfo, __FILE__, __LINE__, message);
+        writer.write(LogDebug, __FILE__, __LINE__, message);
+    }
+
+    writer.flush();
+    S9S_COMPARE(writer.nLines(), 2000ull);
+    S9S_COMPARE(countLines(path), 2000);
+
+    writer.write(LogError, __FILE__, __LINE__, "The last line.");
+    writer.close();
+    S9S_VERIFY(!writer.isOpen());
+    S9S_COMPARE(countLines(path), 2001);
+
+    unlink(STR(path));
+    return true;
+}
+
+/**
+ * The file is rotated when it grows over the limit and only the given number
+ * of old files are kept.
+ */
+bool
+UtS9sLogWriter::testRotate()
+{
+    S9sString    path;
+    S9sString    rotated;
+    S9sLogWriter writer;
+
+    path.sprintf("/tmp/ut_s9slogwriter.%d.rot.log", getpid());
+    unlink(STR(path));
+
+    S9S_VERIFY(writer.open(path, 4096ull, 2));
+    for (int idx = 0; idx < 1000; ++idx)
+    {
+        writer.write(LogDebug, __FILE__, __LINE__, "Some text to rotate.");
+
+        // Give the background thread a chance to write the chunks.
+        if (idx % 100 == 0)
+            writer.flush();
+    }
+    
+    writer.close();
+    S9S_VERIFY(writer.nRotations() > 0ull);
+    
+    rotated = path + ".1";
+    S9S_VERIFY(access(STR(rotated), F_OK) == 0);
+    S9S_VERIFY(countLines(rotated) > 0);
+    unlink(STR(rotated));
+    
+    rotated = path + ".2";
+    S9S_VERIFY(access(STR(rotated), F_OK) == 0);
+    unlink(STR(rotated));
+    
+    rotated = path + ".3";
+    S9S_VERIFY(access(STR(rotated), F_OK) != 0);
+    
+    unlink(STR(path));
+    return true;
+}
+
+/**
+ * If the directory of the log file disappears the rotation can not open a new
+ * file, the logging is disabled then and writing does not crash.
+ */
+bool
+UtS9sLogWriter::testRotateFailure()
+{
+    S9sString    directory;
+    S9sString    path;
+    S9sLogWriter writer;
+
+    directory.sprintf("/tmp/ut_s9slogwriter.%d.dir", getpid());
+    path = directory + "/test.log";
+    S9S_VERIFY(mkdir(STR(directory), 0700) == 0);
+
+    S9S_VERIFY(writer.open(path, 1024ull, 1));
+    S9S_VERIFY(writer.isEnabled(LogDebug));
+
+    unlink(STR(path));
+    S9S_VERIFY(rmdir(STR(directory)) == 0);
+
+    for (int idx = 0; idx < 200; ++idx)
+    {
+        writer.write(LogDebug, __FILE__, __LINE__, "Some text to rotate.");
+
+        if (idx % 20 == 0)
+            writer.flush();
+    }
+
+    writer.flush();
+    S9S_VERIFY(!writer.isEnabled(LogDebug));
+    S9S_VERIFY(!writer.isOpen());
+    
+    writer.write(LogDebug, __FILE__, __LINE__, "Not written.");
+    writer.close();
+
+    return true;
+}
+
+/**
+ * A line longer than the whole buffer is not cut and it stays between the
+ * lines written before and after it.
+ */
+bool
+UtS9sLogWriter::testLongLine()
+{
+    S9sString    path;
+    S9sString    longMessage = std::string(2000, 'x');
+    S9sString    content;
+    S9sLogWriter writer(256);
+    FILE        *stream;
+    char         buffer[4096];
+    size_t       nRead;
+
+    path.sprintf("/tmp/ut_s9slogwriter.%d.long.log", getpid());
+    unlink(STR(path));
+
+    S9S_VERIFY(writer.open(path));
+    writer.write(LogError, __FILE__, __LINE__, "The first line.");
+    writer.write(LogError, __FILE__, __LINE__, longMessage);
+    writer.write(LogError, __FILE__, __LINE__, "The last line.");
+    writer.close();
+
+    S9S_COMPARE(writer.nLines(), 3ull);
+    S9S_COMPARE(countLines(path), 3);
+
+    stream = fopen(STR(path), "r");
+    S9S_VERIFY(stream != NULL);
+    nRead = fread(buffer, 1, sizeof(buffer), stream);
+    fclose(stream);
+    content = S9sString(std::string(buffer, nRead));
+
+    S9S_VERIFY(content.find(longMessage + "\n") != std::string::npos);
+    S9S_VERIFY(content.find("The first line.") < content.find(longMessage));
+    S9S_VERIFY(content.find(longMessage) < content.find("The last line."));
+
+    unlink(STR(path));
+    return true;
+}
+
+int
+UtS9sLogWriter::countLines(
+        const S9sString &path)
+{
+    FILE *stream = fopen(STR(path), "r");
+    int   retval = 0;
+    int   c;
+
+    if (stream == NULL)
+        return -1;
+
+    while ((c = fgetc(stream)) != EOF)
+    {
+        if (c == '\n')
+            ++retval;
+    }
+
+    fclose(stream);
+    return retval;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sLogWriter)
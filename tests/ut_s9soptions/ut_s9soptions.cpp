@@ -47,6 +47,7 @@ UtS9sOptions::runTest(const char *testName)
     PERFORM_TEST(testCreate,        retval);
     PERFORM_TEST(testConfigFile01,  retval);
     PERFORM_TEST(testConfigFile02,  retval);
+    PERFORM_TEST(testConfigIndex,   retval);
     PERFORM_TEST(testController,    retval);
     PERFORM_TEST(testReadOptions01, retval);
     PERFORM_TEST(testReadOptions02, retval);
@@ -64,6 +65,7 @@ UtS9sOptions::runTest(const char *testName)
     PERFORM_TEST(testConfigureWalOptions, retval);
     PERFORM_TEST(testAddController, retval);
     PERFORM_TEST(testVirtualRouterId, retval);
+    PERFORM_TEST(testJobIds, retval);
 
     return retval;
 }
@@ -150,6 +152,52 @@ UtS9sOptions::testConfigFile02()
     return true;
 }
 
+/**
+ * Checks the index of the configuration values: the user's configuration
+ * overrides the system configuration, the command line overrides both.
+ */
+bool
+UtS9sOptions::testConfigIndex()
+{
+    S9sOptions  *options;
+
+    S9sOptions::uninit();
+    options = S9sOptions::instance();
+
+    S9S_VERIFY(options->m_userConfig.parse(
+                "cmon_user = \"user_value\"\n"
+                "color = never\n"
+                "update_freq = 5\n"));
+
+    S9S_VERIFY(options->m_systemConfig.parse(
+                "cmon_user = system_value\n"
+                "cmon_password = system_password\n"
+                "update_freq = 7\n"
+                "truncate = always\n"));
+
+    options->resolveConfig();
+
+    S9S_COMPARE(options->configValue("cmon_user"),       "user_value");
+    S9S_COMPARE(options->configValue("truncate"),        "always");
+    S9S_COMPARE(options->configValue("no_such_variable"), "");
+    S9S_COMPARE(options->userConfigValue("truncate"),    "");
+    S9S_COMPARE(options->systemConfigValue("cmon_user"), "system_value");
+
+    S9S_COMPARE(options->userName(),   "user_value");
+    S9S_COMPARE(options->updateFreq(), 5);
+    S9S_VERIFY(!options->useSyntaxHighlight());
+    S9S_VERIFY(options->truncate());
+
+    // The user config has a user name, so the system password is not used.
+    S9S_COMPARE(options->password(),   "");
+    
+    options->m_options["update_freq"] = 3;
+    S9S_COMPARE(options->updateFreq(), 3);
+
+    S9sOptions::uninit();
+    return true;
+}
+
 /**
  * This function tests the S9sOptions::setController() function with various
  * strings.
@@ -1058,4 +1106,114 @@ UtS9sOptions::testVirtualRouterId()
     return true;
 }
 
+/**
+ * Testing the --job-id option with a list of job IDs and the --all-running
+ * option.
+ */
+bool
+UtS9sOptions::testJobIds()
+{
+    S9sOptions     *options;
+    S9sVariantList  jobIds;
+    bool            success;
+
+    // One job ID, the way it always worked.
+    const char *argv1[] = {
+        "/bin/s9s", "job",
+        "--wait",
+        "--job-id=42",
+        nullptr
+    };
+    int argc1 = sizeof(argv1) / sizeof(char *) - 1;
+
+    S9sOptions::uninit();
+    options = S9sOptions::instance();
+    success = options->readOptions(&argc1, (char **)argv1);
+    S9S_VERIFY(success);
+    S9S_COMPARE(options->jobId(), 42);
+    S9S_COMPARE((int) options->jobIds().size(), 1);
+
+    // A list of job IDs.
+    const char *argv2[] = {
+        "/bin/s9s", "job",
+        "--wait",
+        "--job-id=10,11,12",
+        nullptr
+    };
+    int argc2 = sizeof(argv2) / sizeof(char *) - 1;
+
+    S9sOptions::uninit();
+    options = S9sOptions::instance();
+    success = options->readOptions(&argc2, (char **)argv2);
+    S9S_VERIFY(success);
+    S9S_COMPARE(options->jobId(), 10);
+
+    jobIds = options->jobIds();
+    S9S_COMPARE((int) jobIds.size(), 3);
+    S9S_COMPARE(jobIds[0].toInt(), 10);
+    S9S_COMPARE(jobIds[2].toInt(), 12);
+
+    // Invalid job ID in the list.
+    const char *argv3[] = {
+        "/bin/s9s", "job",
+        "--wait",
+        "--job-id=10,abc",
+        nullptr
+    };
+    int argc3 = sizeof(argv3) / sizeof(char *) - 1;
+
+    S9sOptions::uninit();
+    options = S9sOptions::instance();
+    success = options->readOptions(&argc3, (char **)argv3);
+    S9S_VERIFY(!success);
+
+    // Multiple jobs can only be waited for.
+    const char *argv4[] = {
+        "/bin/s9s", "job",
+        "--log",
+        "--job-id=10,11",
+        nullptr
+    };
+    int argc4 = sizeof(argv4) / sizeof(char *) - 1;
+
+    S9sOptions::uninit();
+    options = S9sOptions::instance();
+    success = options->readOptions(&argc4, (char **)argv4);
+    S9S_VERIFY(!success);
+
+    // The --all-running option.
+    const char *argv5[] = {
+        "/bin/s9s", "job",
+        "--wait",
+        "--all-running",
+        "--cluster-id=1",
+        nullptr
+    };
+    int argc5 = sizeof(argv5) / sizeof(char *) - 1;
+
+    S9sOptions::uninit();
+    options = S9sOptions::instance();
+    success = options->readOptions(&argc5, (char **)argv5);
+    S9S_VERIFY(success);
+    S9S_VERIFY(options->isAllRunningRequested());
+
+    // The --all-running and --job-id are mutually exclusive.
+    const char *argv6[] = {
+        "/bin/s9s", "job",
+        "--wait",
+        "--all-running",
+        "--job-id=10",
+        nullptr
+    };
+    int argc6 = sizeof(argv6) / sizeof(char *) - 1;
+
+    S9sOptions::uninit();
+    options = S9sOptions::instance();
+    success = options->readOptions(&argc6, (char **)argv6);
+    S9S_VERIFY(!success);
+
+    S9sOptions::uninit();
+    return true;
+}
+
 S9S_UNIT_TEST_MAIN(UtS9sOptions)
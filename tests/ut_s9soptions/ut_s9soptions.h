@@ -30,6 +30,7 @@ class UtS9sOptions : public S9sUnitTest
         bool testCreate();
         bool testConfigFile01();
         bool testConfigFile02();
+        bool testConfigIndex();
         bool testController();
         bool testReadOptions01();
         bool testReadOptions02();
@@ -47,4 +48,5 @@ class UtS9sOptions : public S9sUnitTest
         bool testConfigureWalOptions();
         bool testAddController();
         bool testVirtualRouterId();
+        bool testJobIds();
 };
@@ -0,0 +1,283 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9sprocesstable.h"
+
+#include "s9sprocesstable.h"
+#include "s9svariantmap.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sProcessTable::UtS9sProcessTable()
+{
+}
+
+UtS9sProcessTable::~UtS9sProcessTable()
+{
+}
+
+bool
+UtS9sProcessTable::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testDecode,        retval);
+    PERFORM_TEST(testSort,          retval);
+    PERFORM_TEST(testPartialSort,   retval);
+    PERFORM_TEST(testSwap,          retval);
+    PERFORM_TEST(testAppend,        retval);
+
+    return retval;
+}
+
+/**
+ * Decoding the processes of the getRunningProcesses reply.
+ */
+bool
+UtS9sProcessTable::testDecode()
+{
+    S9sProcessTable table;
+
+    S9S_VERIFY(table.empty());
+
+    table.appendHosts(createHosts());
+    S9S_COMPARE((int) table.size(), 4);
+    S9S_COMPARE((int) table.nHosts(), 2);
+
+    S9S_COMPARE(table.pid(0), 100);
+    S9S_COMPARE(table.hostName(0), "db1");
+    S9S_COMPARE(table.hostIndex(0), 0);
+    S9S_COMPARE(table.userName(0), "mysql");
+    S9S_COMPARE(table.priority(0), 20);
+    S9S_COMPARE((int) table.virtMem(0), 4096000);
+    S9S_COMPARE((int) table.resMem(0), 1024000);
+    S9S_COMPARE(table.cpuUsage(0), 12.5);
+    S9S_COMPARE(table.memUsage(0), 30.0);
+    S9S_COMPARE(table.state(0), 'S');
+    S9S_COMPARE(table.executable(0), "mysqld");
+
+    S9S_COMPARE(table.hostName(3), "db2");
+    S9S_COMPARE(table.hostIndex(3), 1);
+    S9S_COMPARE(table.userName(3), "mysql");
+    
+    // Missing fields are decoded as zero/empty.
+    S9S_COMPARE(table.state(2), ' ');
+    S9S_COMPARE((int) table.virtMem(2), 0);
+
+    table.clear();
+    S9S_VERIFY(table.empty());
+    S9S_COMPARE((int) table.nHosts(), 0);
+
+    return true;
+}
+
+/**
+ * The rows can be ordered by the PID, CPU or memory usage; the ties are
+ * ordered by the PID.
+ */
+bool
+UtS9sProcessTable::testSort()
+{
+    S9sProcessTable table;
+    S9sVector<uint> rows;
+
+    table.appendHosts(createHosts());
+
+    rows = table.sortedRows(S9sProcessTable::SortByPid);
+    S9S_COMPARE((int) rows.size(), 4);
+    S9S_COMPARE(table.pid(rows[0]), 1);
+    S9S_COMPARE(table.pid(rows[3]), 300);
+
+    rows = table.sortedRows(S9sProcessTable::SortByCpu);
+    S9S_COMPARE(table.pid(rows[0]), 300);
+    S9S_COMPARE(table.pid(rows[1]), 100);
+    // 0.0 and 0.0, the higher PID first.
+    S9S_COMPARE(table.pid(rows[2]), 200);
+    S9S_COMPARE(table.pid(rows[3]), 1);
+
+    rows = table.sortedRows(S9sProcessTable::SortByMemory);
+    S9S_COMPARE(table.pid(rows[0]), 100);
+
+    return true;
+}
+
+/**
+ * Only the first rows are put in order when only those are needed, they are
+ * the same as the first rows of the full sort.
+ */
+bool
+UtS9sProcessTable::testPartialSort()
+{
+    S9sProcessTable table;
+    S9sVector<uint> all;
+    S9sVector<uint> rows;
+    S9sVariantList  processes;
+
+    for (int idx = 0; idx < 1000; ++idx)
+    {
+        S9sVariantMap process;
+
+        process["pid"]       = idx + 1;
+        process["cpu_usage"] = (double) ((idx * 7919) % 1000) / 10.0;
+        processes << process;
+    }
+
+    table.appendHost("db1", processes);
+    all  = table.sortedRows(S9sProcessTable::SortByCpu);
+    rows = table.sortedRows(S9sProcessTable::SortByCpu, 20u);
+
+    S9S_COMPARE((int) rows.size(), 20);
+    for (uint idx = 0u; idx < rows.size(); ++idx)
+        S9S_COMPARE((int) rows[idx], (int) all[idx]);
+
+    // Sorting a subset of the rows.
+    rows.clear();
+    rows << 10u << 20u << 30u;
+    table.sortRows(rows, S9sProcessTable::SortByPid, 2u);
+    S9S_COMPARE((int) rows.size(), 2);
+    S9S_COMPARE(table.pid(rows[0]), 11);
+    S9S_COMPARE(table.pid(rows[1]), 21);
+
+    // The limit is larger than the number of rows.
+    rows = table.sortedRows(S9sProcessTable::SortByPid, 5000u);
+    S9S_COMPARE((int) rows.size(), 1000);
+
+    return true;
+}
+
+/**
+ * A table is built in the background and swapped in.
+ */
+bool
+UtS9sProcessTable::testSwap()
+{
+    S9sProcessTable shown;
+    S9sProcessTable received;
+
+    received.appendHosts(createHosts());
+    shown.swap(received);
+
+    S9S_COMPARE((int) shown.size(), 4);
+    S9S_COMPARE(shown.hostName(3), "db2");
+    S9S_VERIFY(received.empty());
+
+    return true;
+}
+
+/**
+ * The processes of two clusters are merged into one table.
+ */
+bool
+UtS9sProcessTable::testAppend()
+{
+    S9sProcessTable merged;
+    S9sProcessTable cluster1;
+    S9sProcessTable cluster2;
+    S9sVector<uint> rows;
+
+    cluster1.appendHosts(createHosts(), 1);
+    cluster2.appendHost("db3", createHosts()[0]["processes"].toVariantList(), 2);
+
+    merged.append(cluster1);
+    merged.append(cluster2);
+
+    S9S_COMPARE((int) merged.size(), 7);
+    S9S_COMPARE((int) merged.nHosts(), 3);
+
+    S9S_COMPARE(merged.clusterId(0), 1);
+    S9S_COMPARE(merged.hostName(3), "db2");
+    S9S_COMPARE(merged.clusterId(3), 1);
+    S9S_COMPARE(merged.hostName(4), "db3");
+    S9S_COMPARE(merged.hostIndex(4), 2);
+    S9S_COMPARE(merged.clusterId(4), 2);
+    S9S_COMPARE(merged.userName(4), "mysql");
+    S9S_COMPARE(merged.userName(6), "root");
+    S9S_COMPARE(merged.executable(6), "sshd");
+
+    // The merged table is sorted as a whole.
+    rows = merged.sortedRows(S9sProcessTable::SortByCpu, 3u);
+    S9S_COMPARE(merged.pid(rows[0]), 300);
+    S9S_COMPARE(merged.pid(rows[1]), 100);
+    S9S_COMPARE(merged.pid(rows[2]), 100);
+    
+    // Without a cluster the ID is 0.
+    cluster1.clear();
+    cluster1.appendHosts(createHosts());
+    S9S_COMPARE(cluster1.clusterId(0), 0);
+
+    return true;
+}
+
+S9sVariantList
+UtS9sProcessTable::createHosts()
+{
+    S9sVariantList hosts;
+    S9sVariantList processes;
+    S9sVariantMap  host;
+    S9sVariantMap  process;
+
+    process["pid"]        = 100;
+    process["user"]       = "mysql";
+    process["priority"]   = 20;
+    process["virt_mem"]   = 4096000ull;
+    process["res_mem"]    = 1024000ull;
+    process["cpu_usage"]  = 12.5;
+    process["mem_usage"]  = 30.0;
+    process["state"]      = "S";
+    process["executable"] = "mysqld";
+    processes << process;
+
+    process.clear();
+    process["pid"]        = 1;
+    process["user"]       = "root";
+    process["cpu_usage"]  = 0.0;
+    process["mem_usage"]  = 0.1;
+    process["state"]      = "S";
+    process["executable"] = "systemd";
+    processes << process;
+    
+    process.clear();
+    process["pid"]        = 200;
+    process["user"]       = "root";
+    process["executable"] = "sshd";
+    processes << process;
+
+    host["hostname"]      = "db1";
+    host["processes"]     = processes;
+    hosts << host;
+
+    processes.clear();
+    process.clear();
+    process["pid"]        = 300;
+    process["user"]       = "mysql";
+    process["cpu_usage"]  = 50.0;
+    process["mem_usage"]  = 20.0;
+    process["state"]      = "R";
+    process["executable"] = "mysqld";
+    processes << process;
+
+    host["hostname"]      = "db2";
+    host["processes"]     = processes;
+    hosts << host;
+
+    return hosts;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sProcessTable)
@@ -0,0 +1,154 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9srecordwriter.h"
+
+#include "s9srecordwriter.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sRecordWriter::UtS9sRecordWriter()
+{
+}
+
+UtS9sRecordWriter::~UtS9sRecordWriter()
+{
+}
+
+bool
+UtS9sRecordWriter::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testFormat,        retval);
+    PERFORM_TEST(testNdjson,        retval);
+    PERFORM_TEST(testCsv,           retval);
+    PERFORM_TEST(testTsv,           retval);
+
+    return retval;
+}
+
+bool
+UtS9sRecordWriter::testFormat()
+{
+    S9S_COMPARE(
+            S9sRecordWriter::formatFromString("ndjson"), 
+            S9sRecordWriter::Ndjson);
+
+    S9S_COMPARE(
+            S9sRecordWriter::formatFromString("CSV"), 
+            S9sRecordWriter::Csv);
+    
+    S9S_COMPARE(
+            S9sRecordWriter::formatFromString("tsv"), 
+            S9sRecordWriter::Tsv);
+    
+    S9S_COMPARE(
+            S9sRecordWriter::formatFromString("xml"), 
+            S9sRecordWriter::Invalid);
+
+    S9S_VERIFY(!S9sRecordWriter("table", S9sVariantList()).isValid());
+
+    return true;
+}
+
+/**
+ * NDJSON with and without field projection, the paths can point into the
+ * embedded objects.
+ */
+bool
+UtS9sRecordWriter::testNdjson()
+{
+    S9sVariantMap   record;
+    S9sVariantMap   host;
+    S9sVariantList  fields;
+
+    host["hostname"]  = "192.168.0.1";
+    record["job_id"]  = 42;
+    record["status"]  = "FINISHED";
+    record["host"]    = host;
+
+    S9sRecordWriter writer1("ndjson", S9sVariantList());
+
+    S9S_COMPARE(writer1.header(), "");
+    S9S_COMPARE(
+            writer1.toLine(record), 
+            "{ \"job_id\": 42, \"status\": \"FINISHED\", "
+            "\"host\": { \"hostname\": \"192.168.0.1\" } }");
+    
+    fields << "status" << "host/hostname" << "missing";
+    S9sRecordWriter writer2("ndjson", fields);
+    S9S_COMPARE(
+            writer2.toLine(record), 
+            "{ \"host/hostname\": \"192.168.0.1\", \"status\": \"FINISHED\" }");
+
+    return true;
+}
+
+/**
+ * The columns of the CSV are taken from the first record if not set, the
+ * values are quoted if necessary.
+ */
+bool
+UtS9sRecordWriter::testCsv()
+{
+    S9sVariantMap   record;
+    S9sVariantMap   host;
+    S9sVariantList  fields;
+
+    host["port"]      = 3306;
+    record["id"]      = 1;
+    record["message"] = "Hello, \"world\"";
+    record["host"]    = host;
+
+    S9sRecordWriter writer1("csv", S9sVariantList());
+    S9S_COMPARE(writer1.toLine(record), "1,\"Hello, \"\"world\"\"\"");
+    S9S_COMPARE(writer1.header(), "id,message");
+    
+    record["id"]      = 2;
+    record["message"] = "plain";
+    S9S_COMPARE(writer1.toLine(record), "2,plain");
+    
+    fields << "host" << "nothing" << "id";
+    S9sRecordWriter writer2("csv", fields);
+    S9S_COMPARE(writer2.header(), "host,nothing,id");
+    S9S_COMPARE(writer2.toLine(record), "\"{ \"\"port\"\": 3306 }\",,2");
+
+    return true;
+}
+
+bool
+UtS9sRecordWriter::testTsv()
+{
+    S9sVariantMap   record;
+    S9sVariantList  fields;
+
+    record["id"]      = 7;
+    record["message"] = "line1\nline2\tend\\";
+
+    fields << "id" << "message";
+    S9sRecordWriter writer("tsv", fields);
+    S9S_COMPARE(writer.header(), "id\tmessage");
+    S9S_COMPARE(writer.toLine(record), "7\tline1\\nline2\\tend\\\\");
+
+    return true;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sRecordWriter)
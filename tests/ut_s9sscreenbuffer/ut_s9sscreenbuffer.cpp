@@ -0,0 +1,243 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9sscreenbuffer.h"
+
+#include "s9sscreenbuffer.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sScreenBuffer::UtS9sScreenBuffer()
+{
+}
+
+UtS9sScreenBuffer::~UtS9sScreenBuffer()
+{
+}
+
+bool
+UtS9sScreenBuffer::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testParse01,       retval);
+    PERFORM_TEST(testParse02,       retval);
+    PERFORM_TEST(testAttributes,    retval);
+    PERFORM_TEST(testRender01,      retval);
+    PERFORM_TEST(testRender02,      retval);
+    PERFORM_TEST(testWideChars,     retval);
+
+    return retval;
+}
+
+/**
+ * Checking the basic text, new-line and erase handling.
+ */
+bool
+UtS9sScreenBuffer::testParse01()
+{
+    S9sScreenBuffer buffer;
+
+    buffer.setSize(10, 3);
+    buffer.parse(TERM_HOME "hello" TERM_ERASE_EOL "\n\rworld");
+
+    S9S_COMPARE(buffer.lineAt(0), "hello     ");
+    S9S_COMPARE(buffer.lineAt(1), "world     ");
+    S9S_COMPARE(buffer.lineAt(2), "          ");
+    
+    buffer.parse(TERM_HOME "\033[1Cxy\033[1K");
+    S9S_COMPARE(buffer.lineAt(0), "    o     ");
+    
+    buffer.parse("\033[2;3H\033[2K");
+    S9S_COMPARE(buffer.lineAt(1), "          ");
+    
+    // The new-line on the last line does not scroll.
+    buffer.parse("\033[3;1Hlast\n\r!");
+    S9S_COMPARE(buffer.lineAt(2), "!ast      ");
+
+    return true;
+}
+
+/**
+ * Cursor addressing and the right edge (the auto-wrap is off on our screens).
+ */
+bool
+UtS9sScreenBuffer::testParse02()
+{
+    S9sScreenBuffer buffer;
+
+    buffer.setSize(10, 2);
+    buffer.parse("\033[2;8Habcdef");
+    S9S_COMPARE(buffer.lineAt(0), "          ");
+    S9S_COMPARE(buffer.lineAt(1), "       abf");
+
+    buffer.parse("\033[H0123456789" "\033[2J");
+    S9S_COMPARE(buffer.lineAt(0), "          ");
+    S9S_COMPARE(buffer.lineAt(1), "          ");
+    
+    buffer.parse("\033[Ha\tb");
+    S9S_COMPARE(buffer.lineAt(0), "a       b ");
+
+    return true;
+}
+
+bool
+UtS9sScreenBuffer::testAttributes()
+{
+    S9sScreenBuffer buffer;
+    S9sScreenAttr   attr;
+
+    buffer.setSize(10, 2);
+    buffer.parse(TERM_HOME TERM_RED "X" TERM_NORMAL "Y\033[38;5;17m\033[48;5;4mZ");
+
+    attr = buffer.cellAt(0, 0).m_attr;
+    S9S_COMPARE((int) attr.m_flags,    (int) S9sScreenAttr::Bold);
+    S9S_COMPARE(attr.m_foreground,     1);
+    S9S_COMPARE(attr.toSgr(),          "\033[0;1;31m");
+    
+    attr = buffer.cellAt(1, 0).m_attr;
+    S9S_COMPARE((int) attr.m_flags,    0);
+    S9S_COMPARE(attr.m_foreground,     -1);
+    S9S_COMPARE(attr.toSgr(),          "\033[0m");
+    
+    attr = buffer.cellAt(2, 0).m_attr;
+    S9S_COMPARE(attr.m_foreground,     17);
+    S9S_COMPARE(attr.m_background,     4);
+    S9S_COMPARE(attr.toSgr(),          "\033[0;38;5;17;44m");
+
+    // Erasing keeps only the background color.
+    buffer.parse(TERM_INVERSE TERM_ERASE_EOL);
+    attr = buffer.cellAt(5, 0).m_attr;
+    S9S_COMPARE((int) attr.m_flags,    0);
+    S9S_COMPARE(attr.m_foreground,     -1);
+    S9S_COMPARE(attr.m_background,     4);
+
+    return true;
+}
+
+/**
+ * The first frame is sent as a whole, then the same frame again should cost
+ * nothing.
+ */
+bool
+UtS9sScreenBuffer::testRender01()
+{
+    S9sScreenBuffer buffer;
+    S9sString       frame;
+    S9sString       output;
+
+    frame = TERM_HOME "line 1" TERM_ERASE_EOL "\n\rline 2" TERM_ERASE_EOL;
+
+    buffer.setSize(20, 2);
+    buffer.parse(frame);
+    output = buffer.render();
+    S9S_VERIFY(output.startsWith("\033[0m\033[H\033[2J"));
+    S9S_VERIFY(output.contains("line 1"));
+    S9S_VERIFY(output.contains("line 2"));
+
+    buffer.parse(frame);
+    output = buffer.render();
+    S9S_COMPARE(output, "");
+    S9S_COMPARE(buffer.nFrames(), 2ull);
+    S9S_COMPARE(buffer.bytesGenerated(), 2ull * frame.length());
+
+    // After invalidating everything is sent again.
+    buffer.invalidate();
+    buffer.parse(frame);
+    output = buffer.render();
+    S9S_VERIFY(output.contains("line 1"));
+
+    return true;
+}
+
+/**
+ * Only the changed cells are sent with cursor addressing.
+ */
+bool
+UtS9sScreenBuffer::testRender02()
+{
+    S9sScreenBuffer buffer;
+    S9sString       output;
+
+    buffer.setSize(10, 2);
+    buffer.parse(TERM_HOME "abcde" TERM_ERASE_EOL);
+    buffer.render();
+
+    buffer.parse(TERM_HOME "abXde" TERM_ERASE_EOL);
+    output = buffer.render();
+    S9S_COMPARE(output, "\033[1;3HX");
+
+    // Two close changes are sent together, the gap is re-sent.
+    buffer.parse(TERM_HOME "QbXdQ" TERM_ERASE_EOL);
+    output = buffer.render();
+    S9S_COMPARE(output, "\033[1;1HQbXdQ");
+    
+    // Attributes are sent only when they change.
+    buffer.parse("\033[2;1H" TERM_BOLD "hi" TERM_NORMAL);
+    output = buffer.render();
+    S9S_COMPARE(output, "\033[2;1H\033[0;1mhi");
+    
+    // Trailing blanks are cleared with one sequence.
+    buffer.parse(TERM_HOME TERM_NORMAL TERM_ERASE_EOL);
+    output = buffer.render();
+    S9S_COMPARE(output, "\033[1;1H\033[0m\033[K");
+
+    // The cursor.
+    buffer.parse("\033[2;4H" TERM_CURSOR_ON);
+    output = buffer.render();
+    S9S_COMPARE(output, "\033[2;4H" TERM_CURSOR_ON);
+    
+    buffer.parse(TERM_CURSOR_OFF);
+    output = buffer.render();
+    S9S_COMPARE(output, TERM_CURSOR_OFF);
+
+    return true;
+}
+
+/**
+ * If a row has characters that might be wider than one cell the whole row is
+ * sent whenever something changes in it.
+ */
+bool
+UtS9sScreenBuffer::testWideChars()
+{
+    S9sScreenBuffer buffer;
+    S9sString       output;
+
+    buffer.setSize(10, 2);
+    buffer.parse(TERM_HOME "⏸️ ab" TERM_ERASE_EOL "\n\r│ box");
+    S9S_COMPARE(buffer.lineAt(0), "⏸️ ab      ");
+    S9S_COMPARE(buffer.lineAt(1), "│ box     ");
+    S9S_VERIFY(buffer.cellAt(0, 0).isAmbiguousWidth());
+    S9S_VERIFY(!buffer.cellAt(0, 1).isAmbiguousWidth());
+    buffer.render();
+
+    buffer.parse(TERM_HOME "⏸️ ac");
+    output = buffer.render();
+    S9S_COMPARE(output, "\033[1;1H⏸️ ac\033[K");
+    
+    buffer.parse("\033[2;3HB");
+    output = buffer.render();
+    S9S_COMPARE(output, "\033[2;3HB");
+
+    return true;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sScreenBuffer)
@@ -0,0 +1,358 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9sstatcache.h"
+
+#include "s9sstatcache.h"
+#include "s9sfile.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <utime.h>
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sStatCache::UtS9sStatCache()
+{
+    m_directory.sprintf("/tmp/ut_s9sstatcache.%d", getpid());
+}
+
+UtS9sStatCache::~UtS9sStatCache()
+{
+    S9sString command;
+
+    command.sprintf("rm -rf '%s'", STR(m_directory));
+    if (system(STR(command)) != 0)
+        S9S_WARNING("Failed to remove '%s'.", STR(m_directory));
+}
+
+bool
+UtS9sStatCache::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testEntryName,     retval);
+    PERFORM_TEST(testMissingRanges, retval);
+    PERFORM_TEST(testSaveAndLoad,   retval);
+    PERFORM_TEST(testEviction,      retval);
+    PERFORM_TEST(testSameTime,      retval);
+
+    return retval;
+}
+
+/**
+ * The entry names are used as directory names.
+ */
+bool
+UtS9sStatCache::testEntryName()
+{
+    S9S_COMPARE(
+            S9sStatCache::entryName("127.0.0.1", 9501, "1", "cpustat"),
+            "127.0.0.1-9501-1-cpustat");
+
+    S9S_COMPARE(
+            S9sStatCache::entryName("host", 9501, "my cluster/2", "sqlstat"),
+            "host-9501-my_cluster_2-sqlstat");
+
+    S9S_COMPARE(
+            S9sStatCache::entryName("..", 1, "x", "y"),
+            "_.-1-x-y");
+
+    return true;
+}
+
+/**
+ * Only the time before and after the covered range is requested, the last
+ * settleTime seconds are requested again.
+ */
+bool
+UtS9sStatCache::testMissingRanges()
+{
+    S9sStatCache       cache(m_directory, 1024 * 1024);
+    S9sVector<time_t>  starts;
+    S9sVector<time_t>  ends;
+    S9sVariantList     samples;
+    time_t             now = 100000;
+
+    // An empty cache does not cover anything.
+    cache.missingRanges(1000, 2000, starts, ends);
+    S9S_COMPARE((int) starts.size(), 1);
+    S9S_COMPARE((int) starts[0], 1000);
+    S9S_COMPARE((int) ends[0],   2000);
+
+    cache.merge(samples, S9sVariantList(), 1000, 2000, now);
+    S9S_COMPARE((int) cache.begin(), 1000);
+    S9S_COMPARE((int) cache.end(),   2000);
+
+    // Covered.
+    cache.missingRanges(1200, 1800, starts, ends);
+    S9S_COMPARE((int) starts.size(), 0);
+
+    // Before and after.
+    cache.missingRanges(500, 2500, starts, ends);
+    S9S_COMPARE((int) starts.size(), 2);
+    S9S_COMPARE((int) starts[0], 500);
+    S9S_COMPARE((int) ends[0],   1000);
+    S9S_COMPARE((int) starts[1], 2000);
+    S9S_COMPARE((int) ends[1],   2500);
+
+    // Extending the covered range.
+    cache.merge(samples, S9sVariantList(), 2000, 3000, now);
+    S9S_COMPARE((int) cache.begin(), 1000);
+    S9S_COMPARE((int) cache.end(),   3000);
+
+    // A range that does not overlap is requested as a whole and replaces the
+    // cached range.
+    cache.missingRanges(5000, 6000, starts, ends);
+    S9S_COMPARE((int) starts.size(), 1);
+    S9S_COMPARE((int) starts[0], 5000);
+    S9S_COMPARE((int) ends[0],   6000);
+
+    cache.merge(samples, S9sVariantList(), 5000, 6000, now);
+    S9S_COMPARE((int) cache.begin(), 5000);
+    S9S_COMPARE((int) cache.end(),   6000);
+
+    // The last seconds are not covered.
+    cache.merge(samples, S9sVariantList(), 6000, now, now);
+    S9S_COMPARE((int) cache.end(), (int) (now - S9sStatCache::settleTime));
+    
+    cache.missingRanges(now - 3600, now, starts, ends);
+    S9S_COMPARE((int) starts.size(), 1);
+    S9S_COMPARE((int) starts[0], (int) (now - S9sStatCache::settleTime));
+    S9S_COMPARE((int) ends[0],   (int) now);
+
+    return true;
+}
+
+/**
+ * The samples are merged, saved and loaded back with the values and the list
+ * of hosts unchanged.
+ */
+bool
+UtS9sStatCache::testSaveAndLoad()
+{
+    S9sString       name = S9sStatCache::entryName("host", 9501, "1", "cpu");
+    S9sStatCache    cache(m_directory, 1024 * 1024);
+    S9sVariantList  hosts;
+    S9sVariantList  samples;
+    S9sVariantList  result;
+    S9sVariantMap   host;
+
+    host["hostid"]   = 1;
+    host["hostname"] = "192.168.0.1";
+    hosts << host;
+    
+    host["hostid"]   = 2;
+    host["hostname"] = "192.168.0.2";
+    hosts << host;
+
+    for (int idx = 0; idx < 10; ++idx)
+    {
+        samples << createSample(1, 1000 + idx * 10, idx + 0.123456789);
+        samples << createSample(2, 1000 + idx * 10, 1234567890.5 + idx);
+    }
+
+    S9S_VERIFY(!cache.load(name));
+    cache.merge(samples, hosts, 1000, 1100, 100000);
+    S9S_COMPARE(cache.nSamples(), 20);
+
+    // The samples we already have are replaced.
+    samples.clear();
+    samples << createSample(1, 1090, 42.0);
+    samples << createSample(2, 1100, 43.0);
+    cache.merge(samples, S9sVariantList(), 1090, 1100, 100000);
+    S9S_COMPARE(cache.nSamples(), 21);
+    S9S_VERIFY(cache.save());
+
+    // Loading it back.
+    S9sStatCache loaded(m_directory, 1024 * 1024);
+
+    S9S_VERIFY(loaded.load(name));
+    S9S_COMPARE((int) loaded.begin(),    1000);
+    S9S_COMPARE((int) loaded.end(),      1100);
+    S9S_COMPARE(loaded.nSamples(), 21);
+    S9S_COMPARE((int) loaded.hosts().size(), 2);
+    S9S_COMPARE(
+            loaded.hosts()[1].toVariantMap().at("hostname").toString(), 
+            "192.168.0.2");
+
+    // The samples are ordered by time.
+    result = loaded.samples(1010, 1030);
+    S9S_COMPARE((int) result.size(), 6);
+    S9S_COMPARE(result[0].toVariantMap().at("created").toInt(), 1010);
+    S9S_COMPARE(result[0].toVariantMap().at("hostid").toInt(),  1);
+    S9S_COMPARE(result[1].toVariantMap().at("hostid").toInt(),  2);
+    S9S_COMPARE(result[5].toVariantMap().at("created").toInt(), 1030);
+    S9S_COMPARE(result[0].toVariantMap().at("interval").toInt(), 10000);
+    S9S_COMPARE(
+            result[0].toVariantMap().at("value").toDouble(), 1.123456789);
+    S9S_COMPARE(
+            result[1].toVariantMap().at("value").toDouble(), 1234567891.5);
+
+    result = loaded.samples(1090, 2000);
+    S9S_COMPARE((int) result.size(), 3);
+    S9S_COMPARE(result[0].toVariantMap().at("value").toDouble(), 42.0);
+    S9S_COMPARE(result[2].toVariantMap().at("value").toDouble(), 43.0);
+
+    return true;
+}
+
+/**
+ * The entries used the longest time ago are removed when the cache is too
+ * big.
+ */
+bool
+UtS9sStatCache::testEviction()
+{
+    S9sString       directory = m_directory + "/eviction";
+    S9sVariantList  samples;
+    ulonglong       size = 0ull;
+
+    for (int idx = 0; idx < 100; ++idx)
+        samples << createSample(1, 1000 + idx * 10, idx);
+
+    for (int idx = 0; idx < 3; ++idx)
+    {
+        S9sStatCache    cache(directory, 1024 * 1024);
+        S9sString       name;
+        S9sString       path;
+        struct utimbuf  times;
+
+        name.sprintf("entry%d", idx);
+        path = directory + "/" + name + "/index";
+
+        S9S_VERIFY(!cache.load(name));
+        cache.merge(samples, S9sVariantList(), 1000, 2000, 100000);
+        S9S_VERIFY(cache.save());
+
+        // The entries were used one hour after the other.
+        times.actime  = 1000000 + idx * 3600;
+        times.modtime = 1000000 + idx * 3600;
+        S9S_VERIFY(utime(STR(path), &times) == 0);
+    }
+
+    size = S9sStatCache(directory, 1024 * 1024).evict();
+    S9S_VERIFY(size > 0ull);
+
+    // Using the first one, so the second one is the oldest.
+    S9S_VERIFY(S9sStatCache(directory, 1024 * 1024).load("entry0"));
+
+    // Room for two entries.
+    S9sStatCache(directory, size * 2 / 3 + 1).evict();
+    S9S_VERIFY(S9sFile::fileExists(directory + "/entry0/index"));
+    S9S_VERIFY(!S9sFile::fileExists(directory + "/entry1/index"));
+    S9S_VERIFY(S9sFile::fileExists(directory + "/entry2/index"));
+
+    S9S_VERIFY(S9sStatCache(directory, 1024 * 1024).load("entry2"));
+    S9S_COMPARE((int) S9sStatCache(directory, 1).evict(), 0);
+    S9S_VERIFY(!S9sFile::fileExists(directory + "/entry0/index"));
+    S9S_VERIFY(!S9sFile::fileExists(directory + "/entry2/index"));
+
+    return true;
+}
+
+/**
+ * The controller sends one sample for every CPU core, partition and network
+ * interface with the same creation time, the cache has to keep all of them.
+ */
+bool
+UtS9sStatCache::testSameTime()
+{
+    S9sString       name = S9sStatCache::entryName("host", 9501, "1", "same");
+    S9sStatCache    cache(m_directory, 1024 * 1024);
+    S9sVariantList  samples;
+    S9sVariantList  result;
+    S9sVariantMap   sample;
+
+    for (int idx = 0; idx < 10; ++idx)
+    {
+        for (int cpuId = 0; cpuId < 4; ++cpuId)
+        {
+            sample = createSample(1, 1000 + idx * 10, cpuId);
+            sample["cpuid"] = cpuId;
+            samples << sample;
+        }
+
+        sample = createSample(1, 1000 + idx * 10, 1.0);
+        sample["mountpoint"] = "/";
+        samples << sample;
+
+        sample = createSample(1, 1000 + idx * 10, 2.0);
+        sample["mountpoint"] = "/home";
+        samples << sample;
+        
+        sample = createSample(1, 1000 + idx * 10, 3.0);
+        sample["interface"] = "eth0";
+        samples << sample;
+    }
+
+    S9S_VERIFY(!cache.load(name));
+    cache.merge(samples, S9sVariantList(), 1000, 1100, 100000);
+    S9S_COMPARE(cache.nSamples(), 70);
+
+    // Receiving the same samples again does not duplicate them.
+    cache.merge(samples, S9sVariantList(), 1000, 1100, 100000);
+    S9S_COMPARE(cache.nSamples(), 70);
+    S9S_VERIFY(cache.save());
+
+    S9sStatCache loaded(m_directory, 1024 * 1024);
+
+    S9S_VERIFY(loaded.load(name));
+    S9S_COMPARE(loaded.nSamples(), 70);
+
+    result = loaded.samples(1000, 1000);
+    S9S_COMPARE((int) result.size(), 7);
+
+    for (uint idx = 0u; idx < result.size(); ++idx)
+    {
+        S9sVariantMap theMap = result[idx].toVariantMap();
+
+        if (theMap.contains("cpuid"))
+        {
+            S9S_COMPARE(
+                    theMap.at("value").toDouble(), 
+                    theMap.at("cpuid").toDouble());
+        } else if (theMap.contains("mountpoint") && 
+                theMap.at("mountpoint").toString() == "/home")
+        {
+            S9S_COMPARE(theMap.at("value").toDouble(), 2.0);
+        }
+    }
+
+    return true;
+}
+
+S9sVariantMap
+UtS9sStatCache::createSample(
+        const int     hostId,
+        const time_t  created,
+        const double  value)
+{
+    S9sVariantMap retval;
+
+    retval["hostid"]   = hostId;
+    retval["created"]  = (ulonglong) created;
+    retval["interval"] = 10000;
+    retval["value"]    = value;
+
+    return retval;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sStatCache)
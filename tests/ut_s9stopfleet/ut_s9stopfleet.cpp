@@ -0,0 +1,399 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9stopfleet.h"
+
+#include "s9stopfleet.h"
+#include "s9svariantmap.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+#define GIGABYTE 1073741824ull
+
+UtS9sTopFleet::UtS9sTopFleet()
+{
+}
+
+UtS9sTopFleet::~UtS9sTopFleet()
+{
+}
+
+bool
+UtS9sTopFleet::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testClusters,      retval);
+    PERFORM_TEST(testUpdate,        retval);
+    PERFORM_TEST(testSchedule,      retval);
+    PERFORM_TEST(testRank,          retval);
+    PERFORM_TEST(testMerge,         retval);
+
+    return retval;
+}
+
+/**
+ * The list of the clusters is refreshed, the clusters that are new are polled
+ * at once, the ones that disappeared are removed.
+ */
+bool
+UtS9sTopFleet::testClusters()
+{
+    S9sTopFleet     fleet;
+    S9sProcessTable processes;
+    S9sVariantList  clusters = createClusters(3);
+    S9sVector<int>  due;
+
+    fleet.setClusters(clusters, 1000ll);
+    S9S_COMPARE((int) fleet.nClusters(), 3);
+    S9S_VERIFY(fleet.hasCluster(2));
+    S9S_VERIFY(!fleet.hasCluster(4));
+    S9S_COMPARE(fleet.cluster(2).m_clusterName, "cluster_2");
+    S9S_COMPARE(fleet.cluster(2).m_state, "STARTED");
+
+    due = fleet.dueClusters(1000ll);
+    S9S_COMPARE((int) due.size(), 3);
+    S9S_COMPARE(due[0], 1);
+    S9S_COMPARE(due[2], 3);
+    
+    // The clusters are not due before they are added.
+    due = fleet.dueClusters(999ll);
+    S9S_COMPARE((int) due.size(), 0);
+
+    processes.appendHosts(createHosts("db1"), 1);
+    fleet.update(1, createCpuStats(0.5), createMemoryStats(GIGABYTE), 
+            processes, 1000ll);
+
+    /*
+     * Cluster 3 is gone, the others keep their data.
+     */
+    clusters.erase(clusters.begin() + 2);
+    clusters[0]["cluster_name"] = "renamed";
+    fleet.setClusters(clusters, 5000ll);
+
+    S9S_COMPARE((int) fleet.nClusters(), 2);
+    S9S_VERIFY(!fleet.hasCluster(3));
+    S9S_COMPARE(fleet.cluster(1).m_clusterName, "renamed");
+    S9S_COMPARE(fleet.cluster(1).m_nPolls, 1);
+    S9S_COMPARE((int) fleet.cluster(1).m_processes.size(), 2);
+    S9S_COMPARE((int) fleet.nProcesses(), 2);
+
+    // Clusters without an ID are ignored.
+    clusters << S9sVariantMap();
+    fleet.setClusters(clusters, 5000ll);
+    S9S_COMPARE((int) fleet.nClusters(), 2);
+
+    return true;
+}
+
+/**
+ * The statistics of the clusters are aggregated.
+ */
+bool
+UtS9sTopFleet::testUpdate()
+{
+    S9sTopFleet     fleet;
+    S9sProcessTable processes;
+    S9sVariantList  cpuStats = createCpuStats(0.25);
+    S9sVariantMap   oldSample;
+
+    // An older sample of the same core is ignored.
+    oldSample = cpuStats[0].toVariantMap();
+    oldSample["created"] = 10;
+    oldSample["idle"]    = 1.0;
+    cpuStats << oldSample;
+
+    fleet.setClusters(createClusters(1), 0ll);
+    processes.appendHosts(createHosts("db1"), 1);
+
+    fleet.update(1, cpuStats, createMemoryStats(3 * GIGABYTE), 
+            processes, 100ll);
+
+    const S9sTopFleetCluster &cluster = fleet.cluster(1);
+
+    S9S_COMPARE(cluster.m_nHosts, 2);
+    S9S_COMPARE(cluster.m_nCores, 4);
+    S9S_COMPARE(cluster.m_cpuUsage, 75.0);
+    S9S_COMPARE((int) (cluster.m_memTotal / GIGABYTE), 16);
+    S9S_COMPARE((int) (cluster.m_memUsed / GIGABYTE), 6);
+    S9S_COMPARE((int) cluster.m_processes.size(), 2);
+    S9S_COMPARE((int) cluster.m_lastUpdate, 100);
+    S9S_COMPARE(cluster.m_nPolls, 1);
+    
+    // The table that was passed got the previous processes.
+    S9S_VERIFY(processes.empty());
+
+    // Without statistics the CPU usage is not known.
+    processes.appendHosts(createHosts("db1"), 1);
+    fleet.update(1, S9sVariantList(), S9sVariantList(), processes, 200ll);
+    S9S_COMPARE(fleet.cluster(1).m_cpuUsage, -1.0);
+    S9S_COMPARE(fleet.cluster(1).m_nHosts, 1);
+    S9S_COMPARE((int) fleet.cluster(1).m_memTotal, 0);
+
+    // Updating a cluster that is not in the fleet does nothing.
+    fleet.update(42, cpuStats, S9sVariantList(), processes, 200ll);
+    S9S_VERIFY(!fleet.hasCluster(42));
+
+    return true;
+}
+
+/**
+ * The busy clusters are polled with the shortest interval, the idle clusters
+ * less and less often, a change in the load resets the interval.
+ */
+bool
+UtS9sTopFleet::testSchedule()
+{
+    S9sTopFleet     fleet;
+    S9sProcessTable processes;
+    S9sVector<int>  due;
+
+    fleet.setIntervals(1000, 8000);
+    fleet.setJitter(0);
+    fleet.setBusyThreshold(50.0);
+    fleet.setClusters(createClusters(3), 0ll);
+
+    // Busy.
+    fleet.update(1, createCpuStats(0.2), S9sVariantList(), processes, 0ll);
+    S9S_COMPARE((int) fleet.cluster(1).m_nextPoll, 1000);
+
+    // Idle.
+    fleet.update(2, createCpuStats(0.95), S9sVariantList(), processes, 0ll);
+    S9S_COMPARE((int) fleet.cluster(2).m_nextPoll, 2000);
+
+    // Failed.
+    fleet.failed(3, 0ll);
+    S9S_COMPARE((int) fleet.cluster(3).m_nextPoll, 2000);
+    S9S_COMPARE(fleet.cluster(3).m_nFailures, 1);
+
+    due = fleet.dueClusters(1500ll);
+    S9S_COMPARE((int) due.size(), 1);
+    S9S_COMPARE(due[0], 1);
+
+    /*
+     * The idle cluster backs off up to the limit.
+     */
+    fleet.update(2, createCpuStats(0.95), S9sVariantList(), processes, 2000ll);
+    S9S_COMPARE((int) fleet.cluster(2).m_nextPoll, 6000);
+    
+    fleet.update(2, createCpuStats(0.95), S9sVariantList(), processes, 6000ll);
+    S9S_COMPARE((int) fleet.cluster(2).m_nextPoll, 14000);
+    
+    fleet.update(2, createCpuStats(0.95), S9sVariantList(), processes, 14000ll);
+    S9S_COMPARE((int) fleet.cluster(2).m_nextPoll, 22000);
+
+    // The load changed.
+    fleet.update(2, createCpuStats(0.7), S9sVariantList(), processes, 22000ll);
+    S9S_COMPARE((int) fleet.cluster(2).m_nextPoll, 23000);
+
+    /*
+     * The one waiting the longest comes first.
+     */
+    due = fleet.dueClusters(30000ll);
+    S9S_COMPARE((int) due.size(), 3);
+    S9S_COMPARE(due[0], 1);
+    S9S_COMPARE(due[1], 3);
+    S9S_COMPARE(due[2], 2);
+
+    return true;
+}
+
+/**
+ * The clusters are ranked by CPU or memory usage.
+ */
+bool
+UtS9sTopFleet::testRank()
+{
+    S9sTopFleet     fleet;
+    S9sProcessTable processes;
+    S9sVector<int>  ranked;
+
+    fleet.setClusters(createClusters(3), 0ll);
+    fleet.update(1, createCpuStats(0.2), createMemoryStats(GIGABYTE), 
+            processes, 0ll);
+    fleet.update(2, createCpuStats(0.9), createMemoryStats(4 * GIGABYTE), 
+            processes, 0ll);
+
+    ranked = fleet.rankedClusters(S9sProcessTable::SortByCpu);
+    S9S_COMPARE((int) ranked.size(), 3);
+    S9S_COMPARE(ranked[0], 1);
+    S9S_COMPARE(ranked[1], 2);
+    S9S_COMPARE(ranked[2], 3);
+
+    ranked = fleet.rankedClusters(S9sProcessTable::SortByMemory);
+    S9S_COMPARE(ranked[0], 2);
+    S9S_COMPARE(ranked[1], 1);
+    S9S_COMPARE(ranked[2], 3);
+
+    ranked = fleet.rankedClusters(S9sProcessTable::SortByPid);
+    S9S_COMPARE(ranked[0], 1);
+    S9S_COMPARE(ranked[1], 2);
+    S9S_COMPARE(ranked[2], 3);
+
+    return true;
+}
+
+/**
+ * The processes of the clusters are merged into one table.
+ */
+bool
+UtS9sTopFleet::testMerge()
+{
+    S9sTopFleet     fleet;
+    S9sProcessTable processes;
+    S9sProcessTable merged;
+    S9sVector<uint> rows;
+
+    fleet.setClusters(createClusters(2), 0ll);
+
+    processes.appendHosts(createHosts("db1"), 1);
+    fleet.update(1, S9sVariantList(), S9sVariantList(), processes, 0ll);
+    
+    processes.clear();
+    processes.appendHosts(createHosts("db2"), 2);
+    fleet.update(2, S9sVariantList(), S9sVariantList(), processes, 0ll);
+
+    fleet.merge(merged);
+    S9S_COMPARE((int) merged.size(), 4);
+    S9S_COMPARE((int) merged.nHosts(), 2);
+    S9S_COMPARE((int) fleet.nHosts(), 2);
+
+    rows = merged.sortedRows(S9sProcessTable::SortByCpu);
+    S9S_COMPARE(merged.hostName(rows[0]), "db1");
+    S9S_COMPARE(merged.clusterId(rows[0]), 1);
+    S9S_COMPARE(merged.hostName(rows[1]), "db2");
+    S9S_COMPARE(merged.clusterId(rows[1]), 2);
+
+    return true;
+}
+
+/**
+ * \returns A list of clusters as the getAllClusterInfo reply holds them.
+ */
+S9sVariantList
+UtS9sTopFleet::createClusters(
+        const int nClusters)
+{
+    S9sVariantList clusters;
+
+    for (int clusterId = 1; clusterId <= nClusters; ++clusterId)
+    {
+        S9sVariantMap cluster;
+        S9sString     name;
+
+        name.sprintf("cluster_%d", clusterId);
+
+        cluster["cluster_id"]   = clusterId;
+        cluster["cluster_name"] = name;
+        cluster["state"]        = "STARTED";
+
+        clusters << cluster;
+    }
+
+    return clusters;
+}
+
+/**
+ * \returns CPU statistics of two hosts with two cores each.
+ */
+S9sVariantList
+UtS9sTopFleet::createCpuStats(
+        const double idle)
+{
+    S9sVariantList samples;
+
+    for (int core = 0; core < 4; ++core)
+    {
+        S9sVariantMap sample;
+        S9sString     key;
+
+        key.sprintf("cpustat-%d-%d", core / 2 + 1, core % 2);
+
+        sample["samplekey"] = key;
+        sample["created"]   = 100;
+        sample["hostid"]    = core / 2 + 1;
+        sample["idle"]      = idle;
+
+        samples << sample;
+    }
+
+    return samples;
+}
+
+/**
+ * \returns Memory statistics of two hosts with 8GiB of memory each.
+ */
+S9sVariantList
+UtS9sTopFleet::createMemoryStats(
+        const ulonglong used)
+{
+    S9sVariantList samples;
+
+    for (int hostId = 1; hostId <= 2; ++hostId)
+    {
+        S9sVariantMap sample;
+        S9sString     key;
+
+        key.sprintf("memorystat-%d", hostId);
+
+        sample["samplekey"]  = key;
+        sample["created"]    = 100;
+        sample["hostid"]     = hostId;
+        sample["ramtotal"]   = 8 * GIGABYTE;
+        sample["ramfree"]    = 8 * GIGABYTE - used - GIGABYTE;
+        sample["rambuffers"] = GIGABYTE / 2;
+        sample["ramcached"]  = GIGABYTE / 2;
+
+        samples << sample;
+    }
+
+    return samples;
+}
+
+S9sVariantList
+UtS9sTopFleet::createHosts(
+        const S9sString &hostName)
+{
+    S9sVariantList hosts;
+    S9sVariantList processes;
+    S9sVariantMap  host;
+    S9sVariantMap  process;
+
+    process["pid"]        = 100;
+    process["user"]       = "mysql";
+    process["cpu_usage"]  = hostName == "db1" ? 40.0 : 30.0;
+    process["executable"] = "mysqld";
+    processes << process;
+
+    process.clear();
+    process["pid"]        = 1;
+    process["user"]       = "root";
+    process["cpu_usage"]  = 0.0;
+    process["executable"] = "systemd";
+    processes << process;
+
+    host["hostname"]      = hostName;
+    host["processes"]     = processes;
+    hosts << host;
+
+    return hosts;
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sTopFleet)
@@ -0,0 +1,422 @@
+/*
+ * Severalnines Tools
+ * Copyright (C) 2016-2018 Severalnines AB
+ *
+ * This file is part of s9s-tools.
+ *
+ * s9s-tools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * s9s-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with s9s-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ut_s9streenode.h"
+
+#include "s9streenode.h"
+
+//#define DEBUG
+#include "s9sdebug.h"
+
+UtS9sTreeNode::UtS9sTreeNode()
+{
+}
+
+UtS9sTreeNode::~UtS9sTreeNode()
+{
+}
+
+bool
+UtS9sTreeNode::runTest(const char *testName)
+{
+    bool retval = true;
+
+    PERFORM_TEST(testCreate,        retval);
+    PERFORM_TEST(testChildren,      retval);
+    PERFORM_TEST(testSubTree,       retval);
+    PERFORM_TEST(testShare,         retval);
+    PERFORM_TEST(testToVariantMap,  retval);
+    PERFORM_TEST(testLargeTree,     retval);
+    PERFORM_TEST(testIsEqual,       retval);
+    PERFORM_TEST(testReplaceSubTree, retval);
+
+    return retval;
+}
+
+bool
+UtS9sTreeNode::testCreate()
+{
+    S9sTreeNode empty;
+    S9sTreeNode root(createTree());
+
+    S9S_COMPARE(empty.nChildren(), 0);
+    S9S_VERIFY(!empty.hasParent());
+    S9S_COMPARE(empty.property("class_name").toString(), "CmonTreeNode");
+
+    // The root has no name, only a path.
+    S9S_COMPARE(root.name(), "/");
+    S9S_COMPARE(root.path(), "/");
+    S9S_VERIFY(root.isFolder());
+    S9S_VERIFY(!root.hasParent());
+    S9S_VERIFY(root.hasProperty("item_type"));
+    S9S_VERIFY(!root.hasProperty("sub_items"));
+    S9S_VERIFY(root.property("sub_items").isInvalid());
+    S9S_COMPARE(root.typeAsChar(), 'd');
+
+    return true;
+}
+
+bool
+UtS9sTreeNode::testChildren()
+{
+    S9sTreeNode            root(createTree());
+    S9sVector<S9sTreeNode> children = root.childNodes();
+    S9sTreeNode            home;
+
+    S9S_COMPARE(root.nChildren(), 3);
+    S9S_COMPARE((int) children.size(), 3);
+    S9S_COMPARE(children[0].name(), "groups");
+    S9S_COMPARE(children[1].name(), "home");
+    S9S_COMPARE(children[2].name(), "clusters");
+    S9S_COMPARE(children[2].typeAsChar(), 'd');
+
+    S9S_VERIFY(root.hasChild("home"));
+    S9S_VERIFY(!root.hasChild("pipas"));
+
+    home = root.childNode(1);
+    S9S_COMPARE(home.nChildren(), 2);
+    S9S_COMPARE(home.childNode(0).name(), "pipas");
+    S9S_COMPARE(home.childNode(0).fullPath(), "/home/pipas");
+    S9S_VERIFY(home.childNode(0).isUser());
+
+    // Out of range.
+    S9S_COMPARE(home.childNode(2).name(), "");
+    S9S_COMPARE(home.childNode(-1).name(), "");
+
+    // The parent points back into the same tree.
+    S9S_VERIFY(home.childNode(0).hasParent());
+    S9S_COMPARE(home.childNode(0).parent().name(), "home");
+    S9S_COMPARE(home.parent().name(), "/");
+    S9S_COMPARE(root.parent().name(), "/");
+
+    return true;
+}
+
+bool
+UtS9sTreeNode::testSubTree()
+{
+    S9sTreeNode root(createTree());
+    S9sTreeNode node;
+
+    S9S_VERIFY(root.subTree("/home/pipas", node));
+    S9S_COMPARE(node.name(), "pipas");
+    S9S_COMPARE(node.path(), "/home");
+
+    S9S_VERIFY(root.subTree("home", node));
+    S9S_COMPARE(node.name(), "home");
+
+    S9S_VERIFY(root.subTree("/", node));
+    S9S_COMPARE(node.name(), "/");
+
+    S9S_VERIFY(!root.subTree("/home/nobody", node));
+    S9S_VERIFY(!root.subTree("/home/pipas/x", node));
+
+    S9S_VERIFY(root.pathExists("/clusters/ft_galera"));
+    S9S_VERIFY(!root.pathExists("/clusters/ft_galeraX"));
+
+    // The path is relative to the node.
+    S9S_VERIFY(root.subTree("home", node));
+    S9S_VERIFY(node.pathExists("pipas"));
+    S9S_VERIFY(!node.pathExists("home/pipas"));
+
+    /*
+     * If there are more entries with the same name, only the first one is
+     * found, also when looking deeper.
+     */
+    S9S_VERIFY(root.subTree("/clusters/ft_galera", node));
+    S9S_COMPARE(node.spec(), "first");
+    S9S_VERIFY(!root.pathExists("/clusters/ft_galera/databases"));
+
+    return true;
+}
+
+/**
+ * The nodes are handles, copying them does not copy the tree and the nodes
+ * stay valid while the original tree is gone.
+ */
+bool
+UtS9sTreeNode::testShare()
+{
+    S9sTreeNode pipas;
+    S9sTreeNode copy;
+
+    {
+        S9sTreeNode root(createTree());
+
+        root.subTree("/home/pipas", pipas);
+        copy = root;
+    }
+
+    S9S_COMPARE(pipas.name(), "pipas");
+    S9S_COMPARE(pipas.parent().parent().name(), "/");
+    S9S_COMPARE(copy.nChildren(), 3);
+
+    // Assigning new properties makes a new tree, the old one is not changed.
+    copy = createEntry("/", "", "Folder");
+    S9S_COMPARE(copy.nChildren(), 0);
+    S9S_COMPARE(pipas.parent().nChildren(), 2);
+
+    copy = pipas;
+    S9S_COMPARE(copy.name(), "pipas");
+
+    copy = copy;
+    S9S_COMPARE(copy.name(), "pipas");
+
+    return true;
+}
+
+bool
+UtS9sTreeNode::testToVariantMap()
+{
+    S9sVariantMap  original = createTree();
+    S9sTreeNode    root(original);
+    S9sTreeNode    home;
+    S9sVariantMap  theMap;
+
+    theMap = root.toVariantMap();
+    S9S_COMPARE(theMap["class_name"].toString(), "CmonTreeNode");
+    S9S_COMPARE(theMap["sub_items"].toVariantList().size(), 3);
+    
+    root.subTree("/home", home);
+    theMap = home.toVariantMap();
+    S9S_COMPARE(theMap["item_name"].toString(), "home");
+    S9S_COMPARE(theMap["sub_items"].toVariantList().size(), 2);
+    S9S_COMPARE(
+            theMap["sub_items"][0]["item_name"].toString(), "pipas");
+
+    // Leaves have no sub_items.
+    theMap = home.childNode(1).toVariantMap();
+    S9S_VERIFY(!theMap.contains("sub_items"));
+
+    return true;
+}
+
+/**
+ * A wide and deep tree is built and walked. Copying the sub-trees for every
+ * node would make this quadratic.
+ */
+bool
+UtS9sTreeNode::testLargeTree()
+{
+    S9sVariantList  folders;
+    S9sVariantMap   deep = createEntry("/deep", "leaf", "File");
+    S9sTreeNode     root;
+    S9sTreeNode     node;
+    S9sString       path;
+    int             nNodes = 1;
+
+    for (int idx = 0; idx < 1000; ++idx)
+    {
+        S9sVariantList files;
+        S9sString      folderName;
+
+        folderName.sprintf("folder%d", idx);
+
+        for (int idx1 = 0; idx1 < 100; ++idx1)
+        {
+            S9sString fileName;
+
+            fileName.sprintf("file%d", idx1);
+            files << createEntry("/" + folderName, fileName, "File");
+        }
+
+        folders << createEntry("/", folderName, "Folder", files);
+        nNodes += 101;
+    }
+
+    // 200 levels deep.
+    for (int idx = 0; idx < 200; ++idx)
+    {
+        S9sVariantList subItems;
+
+        subItems << deep;
+        deep = createEntry("/deep", "deep", "Folder", subItems);
+        path += "/deep";
+    }
+
+    folders << deep;
+    root = createEntry("/", "", "Folder", folders);
+    S9S_COMPARE(root.nChildren(), 1001);
+
+    S9S_VERIFY(root.subTree("/folder999/file99", node));
+    S9S_COMPARE(node.path(), "/folder999");
+    S9S_VERIFY(!root.pathExists("/folder1000"));
+
+    S9S_VERIFY(root.subTree(path + "/leaf", node));
+    S9S_VERIFY(node.isFile());
+
+    // Walking up to the root.
+    for (int idx = 0; idx <= 200; ++idx)
+        node = node.parent();
+    
+    S9S_COMPARE(node.name(), "/");
+    S9S_COMPARE(nNodes, 101001);
+
+    return true;
+}
+
+bool
+UtS9sTreeNode::testIsEqual()
+{
+    S9sTreeNode    root1(createTree());
+    S9sTreeNode    root2(createTree());
+    S9sTreeNode    node1;
+    S9sTreeNode    node2;
+    S9sVariantList home;
+
+    S9S_VERIFY(root1.isEqual(root2));
+    S9S_VERIFY(root1.isEqual(root1));
+
+    // Sub-trees in different trees.
+    S9S_VERIFY(root1.subTree("/home", node1));
+    S9S_VERIFY(root2.subTree("/home", node2));
+    S9S_VERIFY(node1.isEqual(node2));
+    S9S_VERIFY(!node1.isEqual(root2));
+
+    // A property changed.
+    home << createEntry("/home", "pipas", "User");
+    home << createEntry("/home", "system", "Folder");
+    node2 = createEntry("/", "home", "Folder", home);
+    S9S_VERIFY(!node1.isEqual(node2));
+
+    // A child missing.
+    home.clear();
+    home << createEntry("/home", "pipas", "User");
+    node2 = createEntry("/", "home", "Folder", home);
+    S9S_VERIFY(!node1.isEqual(node2));
+    
+    return true;
+}
+
+bool
+UtS9sTreeNode::testReplaceSubTree()
+{
+    S9sTreeNode    root(createTree());
+    S9sTreeNode    original(root);
+    S9sTreeNode    pipas;
+    S9sTreeNode    node;
+    S9sVariantList home;
+    S9sVariantList pipasFiles;
+
+    S9S_VERIFY(root.subTree("/home/pipas", pipas));
+
+    pipasFiles << createEntry("/home/pipas", "notes.txt", "File");
+    home << createEntry("/home", "pipas", "User", pipasFiles);
+    home << createEntry("/home", "system", "User");
+    home << createEntry("/home", "admin", "User");
+
+    node = createEntry("/", "home", "Folder", home);
+    S9S_VERIFY(root.replaceSubTree("/home", node));
+    
+    // The new tree has the new sub-tree and the rest is the same.
+    S9S_COMPARE(root.nChildren(), 3);
+    S9S_VERIFY(root.subTree("/home", node));
+    S9S_COMPARE(node.nChildren(), 3);
+    S9S_VERIFY(root.pathExists("/home/admin"));
+    S9S_VERIFY(root.subTree("/home/pipas/notes.txt", node));
+    S9S_VERIFY(node.isFile());
+    S9S_COMPARE(node.parent().parent().parent().name(), "/");
+    S9S_VERIFY(root.subTree("/clusters", node));
+    S9S_COMPARE(node.nChildren(), 2);
+    S9S_COMPARE(node.childNode(1).nChildren(), 1);
+    S9S_COMPARE(root.childNode(0).name(), "groups");
+    S9S_COMPARE(root.childNode(2).name(), "clusters");
+
+    // The old tree is not changed.
+    S9S_VERIFY(!original.pathExists("/home/admin"));
+    S9S_COMPARE(pipas.nChildren(), 0);
+    S9S_COMPARE(pipas.parent().nChildren(), 2);
+    S9S_VERIFY(!root.isEqual(original));
+
+    // Replacing with the same sub-tree.
+    S9S_VERIFY(original.subTree("/home", node));
+    S9S_VERIFY(root.replaceSubTree("/home", node));
+    S9S_VERIFY(root.isEqual(original));
+
+    // Replacing the root.
+    S9S_VERIFY(root.replaceSubTree("/", createEntry("/", "", "Folder")));
+    S9S_COMPARE(root.nChildren(), 0);
+
+    S9S_VERIFY(!root.replaceSubTree("/home", node));
+
+    return true;
+}
+
+S9sVariantMap 
+UtS9sTreeNode::createEntry(
+        const S9sString      &path,
+        const S9sString      &name,
+        const S9sString      &type,
+        const S9sVariantList &subItems)
+{
+    S9sVariantMap retval;
+
+    retval["item_path"] = path;
+    retval["item_type"] = type;
+    retval["item_acl"]  = "user::rwx,group::rwx,other::---";
+
+    if (!name.empty())
+        retval["item_name"] = name;
+
+    if (!subItems.empty())
+        retval["sub_items"] = subItems;
+
+    return retval;
+}
+
+/**
+ * \code
+ * /
+ * ├── groups
+ * ├── home
+ * │   ├── pipas
+ * │   └── system
+ * └── clusters
+ *     ├── ft_galera
+ *     └── ft_galera
+ *         └── databases
+ * \endcode
+ */
+S9sVariantMap 
+UtS9sTreeNode::createTree()
+{
+    S9sVariantList home;
+    S9sVariantList clusters;
+    S9sVariantList databases;
+    S9sVariantList root;
+    S9sVariantMap  cluster;
+
+    home << createEntry("/home", "pipas", "User");
+    home << createEntry("/home", "system", "User");
+
+    cluster = createEntry("/clusters", "ft_galera", "Cluster");
+    cluster["item_spec"] = "first";
+    clusters << cluster;
+
+    databases << createEntry("/clusters/ft_galera", "databases", "Folder");
+    clusters << createEntry("/clusters", "ft_galera", "Cluster", databases);
+
+    root << createEntry("/", "groups", "Folder");
+    root << createEntry("/", "home", "Folder", home);
+    root << createEntry("/", "clusters", "Folder", clusters);
+
+    return createEntry("/", "", "Folder", root);
+}
+
+S9S_UNIT_TEST_MAIN(UtS9sTreeNode)